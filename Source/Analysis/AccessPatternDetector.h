@@ -0,0 +1,113 @@
+﻿// Source/Analysis/AccessPatternDetector.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 预读范围
+ */
+struct PrefetchRange {
+    uint64_t offset = 0;    ///< 文件偏移
+    uint64_t size = 0;      ///< 长度
+};
+
+/**
+ * @brief 单个文件的访问模式识别
+ *
+ * 按读取顺序观察(偏移, 长度)，连续两次步长一致即认为是顺序或固定步长访问
+ * （逐帧播放、倒放、按指令类型跳读都表现为近似固定的偏移步长），
+ * 随后预测接下来depth次访问的范围。步长允许少量抖动以容纳长度略有变化的数据包。
+ * 纯C++实现，不依赖Qt；非线程安全，由调用者加锁。
+ */
+class AccessPatternDetector {
+public:
+    static constexpr int CONFIRM_COUNT = 2;             ///< 步长连续一致的次数达到此值才预读
+    static constexpr uint64_t STRIDE_SLACK = 4096;      ///< 步长允许的固定抖动
+
+    /**
+     * @brief 记录一次访问并返回预测的后续范围
+     * @param offset 本次读取的文件偏移
+     * @param size 本次读取的长度
+     * @param depth 预测的访问次数
+     * @return 预测范围，未识别出模式时为空
+     */
+    std::vector<PrefetchRange> onAccess(uint64_t offset, uint64_t size, int depth)
+    {
+        std::vector<PrefetchRange> ranges;
+
+        if (!m_hasLast) {
+            m_hasLast = true;
+            m_lastOffset = offset;
+            return ranges;
+        }
+
+        const int64_t delta = static_cast<int64_t>(offset - m_lastOffset);
+        m_lastOffset = offset;
+
+        // 重复读取同一位置不改变模式
+        if (delta == 0) {
+            return ranges;
+        }
+
+        if (m_stride != 0 && strideMatches(delta)) {
+            if (m_confidence < CONFIRM_COUNT) {
+                m_confidence++;
+            }
+        }
+        else {
+            m_confidence = 1;
+        }
+        m_stride = delta;
+
+        if (m_confidence < CONFIRM_COUNT || depth <= 0) {
+            return ranges;
+        }
+
+        ranges.reserve(static_cast<size_t>(depth));
+        int64_t next = static_cast<int64_t>(offset);
+        for (int i = 0; i < depth; ++i) {
+            next += m_stride;
+            if (next < 0) {
+                break;
+            }
+            PrefetchRange range;
+            range.offset = static_cast<uint64_t>(next);
+            range.size = size;
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+    /**
+     * @brief 当前识别出的步长，0表示尚未识别
+     */
+    int64_t stride() const { return m_confidence >= CONFIRM_COUNT ? m_stride : 0; }
+
+    void reset()
+    {
+        m_hasLast = false;
+        m_stride = 0;
+        m_confidence = 0;
+    }
+
+private:
+    bool strideMatches(int64_t delta) const
+    {
+        // 方向相同且差异在步长的1/8（至少STRIDE_SLACK）以内
+        if ((delta > 0) != (m_stride > 0)) {
+            return false;
+        }
+        uint64_t a = static_cast<uint64_t>(delta > 0 ? delta : -delta);
+        uint64_t b = static_cast<uint64_t>(m_stride > 0 ? m_stride : -m_stride);
+        uint64_t diff = a > b ? a - b : b - a;
+        uint64_t slack = b / 8 > STRIDE_SLACK ? b / 8 : STRIDE_SLACK;
+        return diff <= slack;
+    }
+
+    bool m_hasLast = false;
+    uint64_t m_lastOffset = 0;
+    int64_t m_stride = 0;
+    int m_confidence = 0;
+};
@@ -0,0 +1,132 @@
+﻿// Source/Analysis/AccessStatistics.h
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief 64位统计计数器
+ *
+ * 使用relaxed原子操作累加，多个线程同时计数不需要加锁；
+ * 按缓存行对齐，相邻计数器被不同线程频繁修改时不会相互干扰（伪共享）。
+ */
+class alignas(64) StatCounter {
+public:
+    void add(uint64_t value = 1) { m_value.fetch_add(value, std::memory_order_relaxed); }
+    uint64_t load() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{ 0 };
+};
+
+/**
+ * @brief 延迟直方图
+ *
+ * 以微秒为单位按2的幂分桶：桶0为[0, 2)，桶i(i>0)为[2^i, 2^(i+1))，最后一个桶收纳更大的值。
+ * 记录只做几次relaxed原子加，可在任意线程调用；快照各桶之间不保证严格一致，用于统计足够。
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKET_COUNT = 32;     // 最后一个桶起点约35分钟
+
+    /**
+     * @brief 直方图快照
+     */
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};   ///< 各桶计数
+        uint64_t count = 0;                             ///< 样本数
+        uint64_t totalMicros = 0;                       ///< 延迟总和（微秒）
+        uint64_t maxMicros = 0;                         ///< 最大延迟（微秒）
+
+        /**
+         * @brief 平均延迟（微秒）
+         */
+        double averageMicros() const
+        {
+            return count > 0 ? static_cast<double>(totalMicros) / count : 0.0;
+        }
+
+        /**
+         * @brief 百分位延迟的上界（微秒），精度为所在桶的上界
+         * @param percentile 百分位(0-100)
+         */
+        uint64_t percentileMicros(double percentile) const
+        {
+            if (count == 0) {
+                return 0;
+            }
+
+            uint64_t target = static_cast<uint64_t>(count * percentile / 100.0);
+            if (target >= count) {
+                target = count - 1;
+            }
+
+            uint64_t seen = 0;
+            for (int i = 0; i < BUCKET_COUNT; ++i) {
+                seen += buckets[i];
+                if (seen > target) {
+                    // 最后一个桶没有上界，用实际最大值
+                    const uint64_t upper = i == BUCKET_COUNT - 1 ? maxMicros : (uint64_t(1) << (i + 1)) - 1;
+                    return upper < maxMicros ? upper : maxMicros;
+                }
+            }
+            return maxMicros;
+        }
+    };
+
+    /**
+     * @brief 记录一次延迟
+     * @param micros 延迟（微秒）
+     */
+    void record(uint64_t micros)
+    {
+        m_buckets[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_totalMicros.fetch_add(micros, std::memory_order_relaxed);
+
+        uint64_t currentMax = m_maxMicros.load(std::memory_order_relaxed);
+        while (micros > currentMax &&
+            !m_maxMicros.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot result;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            result.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count = m_count.load(std::memory_order_relaxed);
+        result.totalMicros = m_totalMicros.load(std::memory_order_relaxed);
+        result.maxMicros = m_maxMicros.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset()
+    {
+        for (auto& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_totalMicros.store(0, std::memory_order_relaxed);
+        m_maxMicros.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static int bucketFor(uint64_t micros)
+    {
+        int bucket = 0;
+        while (micros > 1 && bucket < BUCKET_COUNT - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    alignas(64) std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_totalMicros{ 0 };
+    std::atomic<uint64_t> m_maxMicros{ 0 };
+};
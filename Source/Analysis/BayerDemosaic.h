@@ -0,0 +1,609 @@
+﻿// Source/Analysis/BayerDemosaic.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <emmintrin.h>
+#include "RgbScanlineDecoder.h"
+
+/**
+ * @brief 拜耳RAW数据去马赛克，输出RGB888扫描线
+ *
+ * 输入为MIPI CSI-2打包格式：RAW8每像素1字节；RAW10每4像素5字节，前4字节为高8位，
+ * 第5字节依次为4个像素的低2位；RAW12每2像素3字节，前2字节为高8位，第3字节低4位、高4位
+ * 分别是两个像素的低4位。每行按整组补齐（宽度不是4或2的倍数时，最后一组的空位也占字节），
+ * 行字节数为rowBytes(width)。
+ *
+ * 按行块处理：每块先把所需的RAW行（含上下光晕行，边界按镜像补齐，保持CFA相位）解包为int16，
+ * 再插值并直接写出本块的扫描线，解包、插值和色调映射都在缓存中完成。
+ * - 双线性：缺失分量取相邻同色像素的平均。
+ * - 边缘自适应：绿色按Hamilton-Adams沿梯度较小的方向插值并加二阶修正，
+ *   红蓝按色差(R-G、B-G)在相邻像素间插值，减少边缘处的伪彩色和拉链效应。
+ * 插值用SSE2的int16通道每次处理8个像素，交织输出用SSSE3（运行时检测），
+ * 行尾和不支持SSSE3时由标量代码按相同的整数公式完成，结果逐字节相同。
+ * 色调映射为可选的gamma 1/2.2查找表，关闭时按位数直接截取高8位。
+ * 纯C++实现，不依赖Qt，不同行块可以并行。
+ */
+class BayerDemosaic {
+public:
+    /**
+     * @brief CFA排列，按左上角2x2的顺序命名
+     */
+    enum Pattern {
+        PATTERN_RGGB = 0,
+        PATTERN_GRBG = 1,
+        PATTERN_GBRG = 2,
+        PATTERN_BGGR = 3
+    };
+
+    /**
+     * @brief 插值方法
+     */
+    enum Method {
+        METHOD_BILINEAR = 0,        ///< 双线性
+        METHOD_EDGE_AWARE = 1       ///< 边缘自适应
+    };
+
+    static constexpr int TILE_ROWS = 32;        ///< 每块的输出行数
+    static constexpr int PAD = 2;               ///< 每行左右各补的像素数
+
+    /**
+     * @brief 每个线程复用的工作缓冲
+     */
+    struct Workspace {
+        std::vector<int16_t> raw;       ///< 解包后的RAW行（含光晕行和左右补齐）
+        std::vector<int16_t> green;     ///< 边缘自适应的绿色平面
+        std::vector<int16_t> planes;    ///< 一行的R、G、B平面
+    };
+
+    /**
+     * @brief 构造去马赛克器
+     * @param rawBits RAW位数：8、10或12
+     * @param pattern CFA排列
+     * @param method 插值方法
+     * @param toneMap 是否做gamma色调映射
+     */
+    BayerDemosaic(int rawBits, int pattern, int method, bool toneMap)
+        : m_rawBits(rawBits == 10 || rawBits == 12 ? rawBits : 8)
+        , m_maxValue((1 << m_rawBits) - 1)
+        , m_method(method == METHOD_EDGE_AWARE ? METHOD_EDGE_AWARE : METHOD_BILINEAR)
+        , m_toneMap(toneMap)
+        , m_useSsse3(RgbScanlineDecoder::hasSsse3())
+    {
+        const int p = pattern >= PATTERN_RGGB && pattern <= PATTERN_BGGR ? pattern : PATTERN_RGGB;
+        m_redRow = (p == PATTERN_GBRG || p == PATTERN_BGGR) ? 1 : 0;
+        m_redColumn = (p == PATTERN_GRBG || p == PATTERN_BGGR) ? 1 : 0;
+
+        if (m_toneMap) {
+            m_toneTable.resize(static_cast<size_t>(m_maxValue) + 1);
+            for (int v = 0; v <= m_maxValue; ++v) {
+                const double linear = static_cast<double>(v) / m_maxValue;
+                m_toneTable[static_cast<size_t>(v)] = static_cast<uint8_t>(std::lround(255.0 * std::pow(linear, 1.0 / 2.2)));
+            }
+        }
+    }
+
+    /**
+     * @brief 图像格式对应的RAW位数
+     * @param format RAW8(0x38)、RAW10(0x39)、RAW12(0x3A)
+     * @return 位数，其他格式为0
+     */
+    static int rawBitsOf(uint8_t format)
+    {
+        switch (format) {
+        case 0x38: return 8;
+        case 0x39: return 10;
+        case 0x3A: return 12;
+        default: return 0;
+        }
+    }
+
+    int rawBits() const { return m_rawBits; }
+
+    /**
+     * @brief 一行源数据的字节数，按整组补齐
+     */
+    size_t rowBytes(int width) const { return packedRowBytes(m_rawBits, width); }
+
+    /**
+     * @brief 按位数计算一行源数据的字节数：RAW10每4像素一组5字节，RAW12每2像素一组3字节
+     */
+    static size_t packedRowBytes(int rawBits, int width)
+    {
+        const size_t pixels = static_cast<size_t>(width > 0 ? width : 0);
+        switch (rawBits) {
+        case 10: return (pixels + 3) / 4 * 5;
+        case 12: return (pixels + 1) / 2 * 3;
+        default: return pixels;
+        }
+    }
+
+    /**
+     * @brief 尺寸是否可以处理（镜像补齐需要每个方向至少4个像素）
+     */
+    static bool supports(int width, int height) { return width >= 4 && height >= 4; }
+
+    /**
+     * @brief 去马赛克连续若干行
+     * @param frame 整帧源数据（光晕行需要读取相邻行）
+     * @param srcStride 源数据每行字节数
+     * @param width 图像宽度
+     * @param height 图像高度
+     * @param firstRow 第一行
+     * @param rowCount 行数
+     * @param dst 整帧输出的第0行
+     * @param dstStride 输出每行字节数
+     * @param workspace 工作缓冲，同一时刻只能被一个线程使用
+     */
+    void decodeRows(const uint8_t* frame, size_t srcStride, int width, int height,
+        int firstRow, int rowCount, uint8_t* dst, size_t dstStride, Workspace& workspace) const
+    {
+        if (!supports(width, height)) {
+            return;
+        }
+
+        const int lastRow = std::min(firstRow + rowCount, height);
+        for (int y0 = firstRow; y0 < lastRow; y0 += TILE_ROWS) {
+            decodeTile(frame, srcStride, width, height, y0, std::min(y0 + TILE_ROWS, lastRow),
+                dst, dstStride, workspace);
+        }
+    }
+
+    /**
+     * @brief 按2x2超像素缩小一行，用于缩略图
+     *
+     * 每factor个像素取一个CFA块，块内的红、蓝像素和两个绿像素的平均直接组成一个RGB像素，不做插值。
+     * @param row0 CFA块上一行的源数据，必须是偶数行
+     * @param row1 CFA块下一行的源数据
+     * @param width 图像宽度
+     * @param factor 缩小倍数，偶数
+     * @param out 输出width / factor个RGB像素
+     * @param workspace 工作缓冲
+     */
+    void decodeSuperpixelRow(const uint8_t* row0, const uint8_t* row1, int width, int factor,
+        uint8_t* out, Workspace& workspace) const
+    {
+        if (width < 2 || factor < 2 || (factor & 1) != 0) {
+            return;
+        }
+
+        workspace.raw.resize(static_cast<size_t>(width) * 2);
+        int16_t* top = workspace.raw.data();
+        int16_t* bottom = top + width;
+        unpackRow(row0, top, width);
+        unpackRow(row1, bottom, width);
+
+        const int16_t* redRow = m_redRow == 0 ? top : bottom;
+        const int16_t* blueRow = m_redRow == 0 ? bottom : top;
+        const int shift = m_rawBits - 8;
+        const int outputWidth = width / factor;
+        for (int x = 0; x < outputWidth; ++x) {
+            const int block = x * factor;
+            const int red = redRow[block + m_redColumn];
+            const int green = average(redRow[block + 1 - m_redColumn], blueRow[block + m_redColumn]);
+            const int blue = blueRow[block + 1 - m_redColumn];
+            uint8_t* pixel = out + static_cast<size_t>(x) * 3;
+            if (m_toneMap) {
+                pixel[0] = m_toneTable[static_cast<size_t>(red)];
+                pixel[1] = m_toneTable[static_cast<size_t>(green)];
+                pixel[2] = m_toneTable[static_cast<size_t>(blue)];
+            }
+            else {
+                pixel[0] = static_cast<uint8_t>(red >> shift);
+                pixel[1] = static_cast<uint8_t>(green >> shift);
+                pixel[2] = static_cast<uint8_t>(blue >> shift);
+            }
+        }
+    }
+
+private:
+    /// 光晕行数：双线性需要上下各1行；边缘自适应的绿色平面需要上下各1行，每行绿色又需要上下各2行
+    int halo() const { return m_method == METHOD_EDGE_AWARE ? 3 : 1; }
+
+    static int reflect(int index, int count)
+    {
+        if (index < 0) {
+            return -index;
+        }
+        return index >= count ? 2 * (count - 1) - index : index;
+    }
+
+    void decodeTile(const uint8_t* frame, size_t srcStride, int width, int height,
+        int y0, int y1, uint8_t* dst, size_t dstStride, Workspace& ws) const
+    {
+        const int h = halo();
+        const int stride = width + 2 * PAD;
+        const int rawRows = (y1 - y0) + 2 * h;
+        ws.raw.resize(static_cast<size_t>(rawRows) * stride);
+        ws.planes.resize(static_cast<size_t>(width) * 3);
+
+        // 解包本块需要的全部RAW行，上下越界的行按镜像取，保持CFA相位
+        for (int r = 0; r < rawRows; ++r) {
+            const int sourceRow = reflect(y0 - h + r, height);
+            int16_t* row = ws.raw.data() + static_cast<size_t>(r) * stride + PAD;
+            unpackRow(frame + static_cast<size_t>(sourceRow) * srcStride, row, width);
+            padRow(row, width);
+        }
+        auto rawRow = [&](int y) { return ws.raw.data() + static_cast<size_t>(y - (y0 - h)) * stride + PAD; };
+
+        if (m_method == METHOD_EDGE_AWARE) {
+            // 绿色平面：第y0-1行到第y1行
+            const int greenRows = (y1 - y0) + 2;
+            ws.green.resize(static_cast<size_t>(greenRows) * stride);
+            for (int r = 0; r < greenRows; ++r) {
+                const int y = y0 - 1 + r;
+                int16_t* green = ws.green.data() + static_cast<size_t>(r) * stride + PAD;
+                const int16_t* rows[5] = { rawRow(y - 2), rawRow(y - 1), rawRow(y), rawRow(y + 1), rawRow(y + 2) };
+                interpolateGreenRow(rows, green, width, siteParity(reflect(y, height)));
+                padRow(green, width);
+            }
+        }
+        auto greenRow = [&](int y) { return ws.green.data() + static_cast<size_t>(y - (y0 - 1)) * stride + PAD; };
+
+        int16_t* red = ws.planes.data();
+        int16_t* green = red + width;
+        int16_t* blue = green + width;
+        for (int y = y0; y < y1; ++y) {
+            const bool redRow = (y & 1) == m_redRow;
+            const int parity = siteParity(y);
+            const int16_t* rows[3] = { rawRow(y - 1), rawRow(y), rawRow(y + 1) };
+
+            // own为本行的非绿颜色，other为另一种
+            int16_t* own = redRow ? red : blue;
+            int16_t* other = redRow ? blue : red;
+            if (m_method == METHOD_EDGE_AWARE) {
+                const int16_t* greens[3] = { greenRow(y - 1), greenRow(y), greenRow(y + 1) };
+                interpolateEdgeAwareRow(rows, greens, own, green, other, width, parity);
+            }
+            else {
+                interpolateBilinearRow(rows, own, green, other, width, parity);
+            }
+
+            writeOutput(red, green, blue, dst + static_cast<size_t>(y) * dstStride, width);
+        }
+    }
+
+    /**
+     * @brief 第y行非绿像素所在列的奇偶
+     */
+    int siteParity(int y) const
+    {
+        return (y & 1) == m_redRow ? m_redColumn : 1 - m_redColumn;
+    }
+
+    static void padRow(int16_t* row, int width)
+    {
+        row[-1] = row[1];
+        row[-2] = row[2];
+        row[width] = row[width - 2];
+        row[width + 1] = row[width - 3];
+    }
+
+    // ---------------------------------------------------------------- 解包
+
+    void unpackRow(const uint8_t* src, int16_t* out, int width) const
+    {
+        int x = 0;
+        if (m_rawBits == 8) {
+            const __m128i zero = _mm_setzero_si128();
+            for (; x + 16 <= width; x += 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_unpacklo_epi8(in, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + 8), _mm_unpackhi_epi8(in, zero));
+            }
+            for (; x < width; ++x) {
+                out[x] = src[x];
+            }
+            return;
+        }
+
+        if (m_useSsse3) {
+            x = m_rawBits == 10 ? unpackRaw10Ssse3(src, out, width) : unpackRaw12Ssse3(src, out, width);
+        }
+
+        if (m_rawBits == 10) {
+            for (; x < width; ++x) {
+                const uint8_t* group = src + (x / 4) * 5;
+                out[x] = static_cast<int16_t>((group[x % 4] << 2) | ((group[4] >> (2 * (x % 4))) & 0x3));
+            }
+        }
+        else {
+            for (; x < width; ++x) {
+                const uint8_t* group = src + (x / 2) * 3;
+                out[x] = static_cast<int16_t>((group[x % 2] << 4) | ((group[2] >> (4 * (x % 2))) & 0xF));
+            }
+        }
+    }
+
+    /**
+     * @brief RAW10：每次8个像素（10字节），每个16位通道取(低位字节, 高8位字节)，按像素位置移出低2位
+     */
+    RGB_DECODER_SSSE3 static int unpackRaw10Ssse3(const uint8_t* src, int16_t* out, int width)
+    {
+        const __m128i gather = _mm_setr_epi8(4, 0, 4, 1, 4, 2, 4, 3, 9, 5, 9, 6, 9, 7, 9, 8);
+        const __m128i lowShift = _mm_setr_epi16(1 << 14, 1 << 12, 1 << 10, 1 << 8, 1 << 14, 1 << 12, 1 << 10, 1 << 8);
+        const __m128i highMask = _mm_set1_epi16(static_cast<short>(0xFF00));
+
+        // 每次读16字节，源数据最后不足16字节的部分交给标量
+        const size_t totalBytes = packedRowBytes(10, width);
+        int x = 0;
+        for (; x + 8 <= width && static_cast<size_t>(x / 4) * 5 + 16 <= totalBytes; x += 8) {
+            const __m128i word = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (x / 4) * 5)), gather);
+            const __m128i high = _mm_srli_epi16(_mm_and_si128(word, highMask), 6);
+            const __m128i low = _mm_srli_epi16(_mm_mullo_epi16(word, lowShift), 14);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_or_si128(high, low));
+        }
+        return x;
+    }
+
+    /**
+     * @brief RAW12：每次8个像素（12字节），偶数像素取低半字节，奇数像素取高半字节
+     */
+    RGB_DECODER_SSSE3 static int unpackRaw12Ssse3(const uint8_t* src, int16_t* out, int width)
+    {
+        const __m128i gather = _mm_setr_epi8(2, 0, 2, 1, 5, 3, 5, 4, 8, 6, 8, 7, 11, 9, 11, 10);
+        const __m128i lowShift = _mm_setr_epi16(1 << 12, 1 << 8, 1 << 12, 1 << 8, 1 << 12, 1 << 8, 1 << 12, 1 << 8);
+        const __m128i highMask = _mm_set1_epi16(static_cast<short>(0xFF00));
+
+        const size_t totalBytes = packedRowBytes(12, width);
+        int x = 0;
+        for (; x + 8 <= width && static_cast<size_t>(x / 2) * 3 + 16 <= totalBytes; x += 8) {
+            const __m128i word = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (x / 2) * 3)), gather);
+            const __m128i high = _mm_srli_epi16(_mm_and_si128(word, highMask), 4);
+            const __m128i low = _mm_srli_epi16(_mm_mullo_epi16(word, lowShift), 12);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_or_si128(high, low));
+        }
+        return x;
+    }
+
+    // ---------------------------------------------------------------- SIMD辅助
+
+    static __m128i load(const int16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(int16_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    /// mask为全1的通道取a，否则取b
+    static __m128i select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    static __m128i absolute(__m128i v) { return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v)); }
+
+    /// 偶数通道（parity为0）或奇数通道（parity为1）全1的掩码
+    static __m128i siteMask(int parity)
+    {
+        return parity == 0 ? _mm_setr_epi16(-1, 0, -1, 0, -1, 0, -1, 0) : _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+    }
+
+    /// 与_mm_avg_epu16相同的舍入：(a + b + 1) >> 1
+    static int average(int a, int b) { return (a + b + 1) >> 1; }
+
+    int clampValue(int v) const { return v < 0 ? 0 : (v > m_maxValue ? m_maxValue : v); }
+
+    // ---------------------------------------------------------------- 双线性
+
+    void interpolateBilinearRow(const int16_t* const rows[3], int16_t* own, int16_t* green, int16_t* other,
+        int width, int parity) const
+    {
+        const int16_t* up = rows[0];
+        const int16_t* mid = rows[1];
+        const int16_t* down = rows[2];
+
+        int x = 0;
+        const __m128i site = siteMask(parity);
+        for (; x + 8 <= width; x += 8) {
+            const __m128i c = load(mid + x);
+            const __m128i horizontal = _mm_avg_epu16(load(mid + x - 1), load(mid + x + 1));
+            const __m128i vertical = _mm_avg_epu16(load(up + x), load(down + x));
+            const __m128i cross = _mm_avg_epu16(horizontal, vertical);
+            const __m128i diagonal = _mm_avg_epu16(_mm_avg_epu16(load(up + x - 1), load(up + x + 1)),
+                _mm_avg_epu16(load(down + x - 1), load(down + x + 1)));
+
+            store(own + x, select(site, c, horizontal));
+            store(green + x, select(site, cross, c));
+            store(other + x, select(site, diagonal, vertical));
+        }
+
+        for (; x < width; ++x) {
+            const int c = mid[x];
+            const int horizontal = average(mid[x - 1], mid[x + 1]);
+            const int vertical = average(up[x], down[x]);
+            if ((x & 1) == parity) {
+                own[x] = static_cast<int16_t>(c);
+                green[x] = static_cast<int16_t>(average(horizontal, vertical));
+                other[x] = static_cast<int16_t>(average(average(up[x - 1], up[x + 1]), average(down[x - 1], down[x + 1])));
+            }
+            else {
+                own[x] = static_cast<int16_t>(horizontal);
+                green[x] = static_cast<int16_t>(c);
+                other[x] = static_cast<int16_t>(vertical);
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------- 边缘自适应
+
+    /**
+     * @brief 生成一行绿色：绿色像素原样保留，红蓝像素沿梯度较小的方向插值
+     *
+     * 梯度 = |相邻两点之差| + |2c - 隔一点的两点|，估计值 = (2(相邻之和) + 2c - 隔一点之和) >> 2，
+     * 两个方向梯度相等时取两个估计的平均。
+     */
+    void interpolateGreenRow(const int16_t* const rows[5], int16_t* out, int width, int parity) const
+    {
+        const int16_t* up2 = rows[0];
+        const int16_t* up = rows[1];
+        const int16_t* mid = rows[2];
+        const int16_t* down = rows[3];
+        const int16_t* down2 = rows[4];
+
+        int x = 0;
+        const __m128i site = siteMask(parity);
+        const __m128i maxValue = _mm_set1_epi16(static_cast<short>(m_maxValue));
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 8 <= width; x += 8) {
+            const __m128i c = load(mid + x);
+            const __m128i c2 = _mm_add_epi16(c, c);
+            const __m128i west = load(mid + x - 1);
+            const __m128i east = load(mid + x + 1);
+            const __m128i north = load(up + x);
+            const __m128i south = load(down + x);
+            const __m128i laplaceH = _mm_sub_epi16(c2, _mm_add_epi16(load(mid + x - 2), load(mid + x + 2)));
+            const __m128i laplaceV = _mm_sub_epi16(c2, _mm_add_epi16(load(up2 + x), load(down2 + x)));
+
+            const __m128i gradH = _mm_add_epi16(absolute(_mm_sub_epi16(west, east)), absolute(laplaceH));
+            const __m128i gradV = _mm_add_epi16(absolute(_mm_sub_epi16(north, south)), absolute(laplaceV));
+            const __m128i sumH = _mm_add_epi16(west, east);
+            const __m128i sumV = _mm_add_epi16(north, south);
+            const __m128i estimateH = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(sumH, sumH), laplaceH), 2);
+            const __m128i estimateV = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(sumV, sumV), laplaceV), 2);
+            const __m128i estimateBoth = _mm_srai_epi16(_mm_add_epi16(estimateH, estimateV), 1);
+
+            __m128i g = select(_mm_cmplt_epi16(gradH, gradV), estimateH,
+                select(_mm_cmplt_epi16(gradV, gradH), estimateV, estimateBoth));
+            g = _mm_min_epi16(_mm_max_epi16(g, zero), maxValue);
+            store(out + x, select(site, g, c));
+        }
+
+        for (; x < width; ++x) {
+            const int c = mid[x];
+            if ((x & 1) != parity) {
+                out[x] = static_cast<int16_t>(c);
+                continue;
+            }
+            const int laplaceH = 2 * c - mid[x - 2] - mid[x + 2];
+            const int laplaceV = 2 * c - up2[x] - down2[x];
+            const int gradH = std::abs(mid[x - 1] - mid[x + 1]) + std::abs(laplaceH);
+            const int gradV = std::abs(up[x] - down[x]) + std::abs(laplaceV);
+            const int estimateH = (2 * (mid[x - 1] + mid[x + 1]) + laplaceH) >> 2;
+            const int estimateV = (2 * (up[x] + down[x]) + laplaceV) >> 2;
+            const int g = gradH < gradV ? estimateH : (gradV < gradH ? estimateV : (estimateH + estimateV) >> 1);
+            out[x] = static_cast<int16_t>(clampValue(g));
+        }
+    }
+
+    /**
+     * @brief 用绿色平面按色差插值红蓝
+     *
+     * 绿色像素：本行颜色取左右色差的平均，另一颜色取上下色差的平均；
+     * 红蓝像素：另一颜色取四个对角色差的平均。
+     */
+    void interpolateEdgeAwareRow(const int16_t* const rows[3], const int16_t* const greens[3],
+        int16_t* own, int16_t* green, int16_t* other, int width, int parity) const
+    {
+        const int16_t* up = rows[0];
+        const int16_t* mid = rows[1];
+        const int16_t* down = rows[2];
+        const int16_t* greenUp = greens[0];
+        const int16_t* greenMid = greens[1];
+        const int16_t* greenDown = greens[2];
+
+        int x = 0;
+        const __m128i site = siteMask(parity);
+        const __m128i maxValue = _mm_set1_epi16(static_cast<short>(m_maxValue));
+        const __m128i zero = _mm_setzero_si128();
+        auto difference = [](const int16_t* raw, const int16_t* g, int offset) {
+            return _mm_sub_epi16(load(raw + offset), load(g + offset));
+            };
+        for (; x + 8 <= width; x += 8) {
+            const __m128i c = load(mid + x);
+            const __m128i g = load(greenMid + x);
+
+            const __m128i horizontal = _mm_srai_epi16(_mm_add_epi16(difference(mid, greenMid, x - 1),
+                difference(mid, greenMid, x + 1)), 1);
+            const __m128i vertical = _mm_srai_epi16(_mm_add_epi16(difference(up, greenUp, x),
+                difference(down, greenDown, x)), 1);
+            const __m128i diagonal = _mm_srai_epi16(_mm_add_epi16(
+                _mm_add_epi16(difference(up, greenUp, x - 1), difference(up, greenUp, x + 1)),
+                _mm_add_epi16(difference(down, greenDown, x - 1), difference(down, greenDown, x + 1))), 2);
+
+            const __m128i ownValue = select(site, c, _mm_add_epi16(g, horizontal));
+            const __m128i otherValue = _mm_add_epi16(g, select(site, diagonal, vertical));
+            store(own + x, _mm_min_epi16(_mm_max_epi16(ownValue, zero), maxValue));
+            store(green + x, g);
+            store(other + x, _mm_min_epi16(_mm_max_epi16(otherValue, zero), maxValue));
+        }
+
+        for (; x < width; ++x) {
+            const int g = greenMid[x];
+            green[x] = static_cast<int16_t>(g);
+            if ((x & 1) == parity) {
+                const int diagonal = ((up[x - 1] - greenUp[x - 1]) + (up[x + 1] - greenUp[x + 1])
+                    + (down[x - 1] - greenDown[x - 1]) + (down[x + 1] - greenDown[x + 1])) >> 2;
+                own[x] = mid[x];
+                other[x] = static_cast<int16_t>(clampValue(g + diagonal));
+            }
+            else {
+                const int horizontal = ((mid[x - 1] - greenMid[x - 1]) + (mid[x + 1] - greenMid[x + 1])) >> 1;
+                const int vertical = ((up[x] - greenUp[x]) + (down[x] - greenDown[x])) >> 1;
+                own[x] = static_cast<int16_t>(clampValue(g + horizontal));
+                other[x] = static_cast<int16_t>(clampValue(g + vertical));
+            }
+        }
+    }
+
+    // ---------------------------------------------------------------- 输出
+
+    void writeOutput(const int16_t* red, const int16_t* green, const int16_t* blue, uint8_t* out, int width) const
+    {
+        if (m_toneMap) {
+            const uint8_t* table = m_toneTable.data();
+            for (int x = 0; x < width; ++x) {
+                out[3 * x] = table[red[x]];
+                out[3 * x + 1] = table[green[x]];
+                out[3 * x + 2] = table[blue[x]];
+            }
+            return;
+        }
+
+        const int shift = m_rawBits - 8;
+        int x = m_useSsse3 ? writeLinearSsse3(red, green, blue, out, width, shift) : 0;
+        for (; x < width; ++x) {
+            out[3 * x] = static_cast<uint8_t>(red[x] >> shift);
+            out[3 * x + 1] = static_cast<uint8_t>(green[x] >> shift);
+            out[3 * x + 2] = static_cast<uint8_t>(blue[x] >> shift);
+        }
+    }
+
+    /**
+     * @brief 截取高8位并交织为R G B，每次8个像素
+     */
+    RGB_DECODER_SSSE3 static int writeLinearSsse3(const int16_t* red, const int16_t* green, const int16_t* blue,
+        uint8_t* out, int width, int shift)
+    {
+        const __m128i count = _mm_cvtsi32_si128(shift);
+        const __m128i rgToLow = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+        const __m128i bToLow = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+        const __m128i rgToHigh = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i bToHigh = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i r = _mm_srl_epi16(load(red + x), count);
+            const __m128i g = _mm_srl_epi16(load(green + x), count);
+            const __m128i b = _mm_srl_epi16(load(blue + x), count);
+            const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+            const __m128i b8 = _mm_packus_epi16(b, b);
+
+            uint8_t* pixel = out + static_cast<size_t>(x) * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel),
+                _mm_or_si128(_mm_shuffle_epi8(rg, rgToLow), _mm_shuffle_epi8(b8, bToLow)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pixel + 16),
+                _mm_or_si128(_mm_shuffle_epi8(rg, rgToHigh), _mm_shuffle_epi8(b8, bToHigh)));
+        }
+        return x;
+    }
+
+    int m_rawBits;                          ///< RAW位数
+    int m_maxValue;                         ///< RAW最大值
+    int m_method;                           ///< 插值方法
+    bool m_toneMap;                         ///< 是否色调映射
+    bool m_useSsse3;                        ///< 是否使用SSSE3路径
+    int m_redRow = 0;                       ///< 红色像素所在行的奇偶
+    int m_redColumn = 0;                    ///< 红色像素所在列的奇偶
+    std::vector<uint8_t> m_toneTable;       ///< 色调映射表
+};
@@ -0,0 +1,248 @@
+﻿// Source/Analysis/BlockCache.cpp
+#include "BlockCache.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+BlockCache::BlockCache(qint64 budgetBytes, EvictionPolicy policy, int shardCount)
+    : m_budget(budgetBytes)
+    , m_policy(policy)
+{
+    int bits = 0;
+    while ((1 << bits) < std::max(shardCount, 1)) {
+        bits++;
+    }
+    m_shardShift = 64 - bits;
+
+    m_shards.reserve(static_cast<size_t>(1) << bits);
+    for (int i = 0; i < (1 << bits); ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->hand = shard->order.end();
+        m_shards.push_back(std::move(shard));
+    }
+}
+
+BlockCache::Shard& BlockCache::shardFor(quint64 key) const
+{
+    // 乘法哈希取高位，相邻块均匀分布到不同分片
+    if (m_shardShift >= 64) {
+        return *m_shards[0];
+    }
+    quint64 hash = key * 0x9E3779B97F4A7C15ull;
+    return *m_shards[static_cast<size_t>(hash >> m_shardShift)];
+}
+
+bool BlockCache::lookup(uint32_t fileId, uint64_t blockIndex, int minLength, QByteArray& block,
+    bool* prefetchHit)
+{
+    const quint64 key = makeKey(fileId, blockIndex);
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+
+    auto it = shard.slots.find(key);
+    if (it == shard.slots.end() || it->data.size() < minLength) {
+        return false;
+    }
+
+    if (m_policy.load(std::memory_order_relaxed) == EvictionPolicy::LRU) {
+        shard.order.splice(shard.order.begin(), shard.order, it->position);
+        it->lastUse = m_useCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    else {
+        it->referenced = true;
+    }
+
+    if (it->prefetched) {
+        it->prefetched = false;
+        if (prefetchHit) {
+            *prefetchHit = true;
+        }
+    }
+
+    block = it->data;
+    return true;
+}
+
+void BlockCache::insert(uint32_t fileId, uint64_t blockIndex, const QByteArray& block, bool prefetched)
+{
+    if (block.isEmpty() || block.size() > BLOCK_SIZE) {
+        return;
+    }
+
+    const quint64 key = makeKey(fileId, blockIndex);
+    const EvictionPolicy policy = m_policy.load(std::memory_order_relaxed);
+    const quint64 use = m_useCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    {
+        Shard& shard = shardFor(key);
+        QMutexLocker locker(&shard.mutex);
+
+        auto it = shard.slots.find(key);
+        if (it != shard.slots.end()) {
+            // 已存在（例如文件增长后的尾块），替换数据
+            const qint64 delta = block.size() - it->data.size();
+            shard.usedBytes += delta;
+            m_usedBytes.fetch_add(delta, std::memory_order_relaxed);
+            it->data = block;
+            it->lastUse = use;
+        }
+        else {
+            Slot slot;
+            slot.data = block;
+            slot.prefetched = prefetched;
+            slot.lastUse = use;
+            if (policy == EvictionPolicy::LRU) {
+                slot.position = shard.order.insert(shard.order.begin(), key);
+            }
+            else {
+                // 插在指针之前（指针在末尾时即追加到末尾），新块要等指针转一圈才会被检查
+                slot.position = shard.order.insert(shard.hand, key);
+            }
+            shard.slots.insert(key, slot);
+            shard.usedBytes += block.size();
+            m_usedBytes.fetch_add(block.size(), std::memory_order_relaxed);
+        }
+    }
+
+    evictToBudget();
+}
+
+bool BlockCache::contains(uint32_t fileId, uint64_t blockIndex) const
+{
+    const quint64 key = makeKey(fileId, blockIndex);
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+    return shard.slots.contains(key);
+}
+
+void BlockCache::evictToBudget()
+{
+    const EvictionPolicy policy = m_policy.load(std::memory_order_relaxed);
+    while (m_usedBytes.load(std::memory_order_relaxed) > m_budget.load(std::memory_order_relaxed)) {
+        // 逐个分片查看淘汰候选，不同时持有两把锁；选出后其他线程可能已改动，结果是近似的
+        // LRU看队尾，时钟算法看指针处的块（时钟算法命中不更新序号，按放入的先后比较）
+        Shard* victimShard = nullptr;
+        quint64 oldestUse = 0;
+        for (auto& shard : m_shards) {
+            QMutexLocker locker(&shard->mutex);
+            if (shard->order.empty()) {
+                continue;
+            }
+            quint64 candidate;
+            if (policy == EvictionPolicy::LRU) {
+                candidate = shard->order.back();
+            }
+            else {
+                candidate = shard->hand == shard->order.end() ? shard->order.front() : *shard->hand;
+            }
+            const quint64 candidateUse = shard->slots.find(candidate)->lastUse;
+            if (!victimShard || candidateUse < oldestUse) {
+                victimShard = shard.get();
+                oldestUse = candidateUse;
+            }
+        }
+
+        if (!victimShard) {
+            break;
+        }
+
+        QMutexLocker locker(&victimShard->mutex);
+        evictOneLocked(*victimShard, policy);
+    }
+}
+
+bool BlockCache::evictOneLocked(Shard& shard, EvictionPolicy policy)
+{
+    if (shard.order.empty()) {
+        return false;
+    }
+
+    std::list<quint64>::iterator victim;
+    if (policy == EvictionPolicy::LRU) {
+        victim = std::prev(shard.order.end());
+    }
+    else {
+        // 时钟扫描：跳过并清除访问位，直到找到未被访问的块
+        while (true) {
+            if (shard.hand == shard.order.end()) {
+                shard.hand = shard.order.begin();
+            }
+            Slot& slot = shard.slots[*shard.hand];
+            if (!slot.referenced) {
+                break;
+            }
+            slot.referenced = false;
+            ++shard.hand;
+        }
+        victim = shard.hand;
+    }
+
+    auto slotIt = shard.slots.find(*victim);
+    shard.usedBytes -= slotIt->data.size();
+    m_usedBytes.fetch_sub(slotIt->data.size(), std::memory_order_relaxed);
+    shard.slots.erase(slotIt);
+
+    const bool victimIsHand = shard.hand == victim;
+    std::list<quint64>::iterator next = shard.order.erase(victim);
+    if (victimIsHand) {
+        shard.hand = next;
+    }
+    return true;
+}
+
+void BlockCache::setBudget(qint64 budgetBytes)
+{
+    m_budget.store(budgetBytes);
+    evictToBudget();
+}
+
+void BlockCache::setPolicy(EvictionPolicy policy)
+{
+    if (policy == m_policy.load()) {
+        return;
+    }
+
+    // 两种策略共用同一队列：LRU队首最新，时钟环从指针处开始由旧到新。
+    // 切换时调整方向并重置时钟状态，splice和reverse不会使各块记录的位置失效
+    for (auto& shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        for (Slot& slot : shard->slots) {
+            slot.referenced = false;
+        }
+        if (policy == EvictionPolicy::LRU) {
+            shard->order.splice(shard->order.end(), shard->order, shard->order.begin(), shard->hand);
+            shard->order.reverse();
+        }
+        else {
+            shard->order.reverse();
+        }
+        shard->hand = shard->order.begin();
+    }
+    m_policy.store(policy);
+}
+
+void BlockCache::clear()
+{
+    for (auto& shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        shard->slots.clear();
+        shard->order.clear();
+        shard->hand = shard->order.end();
+        m_usedBytes.fetch_sub(shard->usedBytes, std::memory_order_relaxed);
+        shard->usedBytes = 0;
+    }
+}
+
+qint64 BlockCache::usedBytes() const
+{
+    return m_usedBytes.load(std::memory_order_relaxed);
+}
+
+int BlockCache::blockCount() const
+{
+    int total = 0;
+    for (const auto& shard : m_shards) {
+        QMutexLocker locker(&shard->mutex);
+        total += shard->slots.size();
+    }
+    return total;
+}
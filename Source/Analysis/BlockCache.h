@@ -0,0 +1,144 @@
+﻿// Source/Analysis/BlockCache.h
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <list>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+/**
+ * @brief 分片块缓存
+ *
+ * 以(文件ID, 块号)为键缓存按BLOCK_SIZE对齐的文件数据块，键为64位整数，查找时不构造字符串。
+ * 缓存按键哈希分为多个分片，每个分片独立加锁，并发读取不会争用同一把锁。
+ * 内存预算按全局计算，不平均分给各分片：超出预算时比较各分片的淘汰候选（LRU的队尾、时钟算法的指针处），
+ * 从其中最久未使用的分片淘汰，是近似的全局LRU。一次较大的范围读取集中落在少数分片时，也不会挤出本次刚放入的块。
+ * 文件末尾的块可能不足BLOCK_SIZE，只有请求范围落在已缓存长度内时才视为命中。
+ */
+class BlockCache {
+public:
+    /**
+     * @brief 淘汰策略
+     */
+    enum class EvictionPolicy {
+        LRU,    ///< 最近最少使用：命中时移到队首，从队尾淘汰
+        Clock   ///< 时钟算法：命中只置访问位，淘汰时扫描清除访问位，命中开销更低
+    };
+
+    static constexpr int BLOCK_SHIFT = 16;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_SHIFT;    // 64KB
+    static constexpr int DEFAULT_SHARD_COUNT = 16;
+
+    /**
+     * @brief 构造函数
+     * @param budgetBytes 内存预算（字节），所有分片共用
+     * @param policy 淘汰策略
+     * @param shardCount 分片数，向上取整为2的幂
+     */
+    explicit BlockCache(qint64 budgetBytes, EvictionPolicy policy = EvictionPolicy::LRU,
+        int shardCount = DEFAULT_SHARD_COUNT);
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /**
+     * @brief 查找数据块
+     * @param fileId 文件ID
+     * @param blockIndex 块号（文件偏移 / BLOCK_SIZE）
+     * @param minLength 需要的最小块长度，块较短时视为未命中
+     * @param block 命中时输出块数据（隐式共享，不复制）
+     * @param prefetchHit 可选，命中的块由预读放入且首次被读取时置为true
+     * @return 是否命中
+     */
+    bool lookup(uint32_t fileId, uint64_t blockIndex, int minLength, QByteArray& block,
+        bool* prefetchHit = nullptr);
+
+    /**
+     * @brief 插入或替换数据块
+     * @param fileId 文件ID
+     * @param blockIndex 块号
+     * @param block 块数据，长度不超过BLOCK_SIZE
+     * @param prefetched 是否由预读放入
+     */
+    void insert(uint32_t fileId, uint64_t blockIndex, const QByteArray& block, bool prefetched = false);
+
+    /**
+     * @brief 块是否已缓存（不更新访问记录）
+     */
+    bool contains(uint32_t fileId, uint64_t blockIndex) const;
+
+    /**
+     * @brief 设置内存预算，超出部分立即淘汰
+     */
+    void setBudget(qint64 budgetBytes);
+    qint64 budget() const { return m_budget.load(); }
+
+    /**
+     * @brief 设置淘汰策略
+     */
+    void setPolicy(EvictionPolicy policy);
+    EvictionPolicy policy() const { return m_policy.load(); }
+
+    /**
+     * @brief 清空所有数据块
+     */
+    void clear();
+
+    /**
+     * @brief 当前缓存的字节数
+     */
+    qint64 usedBytes() const;
+
+    /**
+     * @brief 当前缓存的块数
+     */
+    int blockCount() const;
+
+    /**
+     * @brief 由文件ID和块号组成的64位键
+     */
+    static quint64 makeKey(uint32_t fileId, uint64_t blockIndex)
+    {
+        return (static_cast<quint64>(fileId) << 40) | (blockIndex & ((quint64(1) << 40) - 1));
+    }
+
+private:
+    struct Slot {
+        QByteArray data;
+        std::list<quint64>::iterator position;  ///< 在淘汰队列中的位置
+        quint64 lastUse = 0;                    ///< 最近访问序号，分片之间比较新旧
+        bool referenced = false;                ///< 时钟算法访问位
+        bool prefetched = false;                ///< 由预读放入且尚未被读取
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<quint64, Slot> slots;
+        std::list<quint64> order;               ///< LRU队列（队首最新）或时钟环
+        std::list<quint64>::iterator hand;      ///< 时钟指针
+        qint64 usedBytes = 0;
+    };
+
+    Shard& shardFor(quint64 key) const;
+
+    /**
+     * @brief 淘汰到全局预算以内，不持有任何分片锁时调用
+     */
+    void evictToBudget();
+
+    /**
+     * @brief 从分片淘汰一个块（调用者需持有分片锁）
+     * @return 是否淘汰了块
+     */
+    bool evictOneLocked(Shard& shard, EvictionPolicy policy);
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    int m_shardShift;                               ///< 64 - log2(分片数)
+    std::atomic<qint64> m_budget;
+    std::atomic<qint64> m_usedBytes{ 0 };          ///< 所有分片的字节数
+    std::atomic<quint64> m_useCounter{ 0 };        ///< 访问序号
+    std::atomic<EvictionPolicy> m_policy;
+};
@@ -0,0 +1,105 @@
+﻿// Source/Analysis/ChannelDeinterleave.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <emmintrin.h>
+
+/**
+ * @brief 4通道交错数据拆分
+ *
+ * 波形数据按样本交错存放：[CH0 CH1 CH2 CH3][CH0 CH1 CH2 CH3]...，每通道每样本1字节。
+ * split()一次遍历同时拆出4个通道的字节平面，packNonZero()把字节平面压缩为逻辑电平位图。
+ * 两者都用SSE2实现（x64基线指令集，无需运行时检测），尾部不足一组的样本按标量处理。
+ * 纯C++实现，不依赖Qt。
+ */
+class ChannelDeinterleave {
+public:
+    static constexpr int CHANNEL_COUNT = 4;
+
+    /**
+     * @brief 拆分交错样本为4个字节平面
+     * @param src 交错数据，长度至少为sampleCount * CHANNEL_COUNT
+     * @param sampleCount 样本数
+     * @param plane0 通道0输出，长度至少为sampleCount，以下同
+     * @param plane1 通道1输出
+     * @param plane2 通道2输出
+     * @param plane3 通道3输出
+     */
+    static void split(const uint8_t* src, size_t sampleCount,
+        uint8_t* plane0, uint8_t* plane1, uint8_t* plane2, uint8_t* plane3)
+    {
+        size_t i = 0;
+
+        // 每次处理16个样本（64字节）：三轮字节交织把同一通道的字节聚到一起，最后按64位拼出各通道
+        for (; i + 16 <= sampleCount; i += 16) {
+            const __m128i* in = reinterpret_cast<const __m128i*>(src + i * CHANNEL_COUNT);
+            __m128i v0 = _mm_loadu_si128(in);
+            __m128i v1 = _mm_loadu_si128(in + 1);
+            __m128i v2 = _mm_loadu_si128(in + 2);
+            __m128i v3 = _mm_loadu_si128(in + 3);
+
+            __m128i t0 = _mm_unpacklo_epi8(v0, v1);
+            __m128i t1 = _mm_unpackhi_epi8(v0, v1);
+            __m128i t2 = _mm_unpacklo_epi8(v2, v3);
+            __m128i t3 = _mm_unpackhi_epi8(v2, v3);
+
+            __m128i u0 = _mm_unpacklo_epi8(t0, t1);
+            __m128i u1 = _mm_unpackhi_epi8(t0, t1);
+            __m128i u2 = _mm_unpacklo_epi8(t2, t3);
+            __m128i u3 = _mm_unpackhi_epi8(t2, t3);
+
+            // w0: CH0[0..7] CH1[0..7]，w1: CH2[0..7] CH3[0..7]，w2/w3为样本8..15
+            __m128i w0 = _mm_unpacklo_epi8(u0, u1);
+            __m128i w1 = _mm_unpackhi_epi8(u0, u1);
+            __m128i w2 = _mm_unpacklo_epi8(u2, u3);
+            __m128i w3 = _mm_unpackhi_epi8(u2, u3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(plane0 + i), _mm_unpacklo_epi64(w0, w2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(plane1 + i), _mm_unpackhi_epi64(w0, w2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(plane2 + i), _mm_unpacklo_epi64(w1, w3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(plane3 + i), _mm_unpackhi_epi64(w1, w3));
+        }
+
+        for (; i < sampleCount; ++i) {
+            const uint8_t* sample = src + i * CHANNEL_COUNT;
+            plane0[i] = sample[0];
+            plane1[i] = sample[1];
+            plane2[i] = sample[2];
+            plane3[i] = sample[3];
+        }
+    }
+
+    /**
+     * @brief 把字节平面压缩为位图，非零字节对应位为1
+     * @param plane 字节平面
+     * @param count 样本数
+     * @param bits 输出位图，第i个样本对应bits[i / 64]的第(i % 64)位，长度至少为(count + 63) / 64
+     */
+    static void packNonZero(const uint8_t* plane, size_t count, uint64_t* bits)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+
+        // 每次处理64个样本，正好填满一个字
+        for (; i + 64 <= count; i += 64) {
+            uint64_t word = 0;
+            for (int part = 0; part < 4; ++part) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(plane + i + part * 16));
+                uint32_t zeroMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+                word |= static_cast<uint64_t>(~zeroMask & 0xFFFFu) << (part * 16);
+            }
+            bits[i / 64] = word;
+        }
+
+        if (i < count) {
+            uint64_t word = 0;
+            for (size_t j = i; j < count; ++j) {
+                if (plane[j] != 0) {
+                    word |= uint64_t(1) << (j - i);
+                }
+            }
+            bits[i / 64] = word;
+        }
+    }
+};
@@ -2,15 +2,23 @@
 #pragma once
 
 #include <QObject>
-#include <QCache>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QSet>
+#include <QFile>
+#include <QThreadPool>
 #include <QFuture>
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QTimer>
 #include <QPair>
 #include <memory>
+#include <atomic>
 #include "IIndexAccess.h"
+#include "BlockCache.h"
+#include "AccessPatternDetector.h"
+#include "AccessStatistics.h"
 
 class FileOperationController;
 
@@ -54,6 +62,10 @@ public:
 
     /**
      * @brief 读取特定时间范围内的所有数据
+     *
+     * 相邻的数据包合并为大块顺序读取，多个文件并行读取，回调仍在调用线程中按文件、偏移顺序执行。
+     * 回调收到的数据直接引用读取缓冲区，只在回调期间有效，需要保留时应深拷贝。
+     *
      * @param startTime 开始时间戳
      * @param endTime 结束时间戳
      * @param callback 每个数据包的回调函数
@@ -72,6 +84,9 @@ public:
 
     /**
      * @brief 按查询条件读取数据包
+     *
+     * 读取方式与readPacketsInRange相同，回调数据只在回调期间有效。
+     *
      * @param query 查询条件
      * @param callback 每个数据包的回调函数
      * @return 操作是否成功
@@ -105,6 +120,26 @@ public:
      */
     void setCacheSize(int sizeInMB);
 
+    /**
+     * @brief 设置缓存淘汰策略
+     * @param policy LRU或时钟算法
+     */
+    void setCachePolicy(BlockCache::EvictionPolicy policy);
+
+    /**
+     * @brief 设置预读深度
+     * @param packetCount 识别出顺序或固定步长访问后预读的数据包数，0表示关闭预读
+     *
+     * 预读的总字节数另受缓存预算限制（见PREFETCH_BUDGET_DIVISOR），数据包较大时实际预读的包数更少。
+     */
+    void setPrefetchDepth(int packetCount);
+
+    /**
+     * @brief 设置范围读取的合并空隙
+     * @param bytes 相邻数据包间隔不超过此值时合并为一次读取，0表示只合并紧邻的数据包
+     */
+    void setCoalesceGap(int bytes);
+
     /**
      * @brief 清除缓存
      */
@@ -122,18 +157,44 @@ public:
     bool isFileReadable(const QString& filePath);
 
     /**
-     * @brief 性能统计信息
+     * @brief 性能统计信息快照
      */
     struct PerformanceStats {
-        int cacheHits = 0;
-        int cacheMisses = 0;
-        int readErrors = 0;
-        int totalReads = 0;
-        qint64 totalReadTime = 0;
+        quint64 cacheHits = 0;
+        quint64 cacheMisses = 0;
+        quint64 readErrors = 0;
+        quint64 totalReads = 0;
+        qint64 totalReadTime = 0;       // 未命中读取的总耗时（毫秒）
+        quint64 prefetchedBlocks = 0;   // 预读放入缓存的块数
+        quint64 prefetchHits = 0;       // 读取命中预读块的次数
+        quint64 bytesFromCache = 0;     // 由缓存提供的字节数
+        quint64 bytesFromDisk = 0;      // 从磁盘读取的字节数（含预读和范围读取）
+        qint64 cacheUsedBytes = 0;      // 缓存当前占用
+        qint64 cacheBudgetBytes = 0;    // 缓存预算
+
+        LatencyHistogram::Snapshot cacheHitLatency;     // 缓存命中的读取延迟
+        LatencyHistogram::Snapshot cacheMissLatency;    // 缓存未命中的读取延迟（含磁盘读取）
+        LatencyHistogram::Snapshot diskReadLatency;     // 单次磁盘定位+读取的延迟
+
+        /**
+         * @brief 缓存命中率(0-1)
+         */
+        double hitRate() const {
+            quint64 total = cacheHits + cacheMisses;
+            return total > 0 ? static_cast<double>(cacheHits) / total : 0.0;
+        }
+
+        /**
+         * @brief 缓存提供的字节占比(0-1)
+         */
+        double cacheByteRatio() const {
+            quint64 total = bytesFromCache + bytesFromDisk;
+            return total > 0 ? static_cast<double>(bytesFromCache) / total : 0.0;
+        }
     };
 
     /**
-     * @brief 获取性能统计信息
+     * @brief 获取性能统计信息快照，可在任意线程调用
      */
     PerformanceStats getPerformanceStats() const;
 
@@ -161,14 +222,63 @@ public:
      */
     QVector<double> getChannelData(int channel, int startIndex, int length);
 
+    /**
+     * @brief 读取指定范围的数据并一次拆分出4个通道
+     * @param startIndex 起始索引
+     * @param length 数据长度
+     * @return 4个通道的字节平面，读取失败时各平面为空
+     */
+    QVector<QByteArray> getChannelPlanes(int startIndex, int length);
+
+    /**
+     * @brief 当前采集文件的样本总数
+     *
+     * 样本i位于文件偏移20 + 4 * i处；实时保存时文件持续增长，每次调用都重新获取文件大小。
+     *
+     * @return 样本数，没有加载或正在保存的文件时为0
+     */
+    quint64 getCaptureSampleCount() const;
+
+    /**
+     * @brief 采集文件大小对应的样本数
+     * @param fileSize 文件大小（字节）
+     */
+    static quint64 sampleCountForFileSize(quint64 fileSize);
+
+    /**
+     * @brief 按样本位置读取一段波形并一次拆分出4个通道
+     *
+     * 使用64位样本位置，可访问超过4GB的文件；不持有服务内部的锁，可在任意线程调用。
+     *
+     * @param firstSample 第一个样本
+     * @param sampleCount 样本数
+     * @return 4个通道的字节平面，到达文件末尾时样本数少于sampleCount，读取失败时各平面为空
+     */
+    QVector<QByteArray> readChannelSamples(quint64 firstSample, int sampleCount);
+
     /**
      * @brief 从数据包提取通道数据
+     *
+     * 每次调用都要拆分整个数据包，需要多个通道时应使用deinterleaveChannels。
+     *
      * @param data 数据包
      * @param channel 通道索引(0-3)
      * @return 通道数据向量
      */
     QVector<double> extractChannelData(const QByteArray& data, int channel);
 
+    /**
+     * @brief 一次遍历拆分数据包中的4个通道
+     * @param data 数据包（20字节包头之后为4通道交错数据）
+     * @return 4个通道的字节平面，每样本1字节，不做浮点转换
+     */
+    static QVector<QByteArray> deinterleaveChannels(const QByteArray& data);
+
+    /**
+     * @brief 把字节平面转换为逻辑电平（非零为1.0，零为0.0），供绘制使用
+     */
+    static QVector<double> planeToLevels(const QByteArray& plane);
+
     /**
      * @brief 读取指定数据包的波形数据
      * @param packetIndex 数据包索引
@@ -229,12 +339,46 @@ private:
     QMap<QString, FileCache> m_openFiles;
     QMutex m_fileMutex;
 
-    // 数据缓存
-    QCache<QString, QByteArray> m_dataCache;  // 键格式: "filename:offset:size"
-    QMutex m_cacheMutex;
-
-    // 性能统计
-    PerformanceStats m_stats;
+    // 数据块缓存，按(文件ID, 块号)分片缓存对齐的64KB数据块
+    BlockCache m_blockCache;
+
+    // 文件路径到文件ID的映射，缓存键只使用整数ID
+    QHash<QString, uint32_t> m_fileIds;
+    QReadWriteLock m_fileIdLock;
+
+    // 预读：按文件识别访问模式，由单线程池异步读取预测的块
+    static constexpr int DEFAULT_PREFETCH_DEPTH = 8;
+    static constexpr int PREFETCH_BUDGET_DIVISOR = 2;             // 预读范围不超过缓存预算的1/2，避免挤出正在读取的块
+    QThreadPool m_prefetchPool;
+    QMutex m_prefetchMutex;
+    QHash<uint32_t, AccessPatternDetector> m_accessPatterns;   // 各文件的访问模式
+    QSet<quint64> m_prefetchInFlight;                          // 正在预读的块
+    QFile m_prefetchFile;                                       // 预读线程专用句柄，不占用m_fileMutex
+    std::atomic<int> m_prefetchDepth{ DEFAULT_PREFETCH_DEPTH };
+
+    // 范围读取：合并相邻数据包，每个文件一个读取任务
+    static constexpr int DEFAULT_COALESCE_GAP = 64 * 1024;        // 默认合并空隙64KB
+    static constexpr int MAX_RUN_BYTES = 8 * 1024 * 1024;         // 单次读取最大8MB
+    static constexpr int MAX_PARALLEL_FILES = 4;                  // 同时读取的文件数
+    static constexpr int RUN_QUEUE_DEPTH = 4;                     // 每个文件预先读好的块数
+    QThreadPool m_rangeReadPool;
+    std::atomic<int> m_coalesceGap{ DEFAULT_COALESCE_GAP };
+
+    // 性能统计：原子计数，读取线程、预读线程和界面线程可同时更新
+    struct StatsCounters {
+        StatCounter cacheHits;
+        StatCounter cacheMisses;
+        StatCounter readErrors;
+        StatCounter totalReads;
+        StatCounter prefetchedBlocks;
+        StatCounter prefetchHits;
+        StatCounter bytesFromCache;
+        StatCounter bytesFromDisk;
+        LatencyHistogram cacheHitLatency;
+        LatencyHistogram cacheMissLatency;
+        LatencyHistogram diskReadLatency;
+    };
+    StatsCounters m_stats;
 
     // 读取超时（毫秒）
     int m_readTimeout;
@@ -245,8 +389,25 @@ private:
     // 获取或打开文件
     QFile* getOrOpenFile(const QString& filePath);
 
-    // 生成缓存键
-    QString generateCacheKey(const QString& filename, uint64_t offset, uint32_t size);
+    // 获取文件ID，同一路径始终返回相同的ID
+    uint32_t getFileId(const QString& filePath);
+
+    // 从缓存块拼出指定范围的数据，任一块缺失时返回false
+    bool readFromCache(uint32_t fileId, uint64_t offset, uint32_t size, QByteArray& data);
+
+    // 将数据中完整覆盖的块放入缓存，includePartialTail为true时末尾不足一块的部分（文件尾）也缓存，返回放入的块数
+    int cacheBlocks(uint32_t fileId, uint64_t offset, const QByteArray& data, bool includePartialTail,
+        bool prefetched = false);
+
+    // 按文件合并读取条目并依次回调，readPacketsInRange和queryAndReadPackets共用
+    void readEntriesCoalesced(const QVector<PacketIndexEntry>& entries,
+        const std::function<void(const QByteArray&, const PacketIndexEntry&)>& callback);
+
+    // 记录访问并为预测的后续数据包安排预读
+    void schedulePrefetch(uint32_t fileId, const PacketIndexEntry& entry);
+
+    // 在预读线程中读取[firstBlock, lastBlock]并放入缓存
+    void prefetchBlocks(uint32_t fileId, const QString& filePath, uint64_t firstBlock, uint64_t lastBlock);
 
     // 文件操作控制器
     FileOperationController* m_fileOperationController{ nullptr };
@@ -0,0 +1,779 @@
+﻿// Source/Analysis/DataFilterExpression.cpp
+#include "DataFilterExpression.h"
+#include "Logger.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+/**
+ * @brief 筛选表达式的词法和语法分析，按递归下降直接生成后缀指令
+ */
+class DataFilterParser {
+public:
+    explicit DataFilterParser(const QString& text)
+        : m_text(text)
+    {
+    }
+
+    bool parse(DataFilterExpression& expression)
+    {
+        if (!tokenize()) {
+            return false;
+        }
+
+        m_program = &expression.m_program;
+        if (m_tokens.front().kind == Token::END) {
+            emitOp(DataFilterExpression::OpCode::ALL);
+        }
+        else if (!parseOr()) {
+            return false;
+        }
+        if (peek().kind != Token::END) {
+            return fail(LocalQTCompat::fromLocal8Bit("多余的内容"));
+        }
+
+        expression.m_stackDepth = std::max(1, m_maxDepth);
+        return true;
+    }
+
+    const QString& error() const { return m_error; }
+
+private:
+    using Field = DataFilterExpression::Field;
+    using Compare = DataFilterExpression::Compare;
+    using OpCode = DataFilterExpression::OpCode;
+    using Instruction = DataFilterExpression::Instruction;
+
+    struct Token {
+        enum Kind { END, WORD, NUMBER, STRING, OPERATOR, LEFT_PAREN, RIGHT_PAREN, LEFT_BRACKET, RIGHT_BRACKET, COMMA };
+        Kind kind = END;
+        QString text;
+        double number = 0.0;
+        int position = 0;
+    };
+
+    bool tokenize()
+    {
+        const int length = m_text.size();
+        int i = 0;
+        while (i < length) {
+            const QChar c = m_text[i];
+            if (c.isSpace()) {
+                ++i;
+                continue;
+            }
+
+            Token token;
+            token.position = i;
+            const QChar next = i + 1 < length ? m_text[i + 1] : QChar();
+
+            if (c == '"' || c == '\'') {
+                const int end = m_text.indexOf(c, i + 1);
+                if (end < 0) {
+                    m_position = i;
+                    return fail(LocalQTCompat::fromLocal8Bit("字符串缺少结束引号"));
+                }
+                token.kind = Token::STRING;
+                token.text = m_text.mid(i + 1, end - i - 1);
+                i = end + 1;
+            }
+            else if (c.isDigit() || (c == '.' && next.isDigit())
+                || ((c == '-' || c == '+') && (next.isDigit() || next == '.'))) {
+                int end = i + 1;
+                while (end < length && (m_text[end].isLetterOrNumber() || m_text[end] == '.'
+                    || ((m_text[end] == '-' || m_text[end] == '+') && (m_text[end - 1] == 'e' || m_text[end - 1] == 'E')))) {
+                    ++end;
+                }
+                token.kind = Token::NUMBER;
+                token.text = m_text.mid(i, end - i);
+                if (!parseNumber(token.text, token.number)) {
+                    m_position = i;
+                    return fail(LocalQTCompat::fromLocal8Bit("无效的数字: %1").arg(token.text));
+                }
+                i = end;
+            }
+            else if (c.isLetter() || c == '_') {
+                int end = i + 1;
+                while (end < length && (m_text[end].isLetterOrNumber() || m_text[end] == '_')) {
+                    ++end;
+                }
+                token.kind = Token::WORD;
+                token.text = m_text.mid(i, end - i);
+                i = end;
+            }
+            else if (c == '(' || c == ')' || c == '[' || c == ']' || c == ',') {
+                token.kind = c == '(' ? Token::LEFT_PAREN : c == ')' ? Token::RIGHT_PAREN
+                    : c == '[' ? Token::LEFT_BRACKET : c == ']' ? Token::RIGHT_BRACKET : Token::COMMA;
+                token.text = c;
+                ++i;
+            }
+            else {
+                static const char* const OPERATORS[] = { ">=", "<=", "==", "!=", "&&", "||", ">", "<", "=", "~", "!" };
+                for (const char* op : OPERATORS) {
+                    if (m_text.mid(i, static_cast<int>(strlen(op))) == QLatin1String(op)) {
+                        token.kind = Token::OPERATOR;
+                        token.text = QLatin1String(op);
+                        break;
+                    }
+                }
+                if (token.kind != Token::OPERATOR) {
+                    m_position = i;
+                    return fail(LocalQTCompat::fromLocal8Bit("无法识别的字符: %1").arg(c));
+                }
+                i += token.text.size();
+            }
+
+            m_tokens.append(token);
+        }
+
+        Token end;
+        end.position = length;
+        m_tokens.append(end);
+        return true;
+    }
+
+    static bool parseNumber(const QString& text, double& number)
+    {
+        bool ok = false;
+        QString digits = text;
+        const bool negative = digits.startsWith('-');
+        if (negative || digits.startsWith('+')) {
+            digits.remove(0, 1);
+        }
+        if (digits.startsWith(QLatin1String("0x"), Qt::CaseInsensitive)) {
+            number = static_cast<double>(digits.mid(2).toULongLong(&ok, 16));
+        }
+        else {
+            number = digits.toDouble(&ok);
+        }
+        if (negative) {
+            number = -number;
+        }
+        return ok && std::isfinite(number);
+    }
+
+    const Token& peek(int ahead = 0) const
+    {
+        return m_tokens[std::min(m_current + ahead, static_cast<int>(m_tokens.size()) - 1)];
+    }
+
+    const Token& advance()
+    {
+        const Token& token = m_tokens[m_current];
+        if (m_current < static_cast<int>(m_tokens.size()) - 1) {
+            ++m_current;
+        }
+        return token;
+    }
+
+    static bool isKeyword(const Token& token, const char* keyword)
+    {
+        return token.kind == Token::WORD && token.text.compare(QLatin1String(keyword), Qt::CaseInsensitive) == 0;
+    }
+
+    bool isOperator(const Token& token, const char* op) const
+    {
+        return token.kind == Token::OPERATOR && token.text == QLatin1String(op);
+    }
+
+    bool isComparisonOperator(const Token& token) const
+    {
+        return token.kind == Token::OPERATOR && token.text != QLatin1String("&&")
+            && token.text != QLatin1String("||") && token.text != QLatin1String("!");
+    }
+
+    bool fail(const QString& message)
+    {
+        if (m_error.isEmpty()) {
+            const int position = m_position >= 0 ? m_position : peek().position;
+            m_error = LocalQTCompat::fromLocal8Bit("%1（位置%2）").arg(message).arg(position + 1);
+        }
+        return false;
+    }
+
+    void emitOp(OpCode op, int depthChange = 1)
+    {
+        Instruction instruction;
+        instruction.op = op;
+        emitInstruction(std::move(instruction), depthChange);
+    }
+
+    void emitInstruction(Instruction instruction, int depthChange = 1)
+    {
+        m_program->push_back(std::move(instruction));
+        m_depth += depthChange;
+        m_maxDepth = std::max(m_maxDepth, m_depth);
+    }
+
+    bool parseOr()
+    {
+        if (!parseAnd()) {
+            return false;
+        }
+        while (isKeyword(peek(), "OR") || isOperator(peek(), "||")) {
+            advance();
+            if (!parseAnd()) {
+                return false;
+            }
+            emitOp(OpCode::OR, -1);
+        }
+        return true;
+    }
+
+    bool startsOperand(const Token& token) const
+    {
+        switch (token.kind) {
+        case Token::END:
+        case Token::RIGHT_PAREN:
+        case Token::RIGHT_BRACKET:
+        case Token::COMMA:
+            return false;
+        case Token::OPERATOR:
+            return isOperator(token, "!") || isComparisonOperator(token);
+        case Token::WORD:
+            return !isKeyword(token, "OR") && !isKeyword(token, "AND");
+        default:
+            return true;
+        }
+    }
+
+    bool parseAnd()
+    {
+        if (!parseNot()) {
+            return false;
+        }
+        for (;;) {
+            if (isKeyword(peek(), "AND") || isOperator(peek(), "&&")) {
+                advance();
+            }
+            else if (!startsOperand(peek())) {
+                break;
+            }
+            if (!parseNot()) {
+                return false;
+            }
+            emitOp(OpCode::AND, -1);
+        }
+        return true;
+    }
+
+    bool parseNot()
+    {
+        if (isKeyword(peek(), "NOT") || isOperator(peek(), "!")) {
+            advance();
+            if (!parseNot()) {
+                return false;
+            }
+            emitOp(OpCode::NOT, 0);
+            return true;
+        }
+        return parsePrimary();
+    }
+
+    bool parseField(const Token& token, Field& field, int& pointIndex) const
+    {
+        static const QRegularExpression pointPattern(QStringLiteral("^(?:p|point)(\\d+)$"),
+            QRegularExpression::CaseInsensitiveOption);
+
+        const QString name = token.text.toLower();
+        if (name == QLatin1String("value") || name == QLatin1String("val") || name == QLatin1String("v")) {
+            field = Field::VALUE;
+        }
+        else if (name == QLatin1String("index") || name == QLatin1String("idx") || name == QLatin1String("id")) {
+            field = Field::INDEX;
+        }
+        else if (name == QLatin1String("points") || name == QLatin1String("count")) {
+            field = Field::POINT_COUNT;
+        }
+        else if (name == QLatin1String("desc") || name == QLatin1String("description")) {
+            field = Field::DESCRIPTION;
+        }
+        else if (name == QLatin1String("time") || name == QLatin1String("timestamp")) {
+            field = Field::TIMESTAMP;
+        }
+        else {
+            const QRegularExpressionMatch match = pointPattern.match(name);
+            if (!match.hasMatch()) {
+                return false;
+            }
+            field = Field::POINT;
+            pointIndex = match.captured(1).toInt();
+        }
+        return true;
+    }
+
+    bool parsePrimary()
+    {
+        const Token& token = peek();
+
+        if (token.kind == Token::LEFT_PAREN) {
+            advance();
+            if (!parseOr()) {
+                return false;
+            }
+            if (peek().kind != Token::RIGHT_PAREN) {
+                return fail(LocalQTCompat::fromLocal8Bit("缺少右括号"));
+            }
+            advance();
+            return true;
+        }
+
+        // 省略字段名的比较作用于数据值
+        if (isComparisonOperator(token)) {
+            return parseComparison(Field::VALUE, 0);
+        }
+
+        Field field = Field::VALUE;
+        int pointIndex = 0;
+        if (token.kind == Token::WORD && parseField(token, field, pointIndex)) {
+            const Token& next = peek(1);
+            if (isComparisonOperator(next) || isKeyword(next, "IN") || isKeyword(next, "BETWEEN")
+                || isKeyword(next, "CONTAINS")) {
+                advance();
+                return parseComparison(field, pointIndex);
+            }
+        }
+
+        // 单独的词或字符串在描述中查找
+        if (token.kind == Token::WORD || token.kind == Token::STRING || token.kind == Token::NUMBER) {
+            Instruction instruction;
+            instruction.op = OpCode::STRING;
+            instruction.field = Field::DESCRIPTION;
+            instruction.compare = Compare::CONTAINS;
+            instruction.text = advance().text;
+            emitInstruction(std::move(instruction));
+            return true;
+        }
+
+        return fail(LocalQTCompat::fromLocal8Bit("此处需要条件"));
+    }
+
+    bool parseComparison(Field field, int pointIndex)
+    {
+        Instruction instruction;
+        instruction.field = field;
+        instruction.pointIndex = pointIndex;
+
+        const bool stringField = field == Field::DESCRIPTION || field == Field::TIMESTAMP;
+        const Token& op = advance();
+
+        if (isKeyword(op, "IN")) {
+            return !stringField ? parseInList(std::move(instruction))
+                : fail(LocalQTCompat::fromLocal8Bit("字符串字段不支持IN"));
+        }
+        if (isKeyword(op, "BETWEEN")) {
+            if (stringField) {
+                return fail(LocalQTCompat::fromLocal8Bit("字符串字段不支持BETWEEN"));
+            }
+            instruction.op = OpCode::RANGE;
+            if (!expectNumber(instruction.low) || !expectKeyword("AND") || !expectNumber(instruction.high)) {
+                return false;
+            }
+            emitInstruction(std::move(instruction));
+            return true;
+        }
+
+        if (isKeyword(op, "CONTAINS") || isOperator(op, "~")) {
+            if (!stringField) {
+                return fail(LocalQTCompat::fromLocal8Bit("数值字段不支持包含运算"));
+            }
+            instruction.compare = Compare::CONTAINS;
+        }
+        else if (isOperator(op, "<")) {
+            instruction.compare = Compare::LESS;
+        }
+        else if (isOperator(op, "<=")) {
+            instruction.compare = Compare::LESS_EQUAL;
+        }
+        else if (isOperator(op, ">")) {
+            instruction.compare = Compare::GREATER;
+        }
+        else if (isOperator(op, ">=")) {
+            instruction.compare = Compare::GREATER_EQUAL;
+        }
+        else if (isOperator(op, "=") || isOperator(op, "==")) {
+            instruction.compare = Compare::EQUAL;
+        }
+        else if (isOperator(op, "!=")) {
+            instruction.compare = Compare::NOT_EQUAL;
+        }
+        else {
+            return fail(LocalQTCompat::fromLocal8Bit("无效的比较运算符: %1").arg(op.text));
+        }
+
+        if (stringField) {
+            const Token& literal = peek();
+            if (literal.kind != Token::STRING && literal.kind != Token::WORD && literal.kind != Token::NUMBER) {
+                return fail(LocalQTCompat::fromLocal8Bit("此处需要文本"));
+            }
+            instruction.op = OpCode::STRING;
+            instruction.text = advance().text;
+        }
+        else {
+            instruction.op = OpCode::COMPARE;
+            if (!expectNumber(instruction.low)) {
+                return false;
+            }
+        }
+
+        emitInstruction(std::move(instruction));
+        return true;
+    }
+
+    bool parseInList(Instruction instruction)
+    {
+        const Token& open = advance();
+        if (open.kind == Token::LEFT_BRACKET) {
+            // [low, high]为闭区间
+            instruction.op = OpCode::RANGE;
+            if (!expectNumber(instruction.low) || !expect(Token::COMMA, ",")
+                || !expectNumber(instruction.high) || !expect(Token::RIGHT_BRACKET, "]")) {
+                return false;
+            }
+        }
+        else if (open.kind == Token::LEFT_PAREN) {
+            instruction.op = OpCode::SET;
+            for (;;) {
+                double number = 0.0;
+                if (!expectNumber(number)) {
+                    return false;
+                }
+                instruction.set.push_back(number);
+                if (peek().kind != Token::COMMA) {
+                    break;
+                }
+                advance();
+            }
+            if (!expect(Token::RIGHT_PAREN, ")")) {
+                return false;
+            }
+            std::sort(instruction.set.begin(), instruction.set.end());
+        }
+        else {
+            return fail(LocalQTCompat::fromLocal8Bit("IN后需要[下界, 上界]或(值, ...)"));
+        }
+
+        emitInstruction(std::move(instruction));
+        return true;
+    }
+
+    bool expectNumber(double& number)
+    {
+        if (peek().kind != Token::NUMBER) {
+            return fail(LocalQTCompat::fromLocal8Bit("此处需要数字"));
+        }
+        number = advance().number;
+        return true;
+    }
+
+    bool expectKeyword(const char* keyword)
+    {
+        if (!isKeyword(peek(), keyword)) {
+            return fail(LocalQTCompat::fromLocal8Bit("此处需要%1").arg(QLatin1String(keyword)));
+        }
+        advance();
+        return true;
+    }
+
+    bool expect(Token::Kind kind, const char* text)
+    {
+        if (peek().kind != kind) {
+            return fail(LocalQTCompat::fromLocal8Bit("此处需要%1").arg(QLatin1String(text)));
+        }
+        advance();
+        return true;
+    }
+
+    QString m_text;
+    QVector<Token> m_tokens;
+    int m_current = 0;
+    int m_position = -1;                        ///< 词法错误的位置，语法错误取当前记号的位置
+    std::vector<Instruction>* m_program = nullptr;
+    int m_depth = 0;
+    int m_maxDepth = 0;
+    QString m_error;
+};
+
+DataFilterExpression::DataFilterExpression()
+{
+    Instruction instruction;
+    instruction.op = OpCode::ALL;
+    m_program.push_back(instruction);
+}
+
+DataFilterExpression DataFilterExpression::compile(const QString& text)
+{
+    DataFilterExpression expression;
+    expression.m_program.clear();
+    expression.m_text = text;
+
+    DataFilterParser parser(text);
+    if (!parser.parse(expression)) {
+        expression.m_program.clear();
+        expression.m_error = parser.error();
+    }
+    return expression;
+}
+
+DataFilterExpression DataFilterExpression::descriptionContains(const QString& text)
+{
+    DataFilterExpression expression;
+    expression.m_text = text;
+
+    Instruction& instruction = expression.m_program.front();
+    instruction.op = OpCode::STRING;
+    instruction.field = Field::DESCRIPTION;
+    instruction.compare = Compare::CONTAINS;
+    instruction.text = text;
+    return expression;
+}
+
+QVector<int> DataFilterExpression::evaluate(const DataFilterColumns& columns) const
+{
+    QVector<int> rows;
+    if (!isValid() || columns.rowCount == 0) {
+        return rows;
+    }
+
+    // 字符串条件先对字典逐项判断，行上只查表
+    std::vector<std::vector<uint8_t>> dictionaryMasks(m_program.size());
+    for (size_t pc = 0; pc < m_program.size(); ++pc) {
+        const Instruction& instruction = m_program[pc];
+        if (instruction.op != OpCode::STRING) {
+            continue;
+        }
+
+        const QStringList* dictionary = instruction.field == Field::DESCRIPTION ? columns.descriptions : columns.timestamps;
+        if (!dictionary) {
+            continue;
+        }
+
+        std::vector<uint8_t>& mask = dictionaryMasks[pc];
+        mask.resize(static_cast<size_t>(dictionary->size()));
+        for (int i = 0; i < dictionary->size(); ++i) {
+            const QString& entry = dictionary->at(i);
+            bool match = false;
+            switch (instruction.compare) {
+            case Compare::CONTAINS:
+                match = entry.contains(instruction.text, Qt::CaseInsensitive);
+                break;
+            case Compare::EQUAL:
+                match = entry.compare(instruction.text, Qt::CaseInsensitive) == 0;
+                break;
+            case Compare::NOT_EQUAL:
+                match = entry.compare(instruction.text, Qt::CaseInsensitive) != 0;
+                break;
+            case Compare::LESS:
+                match = entry < instruction.text;
+                break;
+            case Compare::LESS_EQUAL:
+                match = entry <= instruction.text;
+                break;
+            case Compare::GREATER:
+                match = entry > instruction.text;
+                break;
+            case Compare::GREATER_EQUAL:
+                match = entry >= instruction.text;
+                break;
+            }
+            mask[static_cast<size_t>(i)] = match ? 1 : 0;
+        }
+    }
+
+    const size_t rowCount = columns.rowCount;
+    if (rowCount <= PARALLEL_CHUNK_ROWS) {
+        evaluateRows(columns, dictionaryMasks, 0, rowCount, rows);
+        return rows;
+    }
+
+    // 分段并行，各段结果按顺序拼接，行号保持升序
+    QVector<QFuture<QVector<int>>> futures;
+    for (size_t first = 0; first < rowCount; first += PARALLEL_CHUNK_ROWS) {
+        const size_t end = std::min(rowCount, first + PARALLEL_CHUNK_ROWS);
+        futures.append(QtConcurrent::run([this, &columns, &dictionaryMasks, first, end]() {
+            QVector<int> chunkRows;
+            evaluateRows(columns, dictionaryMasks, first, end, chunkRows);
+            return chunkRows;
+            }));
+    }
+
+    for (auto& future : futures) {
+        rows += future.result();
+    }
+    return rows;
+}
+
+void DataFilterExpression::evaluateRows(const DataFilterColumns& columns,
+    const std::vector<std::vector<uint8_t>>& dictionaryMasks, size_t firstRow, size_t endRow, QVector<int>& rows) const
+{
+    std::vector<uint8_t> stack(static_cast<size_t>(m_stackDepth) * BLOCK_ROWS);
+    std::vector<double> scratch(BLOCK_ROWS);
+
+    for (size_t blockStart = firstRow; blockStart < endRow; blockStart += BLOCK_ROWS) {
+        const size_t count = std::min(BLOCK_ROWS, endRow - blockStart);
+        size_t depth = 0;
+
+        for (size_t pc = 0; pc < m_program.size(); ++pc) {
+            const Instruction& instruction = m_program[pc];
+            switch (instruction.op) {
+            case OpCode::ALL:
+                std::fill_n(&stack[depth++ * BLOCK_ROWS], count, uint8_t(1));
+                break;
+
+            case OpCode::AND:
+            case OpCode::OR: {
+                --depth;
+                uint8_t* left = &stack[(depth - 1) * BLOCK_ROWS];
+                const uint8_t* right = &stack[depth * BLOCK_ROWS];
+                if (instruction.op == OpCode::AND) {
+                    for (size_t i = 0; i < count; ++i) {
+                        left[i] &= right[i];
+                    }
+                }
+                else {
+                    for (size_t i = 0; i < count; ++i) {
+                        left[i] |= right[i];
+                    }
+                }
+                break;
+            }
+
+            case OpCode::NOT: {
+                uint8_t* operand = &stack[(depth - 1) * BLOCK_ROWS];
+                for (size_t i = 0; i < count; ++i) {
+                    operand[i] ^= 1;
+                }
+                break;
+            }
+
+            case OpCode::STRING: {
+                uint8_t* out = &stack[depth++ * BLOCK_ROWS];
+                const std::vector<uint8_t>& mask = dictionaryMasks[pc];
+                const uint32_t* ids = instruction.field == Field::DESCRIPTION ? columns.descriptionIds : columns.timestampIds;
+                if (!ids || mask.empty()) {
+                    std::fill_n(out, count, uint8_t(0));
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    const uint32_t id = ids[blockStart + i];
+                    out[i] = id < mask.size() ? mask[id] : 0;
+                }
+                break;
+            }
+
+            default:
+                evaluateNumeric(instruction, columns, blockStart, count, scratch.data(), &stack[depth++ * BLOCK_ROWS]);
+                break;
+            }
+        }
+
+        const uint8_t* result = stack.data();
+        for (size_t i = 0; i < count; ++i) {
+            if (result[i] && (!columns.valid || columns.valid[blockStart + i])) {
+                rows.append(static_cast<int>(blockStart + i));
+            }
+        }
+    }
+}
+
+void DataFilterExpression::evaluateNumeric(const Instruction& instruction, const DataFilterColumns& columns,
+    size_t firstRow, size_t count, double* scratch, uint8_t* out)
+{
+    // 先把字段取到连续的double数组，缺失的值为NaN，下面所有比较对NaN都不成立
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    const double* values = scratch;
+    switch (instruction.field) {
+    case Field::VALUE:
+        if (columns.values) {
+            values = columns.values + firstRow;
+        }
+        else {
+            std::fill_n(scratch, count, missing);
+        }
+        break;
+    case Field::INDEX:
+        for (size_t i = 0; i < count; ++i) {
+            scratch[i] = columns.indices ? static_cast<double>(columns.indices[firstRow + i]) : missing;
+        }
+        break;
+    case Field::POINT_COUNT:
+        for (size_t i = 0; i < count; ++i) {
+            scratch[i] = columns.pointOffsets
+                ? static_cast<double>(columns.pointOffsets[firstRow + i + 1] - columns.pointOffsets[firstRow + i]) : missing;
+        }
+        break;
+    case Field::POINT:
+        for (size_t i = 0; i < count; ++i) {
+            scratch[i] = missing;
+            if (columns.pointOffsets && columns.points) {
+                const uint32_t begin = columns.pointOffsets[firstRow + i];
+                const uint32_t end = columns.pointOffsets[firstRow + i + 1];
+                if (static_cast<uint32_t>(instruction.pointIndex) < end - begin) {
+                    scratch[i] = columns.points[begin + static_cast<uint32_t>(instruction.pointIndex)];
+                }
+            }
+        }
+        break;
+    default:
+        std::fill_n(out, count, uint8_t(0));
+        return;
+    }
+
+    const double low = instruction.low;
+    const double high = instruction.high;
+
+    if (instruction.op == OpCode::RANGE) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = values[i] >= low && values[i] <= high;
+        }
+        return;
+    }
+
+    if (instruction.op == OpCode::SET) {
+        const std::vector<double>& set = instruction.set;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = std::binary_search(set.begin(), set.end(), values[i]);
+        }
+        return;
+    }
+
+    switch (instruction.compare) {
+    case Compare::LESS:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = values[i] < low;
+        }
+        break;
+    case Compare::LESS_EQUAL:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = values[i] <= low;
+        }
+        break;
+    case Compare::GREATER:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = values[i] > low;
+        }
+        break;
+    case Compare::GREATER_EQUAL:
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = values[i] >= low;
+        }
+        break;
+    case Compare::EQUAL:
+    case Compare::NOT_EQUAL: {
+        // 与qFuzzyCompare相同的相对容差，另外让0与0相等
+        const uint8_t equalResult = instruction.compare == Compare::EQUAL ? 1 : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const double value = values[i];
+            const bool equal = value == low || std::fabs(value - low) * 1e12 <= std::min(std::fabs(value), std::fabs(low));
+            out[i] = value == value ? static_cast<uint8_t>(equal ? equalResult : equalResult ^ 1) : 0;
+        }
+        break;
+    }
+    default:
+        std::fill_n(out, count, uint8_t(0));
+        break;
+    }
+}
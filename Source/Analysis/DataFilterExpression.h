@@ -0,0 +1,140 @@
+﻿// Source/Analysis/DataFilterExpression.h
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 筛选表达式求值用的列数据
+ *
+ * 每个指针指向rowCount个元素的连续数组，第i个元素属于第i行。字符串列使用字典编码：
+ * 行上只存字典序号，字符串条件对每个字典项只判断一次。为空的列按缺失处理，对应条件不匹配。
+ */
+struct DataFilterColumns {
+    size_t rowCount = 0;                        ///< 行数
+    const double* values = nullptr;             ///< 数据值
+    const int* indices = nullptr;               ///< 数据索引
+    const uint8_t* valid = nullptr;             ///< 是否有效，为空时全部有效
+    const uint32_t* pointOffsets = nullptr;     ///< rowCount+1个，第i行的数据点为points[pointOffsets[i], pointOffsets[i+1])
+    const double* points = nullptr;             ///< 所有行的数据点依次排列
+    const uint32_t* descriptionIds = nullptr;   ///< 描述的字典序号
+    const QStringList* descriptions = nullptr;  ///< 描述字典
+    const uint32_t* timestampIds = nullptr;     ///< 时间戳的字典序号
+    const QStringList* timestamps = nullptr;    ///< 时间戳字典
+};
+
+/**
+ * @brief 编译后的数据筛选表达式
+ *
+ * 语法（关键字不区分大小写）：
+ * - 比较：value > 1.5、index != 3、points >= 4、p0 < 0（p<n>为第n个数据点，没有该点时不匹配）
+ * - 范围和集合：value IN [1, 5]、value BETWEEN 1 AND 5、index IN (1, 2, 0x10)
+ * - 字符串：desc ~ "超时"（包含，不区分大小写）、desc = abc、time >= "2024-01-01 12:00"（按字符串比较）
+ * - 组合：AND/&&、OR/||、NOT/!、括号；相邻的条件之间省略运算符时按AND处理
+ * - 简写：省略字段名的比较作用于value（"> 5"）；单独的词或字符串在描述中查找
+ *
+ * 表达式只解析一次，编译为后缀形式的指令序列。求值按列成块进行：每条指令对一块行计算出匹配标志，
+ * 再按AND/OR合并，循环内没有分支和字符串操作；行数较多时分段交给线程池并行计算。
+ */
+class DataFilterExpression {
+public:
+    /**
+     * @brief 空表达式，匹配所有有效行
+     */
+    DataFilterExpression();
+
+    /**
+     * @brief 编译表达式
+     * @param text 表达式文本，空白时匹配所有有效行
+     * @return 编译结果，出错时isValid()为假，errorString()给出原因
+     */
+    static DataFilterExpression compile(const QString& text);
+
+    /**
+     * @brief 在描述中查找文本的表达式，用于无法解析的输入
+     */
+    static DataFilterExpression descriptionContains(const QString& text);
+
+    bool isValid() const { return m_error.isEmpty(); }
+    const QString& errorString() const { return m_error; }
+    const QString& text() const { return m_text; }
+
+    /**
+     * @brief 求值
+     * @param columns 列数据
+     * @return 匹配的有效行号，升序
+     */
+    QVector<int> evaluate(const DataFilterColumns& columns) const;
+
+private:
+    friend class DataFilterParser;
+
+    static constexpr size_t BLOCK_ROWS = 1024;              ///< 每块行数，匹配标志栈常驻L1
+    static constexpr size_t PARALLEL_CHUNK_ROWS = 65536;    ///< 每个并行任务的行数
+
+    enum class OpCode : uint8_t {
+        ALL,        ///< 全部匹配
+        COMPARE,    ///< 数值比较
+        RANGE,      ///< 数值在[low, high]内
+        SET,        ///< 数值在集合内
+        STRING,     ///< 字符串条件
+        AND,
+        OR,
+        NOT
+    };
+
+    enum class Field : uint8_t {
+        VALUE,          ///< 数据值
+        INDEX,          ///< 数据索引
+        POINT_COUNT,    ///< 数据点数量
+        POINT,          ///< 第pointIndex个数据点
+        DESCRIPTION,    ///< 描述
+        TIMESTAMP       ///< 时间戳
+    };
+
+    enum class Compare : uint8_t {
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        EQUAL,
+        NOT_EQUAL,
+        CONTAINS
+    };
+
+    /**
+     * @brief 后缀指令
+     */
+    struct Instruction {
+        OpCode op = OpCode::ALL;
+        Field field = Field::VALUE;
+        Compare compare = Compare::EQUAL;
+        int pointIndex = 0;             ///< POINT字段的数据点序号
+        double low = 0.0;               ///< 比较值，RANGE的下界
+        double high = 0.0;              ///< RANGE的上界
+        std::vector<double> set;        ///< SET的有序值
+        QString text;                   ///< STRING的比较文本
+    };
+
+    /**
+     * @brief 对一段行求值，追加匹配的行号
+     * @param dictionaryMasks 每条STRING指令对应字典项的匹配标志，按指令位置存放
+     */
+    void evaluateRows(const DataFilterColumns& columns, const std::vector<std::vector<uint8_t>>& dictionaryMasks,
+        size_t firstRow, size_t endRow, QVector<int>& rows) const;
+
+    /**
+     * @brief 对一块行计算数值指令
+     */
+    static void evaluateNumeric(const Instruction& instruction, const DataFilterColumns& columns,
+        size_t firstRow, size_t count, double* scratch, uint8_t* out);
+
+    std::vector<Instruction> m_program;     ///< 后缀指令序列
+    int m_stackDepth = 1;                   ///< 求值需要的匹配标志栈深度
+    QString m_text;                         ///< 原始文本
+    QString m_error;                        ///< 编译错误
+};
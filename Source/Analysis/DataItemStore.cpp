@@ -0,0 +1,304 @@
+﻿// Source/Analysis/DataItemStore.cpp
+#include "DataItemStore.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+void DataItemStore::clear()
+{
+    m_head = 0;
+    m_values.clear();
+    m_indices.clear();
+    m_valid.clear();
+    m_timestampIds.clear();
+    m_descriptionIds.clear();
+    m_pointOffsets.assign(1, 0);
+    m_points.clear();
+    m_rowIds.clear();
+    m_timestamps.clear();
+    m_descriptions.clear();
+    m_rowIdsOrdered = true;
+    m_rowLookupValid = false;
+}
+
+uint64_t DataItemStore::append(int index, const QString& timestamp, double value, const QString& description,
+    const double* points, int pointCount, bool valid)
+{
+    const uint64_t rowId = m_nextRowId++;
+    m_values.push_back(value);
+    m_indices.push_back(index);
+    m_valid.push_back(valid ? 1 : 0);
+    m_timestampIds.push_back(m_timestamps.intern(timestamp));
+    m_descriptionIds.push_back(m_descriptions.intern(description));
+    m_points.insert(m_points.end(), points, points + std::max(0, pointCount));
+    m_pointOffsets.push_back(static_cast<uint32_t>(m_points.size()));
+    m_rowIds.push_back(rowId);
+    m_rowLookupValid = false;
+    return rowId;
+}
+
+void DataItemStore::update(size_t row, int index, const QString& timestamp, double value, const QString& description,
+    const double* points, int pointCount, bool valid)
+{
+    const size_t physicalRow = m_head + row;
+    m_values[physicalRow] = value;
+    m_indices[physicalRow] = index;
+    m_valid[physicalRow] = valid ? 1 : 0;
+    m_timestampIds[physicalRow] = m_timestamps.intern(timestamp);
+    m_descriptionIds[physicalRow] = m_descriptions.intern(description);
+    replacePoints(physicalRow, points, std::max(0, pointCount));
+}
+
+void DataItemStore::replacePoints(size_t physicalRow, const double* points, int pointCount)
+{
+    const uint32_t begin = m_pointOffsets[physicalRow];
+    const uint32_t end = m_pointOffsets[physicalRow + 1];
+    const int64_t delta = static_cast<int64_t>(pointCount) - static_cast<int64_t>(end - begin);
+
+    if (delta == 0) {
+        std::copy(points, points + pointCount, m_points.begin() + begin);
+        return;
+    }
+
+    m_points.erase(m_points.begin() + begin, m_points.begin() + end);
+    m_points.insert(m_points.begin() + begin, points, points + pointCount);
+    for (size_t i = physicalRow + 1; i < m_pointOffsets.size(); ++i) {
+        m_pointOffsets[i] = static_cast<uint32_t>(m_pointOffsets[i] + delta);
+    }
+}
+
+void DataItemStore::remove(size_t row)
+{
+    const size_t physicalRow = m_head + row;
+    replacePoints(physicalRow, nullptr, 0);
+
+    m_values.erase(m_values.begin() + physicalRow);
+    m_indices.erase(m_indices.begin() + physicalRow);
+    m_valid.erase(m_valid.begin() + physicalRow);
+    m_timestampIds.erase(m_timestampIds.begin() + physicalRow);
+    m_descriptionIds.erase(m_descriptionIds.begin() + physicalRow);
+    m_pointOffsets.erase(m_pointOffsets.begin() + physicalRow + 1);
+    m_rowIds.erase(m_rowIds.begin() + physicalRow);
+    m_rowLookupValid = false;
+
+    compactIfNeeded();
+}
+
+void DataItemStore::removeFront(size_t count)
+{
+    m_head += std::min(count, size());
+    m_rowLookupValid = false;
+    compactIfNeeded();
+}
+
+void DataItemStore::compactIfNeeded()
+{
+    const size_t rows = size();
+    const size_t slack = std::max(rows, MIN_COMPACT_ROWS);
+    if (m_head > slack
+        || static_cast<size_t>(m_timestamps.size()) > rows + slack
+        || static_cast<size_t>(m_descriptions.size()) > rows + slack) {
+        compact();
+    }
+}
+
+void DataItemStore::compact()
+{
+    if (m_head > 0) {
+        const uint32_t firstPoint = m_pointOffsets[m_head];
+        m_values.erase(m_values.begin(), m_values.begin() + m_head);
+        m_indices.erase(m_indices.begin(), m_indices.begin() + m_head);
+        m_valid.erase(m_valid.begin(), m_valid.begin() + m_head);
+        m_timestampIds.erase(m_timestampIds.begin(), m_timestampIds.begin() + m_head);
+        m_descriptionIds.erase(m_descriptionIds.begin(), m_descriptionIds.begin() + m_head);
+        m_rowIds.erase(m_rowIds.begin(), m_rowIds.begin() + m_head);
+        m_pointOffsets.erase(m_pointOffsets.begin(), m_pointOffsets.begin() + m_head);
+        for (uint32_t& offset : m_pointOffsets) {
+            offset -= firstPoint;
+        }
+        m_points.erase(m_points.begin(), m_points.begin() + firstPoint);
+        m_head = 0;
+    }
+
+    compactDictionary(m_timestamps, m_timestampIds);
+    compactDictionary(m_descriptions, m_descriptionIds);
+}
+
+void DataItemStore::compactDictionary(StringDictionary& dictionary, std::vector<uint32_t>& ids)
+{
+    constexpr uint32_t UNMAPPED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(static_cast<size_t>(dictionary.size()), UNMAPPED);
+    StringDictionary compacted;
+    for (uint32_t& id : ids) {
+        uint32_t& mapped = remap[id];
+        if (mapped == UNMAPPED) {
+            mapped = compacted.append(dictionary.at(id));
+        }
+        id = mapped;
+    }
+    dictionary = std::move(compacted);
+}
+
+int DataItemStore::rowOf(uint64_t rowId) const
+{
+    if (m_rowIdsOrdered) {
+        const auto first = m_rowIds.begin() + static_cast<std::ptrdiff_t>(m_head);
+        const auto it = std::lower_bound(first, m_rowIds.end(), rowId);
+        return it != m_rowIds.end() && *it == rowId ? static_cast<int>(it - first) : -1;
+    }
+
+    if (!m_rowLookupValid) {
+        m_rowLookup.clear();
+        m_rowLookup.reserve(static_cast<qsizetype>(size()));
+        for (size_t row = 0; row < size(); ++row) {
+            m_rowLookup.insert(m_rowIds[m_head + row], static_cast<int>(row));
+        }
+        m_rowLookupValid = true;
+    }
+    return m_rowLookup.value(rowId, -1);
+}
+
+std::vector<uint32_t> DataItemStore::sortPermutation(int column, bool ascending) const
+{
+    const uint32_t rows = static_cast<uint32_t>(size());
+
+    // 排序键先取到一列连续的double，缺失的数据点为NaN；字符串按字典序号的名次比较
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> keys(rows);
+    auto stringRanks = [](const StringDictionary& dictionary) {
+        std::vector<uint32_t> byText(static_cast<size_t>(dictionary.size()));
+        std::iota(byText.begin(), byText.end(), 0u);
+        std::sort(byText.begin(), byText.end(), [&dictionary](uint32_t a, uint32_t b) {
+            return dictionary.at(a) < dictionary.at(b);
+            });
+        std::vector<uint32_t> ranks(byText.size());
+        for (size_t rank = 0; rank < byText.size(); ++rank) {
+            ranks[byText[rank]] = static_cast<uint32_t>(rank);
+        }
+        return ranks;
+    };
+
+    switch (column) {
+    case 0:
+        for (size_t row = 0; row < rows; ++row) {
+            keys[row] = m_indices[m_head + row];
+        }
+        break;
+    case 1: {
+        const std::vector<uint32_t> ranks = stringRanks(m_timestamps);
+        for (size_t row = 0; row < rows; ++row) {
+            keys[row] = ranks[m_timestampIds[m_head + row]];
+        }
+        break;
+    }
+    case 2:
+        std::copy(m_values.begin() + static_cast<std::ptrdiff_t>(m_head), m_values.end(), keys.begin());
+        break;
+    case 3: {
+        const std::vector<uint32_t> ranks = stringRanks(m_descriptions);
+        for (size_t row = 0; row < rows; ++row) {
+            keys[row] = ranks[m_descriptionIds[m_head + row]];
+        }
+        break;
+    }
+    default: {
+        const uint32_t pointIndex = static_cast<uint32_t>(std::max(0, column - 4));
+        for (size_t row = 0; row < rows; ++row) {
+            const uint32_t begin = m_pointOffsets[m_head + row];
+            const uint32_t end = m_pointOffsets[m_head + row + 1];
+            keys[row] = pointIndex < end - begin ? m_points[begin + pointIndex] : missing;
+        }
+        break;
+    }
+    }
+
+    // 有键的有效行按(键, 行)对连续排序，比较时不再间接访问；缺少键的有效行其次，无效行总在最后
+    std::vector<std::pair<double, uint32_t>> keyed;
+    std::vector<uint32_t> keyless;
+    std::vector<uint32_t> invalid;
+    keyed.reserve(rows);
+    for (uint32_t row = 0; row < rows; ++row) {
+        if (!m_valid[m_head + row]) {
+            invalid.push_back(row);
+        }
+        else if (std::isnan(keys[row])) {
+            keyless.push_back(row);
+        }
+        else {
+            keyed.emplace_back(keys[row], row);
+        }
+    }
+
+    if (ascending) {
+        std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    }
+    else {
+        std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return b.first < a.first; });
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(rows);
+    for (const auto& entry : keyed) {
+        order.push_back(entry.second);
+    }
+    order.insert(order.end(), keyless.begin(), keyless.end());
+    order.insert(order.end(), invalid.begin(), invalid.end());
+    return order;
+}
+
+void DataItemStore::applyPermutation(const std::vector<uint32_t>& order)
+{
+    const size_t rows = size();
+    if (order.size() != rows) {
+        return;
+    }
+
+    auto gather = [this, &order](auto& column) {
+        std::remove_reference_t<decltype(column)> reordered(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            reordered[i] = column[m_head + order[i]];
+        }
+        column.swap(reordered);
+    };
+
+    std::vector<double> points;
+    std::vector<uint32_t> offsets(rows + 1);
+    points.reserve(m_points.size() - m_pointOffsets[m_head]);
+    for (size_t i = 0; i < rows; ++i) {
+        const size_t source = m_head + order[i];
+        offsets[i] = static_cast<uint32_t>(points.size());
+        points.insert(points.end(), m_points.begin() + m_pointOffsets[source], m_points.begin() + m_pointOffsets[source + 1]);
+    }
+    offsets[rows] = static_cast<uint32_t>(points.size());
+
+    gather(m_values);
+    gather(m_indices);
+    gather(m_valid);
+    gather(m_timestampIds);
+    gather(m_descriptionIds);
+    gather(m_rowIds);
+    m_points.swap(points);
+    m_pointOffsets.swap(offsets);
+    m_head = 0;
+
+    m_rowIdsOrdered = std::is_sorted(m_rowIds.begin(), m_rowIds.end());
+    m_rowLookupValid = false;
+}
+
+DataFilterColumns DataItemStore::filterColumns() const
+{
+    DataFilterColumns columns;
+    columns.rowCount = size();
+    columns.values = m_values.data() + m_head;
+    columns.indices = m_indices.data() + m_head;
+    columns.valid = m_valid.data() + m_head;
+    columns.pointOffsets = m_pointOffsets.data() + m_head;
+    columns.points = m_points.data();
+    columns.descriptionIds = m_descriptionIds.data() + m_head;
+    columns.descriptions = &m_descriptions.strings();
+    columns.timestampIds = m_timestampIds.data() + m_head;
+    columns.timestamps = &m_timestamps.strings();
+    return columns;
+}
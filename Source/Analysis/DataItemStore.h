@@ -0,0 +1,180 @@
+﻿// Source/Analysis/DataItemStore.h
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "DataFilterExpression.h"
+
+/**
+ * @brief 字符串字典，相同的字符串只保存一份，行上存字典序号
+ */
+class StringDictionary {
+public:
+    void clear()
+    {
+        m_strings.clear();
+        m_lookup.clear();
+    }
+
+    /**
+     * @brief 取字符串的序号，不存在时加入
+     */
+    uint32_t intern(const QString& text)
+    {
+        auto it = m_lookup.constFind(text);
+        if (it != m_lookup.constEnd()) {
+            return it.value();
+        }
+        return append(text);
+    }
+
+    /**
+     * @brief 加入一个确定不存在的字符串
+     */
+    uint32_t append(const QString& text)
+    {
+        const uint32_t id = static_cast<uint32_t>(m_strings.size());
+        m_strings.append(text);
+        m_lookup.insert(text, id);
+        return id;
+    }
+
+    const QString& at(uint32_t id) const { return m_strings.at(static_cast<int>(id)); }
+    int size() const { return static_cast<int>(m_strings.size()); }
+    const QStringList& strings() const { return m_strings; }
+
+private:
+    QStringList m_strings;              ///< 按序号排列的字符串
+    QHash<QString, uint32_t> m_lookup;  ///< 字符串到序号
+};
+
+/**
+ * @brief 按列存储的数据项集合
+ *
+ * 每个字段一列连续数组：值、索引、有效标志、行号各一列，时间戳和描述按字典编码为序号列，
+ * 所有行的数据点依次放在一个数组里，另有一列记录每行的起始位置。统计、筛选和排序都是对单列的线性扫描，
+ * 不再在每项两个QString、一个QVector的堆对象之间跳转。
+ *
+ * 每行有一个追加时分配、之后不变的行号，删除或排序后仍可用它找到同一行。
+ * 排序先只按一列计算出排列，再把各列按排列整体搬移一次。
+ * 删除开头的行只移动起点，废弃的部分超过现有行数时才整体压缩，按先进先出淘汰的均摊开销为O(1)；
+ * 字典中不再被引用的字符串在压缩时一并清理。
+ *
+ * 非线程安全，由调用者保证。
+ */
+class DataItemStore {
+public:
+    static constexpr uint64_t INVALID_ROW_ID = UINT64_MAX;  ///< 无效行号
+
+    size_t size() const { return m_values.size() - m_head; }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief 清空所有行，行号继续递增
+     */
+    void clear();
+
+    /**
+     * @brief 追加一行
+     * @param points 数据点，pointCount个
+     * @return 新行的行号
+     */
+    uint64_t append(int index, const QString& timestamp, double value, const QString& description,
+        const double* points, int pointCount, bool valid);
+
+    /**
+     * @brief 修改一行，行号不变
+     */
+    void update(size_t row, int index, const QString& timestamp, double value, const QString& description,
+        const double* points, int pointCount, bool valid);
+
+    /**
+     * @brief 删除一行
+     */
+    void remove(size_t row);
+
+    /**
+     * @brief 删除开头的count行
+     */
+    void removeFront(size_t count);
+
+    double value(size_t row) const { return m_values[m_head + row]; }
+    int index(size_t row) const { return m_indices[m_head + row]; }
+    bool isValid(size_t row) const { return m_valid[m_head + row] != 0; }
+    const QString& timestamp(size_t row) const { return m_timestamps.at(m_timestampIds[m_head + row]); }
+    const QString& description(size_t row) const { return m_descriptions.at(m_descriptionIds[m_head + row]); }
+    const double* points(size_t row) const { return m_points.data() + m_pointOffsets[m_head + row]; }
+    int pointCount(size_t row) const
+    {
+        return static_cast<int>(m_pointOffsets[m_head + row + 1] - m_pointOffsets[m_head + row]);
+    }
+    uint64_t rowId(size_t row) const { return m_rowIds[m_head + row]; }
+
+    /**
+     * @brief 按行号查找当前位置
+     * @return 行位置，不存在时为-1
+     */
+    int rowOf(uint64_t rowId) const;
+
+    /**
+     * @brief 计算排序后的排列，无效行总排在最后，相等的行保持原来的顺序
+     * @param column 0索引，1时间戳，2值，3描述，4及以上为第column-4个数据点（没有该点的行排在有效行的最后）
+     * @param ascending 是否升序
+     * @return 第i个元素为排序后第i行原来的位置
+     */
+    std::vector<uint32_t> sortPermutation(int column, bool ascending) const;
+
+    /**
+     * @brief 按排列重排所有列
+     * @param order sortPermutation的结果
+     */
+    void applyPermutation(const std::vector<uint32_t>& order);
+
+    /**
+     * @brief 供筛选表达式使用的列视图，任何修改后失效
+     */
+    DataFilterColumns filterColumns() const;
+
+private:
+    static constexpr size_t MIN_COMPACT_ROWS = 4096;    ///< 废弃的行少于此数时不压缩
+
+    /**
+     * @brief 废弃的开头部分或字典中的无用字符串过多时压缩
+     */
+    void compactIfNeeded();
+
+    /**
+     * @brief 去掉开头废弃的行，重建字典
+     */
+    void compact();
+
+    /**
+     * @brief 按现有的序号列重建字典，只保留仍被引用的字符串
+     */
+    static void compactDictionary(StringDictionary& dictionary, std::vector<uint32_t>& ids);
+
+    /**
+     * @brief 替换第physicalRow行的数据点，之后各行的起始位置随之移动
+     */
+    void replacePoints(size_t physicalRow, const double* points, int pointCount);
+
+    size_t m_head = 0;                      ///< 第0行在各列中的位置，之前的部分已删除
+    std::vector<double> m_values;           ///< 值列
+    std::vector<int> m_indices;             ///< 索引列
+    std::vector<uint8_t> m_valid;           ///< 有效标志列
+    std::vector<uint32_t> m_timestampIds;   ///< 时间戳序号列
+    std::vector<uint32_t> m_descriptionIds; ///< 描述序号列
+    std::vector<uint32_t> m_pointOffsets{ 0 }; ///< 每行数据点在m_points中的起始位置，比行数多一个
+    std::vector<double> m_points;           ///< 所有行的数据点
+    std::vector<uint64_t> m_rowIds;         ///< 行号列
+    StringDictionary m_timestamps;          ///< 时间戳字典
+    StringDictionary m_descriptions;        ///< 描述字典
+    uint64_t m_nextRowId = 0;               ///< 下一个行号
+    bool m_rowIdsOrdered = true;            ///< 行号列是否递增，是则按二分查找定位
+    mutable QHash<uint64_t, int> m_rowLookup;   ///< 排序后按行号定位的索引，按需建立
+    mutable bool m_rowLookupValid = false;  ///< m_rowLookup是否与当前各列一致
+};
@@ -0,0 +1,104 @@
+﻿// Source/Analysis/FrameBufferPool.cpp
+#include "FrameBufferPool.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+FrameBufferPool::FrameBufferPool(int maxIdleBuffers)
+    : m_shared(std::make_shared<Shared>())
+{
+    m_shared->maxIdle = std::max(1, maxIdleBuffers);
+    m_shared->idle.reserve(static_cast<size_t>(m_shared->maxIdle) + 1);
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    QMutexLocker locker(&m_shared->mutex);
+    m_shared->closed = true;
+    for (Buffer* buffer : m_shared->idle) {
+        delete buffer;
+    }
+    m_shared->idle.clear();
+}
+
+QImage FrameBufferPool::acquire(int width, int height, QImage::Format format)
+{
+    if (width <= 0 || height <= 0 || format == QImage::Format_Invalid) {
+        return QImage();
+    }
+
+    Buffer* buffer = nullptr;
+    {
+        QMutexLocker locker(&m_shared->mutex);
+        std::vector<Buffer*>& idle = m_shared->idle;
+        auto it = std::find_if(idle.begin(), idle.end(), [&](const Buffer* candidate) {
+            return candidate->width == width && candidate->height == height && candidate->format == format;
+            });
+
+        if (it != idle.end()) {
+            buffer = *it;
+            idle.erase(it);
+            m_shared->reuses++;
+        }
+        else {
+            // 尺寸或格式变了，其他空闲缓冲不会再被用到
+            for (Buffer* stale : idle) {
+                delete stale;
+            }
+            idle.clear();
+            m_shared->allocations++;
+        }
+    }
+
+    if (!buffer) {
+        const int bitsPerPixel = QImage::toPixelFormat(format).bitsPerPixel();
+        buffer = new Buffer();
+        buffer->width = width;
+        buffer->height = height;
+        buffer->format = format;
+        buffer->bytesPerLine = ((static_cast<qsizetype>(width) * bitsPerPixel + 31) / 32) * 4;
+        buffer->data.reset(new uchar[static_cast<size_t>(buffer->bytesPerLine) * height]);
+    }
+
+    buffer->owner = m_shared;
+    return QImage(buffer->data.get(), width, height, buffer->bytesPerLine, format,
+        &FrameBufferPool::releaseBuffer, buffer);
+}
+
+int FrameBufferPool::idleCount() const
+{
+    QMutexLocker locker(&m_shared->mutex);
+    return static_cast<int>(m_shared->idle.size());
+}
+
+quint64 FrameBufferPool::allocationCount() const
+{
+    QMutexLocker locker(&m_shared->mutex);
+    return m_shared->allocations;
+}
+
+quint64 FrameBufferPool::reuseCount() const
+{
+    QMutexLocker locker(&m_shared->mutex);
+    return m_shared->reuses;
+}
+
+void FrameBufferPool::releaseBuffer(void* info)
+{
+    Buffer* buffer = static_cast<Buffer*>(info);
+
+    // 取出所属池的引用；如果这是最后一个引用，共享状态在本函数返回时释放
+    const std::shared_ptr<Shared> owner = std::move(buffer->owner);
+
+    QMutexLocker locker(&owner->mutex);
+    if (owner->closed) {
+        delete buffer;
+        return;
+    }
+
+    // 超过上限时丢弃最早归还的缓冲
+    if (static_cast<int>(owner->idle.size()) >= owner->maxIdle) {
+        delete owner->idle.front();
+        owner->idle.erase(owner->idle.begin());
+    }
+    owner->idle.push_back(buffer);
+}
@@ -0,0 +1,84 @@
+﻿// Source/Analysis/FrameBufferPool.h
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 视频帧像素缓冲池
+ *
+ * acquire()返回的QImage直接使用池中的像素缓冲，并登记清理函数：最后一个引用该图像的
+ * QImage析构时，缓冲回到池中，而不是释放。图像在解码线程、预解码缓存和模型之间按值移动，
+ * 隐式共享只增减引用计数，稳定播放时不再为每帧分配和释放整帧像素内存。
+ *
+ * 空闲缓冲按(宽, 高, 格式)匹配；出现新的尺寸或格式时，其他尺寸的空闲缓冲随即释放。
+ * 池先于图像销毁时，仍被图像持有的缓冲在图像释放时直接删除。
+ * acquire和缓冲归还可以发生在任意线程。
+ */
+class FrameBufferPool {
+public:
+    static constexpr int DEFAULT_MAX_IDLE_BUFFERS = 4;     ///< 默认最多保留的空闲缓冲数
+
+    explicit FrameBufferPool(int maxIdleBuffers = DEFAULT_MAX_IDLE_BUFFERS);
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    /**
+     * @brief 获取一帧图像，优先复用空闲缓冲
+     * @return 可写图像，内容未初始化；参数无效时为空
+     */
+    QImage acquire(int width, int height, QImage::Format format);
+
+    /**
+     * @brief 当前空闲缓冲数
+     */
+    int idleCount() const;
+
+    /**
+     * @brief 累计新分配的缓冲数
+     */
+    quint64 allocationCount() const;
+
+    /**
+     * @brief 累计复用的次数
+     */
+    quint64 reuseCount() const;
+
+private:
+    struct Shared;
+
+    /**
+     * @brief 像素缓冲
+     */
+    struct Buffer {
+        std::unique_ptr<uchar[]> data;      ///< 像素数据
+        int width = 0;                      ///< 宽度
+        int height = 0;                     ///< 高度
+        QImage::Format format = QImage::Format_Invalid; ///< 格式
+        qsizetype bytesPerLine = 0;         ///< 每行字节数（4字节对齐）
+        std::shared_ptr<Shared> owner;      ///< 借出期间持有所属的池，空闲时为空，避免循环引用
+    };
+
+    /**
+     * @brief 池的共享状态，由池和借出的缓冲共同持有
+     */
+    struct Shared {
+        mutable QMutex mutex;               ///< 保护以下成员
+        std::vector<Buffer*> idle;          ///< 空闲缓冲
+        int maxIdle = DEFAULT_MAX_IDLE_BUFFERS; ///< 空闲缓冲上限
+        bool closed = false;                ///< 池已销毁
+        quint64 allocations = 0;            ///< 新分配次数
+        quint64 reuses = 0;                 ///< 复用次数
+    };
+
+    /**
+     * @brief QImage的清理函数，把缓冲归还给池
+     */
+    static void releaseBuffer(void* info);
+
+    std::shared_ptr<Shared> m_shared;       ///< 共享状态
+};
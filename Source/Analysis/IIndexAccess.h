@@ -79,7 +79,7 @@ public:
 
     QVector<PacketIndexEntry> findPacketsByCommandType(uint8_t commandType, int limit = -1) const override {
         IndexQuery query;
-        query.featureFilters.append(QString("commandType=%1").arg(commandType));
+        query.commandType = commandType;
         query.limit = limit;
         return IndexGenerator::getInstance().queryIndex(query);
     }
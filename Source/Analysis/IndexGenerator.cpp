@@ -6,6 +6,164 @@
 #include <QJsonArray>
 #include <QDir>
 #include <QRegularExpression>
+#include <algorithm>
+
+IndexSegment::IndexSegment(int baseIndex)
+    : m_baseIndex(baseIndex)
+{
+    // 一次分配到位，追加期间地址不变，读者可直接访问已发布的条目
+    m_entries.reserve(CAPACITY);
+    m_timestamps.reserve(CAPACITY);
+    m_entryData = m_entries.data();
+    m_timestampData = m_timestamps.data();
+}
+
+void IndexSegment::append(const PacketIndexEntry& entry)
+{
+    const int count = m_published.load(std::memory_order_relaxed);
+    m_entries.push_back(entry);
+    m_timestamps.append(entry.timestamp);
+
+    // 条目写完后再发布数量
+    m_published.store(count + 1, std::memory_order_release);
+}
+
+void IndexSegment::seal()
+{
+    const int count = m_published.load(std::memory_order_relaxed);
+
+    m_timestamps.freeze();
+
+    // 指令类型倒排表：计数排序，同类型内位置保持升序
+    m_typeOffsets.fill(0);
+    for (int i = 0; i < count; ++i) {
+        m_typeOffsets[m_entryData[i].commandType + 1]++;
+    }
+    for (size_t type = 1; type < m_typeOffsets.size(); ++type) {
+        m_typeOffsets[type] += m_typeOffsets[type - 1];
+    }
+    std::array<uint32_t, 256> cursor;
+    std::copy(m_typeOffsets.begin(), m_typeOffsets.begin() + cursor.size(), cursor.begin());
+    m_typeOrder.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_typeOrder[cursor[m_entryData[i].commandType]++] = static_cast<uint16_t>(i);
+    }
+
+    // 序列号有序表，键中低16位为段内位置
+    m_sequenceKeys.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_sequenceKeys[i] = (static_cast<uint64_t>(m_entryData[i].sequence) << 16) | static_cast<uint64_t>(i);
+    }
+    std::sort(m_sequenceKeys.begin(), m_sequenceKeys.end());
+
+    m_sealed.store(true, std::memory_order_release);
+}
+
+int IndexSegment::lowerBound(uint64_t timestamp, int count) const
+{
+    if (count == CAPACITY && isSealed()) {
+        return static_cast<int>(m_timestamps.lowerBound(timestamp));
+    }
+    return static_cast<int>(std::lower_bound(m_timestampData, m_timestampData + count, timestamp) - m_timestampData);
+}
+
+int IndexSegment::upperBound(uint64_t timestamp, int count) const
+{
+    if (count == CAPACITY && isSealed()) {
+        return static_cast<int>(m_timestamps.upperBound(timestamp));
+    }
+    return static_cast<int>(std::upper_bound(m_timestampData, m_timestampData + count, timestamp) - m_timestampData);
+}
+
+QVector<int> IndexSegment::sequenceRange(uint32_t sequenceStart, uint32_t sequenceEnd) const
+{
+    QVector<int> positions;
+
+    auto first = std::lower_bound(m_sequenceKeys.begin(), m_sequenceKeys.end(),
+        static_cast<uint64_t>(sequenceStart) << 16);
+    auto last = std::upper_bound(first, m_sequenceKeys.end(),
+        (static_cast<uint64_t>(sequenceEnd) << 16) | 0xFFFF);
+
+    positions.reserve(static_cast<int>(last - first));
+    for (auto it = first; it != last; ++it) {
+        positions.append(static_cast<int>(*it & 0xFFFF));
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+int IndexSnapshot::findSegment(uint64_t timestamp, bool upper) const
+{
+    // 以各段末条目时间戳二分，段数很少，代价可忽略
+    int left = 0;
+    int right = segmentCount();
+    while (left < right) {
+        int mid = left + (right - left) / 2;
+        uint64_t lastTimestamp = segment(mid).timestampAt(segmentSize(mid) - 1);
+        if (upper ? lastTimestamp > timestamp : lastTimestamp >= timestamp) {
+            right = mid;
+        }
+        else {
+            left = mid + 1;
+        }
+    }
+    return left;
+}
+
+int IndexSnapshot::lowerBound(uint64_t timestamp) const
+{
+    int s = findSegment(timestamp, false);
+    if (s >= segmentCount()) {
+        return m_size;
+    }
+    return (s << IndexSegment::CAPACITY_SHIFT) + segment(s).lowerBound(timestamp, segmentSize(s));
+}
+
+int IndexSnapshot::upperBound(uint64_t timestamp) const
+{
+    int s = findSegment(timestamp, true);
+    if (s >= segmentCount()) {
+        return m_size;
+    }
+    return (s << IndexSegment::CAPACITY_SHIFT) + segment(s).upperBound(timestamp, segmentSize(s));
+}
+
+int IndexSnapshot::closest(uint64_t timestamp) const
+{
+    if (m_size == 0) {
+        return -1;
+    }
+
+    int pos = lowerBound(timestamp);
+    if (pos >= m_size) {
+        return m_size - 1;
+    }
+
+    uint64_t right = at(pos).timestamp;
+    if (pos == 0 || right == timestamp) {
+        return pos;
+    }
+
+    // 距离相等时取较晚的一个
+    uint64_t diffLeft = timestamp - at(pos - 1).timestamp;
+    uint64_t diffRight = right - timestamp;
+    return diffLeft < diffRight ? pos - 1 : pos;
+}
+
+QVector<PacketIndexEntry> IndexSnapshot::mid(int pos, int length) const
+{
+    QVector<PacketIndexEntry> result;
+    if (pos < 0 || pos >= m_size) {
+        return result;
+    }
+
+    int end = (length < 0 || length > m_size - pos) ? m_size : pos + length;
+    result.reserve(end - pos);
+    for (int i = pos; i < end; ++i) {
+        result.append(at(i));
+    }
+    return result;
+}
 
 IndexGenerator& IndexGenerator::getInstance()
 {
@@ -21,6 +179,7 @@ IndexGenerator::IndexGenerator(QObject* parent)
     , m_foundPartialHeader(false)
     , m_persistentMode(true)
 {
+    m_segments.store(std::make_shared<const IndexSnapshot::SegmentList>());
 }
 
 IndexGenerator::~IndexGenerator() {
@@ -51,11 +210,9 @@ bool IndexGenerator::open(const QString& path)
     }
 
     // 初始化空索引
-    m_indexEntries.clear();
-    m_timestampToIndex.clear();
-    m_entryCount = 0;
-    m_lastSavedCount = 0;
+    resetIndexLocked();
     m_isOpen = true;
+    m_openPath = path;
 
     LOG_INFO(LocalQTCompat::fromLocal8Bit("索引文件已创建: %1").arg(path));
     return true;
@@ -87,7 +244,9 @@ bool IndexGenerator::saveIndex(bool forceSave)
     // 创建JSON文档
     QJsonArray entriesArray;
 
-    for (const PacketIndexEntry& entry : m_indexEntries) {
+    const IndexSnapshot snapshot = getSnapshot();
+    for (int i = 0; i < snapshot.size(); ++i) {
+        const PacketIndexEntry& entry = snapshot.at(i);
         QJsonObject entryObj;
         entryObj["timestamp"] = QString::number(entry.timestamp);
         entryObj["fileOffset"] = QString::number(entry.fileOffset);
@@ -151,12 +310,8 @@ int IndexGenerator::addPacketIndex(const DataPacket& packet, uint64_t fileOffset
     entry.isValidHeader = packet.isValidHeader;
     entry.commandDesc = getCommandDescription(packet.commandType);
 
-    // 添加到内存索引
-    int indexId = m_indexEntries.size();
-    m_indexEntries.append(entry);
-
-    // 更新快速查找映射
-    m_timestampToIndex.insert(entry.timestamp, indexId);
+    // 添加到内存索引并更新各级索引
+    int indexId = appendEntryLocked(entry);
 
     // 写入索引记录
     m_textStream << indexId << ","
@@ -196,59 +351,60 @@ int IndexGenerator::addPacketIndexBatch(const std::vector<DataPacket>& packets,
     int totalAdded = 0;
     uint64_t currentOffset = startFileOffset;
 
-    // 预先计算缓冲区的大小，减少多次分配内存
-    QString entriesBuffer;
-    entriesBuffer.reserve(packets.size() * 120); // 每条记录预估120个字符
+    {
+        // 追加由写锁串行化，读者通过快照访问不受影响
+        QMutexLocker locker(&m_mutex);
 
-    // 批量处理所有数据包
-    for (const auto& packet : packets) {
-        // 创建新索引条目
-        PacketIndexEntry entry;
-        entry.timestamp = packet.timestamp;
-        entry.fileOffset = packet.offsetInFile;
-        entry.size = static_cast<uint32_t>(packet.getSize());
-        // entry.fileName = m_indexFileName;
-        entry.batchId = packet.batchId;
-        entry.packetIndex = packet.packetIndex;
-
-        // 新增字段
-        entry.commandType = packet.commandType;
-        entry.sequence = packet.sequence;
-        entry.isValidHeader = packet.isValidHeader;
-        entry.commandDesc = getCommandDescription(packet.commandType);
-
-        // 添加到内存索引
-        int indexId = m_indexEntries.size();
-        m_indexEntries.append(entry);
-
-        // 更新快速查找映射
-        m_timestampToIndex.insert(entry.timestamp, indexId);
-
-        // 构建索引记录
-        entriesBuffer.append(QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11\n")
-            .arg(indexId)
-            .arg(entry.timestamp)
-            .arg(entry.size)
-            .arg(entry.fileOffset)
-            .arg(entry.fileName)
-            .arg(entry.batchId)
-            .arg(entry.packetIndex)
-            .arg(static_cast<int>(entry.commandType))
-            .arg(entry.sequence)
-            .arg(entry.isValidHeader ? "1" : "0")
-            .arg(entry.commandDesc));
-
-        totalAdded++;
-        currentOffset += packet.getSize();
-    }
+        // 预先计算缓冲区的大小，减少多次分配内存
+        QString entriesBuffer;
+        entriesBuffer.reserve(packets.size() * 120); // 每条记录预估120个字符
+
+        // 批量处理所有数据包
+        for (const auto& packet : packets) {
+            // 创建新索引条目
+            PacketIndexEntry entry;
+            entry.timestamp = packet.timestamp;
+            entry.fileOffset = packet.offsetInFile;
+            entry.size = static_cast<uint32_t>(packet.getSize());
+            // entry.fileName = m_indexFileName;
+            entry.batchId = packet.batchId;
+            entry.packetIndex = packet.packetIndex;
+
+            // 新增字段
+            entry.commandType = packet.commandType;
+            entry.sequence = packet.sequence;
+            entry.isValidHeader = packet.isValidHeader;
+            entry.commandDesc = getCommandDescription(packet.commandType);
+
+            // 添加到内存索引并更新各级索引
+            int indexId = appendEntryLocked(entry);
+
+            // 构建索引记录
+            entriesBuffer.append(QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11\n")
+                .arg(indexId)
+                .arg(entry.timestamp)
+                .arg(entry.size)
+                .arg(entry.fileOffset)
+                .arg(entry.fileName)
+                .arg(entry.batchId)
+                .arg(entry.packetIndex)
+                .arg(static_cast<int>(entry.commandType))
+                .arg(entry.sequence)
+                .arg(entry.isValidHeader ? "1" : "0")
+                .arg(entry.commandDesc));
+
+            totalAdded++;
+            currentOffset += packet.getSize();
+        }
 
-    // 一次性写入所有记录
-    m_textStream << entriesBuffer;
-    m_entryCount += totalAdded;
+        // 一次性写入所有记录
+        m_textStream << entriesBuffer;
+        m_entryCount += totalAdded;
 
-    // 检查是否需要保存索引
-    if (m_entryCount - m_lastSavedCount >= 5000) {
-        saveIndex(false);
+        // 检查是否需要保存索引
+        if (m_entryCount - m_lastSavedCount >= 5000) {
+            saveIndex(false);
+        }
     }
 
     // 每处理完一批数据发送一次信号
@@ -259,6 +415,36 @@ int IndexGenerator::addPacketIndexBatch(const std::vector<DataPacket>& packets,
     return totalAdded;
 }
 
+int IndexGenerator::addIndexEntries(const QVector<PacketIndexEntry>& entries)
+{
+    if (entries.isEmpty()) {
+        return 0;
+    }
+
+    int totalAdded = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!m_isOpen) {
+            return 0;
+        }
+
+        for (const PacketIndexEntry& source : entries) {
+            PacketIndexEntry entry = source;
+            entry.commandDesc = getCommandDescription(entry.commandType);
+
+            // 添加到内存索引并更新各级索引
+            appendEntryLocked(entry);
+            totalAdded++;
+        }
+
+        m_entryCount += totalAdded;
+    }
+
+    emit indexUpdated(m_entryCount);
+    return totalAdded;
+}
+
 // #define IDXG_DBG
 int IndexGenerator::parseDataStream(const uint8_t* data, size_t size, uint64_t fileOffset)
 {
@@ -776,45 +962,15 @@ int IndexGenerator::parseDataStream(const uint8_t* data, size_t size, uint64_t f
 
 PacketIndexEntry IndexGenerator::findClosestPacket(uint64_t timestamp)
 {
-    QMutexLocker locker(&m_mutex);
+    const IndexSnapshot snapshot = getSnapshot();
 
-    if (m_indexEntries.isEmpty()) {
+    int pos = snapshot.closest(timestamp);
+    if (pos < 0) {
         return PacketIndexEntry(); // 返回空条目
     }
 
-    // 二分查找最接近的时间戳
-    int left = 0;
-    int right = m_indexEntries.size() - 1;
-
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-
-        if (m_indexEntries[mid].timestamp == timestamp) {
-            return m_indexEntries[mid];
-        }
-
-        if (m_indexEntries[mid].timestamp < timestamp) {
-            left = mid + 1;
-        }
-        else {
-            right = mid - 1;
-        }
-    }
-
-    // 如果没有精确匹配，找出最接近的
-    if (left >= m_indexEntries.size()) {
-        return m_indexEntries[m_indexEntries.size() - 1];
-    }
-
-    if (left == 0) {
-        return m_indexEntries[0];
-    }
-
-    // 比较哪个更接近
-    uint64_t diffLeft = timestamp - m_indexEntries[left - 1].timestamp;
-    uint64_t diffRight = m_indexEntries[left].timestamp - timestamp;
-
-    return (diffLeft < diffRight) ? m_indexEntries[left - 1] : m_indexEntries[left];
+    // 只在时间戳列上查找，仅访问命中的一个条目
+    return snapshot.at(pos);
 }
 
 QVector<PacketIndexEntry> IndexGenerator::getPacketsInRange(uint64_t startTime, uint64_t endTime)
@@ -828,74 +984,83 @@ QVector<PacketIndexEntry> IndexGenerator::getPacketsInRange(uint64_t startTime,
 
 QVector<PacketIndexEntry> IndexGenerator::queryIndex(const IndexQuery& query)
 {
-    QMutexLocker locker(&m_mutex);
+    // 过滤条件在读取快照前编译，避免对每个条目做字符串解析
+    const CompiledQuery compiled = compileQuery(query);
     QVector<PacketIndexEntry> results;
 
-    if (m_indexEntries.isEmpty()) {
+    // 读取快照，不占用写锁，查询期间的追加不影响本次结果
+    const IndexSnapshot snapshot = getSnapshot();
+    if (snapshot.isEmpty() || compiled.empty || query.timestampStart > query.timestampEnd) {
         return results;
     }
 
-    // 使用二分查找快速定位开始和结束范围
-    int startIdx = binarySearchTimestamp(query.timestampStart, true);   // 下边界(首个大于等于开始时间戳的索引)
-    int endIdx = binarySearchTimestamp(query.timestampEnd, false);      // 上边界(最后一个小于等于结束时间戳的索引)
-
-    if (startIdx == -1 || endIdx == -1 || startIdx > endIdx) {
+    // 时间范围 [startIdx, endIdx)
+    const int startIdx = snapshot.lowerBound(query.timestampStart);
+    const int endIdx = snapshot.upperBound(query.timestampEnd);
+    if (startIdx >= endIdx) {
         return results;
     }
 
-    // 基于时间戳范围过滤
-    for (int i = startIdx; i <= endIdx; ++i) {
-        const PacketIndexEntry& entry = m_indexEntries[i];
-
-        if (entry.timestamp >= query.timestampStart && entry.timestamp <= query.timestampEnd) {
-            // 检查特征过滤条件
-            bool passesFilter = true;
-
-            // 处理特征过滤
-            if (!query.featureFilters.isEmpty()) {
-                for (const QString& filter : query.featureFilters) {
-                    // 支持简单的筛选条件如 "batchId=5" 或 "fileName=data.bin"
-                    if (filter.contains('=')) {
-                        QString field = filter.section('=', 0, 0).trimmed();
-                        QString value = filter.section('=', 1).trimmed();
-
-                        // 检查匹配条件
-                        if (field == "batchId" && QString::number(entry.batchId) != value) {
-                            passesFilter = false;
-                            break;
-                        }
-                        else if (field == "fileName" && !entry.fileName.contains(value)) {
-                            passesFilter = false;
-                            break;
-                        }
-                        else if (field == "packetIndex" && QString::number(entry.packetIndex) != value) {
-                            passesFilter = false;
-                            break;
-                        }
-                        else if (field == "size" && QString::number(entry.size) != value) {
-                            passesFilter = false;
-                            break;
-                        }
-                    }
+    auto matches = [&query, &compiled](const PacketIndexEntry& entry) {
+        return entry.timestamp >= query.timestampStart && entry.timestamp <= query.timestampEnd &&
+            (compiled.commandType < 0 || entry.commandType == compiled.commandType) &&
+            entry.sequence >= compiled.sequenceStart && entry.sequence <= compiled.sequenceEnd &&
+            matchesPredicates(entry, compiled.predicates);
+    };
+
+    if (compiled.commandType < 0 && !compiled.hasSequenceRange() && compiled.predicates.isEmpty()) {
+        results.reserve(endIdx - startIdx);
+    }
+
+    // 逐段查询：已封存分段走二级索引，正在追加的分段直接扫描已发布部分
+    const int firstSegment = startIdx >> IndexSegment::CAPACITY_SHIFT;
+    const int lastSegment = (endIdx - 1) >> IndexSegment::CAPACITY_SHIFT;
+    for (int s = firstSegment; s <= lastSegment; ++s) {
+        const IndexSegment& segment = snapshot.segment(s);
+        const int segmentSize = snapshot.segmentSize(s);
+        const int base = s << IndexSegment::CAPACITY_SHIFT;
+        const int localBegin = std::max(startIdx - base, 0);
+        const int localEnd = std::min(endIdx - base, segmentSize);
+        const bool indexed = segmentSize == IndexSegment::CAPACITY && segment.isSealed();
+
+        if (indexed && compiled.commandType >= 0) {
+            // 指令类型倒排表：位置升序，二分定位本段时间范围
+            const uint8_t commandType = static_cast<uint8_t>(compiled.commandType);
+            const uint16_t* end = segment.commandTypeEnd(commandType);
+            const uint16_t* it = std::lower_bound(segment.commandTypeBegin(commandType), end, localBegin);
+            for (; it != end && *it < localEnd; ++it) {
+                const PacketIndexEntry& entry = segment.at(*it);
+                if (matches(entry)) {
+                    results.append(entry);
                 }
             }
-
-            if (passesFilter) {
-                results.append(entry);
+        }
+        else if (indexed && compiled.hasSequenceRange()) {
+            // 序列号有序表：只访问范围内的条目
+            for (int local : segment.sequenceRange(compiled.sequenceStart, compiled.sequenceEnd)) {
+                if (local < localBegin || local >= localEnd) {
+                    continue;
+                }
+                const PacketIndexEntry& entry = segment.at(local);
+                if (matches(entry)) {
+                    results.append(entry);
+                }
+            }
+        }
+        else {
+            for (int local = localBegin; local < localEnd; ++local) {
+                const PacketIndexEntry& entry = segment.at(local);
+                if (matches(entry)) {
+                    results.append(entry);
+                }
             }
         }
     }
 
-    // 排序结果
+    // 各分段按位置顺序访问，二级索引给出的位置也是升序，结果已按时间戳升序排列，不需要再排序；
+    // 时间戳相同的条目保持存储顺序，每次查询的顺序一致。降序时整体反转
     if (query.descending) {
-        std::sort(results.begin(), results.end(), [](const PacketIndexEntry& a, const PacketIndexEntry& b) {
-            return a.timestamp > b.timestamp;
-            });
-    }
-    else {
-        std::sort(results.begin(), results.end(), [](const PacketIndexEntry& a, const PacketIndexEntry& b) {
-            return a.timestamp < b.timestamp;
-            });
+        std::reverse(results.begin(), results.end());
     }
 
     // 限制结果数量
@@ -906,12 +1071,160 @@ QVector<PacketIndexEntry> IndexGenerator::queryIndex(const IndexQuery& query)
     return results;
 }
 
+IndexGenerator::CompiledQuery IndexGenerator::compileQuery(const IndexQuery& query)
+{
+    CompiledQuery compiled;
+    compiled.commandType = query.commandType;
+    compiled.sequenceStart = query.sequenceStart;
+    compiled.sequenceEnd = query.sequenceEnd;
+
+    // 支持 "field=value"、"field>=value"、"field<value" 等形式，未知字段忽略
+    static const QRegularExpression filterPattern(QStringLiteral("^\\s*(\\w+)\\s*(>=|<=|=|>|<)\\s*(.*?)\\s*$"));
+
+    for (const QString& filter : query.featureFilters) {
+        QRegularExpressionMatch match = filterPattern.match(filter);
+        if (!match.hasMatch()) {
+            continue;
+        }
+
+        const QString field = match.captured(1);
+        const QString opText = match.captured(2);
+        const QString valueText = match.captured(3);
+
+        FieldPredicate predicate;
+        predicate.op = opText == ">=" ? FieldPredicate::GreaterEqual
+            : opText == "<=" ? FieldPredicate::LessEqual
+            : opText == ">" ? FieldPredicate::Greater
+            : opText == "<" ? FieldPredicate::Less
+            : FieldPredicate::Equal;
+
+        if (field == "fileName") {
+            predicate.field = FieldPredicate::FileName;
+            predicate.op = FieldPredicate::Contains;
+            predicate.text = valueText;
+            compiled.predicates.append(predicate);
+            continue;
+        }
+
+        if (field == "batchId") {
+            predicate.field = FieldPredicate::BatchId;
+        }
+        else if (field == "packetIndex") {
+            predicate.field = FieldPredicate::PacketIndex;
+        }
+        else if (field == "size") {
+            predicate.field = FieldPredicate::Size;
+        }
+        else if (field == "commandType") {
+            predicate.field = FieldPredicate::CommandType;
+        }
+        else if (field == "sequence") {
+            predicate.field = FieldPredicate::Sequence;
+        }
+        else {
+            continue;
+        }
+
+        bool ok = false;
+        if (valueText.startsWith("0x", Qt::CaseInsensitive)) {
+            predicate.value = valueText.mid(2).toULongLong(&ok, 16);
+        }
+        else {
+            predicate.value = valueText.toULongLong(&ok, 10);
+        }
+        if (!ok) {
+            // 数值无法解析时与原字符串比较的结果相同：不可能匹配
+            compiled.empty = true;
+            continue;
+        }
+
+        // 指令类型等值条件和序列号范围条件交给二级索引
+        if (predicate.field == FieldPredicate::CommandType && predicate.op == FieldPredicate::Equal) {
+            if (predicate.value > 0xFF ||
+                (compiled.commandType >= 0 && compiled.commandType != static_cast<int>(predicate.value))) {
+                compiled.empty = true;
+            }
+            compiled.commandType = static_cast<int>(predicate.value & 0xFF);
+            continue;
+        }
+
+        if (predicate.field == FieldPredicate::Sequence) {
+            uint64_t lo = compiled.sequenceStart;
+            uint64_t hi = compiled.sequenceEnd;
+            switch (predicate.op) {
+            case FieldPredicate::Equal:        lo = std::max(lo, predicate.value); hi = std::min(hi, predicate.value); break;
+            case FieldPredicate::Greater:      lo = std::max(lo, predicate.value + 1); break;
+            case FieldPredicate::GreaterEqual: lo = std::max(lo, predicate.value); break;
+            case FieldPredicate::Less:
+                if (predicate.value == 0) { compiled.empty = true; }
+                else { hi = std::min(hi, predicate.value - 1); }
+                break;
+            case FieldPredicate::LessEqual:    hi = std::min(hi, predicate.value); break;
+            default: break;
+            }
+            if (lo > hi || lo > UINT32_MAX) {
+                compiled.empty = true;
+            }
+            else {
+                compiled.sequenceStart = static_cast<uint32_t>(lo);
+                compiled.sequenceEnd = static_cast<uint32_t>(hi);
+            }
+            continue;
+        }
+
+        compiled.predicates.append(predicate);
+    }
+
+    if (compiled.commandType > 0xFF || compiled.sequenceStart > compiled.sequenceEnd) {
+        compiled.empty = true;
+    }
+
+    return compiled;
+}
+
+bool IndexGenerator::matchesPredicates(const PacketIndexEntry& entry, const QVector<FieldPredicate>& predicates)
+{
+    for (const FieldPredicate& predicate : predicates) {
+        if (predicate.field == FieldPredicate::FileName) {
+            if (!entry.fileName.contains(predicate.text)) {
+                return false;
+            }
+            continue;
+        }
+
+        uint64_t value = 0;
+        switch (predicate.field) {
+        case FieldPredicate::BatchId:     value = entry.batchId; break;
+        case FieldPredicate::PacketIndex: value = entry.packetIndex; break;
+        case FieldPredicate::Size:        value = entry.size; break;
+        case FieldPredicate::CommandType: value = entry.commandType; break;
+        case FieldPredicate::Sequence:    value = entry.sequence; break;
+        default: break;
+        }
+
+        bool passes = true;
+        switch (predicate.op) {
+        case FieldPredicate::Equal:        passes = value == predicate.value; break;
+        case FieldPredicate::Less:         passes = value < predicate.value; break;
+        case FieldPredicate::LessEqual:    passes = value <= predicate.value; break;
+        case FieldPredicate::Greater:      passes = value > predicate.value; break;
+        case FieldPredicate::GreaterEqual: passes = value >= predicate.value; break;
+        default: break;
+        }
+
+        if (!passes) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool IndexGenerator::loadIndex(const QString& path)
 {
     QMutexLocker locker(&m_mutex);
 
-    // 清空当前索引
-    clearIndex();
+    // 清空当前索引（已持有锁，不能再调用clearIndex）
+    resetIndexLocked();
 
     // 尝试加载JSON索引
     QString jsonPath = path + ".json";
@@ -970,15 +1283,11 @@ bool IndexGenerator::loadIndex(const QString& path)
             entry.commandDesc = getCommandDescription(0);
         }
 
-        // 添加到内存索引
-        int indexId = m_indexEntries.size();
-        m_indexEntries.append(entry);
-
-        // 更新快速查找映射
-        m_timestampToIndex.insert(entry.timestamp, indexId);
+        // 添加到内存索引并更新各级索引
+        appendEntryLocked(entry);
     }
 
-    m_entryCount = m_indexEntries.size();
+    m_entryCount = getSnapshot().size();
     m_lastSavedCount = m_entryCount;
 
     LOG_INFO(LocalQTCompat::fromLocal8Bit("成功加载索引从: %1，共 %2 条记录").arg(jsonPath).arg(m_entryCount));
@@ -993,6 +1302,7 @@ bool IndexGenerator::loadIndex(const QString& path)
 
     m_textStream.setDevice(&m_indexFile);
     m_isOpen = true;
+    m_openPath = path;
 
     // 发送更新信号
     emit indexUpdated(m_entryCount);
@@ -1002,28 +1312,32 @@ bool IndexGenerator::loadIndex(const QString& path)
 
 QVector<PacketIndexEntry> IndexGenerator::getAllIndexEntries()
 {
-    QVector<PacketIndexEntry> entriesCopy;
-    {
-        QMutexLocker locker(&m_mutex);
-        entriesCopy = m_indexEntries;
+    // 在快照上复制，不阻塞索引写入
+    return getSnapshot().mid(0);
+}
+
+IndexSnapshot IndexGenerator::getSnapshot() const
+{
+    std::shared_ptr<const IndexSnapshot::SegmentList> segments = m_segments.load(std::memory_order_acquire);
+
+    // 除最后一段外均已写满，总数由最后一段的已发布数量决定
+    int size = 0;
+    if (!segments->empty()) {
+        const IndexSegment& last = *segments->back();
+        size = last.baseIndex() + last.publishedCount();
     }
-    return entriesCopy;
+    return IndexSnapshot(std::move(segments), size);
 }
 
 int IndexGenerator::getIndexCount()
 {
-    QMutexLocker locker(&m_mutex);
-    return m_entryCount;
+    return getSnapshot().size();
 }
 
 void IndexGenerator::clearIndex()
 {
     QMutexLocker locker(&m_mutex);
-
-    m_indexEntries.clear();
-    m_timestampToIndex.clear();
-    m_entryCount = 0;
-    m_lastSavedCount = 0;
+    resetIndexLocked();
 }
 
 void IndexGenerator::flush()
@@ -1087,52 +1401,39 @@ QString IndexGenerator::getBasePath()
     return m_basePath;
 }
 
-int IndexGenerator::binarySearchTimestamp(uint64_t timestamp, bool lowerBound) const
+int IndexGenerator::appendEntryLocked(const PacketIndexEntry& entry)
 {
-    if (m_indexEntries.isEmpty()) {
-        return -1;
-    }
-
-    int left = 0;
-    int right = m_indexEntries.size() - 1;
-    int result = -1;
-
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-
-        if (m_indexEntries[mid].timestamp == timestamp) {
-            return mid;  // 精确匹配
+    // 当前分段写满后封存，并发布包含新分段的列表
+    if (!m_openSegment || m_openSegment->publishedCount() == IndexSegment::CAPACITY) {
+        int baseIndex = 0;
+        if (m_openSegment) {
+            m_openSegment->seal();
+            baseIndex = m_openSegment->baseIndex() + IndexSegment::CAPACITY;
         }
 
-        if (m_indexEntries[mid].timestamp < timestamp) {
-            left = mid + 1;
-            if (lowerBound) {
-                result = mid;  // 更新下边界
-            }
-        }
-        else {
-            right = mid - 1;
-            if (!lowerBound) {
-                result = mid;  // 更新上边界
-            }
-        }
+        auto segments = std::make_shared<IndexSnapshot::SegmentList>(*m_segments.load(std::memory_order_relaxed));
+        m_openSegment = std::make_shared<IndexSegment>(baseIndex);
+        segments->push_back(m_openSegment);
+        publishSegmentsLocked(std::move(segments));
     }
 
-    // 处理边界情况
-    if (lowerBound) {
-        // 找下边界，如果所有元素都大于目标时间戳
-        if (result == -1 && left == 0) {
-            return 0;
-        }
-    }
-    else {
-        // 找上边界，如果所有元素都小于目标时间戳
-        if (result == -1 && right == m_indexEntries.size() - 1) {
-            return m_indexEntries.size() - 1;
-        }
-    }
+    int indexId = m_openSegment->baseIndex() + m_openSegment->publishedCount();
+    m_openSegment->append(entry);
+    return indexId;
+}
 
-    return result;
+void IndexGenerator::publishSegmentsLocked(std::shared_ptr<const IndexSnapshot::SegmentList> segments)
+{
+    m_segments.store(std::move(segments), std::memory_order_release);
+}
+
+void IndexGenerator::resetIndexLocked()
+{
+    // 已获取的快照仍持有旧分段，不受影响
+    m_openSegment.reset();
+    publishSegmentsLocked(std::make_shared<const IndexSnapshot::SegmentList>());
+    m_entryCount = 0;
+    m_lastSavedCount = 0;
 }
 
 QString IndexGenerator::getCommandDescription(uint8_t commandType)
@@ -12,14 +12,24 @@
 #include <QSharedPointer>
 #include <QVariant>
 #include <memory>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <algorithm>
 #include "DataPacket.h"
+#include "TimestampColumn.h"
 
 struct IndexQuery {
     uint64_t timestampStart = 0;
     uint64_t timestampEnd = UINT64_MAX;
-    QStringList featureFilters;  // 特征过滤条件，如"amplitude>50"
+    QStringList featureFilters;  // 特征过滤条件，如"batchId=5"、"sequence>=100"，查询前编译一次
     int limit = -1;              // 结果限制数量，-1表示无限制
     bool descending = false;     // 是否降序排序
+
+    // 类型化过滤条件，直接走二级索引
+    int commandType = -1;               // 指令类型，-1表示不过滤
+    uint32_t sequenceStart = 0;         // 序列号下限（含）
+    uint32_t sequenceEnd = UINT32_MAX;  // 序列号上限（含）
 };
 
 // 数据包索引结构
@@ -36,6 +46,131 @@ struct PacketIndexEntry {
     QString commandDesc;       // 指令描述
 };
 
+/**
+ * @brief 索引分段
+ *
+ * 容量固定、预先分配，条目只追加不修改。写入线程先写条目再以release方式发布数量，
+ * 读者只访问已发布数量之前的条目，无需加锁。写满后封存：建立时间戳查找树、
+ * 指令类型倒排表和序列号有序表，此后整个分段只读。
+ */
+class IndexSegment {
+public:
+    static constexpr int CAPACITY_SHIFT = 14;
+    static constexpr int CAPACITY = 1 << CAPACITY_SHIFT;    // 每段条目数
+    static constexpr int CAPACITY_MASK = CAPACITY - 1;
+
+    explicit IndexSegment(int baseIndex);
+
+    IndexSegment(const IndexSegment&) = delete;
+    IndexSegment& operator=(const IndexSegment&) = delete;
+
+    int baseIndex() const { return m_baseIndex; }
+    int publishedCount() const { return m_published.load(std::memory_order_acquire); }
+    bool isSealed() const { return m_sealed.load(std::memory_order_acquire); }
+
+    const PacketIndexEntry& at(int local) const { return m_entryData[local]; }
+    uint64_t timestampAt(int local) const { return m_timestampData[local]; }
+
+    /**
+     * @brief 在前count个条目中查找首个时间戳不小于/大于timestamp的位置
+     */
+    int lowerBound(uint64_t timestamp, int count) const;
+    int upperBound(uint64_t timestamp, int count) const;
+
+    /**
+     * @brief 已封存分段中指定指令类型的条目位置（升序）
+     */
+    const uint16_t* commandTypeBegin(uint8_t commandType) const { return m_typeOrder.data() + m_typeOffsets[commandType]; }
+    const uint16_t* commandTypeEnd(uint8_t commandType) const { return m_typeOrder.data() + m_typeOffsets[commandType + 1]; }
+
+    /**
+     * @brief 已封存分段中序列号在[sequenceStart, sequenceEnd]内的条目位置（升序）
+     */
+    QVector<int> sequenceRange(uint32_t sequenceStart, uint32_t sequenceEnd) const;
+
+private:
+    friend class IndexGenerator;
+
+    // 以下仅由持有写锁的写入线程调用
+    void append(const PacketIndexEntry& entry);
+    void seal();
+
+    const int m_baseIndex;                      ///< 首条目的全局位置
+    std::vector<PacketIndexEntry> m_entries;    ///< 条目存储，容量固定不重新分配
+    TimestampColumn m_timestamps;               ///< 时间戳列，封存时建立查找树
+    const PacketIndexEntry* m_entryData;        ///< 条目存储首地址
+    const uint64_t* m_timestampData;            ///< 时间戳列首地址
+    std::atomic<int> m_published{ 0 };          ///< 已发布的条目数
+    std::atomic<bool> m_sealed{ false };        ///< 是否已封存
+
+    // 封存时建立的二级索引
+    std::vector<uint16_t> m_typeOrder;              ///< 按指令类型分组的条目位置
+    std::array<uint32_t, 257> m_typeOffsets{};      ///< 各指令类型在m_typeOrder中的起始位置
+    std::vector<uint64_t> m_sequenceKeys;           ///< (序列号 << 16 | 位置) 升序
+};
+
+/**
+ * @brief 索引只读快照
+ *
+ * 持有获取时刻的分段列表和条目数，复制代价为一次引用计数。
+ * 快照之后追加的条目不可见，清空索引也不影响已获取的快照。
+ */
+class IndexSnapshot {
+public:
+    using SegmentList = std::vector<std::shared_ptr<IndexSegment>>;
+
+    IndexSnapshot() = default;
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    const PacketIndexEntry& at(int index) const
+    {
+        return (*m_segments)[index >> IndexSegment::CAPACITY_SHIFT]->at(index & IndexSegment::CAPACITY_MASK);
+    }
+
+    /**
+     * @brief 首个时间戳不小于timestamp的位置，不存在时返回size()
+     */
+    int lowerBound(uint64_t timestamp) const;
+
+    /**
+     * @brief 首个时间戳大于timestamp的位置，不存在时返回size()
+     */
+    int upperBound(uint64_t timestamp) const;
+
+    /**
+     * @brief 时间戳最接近timestamp的位置，快照为空时返回-1
+     */
+    int closest(uint64_t timestamp) const;
+
+    /**
+     * @brief 复制一段条目
+     * @param pos 起始位置
+     * @param length 长度，-1表示到末尾
+     */
+    QVector<PacketIndexEntry> mid(int pos, int length = -1) const;
+
+private:
+    friend class IndexGenerator;
+
+    IndexSnapshot(std::shared_ptr<const SegmentList> segments, int size)
+        : m_segments(std::move(segments)), m_size(size) {
+    }
+
+    int segmentCount() const { return m_size == 0 ? 0 : ((m_size - 1) >> IndexSegment::CAPACITY_SHIFT) + 1; }
+    const IndexSegment& segment(int i) const { return *(*m_segments)[i]; }
+    int segmentSize(int i) const { return std::min(IndexSegment::CAPACITY, m_size - (i << IndexSegment::CAPACITY_SHIFT)); }
+
+    /**
+     * @brief 二分查找首个末条目时间戳满足条件的分段
+     */
+    int findSegment(uint64_t timestamp, bool upper) const;
+
+    std::shared_ptr<const SegmentList> m_segments;
+    int m_size = 0;
+};
+
 /**
  * @brief 数据索引生成与查询服务
  */
@@ -48,7 +183,7 @@ public:
     /**
      * @brief 打开索引文件
      * @param path 索引文件路径
-     * @return 是否成功
+     * @return 是否成功；已打开时直接返回true，不论路径是否相同，需要切换时先close()
      */
     bool open(const QString& path);
 
@@ -58,6 +193,12 @@ public:
      */
     bool isOpen() const { return m_isOpen; }
 
+    /**
+     * @brief 当前打开的索引文件路径
+     * @return 路径，未打开时为空
+     */
+    QString openPath() const { return m_isOpen ? m_openPath : QString(); }
+
     /**
      * @brief 关闭索引文件
      */
@@ -82,6 +223,13 @@ public:
     int addPacketIndexBatch(const std::vector<DataPacket>& packets,
         uint64_t startFileOffset);
 
+    /**
+     * @brief 批量追加已解析好的索引条目
+     * @param entries 按文件偏移有序的索引条目（commandDesc由本方法填充）
+     * @return 添加成功的条目数量
+     */
+    int addIndexEntries(const QVector<PacketIndexEntry>& entries);
+
     /**
      * @brief 保存索引到磁盘
      * @param forceSave 是否强制保存（忽略缓存条件）
@@ -98,10 +246,16 @@ public:
 
     /**
      * @brief 获取所有索引条目
-     * @return 所有索引条目的列表
+     * @return 所有索引条目的列表（复制全部条目，大索引请使用getSnapshot）
      */
     QVector<PacketIndexEntry> getAllIndexEntries();
 
+    /**
+     * @brief 获取索引只读快照，不加写锁、不复制条目
+     * @return 当前已发布条目的快照
+     */
+    IndexSnapshot getSnapshot() const;
+
     /**
      * @brief 获取总索引条目数
      * @return 条目数量
@@ -193,12 +347,57 @@ private:
     IndexGenerator& operator=(const IndexGenerator&) = delete;
 
     /**
-     * @brief 二分查找指定时间戳
-     * @param timestamp 目标时间戳
-     * @param lowerBound 是否查找下边界
-     * @return 找到的索引位置，-1表示未找到
+     * @brief 编译后的字段谓词
+     */
+    struct FieldPredicate {
+        enum Field { BatchId, PacketIndex, Size, CommandType, Sequence, FileName };
+        enum Op { Equal, Less, LessEqual, Greater, GreaterEqual, Contains };
+        Field field;
+        Op op;
+        uint64_t value = 0;     ///< 数值字段的比较值
+        QString text;           ///< 文件名匹配文本
+    };
+
+    /**
+     * @brief 编译后的查询条件
+     */
+    struct CompiledQuery {
+        int commandType = -1;               ///< 指令类型等值条件，-1表示无
+        uint32_t sequenceStart = 0;         ///< 序列号下限
+        uint32_t sequenceEnd = UINT32_MAX;  ///< 序列号上限
+        bool empty = false;                 ///< 条件互相矛盾，结果必为空
+        QVector<FieldPredicate> predicates; ///< 其余逐条检查的谓词
+
+        bool hasSequenceRange() const { return sequenceStart > 0 || sequenceEnd < UINT32_MAX; }
+    };
+
+    /**
+     * @brief 将查询条件编译为类型化谓词，字符串只解析一次
+     * @param query 查询条件
+     * @return 编译结果
+     */
+    static CompiledQuery compileQuery(const IndexQuery& query);
+
+    /**
+     * @brief 检查条目是否满足编译后的谓词
+     */
+    static bool matchesPredicates(const PacketIndexEntry& entry, const QVector<FieldPredicate>& predicates);
+
+    /**
+     * @brief 追加条目并更新所有索引（调用者需持有m_mutex）
+     * @return 条目位置
+     */
+    int appendEntryLocked(const PacketIndexEntry& entry);
+
+    /**
+     * @brief 发布新的分段列表（调用者需持有m_mutex）
+     */
+    void publishSegmentsLocked(std::shared_ptr<const IndexSnapshot::SegmentList> segments);
+
+    /**
+     * @brief 清空内存索引（调用者需持有m_mutex）
      */
-    int binarySearchTimestamp(uint64_t timestamp, bool lowerBound) const;
+    void resetIndexLocked();
 
     /**
      * @brief 获取指令类型的描述
@@ -207,13 +406,13 @@ private:
      */
     QString getCommandDescription(uint8_t commandType);
 
-    // 快速内存映射查找
-    QMap<uint64_t, int> m_timestampToIndex;     // 时间戳到索引的映射
+    // 分段存储：写入由m_mutex串行化，读者通过原子发布的分段列表无锁访问
+    std::atomic<std::shared_ptr<const IndexSnapshot::SegmentList>> m_segments;
+    std::shared_ptr<IndexSegment> m_openSegment;    // 正在追加的分段（仅写入线程访问）
 
-    QVector<PacketIndexEntry> m_indexEntries;   // 所有索引条目
     QFile m_indexFile;
     QTextStream m_textStream;
-    QMutex m_mutex;
+    QMutex m_mutex;                     ///< 写锁，串行化追加、清空和文件操作
     bool m_isOpen;
     uint64_t m_entryCount;
     uint64_t m_lastSavedCount;          ///< 最后一次保存时的条目数
@@ -225,5 +424,6 @@ private:
     QString m_sessionId;                ///< 会话标识符
     QString m_basePath;                 ///< 索引文件基本路径
     QString m_indexFileName;            ///< 索引文件名称
+    QString m_openPath;                 ///< open()打开的索引文件路径
     bool m_persistentMode;              ///< 持久化模式
 };
\ No newline at end of file
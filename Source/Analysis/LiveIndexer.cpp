@@ -0,0 +1,352 @@
+﻿// Source/Analysis/LiveIndexer.cpp
+#include "LiveIndexer.h"
+#include "Logger.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <algorithm>
+
+// #define LIDX_DBG
+
+LiveIndexer::LiveIndexer(QObject* parent)
+    : QObject(parent)
+{
+    m_pendingEntries.reserve(COMMIT_BATCH_SIZE);
+    m_workerThread = std::thread(&LiveIndexer::workerThreadFunction, this);
+}
+
+LiveIndexer::~LiveIndexer()
+{
+    m_running = false;
+    m_queueCondition.notify_all();
+
+    if (m_workerThread.joinable()) {
+        m_workerThread.join();
+    }
+}
+
+void LiveIndexer::onCaptureStarted(const QString& savePath)
+{
+    Task task;
+    task.type = Task::CaptureStarted;
+    task.path = savePath;
+    enqueue(std::move(task));
+}
+
+void LiveIndexer::onFileOpened(const QString& filePath)
+{
+    Task task;
+    task.type = Task::FileOpened;
+    task.path = filePath;
+    enqueue(std::move(task));
+}
+
+void LiveIndexer::onDataWritten(const QString& filePath, uint64_t fileOffset, const QByteArray& data)
+{
+    Task task;
+    task.type = Task::DataWritten;
+    task.path = filePath;
+    task.fileOffset = fileOffset;
+    task.length = static_cast<uint64_t>(data.size());
+    task.timestamp = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()) * 1000000;
+    task.data = data;
+    enqueue(std::move(task));
+}
+
+void LiveIndexer::onFileClosed(const QString& filePath, uint64_t fileSize)
+{
+    Task task;
+    task.type = Task::FileClosed;
+    task.path = filePath;
+    task.fileOffset = fileSize;
+    enqueue(std::move(task));
+}
+
+void LiveIndexer::onCaptureStopped()
+{
+    Task task;
+    task.type = Task::CaptureStopped;
+    enqueue(std::move(task));
+}
+
+bool LiveIndexer::isBusy() const
+{
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return !m_taskQueue.empty() || m_processing.load();
+}
+
+void LiveIndexer::enqueue(Task&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+
+        if (task.type == Task::DataWritten) {
+            // 索引跟不上写入时不再引用写入缓冲，只记录范围，之后从文件补读
+            if (m_queuedBytes + static_cast<size_t>(task.data.size()) > MAX_QUEUED_BYTES) {
+                if (!m_dropping) {
+                    m_dropping = true;
+                    LOG_WARN(LocalQTCompat::fromLocal8Bit("实时索引积压超过 %1 MB，改为从文件补读")
+                        .arg(MAX_QUEUED_BYTES / (1024 * 1024)));
+                }
+                task.data = QByteArray();
+
+                // 与队尾相邻的范围合并，积压期间队列长度不随写入次数增长
+                if (!m_taskQueue.empty()) {
+                    Task& last = m_taskQueue.back();
+                    if (last.type == Task::DataWritten && last.data.isEmpty() && last.path == task.path
+                        && last.fileOffset + last.length == task.fileOffset) {
+                        last.length += task.length;
+                        last.timestamp = task.timestamp;
+                        return;
+                    }
+                }
+            }
+            else {
+                m_dropping = false;
+                m_queuedBytes += static_cast<size_t>(task.data.size());
+            }
+        }
+
+        m_taskQueue.push(std::move(task));
+    }
+    m_queueCondition.notify_one();
+}
+
+void LiveIndexer::workerThreadFunction()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCondition.wait(lock, [this]() {
+                return !m_running || !m_taskQueue.empty();
+                });
+
+            // 退出前处理完剩余任务
+            if (m_taskQueue.empty()) {
+                break;
+            }
+
+            task = std::move(m_taskQueue.front());
+            m_taskQueue.pop();
+            m_queuedBytes -= static_cast<size_t>(task.data.size());
+            m_processing = true;
+        }
+
+        try {
+            processTask(task);
+        }
+        catch (const std::exception& e) {
+            LOG_ERROR(LocalQTCompat::fromLocal8Bit("实时索引处理异常: %1").arg(e.what()));
+        }
+
+        m_processing = false;
+    }
+}
+
+void LiveIndexer::processTask(const Task& task)
+{
+    switch (task.type) {
+    case Task::CaptureStarted:
+        m_savePath = task.path;
+        m_indexReady = false;
+        m_lastTimestamp = 0;
+        m_indexedCount = 0;
+        break;
+
+    case Task::FileOpened:
+        m_currentFile = task.path;
+        m_filePacketCount = 0;
+        m_scanner.reset(0);
+        m_backlogEnd = 0;
+        m_backlogFile.close();
+        m_indexReady = ensureIndexOpen(task.path);
+        break;
+
+    case Task::DataWritten: {
+        if (!m_indexReady || task.path != m_currentFile) {
+            break;
+        }
+
+        m_currentTimestamp = task.timestamp;
+
+        // 数据未保留，或之前还有未补读完的范围：记为积压，从文件中读取
+        if (task.data.isEmpty() || m_backlogEnd > m_scanner.position()) {
+            if (!task.data.isEmpty()) {
+                // 先补读到本次数据之前，补齐后本次数据直接使用，不再读文件
+                m_backlogEnd = std::max(m_backlogEnd, task.fileOffset);
+                catchUpFromFile();
+            }
+            if (task.data.isEmpty() || m_scanner.position() != task.fileOffset) {
+                m_backlogEnd = std::max(m_backlogEnd, task.fileOffset + task.length);
+                catchUpFromFile();
+                if (m_pendingEntries.size() >= COMMIT_BATCH_SIZE) {
+                    commitEntries();
+                }
+                break;
+            }
+        }
+
+        // 保存线程按顺序写入，偏移必须连续
+        if (task.fileOffset != m_scanner.position()) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("实时索引偏移不连续: 期望%1，实际%2，重新同步")
+                .arg(m_scanner.position()).arg(task.fileOffset));
+            m_scanner.reset(task.fileOffset);
+        }
+
+        m_scanner.feed(reinterpret_cast<const uint8_t*>(task.data.constData()),
+            static_cast<size_t>(task.data.size()),
+            [this](const PacketFrameInfo& frame) { appendEntry(frame); });
+
+        if (m_pendingEntries.size() >= COMMIT_BATCH_SIZE) {
+            commitEntries();
+        }
+        break;
+    }
+
+    case Task::FileClosed:
+        if (m_indexReady && task.path == m_currentFile) {
+            // 文件已关闭，写入的数据都在文件中，补读剩余的积压
+            if (m_backlogEnd > m_scanner.position()) {
+                m_backlogEnd = std::max(m_backlogEnd, task.fileOffset);
+                catchUpFromFile();
+            }
+            m_backlogFile.close();
+            finishCurrentFile();
+            commitEntries();
+
+#ifdef LIDX_DBG
+            LOG_INFO(LocalQTCompat::fromLocal8Bit("实时索引文件完成: %1，大小%2字节，%3个数据包")
+                .arg(task.path).arg(task.fileOffset).arg(m_filePacketCount));
+#endif // LIDX_DBG
+            emit signal_LIDX_fileIndexed(task.path, m_filePacketCount);
+        }
+        m_currentFile.clear();
+        break;
+
+    case Task::CaptureStopped:
+        commitEntries();
+        if (m_indexReady) {
+            IndexGenerator::getInstance().saveIndex(true);
+        }
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("实时索引完成，共 %1 个数据包").arg(m_indexedCount.load()));
+        emit signal_LIDX_captureIndexed(m_indexedCount.load());
+        break;
+    }
+}
+
+void LiveIndexer::catchUpFromFile()
+{
+    if (!m_backlogFile.isOpen() || m_backlogFile.fileName() != m_currentFile) {
+        m_backlogFile.close();
+        m_backlogFile.setFileName(m_currentFile);
+        if (!m_backlogFile.open(QIODevice::ReadOnly)) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("实时索引无法打开文件补读: %1").arg(m_currentFile));
+            return;
+        }
+    }
+
+    // 写入器可能还没把数据落盘，读到多少处理多少，其余留到下一个任务或文件关闭时
+    while (m_scanner.position() < m_backlogEnd) {
+        const qint64 want = static_cast<qint64>(std::min<uint64_t>(m_backlogEnd - m_scanner.position(),
+            static_cast<uint64_t>(CATCH_UP_CHUNK_BYTES)));
+        if (!m_backlogFile.seek(static_cast<qint64>(m_scanner.position()))) {
+            break;
+        }
+        const QByteArray chunk = m_backlogFile.read(want);
+        if (chunk.isEmpty()) {
+            break;
+        }
+        m_scanner.feed(reinterpret_cast<const uint8_t*>(chunk.constData()),
+            static_cast<size_t>(chunk.size()),
+            [this](const PacketFrameInfo& frame) { appendEntry(frame); });
+    }
+}
+
+void LiveIndexer::finishCurrentFile()
+{
+    // 文件末尾未写完的帧无效，按顺序扫描规则从其后一字节继续查找
+    PacketFrameInfo pending;
+    while (m_scanner.pendingFrame(pending)) {
+        uint64_t rescanOffset = pending.offset + 1;
+        m_scanner.reset(rescanOffset);
+
+        QFile file(m_currentFile);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(static_cast<qint64>(rescanOffset))) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("实时索引无法重新扫描文件尾部: %1").arg(m_currentFile));
+            break;
+        }
+
+        QByteArray tail = file.readAll();
+        file.close();
+
+        m_scanner.feed(reinterpret_cast<const uint8_t*>(tail.constData()),
+            static_cast<size_t>(tail.size()),
+            [this](const PacketFrameInfo& frame) { appendEntry(frame); });
+    }
+}
+
+void LiveIndexer::appendEntry(const PacketFrameInfo& frame)
+{
+    // 同一次写入中的多个包使用递增时间戳，保证索引时间戳严格单调
+    uint64_t timestamp = std::max(m_currentTimestamp, m_lastTimestamp + 1);
+    m_lastTimestamp = timestamp;
+
+    PacketIndexEntry entry;
+    entry.timestamp = timestamp;
+    entry.fileOffset = frame.offset;
+    entry.size = static_cast<uint32_t>(frame.totalSize());
+    entry.fileName = m_currentFile;
+    entry.batchId = frame.commandType;
+    entry.packetIndex = static_cast<uint32_t>(m_filePacketCount);
+    entry.commandType = frame.commandType;
+    entry.sequence = frame.sequence;
+    entry.isValidHeader = true;
+
+    m_pendingEntries.append(entry);
+    m_filePacketCount++;
+}
+
+void LiveIndexer::commitEntries()
+{
+    if (m_pendingEntries.isEmpty()) {
+        return;
+    }
+
+    int added = IndexGenerator::getInstance().addIndexEntries(m_pendingEntries);
+    m_indexedCount += added;
+    m_pendingEntries.clear();
+}
+
+bool LiveIndexer::ensureIndexOpen(const QString& filePath)
+{
+    IndexGenerator& indexGenerator = IndexGenerator::getInstance();
+
+    // 同一次采集的分割文件共用一个索引，会话ID取首个文件名
+    if (m_indexReady && indexGenerator.isOpen() && indexGenerator.openPath() == m_indexPath) {
+        return true;
+    }
+
+    QString basePath = m_savePath.isEmpty() ? QFileInfo(filePath).absolutePath() : m_savePath;
+    QString sessionId = QFileInfo(filePath).completeBaseName();
+    QString indexPath = QString("%1/%2.idx").arg(basePath).arg(sessionId);
+
+    // 上次采集或回放打开的索引仍在时open()会直接返回，新条目将追加到旧索引；
+    // 先按旧的路径保存并关闭，再切换路径
+    if (indexGenerator.isOpen() && indexGenerator.openPath() != indexPath) {
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("实时索引关闭之前的索引: %1").arg(indexGenerator.openPath()));
+        indexGenerator.close();
+    }
+
+    indexGenerator.setBasePath(basePath);
+    indexGenerator.setSessionId(sessionId);
+
+    if (!indexGenerator.open(indexPath)) {
+        LOG_ERROR(LocalQTCompat::fromLocal8Bit("实时索引无法打开索引文件: %1").arg(indexPath));
+        return false;
+    }
+
+    m_indexPath = indexPath;
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("实时索引已启动: %1").arg(indexPath));
+    return true;
+}
@@ -0,0 +1,138 @@
+﻿// Source/Analysis/LiveIndexer.h
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QFile>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <queue>
+#include "FileManager.h"
+#include "IndexGenerator.h"
+#include "PacketFraming.h"
+
+/**
+ * @brief 采集过程中的实时索引器
+ *
+ * 作为FileManager的写入观察者，在独立线程中对刚写入文件的数据做流式帧识别，
+ * 以最终文件偏移生成索引条目并追加到IndexGenerator，停止采集时索引即可使用。
+ *
+ * IndexGenerator是全局单例：采集的第一个文件打开时，之前打开的索引（例如界面正在浏览的）
+ * 会被保存并关闭，换成本次采集的索引。因此实时索引默认不启用，由FileOperationModel::setLiveIndexingEnabled开启。
+ *
+ * 写入任务引用保存线程的数据缓冲。排队的数据超过MAX_QUEUED_BYTES时不再保留数据，只记录写入范围，
+ * 相邻的范围合并为一个任务；工作线程之后从文件中补读这些范围，内存占用有上限，索引结果不变。
+ */
+class LiveIndexer : public QObject, public IWriteObserver {
+    Q_OBJECT
+
+public:
+    explicit LiveIndexer(QObject* parent = nullptr);
+    ~LiveIndexer() override;
+
+    // IWriteObserver接口，均在保存线程中调用，仅入队不做解析
+    void onCaptureStarted(const QString& savePath) override;
+    void onFileOpened(const QString& filePath) override;
+    void onDataWritten(const QString& filePath, uint64_t fileOffset, const QByteArray& data) override;
+    void onFileClosed(const QString& filePath, uint64_t fileSize) override;
+    void onCaptureStopped() override;
+
+    /**
+     * @brief 获取本次采集已索引的数据包数量
+     */
+    int getIndexedCount() const { return m_indexedCount.load(); }
+
+    /**
+     * @brief 是否还有待处理的数据
+     */
+    bool isBusy() const;
+
+signals:
+    /**
+     * @brief 单个采集文件索引完成信号
+     * @param filePath 文件路径
+     * @param packetCount 该文件的数据包数量
+     */
+    void signal_LIDX_fileIndexed(const QString& filePath, int packetCount);
+
+    /**
+     * @brief 采集索引完成信号，此时索引已保存可直接定位
+     * @param totalPackets 本次采集的数据包总数
+     */
+    void signal_LIDX_captureIndexed(int totalPackets);
+
+private:
+    /**
+     * @brief 索引任务
+     */
+    struct Task {
+        enum Type { CaptureStarted, FileOpened, DataWritten, FileClosed, CaptureStopped };
+        Type type;
+        QString path;            ///< 保存目录或文件路径
+        uint64_t fileOffset = 0; ///< 数据起始偏移
+        uint64_t length = 0;     ///< 写入的字节数
+        uint64_t timestamp = 0;  ///< 写入时间(ns)
+        QByteArray data;         ///< 写入的数据（隐式共享，不复制），积压时为空，需从文件补读
+    };
+
+    void enqueue(Task&& task);
+    void workerThreadFunction();
+    void processTask(const Task& task);
+
+    /**
+     * @brief 文件结束时处理未写完的帧：从其后一字节重新扫描文件尾部
+     */
+    void finishCurrentFile();
+
+    /**
+     * @brief 从当前文件补读积压的范围，读到文件中已有的部分为止
+     */
+    void catchUpFromFile();
+
+    /**
+     * @brief 将扫描到的帧转换为索引条目
+     */
+    void appendEntry(const PacketFrameInfo& frame);
+
+    /**
+     * @brief 把缓冲的条目提交到IndexGenerator
+     */
+    void commitEntries();
+
+    /**
+     * @brief 确保IndexGenerator已为本次采集打开
+     */
+    bool ensureIndexOpen(const QString& filePath);
+
+    static constexpr int COMMIT_BATCH_SIZE = 1000;      // 每批提交条目数
+    static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;   // 排队任务最多保留的数据字节数
+    static constexpr qint64 CATCH_UP_CHUNK_BYTES = 4 * 1024 * 1024; // 补读时每次读取的字节数
+
+    std::thread m_workerThread;
+    std::queue<Task> m_taskQueue;
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::atomic<bool> m_running{ true };
+    std::atomic<bool> m_processing{ false };
+    size_t m_queuedBytes = 0;           // 排队任务保留的数据字节数（m_queueMutex保护）
+    bool m_dropping = false;            // 是否正在只记录范围（m_queueMutex保护）
+
+    // 以下成员只在工作线程中访问
+    StreamFrameScanner m_scanner;
+    QString m_currentFile;
+    QString m_savePath;
+    QString m_indexPath;
+    uint64_t m_backlogEnd = 0;          // 需要从文件补读到的位置，不大于扫描位置时没有积压
+    QFile m_backlogFile;                // 补读用的文件句柄
+    uint64_t m_currentTimestamp = 0;
+    uint64_t m_lastTimestamp = 0;
+    int m_filePacketCount = 0;
+    bool m_indexReady = false;
+    QVector<PacketIndexEntry> m_pendingEntries;
+
+    std::atomic<int> m_indexedCount{ 0 };
+};
@@ -0,0 +1,335 @@
+﻿// Source/Analysis/LiveWaveformRing.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <emmintrin.h>
+#include "ChannelDeinterleave.h"
+#include "WaveformPyramid.h"
+
+/**
+ * @brief 实时波形的抽取环形缓冲（单生产者/单消费者，无锁）
+ *
+ * 生产者是采集处理线程：push()直接接收USB数据流，按样本交错格式（见ChannelDeinterleave）
+ * 每2^shift个样本抽取为一项，记录4个通道在这段样本内的最低电平、最高电平和最后电平，
+ * 抽取时不会丢失窄脉冲。每项16位：位0-3最低电平，位4-7最高电平，位8-11最后电平，第c位对应通道c。
+ *
+ * 消费者是界面线程：按固定刷新率读取最新的一段，查找触发边沿并生成折线。
+ * 写满后覆盖最旧的项，生产者从不等待；消费者复制完成后检查写位置，
+ * 复制期间被覆盖的数据整帧丢弃。抽取倍数变化或重新启用时开始新的一段，
+ * 段起点之前的项与当前抽取倍数不同，不再读取。
+ * 纯C++实现，不依赖Qt，不读写磁盘。
+ */
+class LiveWaveformRing {
+public:
+    static constexpr int CAPACITY_SHIFT = 20;                       ///< 容量1M项（2MB）
+    static constexpr uint64_t CAPACITY = uint64_t(1) << CAPACITY_SHIFT;
+    static constexpr int MAX_DECIMATION_SHIFT = 24;                 ///< 最大抽取倍数2^24
+    static constexpr int STREAM_HEADER_BYTES = 20;                  ///< 数据流开头的头部长度，与采集文件的波形数据起点一致
+
+    /**
+     * @brief 触发边沿
+     */
+    enum class TriggerEdge {
+        Rising,     ///< 上升沿
+        Falling,    ///< 下降沿
+        Either      ///< 任意沿
+    };
+
+    LiveWaveformRing()
+        : m_entries(CAPACITY)
+    {
+    }
+
+    LiveWaveformRing(const LiveWaveformRing&) = delete;
+    LiveWaveformRing& operator=(const LiveWaveformRing&) = delete;
+
+    static int minLevels(uint16_t entry) { return entry & 0xF; }
+    static int maxLevels(uint16_t entry) { return (entry >> 4) & 0xF; }
+    static int lastLevels(uint16_t entry) { return (entry >> 8) & 0xF; }
+
+    // ---------------- 消费者（界面线程）----------------
+
+    /**
+     * @brief 启用或停用抽取，停用时push()只统计字节数
+     */
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 设置抽取倍数2^shift，生产者在下一次push时开始新的一段
+     */
+    void setDecimationShift(int shift)
+    {
+        shift = shift < 0 ? 0 : (shift > MAX_DECIMATION_SHIFT ? MAX_DECIMATION_SHIFT : shift);
+        m_requestedShift.store(shift, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 已写入的项数（下一项的序号）
+     */
+    uint64_t writeIndex() const { return m_writeIndex.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 当前段的起点和抽取倍数
+     * @param start 输出段第一项的序号
+     * @param shift 输出抽取倍数2^shift
+     */
+    void segment(uint64_t& start, int& shift) const
+    {
+        const uint64_t packed = m_segment.load(std::memory_order_acquire);
+        start = packed >> 8;
+        shift = static_cast<int>(packed & 0xFF);
+    }
+
+    /**
+     * @brief 复制[first, first + count)的项
+     * @return 复制期间这些项没有被覆盖时为true
+     */
+    bool copy(uint64_t first, size_t count, uint16_t* out) const
+    {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = m_entries[static_cast<size_t>((first + i) & (CAPACITY - 1))];
+        }
+
+        // 复制之后再读写位置：此时仍在容量以内的项在复制时也没有被覆盖
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t end = m_writeIndex.load(std::memory_order_relaxed);
+        return end <= CAPACITY || first >= end - CAPACITY;
+    }
+
+    /**
+     * @brief 查找触发边沿，从后向前
+     * @param entries 抽取项
+     * @param first 查找范围第一项（边沿在first - 1与first之间时也算）
+     * @param last 查找范围最后一项（含）
+     * @param channel 触发通道
+     * @param edge 触发边沿
+     * @return 最后一个边沿所在项，没有时为-1
+     */
+    static int64_t findTrigger(const uint16_t* entries, size_t first, size_t last, int channel, TriggerEdge edge)
+    {
+        if (first == 0) {
+            first = 1;
+        }
+        // 前一项结束时为低、本项内出现过高，本项内一定有上升沿；下降沿同理
+        for (size_t i = last + 1; i-- > first;) {
+            const int before = (lastLevels(entries[i - 1]) >> channel) & 1;
+            const bool rising = before == 0 && ((maxLevels(entries[i]) >> channel) & 1) != 0;
+            const bool falling = before == 1 && ((minLevels(entries[i]) >> channel) & 1) == 0;
+            if ((edge != TriggerEdge::Falling && rising) || (edge != TriggerEdge::Rising && falling)) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief 生成一个通道的阶梯折线，第i项占x区间[i, i + 1)
+     *
+     * 与WaveformPyramid摘要层级相同：电平单一的项合并为水平线，电平混合的项画成贯穿高低电平的竖线。
+     */
+    static void trace(const uint16_t* entries, size_t count, int channel, std::vector<WaveformTracePoint>& points)
+    {
+        points.clear();
+        if (count == 0) {
+            return;
+        }
+
+        uint8_t current = static_cast<uint8_t>((minLevels(entries[0]) >> channel) & 1);
+        points.push_back({ 0.0, current });
+
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t low = static_cast<uint8_t>((minLevels(entries[i]) >> channel) & 1);
+            const uint8_t high = static_cast<uint8_t>((maxLevels(entries[i]) >> channel) & 1);
+            const uint8_t last = static_cast<uint8_t>((lastLevels(entries[i]) >> channel) & 1);
+            const double x = static_cast<double>(i);
+
+            if (low == high) {
+                if (low != current) {
+                    points.push_back({ x, current });
+                    points.push_back({ x, low });
+                    current = low;
+                }
+            }
+            else {
+                points.push_back({ x, current });
+                points.push_back({ x, static_cast<uint8_t>(1 - current) });
+                if (last == current) {
+                    points.push_back({ x, current });
+                }
+                current = last;
+            }
+        }
+
+        points.push_back({ static_cast<double>(count), current });
+    }
+
+    // ---------------- 生产者（采集处理线程）----------------
+
+    /**
+     * @brief 新的采集开始，数据流从头部重新计算（采集线程启动前调用）
+     */
+    void resetStream()
+    {
+        m_streamBytes = 0;
+        m_active = false;
+    }
+
+    /**
+     * @brief 接收一段数据流
+     * @param data 数据
+     * @param size 字节数，可以不是整样本，跨包的半个样本会拼接
+     */
+    void push(const uint8_t* data, size_t size)
+    {
+        uint64_t pos = m_streamBytes;
+        m_streamBytes += size;
+        if (!m_enabled.load(std::memory_order_relaxed)) {
+            m_active = false;
+            return;
+        }
+
+        const int shift = m_requestedShift.load(std::memory_order_relaxed);
+        if (!m_active || shift != m_shift) {
+            beginSegment(shift);
+        }
+
+        size_t offset = 0;
+        if (pos < STREAM_HEADER_BYTES) {
+            const size_t skip = static_cast<size_t>(std::min<uint64_t>(STREAM_HEADER_BYTES - pos, size));
+            offset += skip;
+            pos += skip;
+        }
+        if (offset == size) {
+            return;
+        }
+
+        // 本包从样本中间开始：与上一包末尾拼接，刚开始新的一段时跳到下一个样本
+        const size_t sampleBytes = ChannelDeinterleave::CHANNEL_COUNT;
+        const size_t phase = static_cast<size_t>((pos - STREAM_HEADER_BYTES) % sampleBytes);
+        if (phase != 0) {
+            const size_t take = std::min(sampleBytes - phase, size - offset);
+            if (m_pendingCount == phase) {
+                std::memcpy(m_pending + m_pendingCount, data + offset, take);
+                m_pendingCount += take;
+            }
+            offset += take;
+            if (m_pendingCount == sampleBytes) {
+                addSamples(m_pending, 1);
+                m_pendingCount = 0;
+            }
+            if (offset == size) {
+                publish();
+                return;
+            }
+        }
+        m_pendingCount = 0;
+
+        const size_t samples = (size - offset) / sampleBytes;
+        addSamples(data + offset, samples);
+        offset += samples * sampleBytes;
+
+        m_pendingCount = size - offset;
+        std::memcpy(m_pending, data + offset, m_pendingCount);
+        publish();
+    }
+
+private:
+    /**
+     * @brief 开始新的一段，丢弃未完成的抽取组
+     */
+    void beginSegment(int shift)
+    {
+        m_shift = shift;
+        m_groupRemaining = uint64_t(1) << shift;
+        m_andMask = 0xFFFF;
+        m_orMask = 0;
+        m_lastLevels = 0;
+        m_pendingCount = 0;
+        m_active = true;
+        m_segment.store((m_localWrite << 8) | static_cast<uint64_t>(shift), std::memory_order_release);
+    }
+
+    /**
+     * @brief 4字节样本的电平位（非零为高）
+     */
+    static uint32_t sampleLevels(const uint8_t* sample)
+    {
+        uint32_t v;
+        std::memcpy(&v, sample, sizeof(v));
+        // 每字节非零时最高位为1，再把4个最高位收集到第28-31位
+        const uint32_t nonZero = ((((v & 0x7F7F7F7Fu) + 0x7F7F7F7Fu) | v) & 0x80808080u) >> 7;
+        return (nonZero * 0x10204080u) >> 28;
+    }
+
+    /**
+     * @brief 累加整样本，抽取组满时写出一项
+     *
+     * 电平按4位一组累加在16位掩码中（第s个样本占第4s-4s+3位），组结束时再把4组折叠成一组。
+     * 组内剩余不少于4个样本时用SSE2一次判断16字节。
+     */
+    void addSamples(const uint8_t* data, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        while (count > 0) {
+            uint32_t mask;
+            size_t taken;
+            if (count >= 4 && m_groupRemaining >= 4) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                mask = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))) & 0xFFFF;
+                m_lastLevels = mask >> 12;
+                taken = 4;
+            }
+            else {
+                m_lastLevels = sampleLevels(data);
+                mask = m_lastLevels * 0x1111u;
+                taken = 1;
+            }
+
+            m_andMask &= mask;
+            m_orMask |= mask;
+            data += taken * ChannelDeinterleave::CHANNEL_COUNT;
+            count -= taken;
+            m_groupRemaining -= taken;
+
+            if (m_groupRemaining == 0) {
+                const uint32_t low = m_andMask & (m_andMask >> 4) & (m_andMask >> 8) & (m_andMask >> 12) & 0xF;
+                const uint32_t high = (m_orMask | (m_orMask >> 4) | (m_orMask >> 8) | (m_orMask >> 12)) & 0xF;
+                m_entries[static_cast<size_t>(m_localWrite & (CAPACITY - 1))] =
+                    static_cast<uint16_t>(low | (high << 4) | (m_lastLevels << 8));
+                ++m_localWrite;
+
+                m_groupRemaining = uint64_t(1) << m_shift;
+                m_andMask = 0xFFFF;
+                m_orMask = 0;
+            }
+        }
+    }
+
+    void publish() { m_writeIndex.store(m_localWrite, std::memory_order_release); }
+
+    std::vector<uint16_t> m_entries;                ///< 抽取项
+
+    // 两个线程共享
+    std::atomic<uint64_t> m_writeIndex{ 0 };        ///< 已发布的项数
+    std::atomic<uint64_t> m_segment{ 0 };           ///< 当前段：起点 << 8 | 抽取倍数
+    std::atomic<int> m_requestedShift{ 0 };         ///< 消费者请求的抽取倍数
+    std::atomic<bool> m_enabled{ false };           ///< 是否启用
+
+    // 只由生产者访问
+    uint64_t m_localWrite = 0;                      ///< 已写入的项数（未发布）
+    uint64_t m_streamBytes = 0;                     ///< 本次采集已接收的字节数
+    uint64_t m_groupRemaining = 1;                  ///< 当前抽取组剩余样本数
+    uint32_t m_andMask = 0xFFFF;                    ///< 组内电平按位与
+    uint32_t m_orMask = 0;                          ///< 组内电平按位或
+    uint32_t m_lastLevels = 0;                      ///< 最近一个样本的电平
+    uint8_t m_pending[ChannelDeinterleave::CHANNEL_COUNT] = {}; ///< 跨包的半个样本
+    size_t m_pendingCount = 0;                      ///< m_pending中的字节数
+    int m_shift = 0;                                ///< 当前抽取倍数
+    bool m_active = false;                          ///< 当前段是否已开始
+};
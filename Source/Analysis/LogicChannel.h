@@ -0,0 +1,219 @@
+﻿// Source/Analysis/LogicChannel.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include "ChannelDeinterleave.h"
+
+/**
+ * @brief 位压缩的逻辑电平通道
+ *
+ * 每个样本只有高/低两种电平，按位存放（第i个样本为m_levels[i / 64]的第(i % 64)位）。
+ * 另外维护一份跳变位图：第i位为1表示样本i与样本i-1电平不同，相当于游程编码的游程边界；
+ * 跳变位图再按字汇总为一级摘要（摘要第w位表示跳变位图第w个字非零），
+ * 查找下一个跳变时可以成片跳过没有跳变的区域。
+ *
+ * 每个样本约占2位，百万级样本的通道只需几百KB；电平统计和跳变计数都是按字popcount。
+ * 纯C++实现，不依赖Qt；内容只在assign时整体重建，const接口可被多个线程同时调用。
+ */
+class LogicChannel {
+public:
+    /**
+     * @brief 清空所有样本
+     */
+    void clear()
+    {
+        m_levels.clear();
+        m_edges.clear();
+        m_edgeSummary.clear();
+        m_size = 0;
+    }
+
+    /**
+     * @brief 由字节平面构建，非零字节为高电平
+     * @param plane 字节平面
+     * @param count 样本数
+     */
+    void assignNonZero(const uint8_t* plane, size_t count)
+    {
+        m_size = count;
+        m_levels.assign(wordCount(count), 0);
+        if (count > 0) {
+            ChannelDeinterleave::packNonZero(plane, count, m_levels.data());
+        }
+        rebuildEdges();
+    }
+
+    /**
+     * @brief 由电平值构建，大于0.5为高电平
+     * @param values 电平值
+     * @param count 样本数
+     */
+    void assignLevels(const double* values, size_t count)
+    {
+        m_size = count;
+        m_levels.assign(wordCount(count), 0);
+        for (size_t i = 0; i < count; ++i) {
+            if (values[i] > 0.5) {
+                m_levels[i >> 6] |= uint64_t(1) << (i & 63);
+            }
+        }
+        rebuildEdges();
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * @brief 样本电平
+     * @param index 样本下标，应小于size()
+     * @return true为高电平
+     */
+    bool valueAt(size_t index) const
+    {
+        return ((m_levels[index >> 6] >> (index & 63)) & 1) != 0;
+    }
+
+    /**
+     * @brief 下一个跳变的位置
+     * @param index 起始样本下标
+     * @return 首个大于index且电平与前一样本不同的下标，没有时返回size()
+     */
+    size_t nextTransition(size_t index) const
+    {
+        size_t pos = index + 1;
+        if (pos >= m_size) {
+            return m_size;
+        }
+
+        // 当前字内剩余的跳变
+        size_t word = pos >> 6;
+        uint64_t bits = m_edges[word] & (~uint64_t(0) << (pos & 63));
+        if (bits != 0) {
+            return (word << 6) + static_cast<size_t>(std::countr_zero(bits));
+        }
+
+        // 用摘要跳过没有跳变的字
+        size_t next = word + 1;
+        size_t summaryWord = next >> 6;
+        if (summaryWord >= m_edgeSummary.size()) {
+            return m_size;
+        }
+        uint64_t summary = (next & 63) != 0 ? m_edgeSummary[summaryWord] & (~uint64_t(0) << (next & 63))
+            : m_edgeSummary[summaryWord];
+
+        while (summary == 0) {
+            if (++summaryWord >= m_edgeSummary.size()) {
+                return m_size;
+            }
+            summary = m_edgeSummary[summaryWord];
+        }
+
+        word = (summaryWord << 6) + static_cast<size_t>(std::countr_zero(summary));
+        return (word << 6) + static_cast<size_t>(std::countr_zero(m_edges[word]));
+    }
+
+    /**
+     * @brief 区间[begin, end)内高电平样本数
+     */
+    size_t countHigh(size_t begin, size_t end) const
+    {
+        return countBits(m_levels, begin, std::min(end, m_size));
+    }
+
+    /**
+     * @brief 区间[begin, end)内相邻样本之间的跳变次数
+     */
+    size_t countTransitions(size_t begin, size_t end) const
+    {
+        return countBits(m_edges, begin + 1, std::min(end, m_size));
+    }
+
+    /**
+     * @brief 按游程遍历区间[begin, end)
+     * @param fn 回调，参数为(游程起点, 游程长度, 电平)
+     */
+    template <typename Fn>
+    void forEachRun(size_t begin, size_t end, Fn&& fn) const
+    {
+        end = std::min(end, m_size);
+        size_t pos = begin;
+        while (pos < end) {
+            const size_t next = std::min(nextTransition(pos), end);
+            fn(pos, next - pos, valueAt(pos));
+            pos = next;
+        }
+    }
+
+    /**
+     * @brief 占用的内存（字节）
+     */
+    size_t memoryBytes() const
+    {
+        return (m_levels.capacity() + m_edges.capacity() + m_edgeSummary.capacity()) * sizeof(uint64_t);
+    }
+
+private:
+    static size_t wordCount(size_t bits) { return (bits + 63) / 64; }
+
+    /**
+     * @brief 由电平位图重建跳变位图和摘要
+     */
+    void rebuildEdges()
+    {
+        const size_t words = m_levels.size();
+        m_edges.assign(words, 0);
+        m_edgeSummary.assign(wordCount(words), 0);
+
+        uint64_t carry = 0;
+        for (size_t w = 0; w < words; ++w) {
+            const uint64_t levels = m_levels[w];
+            uint64_t edges = levels ^ ((levels << 1) | carry);
+            if (w == 0) {
+                edges &= ~uint64_t(1);      // 第一个样本之前没有跳变
+            }
+            if (w == words - 1 && (m_size & 63) != 0) {
+                edges &= (uint64_t(1) << (m_size & 63)) - 1;   // 去掉末尾之后的虚假跳变
+            }
+            m_edges[w] = edges;
+            if (edges != 0) {
+                m_edgeSummary[w >> 6] |= uint64_t(1) << (w & 63);
+            }
+            carry = levels >> 63;
+        }
+    }
+
+    /**
+     * @brief 位图区间[begin, end)内置位数
+     */
+    static size_t countBits(const std::vector<uint64_t>& bits, size_t begin, size_t end)
+    {
+        if (begin >= end) {
+            return 0;
+        }
+
+        const size_t firstWord = begin >> 6;
+        const size_t lastWord = (end - 1) >> 6;
+        const uint64_t firstMask = ~uint64_t(0) << (begin & 63);
+        const uint64_t lastMask = ~uint64_t(0) >> (63 - ((end - 1) & 63));
+
+        if (firstWord == lastWord) {
+            return static_cast<size_t>(std::popcount(bits[firstWord] & firstMask & lastMask));
+        }
+
+        size_t count = static_cast<size_t>(std::popcount(bits[firstWord] & firstMask));
+        for (size_t w = firstWord + 1; w < lastWord; ++w) {
+            count += static_cast<size_t>(std::popcount(bits[w]));
+        }
+        count += static_cast<size_t>(std::popcount(bits[lastWord] & lastMask));
+        return count;
+    }
+
+    std::vector<uint64_t> m_levels;         ///< 电平位图
+    std::vector<uint64_t> m_edges;          ///< 跳变位图
+    std::vector<uint64_t> m_edgeSummary;    ///< 跳变位图的非零字摘要
+    size_t m_size = 0;                      ///< 样本数
+};
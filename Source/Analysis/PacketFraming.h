@@ -0,0 +1,262 @@
+﻿// Source/Analysis/PacketFraming.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief 数据包帧头匹配结果
+ */
+enum class FrameMatch {
+    NoMatch,    ///< 当前位置不是有效帧头
+    Match,      ///< 找到完整有效帧头
+    NeedMore    ///< 可用字节不足，无法判定
+};
+
+/**
+ * @brief 数据包帧头信息
+ */
+struct PacketFrameInfo {
+    uint64_t offset = 0;        ///< 帧起始偏移（第一个"00 00 00 00"的位置）
+    uint32_t headerSize = 0;    ///< 同步头长度（"00 00 00 00 ... 99 99 99 99 00 00 00 00"）
+    uint32_t dataSize = 0;      ///< 负载长度（repeat * 4）
+    uint8_t commandType = 0;    ///< 指令类型（XX）
+    uint32_t sequence = 0;      ///< SC1-SC3构建的序列号（repeat）
+
+    /**
+     * @brief 完整帧长度：同步头 + 8字节元数据 + 负载
+     */
+    uint64_t totalSize() const { return static_cast<uint64_t>(headerSize) + META_SIZE + dataSize; }
+
+    static constexpr uint32_t META_SIZE = 8;
+};
+
+/**
+ * @brief 数据包帧格式解析
+ *
+ * 帧格式: 00 00 00 00 [0~16字节] 99 99 99 99 00 00 00 00 XX SC1 SC2 SC3 XX ~SC1 ~SC2 ~SC3 [负载]
+ * 与IndexGenerator::parseDataStream使用相同的判定规则，供并行索引和实时索引共用。
+ * 纯C++实现，不依赖Qt。
+ */
+class PacketFraming {
+public:
+    static constexpr size_t SYNC_SEARCH_BEGIN = 4;                  ///< "99"标记最早出现位置
+    static constexpr size_t SYNC_SEARCH_END = 20;                   ///< "99"标记最晚出现位置
+    static constexpr size_t MAX_HEADER_SIZE = SYNC_SEARCH_END + 8;  ///< 最大同步头长度
+    static constexpr size_t MAX_FRAME_LOOKAHEAD = MAX_HEADER_SIZE + PacketFrameInfo::META_SIZE; ///< 判定帧头所需的最大字节数
+    static constexpr uint32_t MAX_DATA_SIZE = 10 * 1024 * 1024;     ///< 负载上限(10MB)
+
+    /**
+     * @brief 判断指定位置是否为有效帧头
+     * @param data 指向候选帧起始位置的指针
+     * @param available 从data开始可访问的字节数
+     * @param info 匹配成功时输出帧信息（offset字段由调用者填写）
+     * @return 匹配结果；仅当可用字节不足以判定时返回NeedMore
+     */
+    static FrameMatch matchHeader(const uint8_t* data, size_t available, PacketFrameInfo& info)
+    {
+        if (available < 4) {
+            return FrameMatch::NeedMore;
+        }
+        if (data[0] != 0x00 || data[1] != 0x00 || data[2] != 0x00 || data[3] != 0x00) {
+            return FrameMatch::NoMatch;
+        }
+
+        // 在接下来的字节内查找第一个 "99 99 99 99 00 00 00 00"
+        for (size_t i = SYNC_SEARCH_BEGIN; i <= SYNC_SEARCH_END; ++i) {
+            if (i + 8 > available) {
+                return FrameMatch::NeedMore;
+            }
+            if (data[i] != 0x99 || data[i + 1] != 0x99 || data[i + 2] != 0x99 || data[i + 3] != 0x99 ||
+                data[i + 4] != 0x00 || data[i + 5] != 0x00 || data[i + 6] != 0x00 || data[i + 7] != 0x00) {
+                continue;
+            }
+
+            const size_t headerSize = i + 8;
+            if (headerSize + PacketFrameInfo::META_SIZE > available) {
+                return FrameMatch::NeedMore;
+            }
+
+            const uint8_t* meta = data + headerSize;
+            uint8_t type1 = meta[0];
+            uint32_t repeat = (static_cast<uint32_t>(meta[1]) << 16) |
+                (static_cast<uint32_t>(meta[2]) << 8) |
+                static_cast<uint32_t>(meta[3]);
+            uint8_t type2 = meta[4];
+            uint32_t repeatInv = 0xFF000000u |
+                (static_cast<uint32_t>(meta[5]) << 16) |
+                (static_cast<uint32_t>(meta[6]) << 8) |
+                static_cast<uint32_t>(meta[7]);
+
+            // 类型一致且计数与其取反值匹配
+            if (type1 != type2 || (repeat ^ repeatInv) != 0xFFFFFFFFu) {
+                return FrameMatch::NoMatch;
+            }
+
+            uint64_t dataSize = static_cast<uint64_t>(repeat) * 4;
+            if (dataSize > MAX_DATA_SIZE) {
+                return FrameMatch::NoMatch;
+            }
+
+            info.headerSize = static_cast<uint32_t>(headerSize);
+            info.dataSize = static_cast<uint32_t>(dataSize);
+            info.commandType = type1;
+            info.sequence = repeat;
+            return FrameMatch::Match;
+        }
+
+        return FrameMatch::NoMatch;
+    }
+
+    /**
+     * @brief 在缓冲区内查找下一个完整帧（参考顺序扫描规则）
+     *
+     * 在[pos, end)范围内逐字节查找帧头，要求整帧结束于limit之前。
+     * 调用者在接受一帧后应从 info.offset + info.totalSize() 继续查找。
+     *
+     * @param data 缓冲区起始指针
+     * @param size 缓冲区可访问字节数（可包含end之后的前瞻字节）
+     * @param pos 起始查找位置
+     * @param end 候选帧起始位置上限（不含）
+     * @param limit 帧必须结束于此位置之前（相对data，通常为文件剩余大小）
+     * @param info 输出帧信息，offset为相对data的偏移
+     * @return 找到返回true
+     */
+    static bool findNextFrame(const uint8_t* data, size_t size, size_t pos, size_t end,
+        uint64_t limit, PacketFrameInfo& info)
+    {
+        if (end > size) {
+            end = size;
+        }
+        for (; pos < end; ++pos) {
+            if (data[pos] != 0x00) {
+                continue;
+            }
+            if (matchHeader(data + pos, size - pos, info) == FrameMatch::Match &&
+                pos + info.totalSize() <= limit) {
+                info.offset = pos;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief 流式帧扫描器
+ *
+ * 按写入顺序分段喂入数据，输出与对整个文件做顺序扫描相同的帧序列。
+ * 已接受帧的负载字节直接跳过，只有帧头判定所需的少量尾部字节会被暂存。
+ */
+class StreamFrameScanner {
+public:
+    /**
+     * @brief 重置扫描状态
+     * @param startOffset 下一次喂入数据在文件中的起始偏移
+     */
+    void reset(uint64_t startOffset = 0)
+    {
+        m_window.clear();
+        m_windowOffset = startOffset;
+        m_streamPos = startOffset;
+        m_skipUntil = startOffset;
+        m_hasPending = false;
+    }
+
+    /**
+     * @brief 喂入一段紧接上次数据的字节
+     * @param data 数据指针
+     * @param size 数据长度
+     * @param onFrame 完整帧回调，参数为const PacketFrameInfo&，offset为文件绝对偏移
+     */
+    template <typename FrameCallback>
+    void feed(const uint8_t* data, size_t size, FrameCallback&& onFrame)
+    {
+        uint64_t base = m_streamPos;
+        m_streamPos += size;
+
+        // 跳过已接受帧的剩余负载
+        if (m_skipUntil > base) {
+            size_t skip = static_cast<size_t>(std::min<uint64_t>(size, m_skipUntil - base));
+            data += skip;
+            size -= skip;
+            base += skip;
+        }
+
+        // 跨写入的帧在全部字节到达后才输出
+        if (m_hasPending && m_streamPos >= m_skipUntil) {
+            onFrame(m_pending);
+            m_hasPending = false;
+        }
+
+        if (size == 0) {
+            return;
+        }
+
+        if (m_window.empty()) {
+            m_windowOffset = base;
+        }
+        m_window.insert(m_window.end(), data, data + size);
+
+        PacketFrameInfo info;
+        size_t pos = 0;
+        while (pos < m_window.size()) {
+            if (m_window[pos] != 0x00) {
+                ++pos;
+                continue;
+            }
+
+            FrameMatch result = PacketFraming::matchHeader(m_window.data() + pos, m_window.size() - pos, info);
+            if (result == FrameMatch::NeedMore) {
+                break;  // 保留剩余字节等待后续数据
+            }
+            if (result == FrameMatch::NoMatch) {
+                ++pos;
+                continue;
+            }
+
+            info.offset = m_windowOffset + pos;
+            m_skipUntil = info.offset + info.totalSize();
+            if (m_skipUntil <= m_streamPos) {
+                onFrame(info);
+                pos = static_cast<size_t>(m_skipUntil - m_windowOffset);
+            }
+            else {
+                m_pending = info;
+                m_hasPending = true;
+                pos = m_window.size();
+            }
+        }
+
+        m_window.erase(m_window.begin(), m_window.begin() + pos);
+        m_windowOffset += pos;
+    }
+
+    /**
+     * @brief 获取尚未写完的帧
+     * @param info 输出帧信息
+     * @return 存在未完成帧返回true；流结束时该帧无效，应从其offset+1处重新扫描
+     */
+    bool pendingFrame(PacketFrameInfo& info) const
+    {
+        if (m_hasPending) {
+            info = m_pending;
+        }
+        return m_hasPending;
+    }
+
+    /**
+     * @brief 已喂入的字节总数（含起始偏移）
+     */
+    uint64_t position() const { return m_streamPos; }
+
+private:
+    std::vector<uint8_t> m_window;  ///< 暂存的未判定字节
+    uint64_t m_windowOffset = 0;    ///< m_window首字节的文件偏移
+    uint64_t m_streamPos = 0;       ///< 已喂入数据的结束偏移
+    uint64_t m_skipUntil = 0;       ///< 当前接受帧的结束偏移
+    bool m_hasPending = false;      ///< 是否有跨写入未完成的帧
+    PacketFrameInfo m_pending;      ///< 未完成的帧
+};
@@ -0,0 +1,240 @@
+﻿// Source/Analysis/ParallelIndexer.cpp
+#include "ParallelIndexer.h"
+#include "Logger.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+    // 扫描过程中检查取消请求和累计进度的步长
+    constexpr size_t SCAN_STRIDE = 1024 * 1024;
+    // 顺序扫描的读取窗口
+    constexpr qint64 SEQUENTIAL_WINDOW = 4 * 1024 * 1024;
+}
+
+ParallelIndexer::ParallelIndexer(QObject* parent)
+    : QObject(parent)
+    , m_chunkSize(DEFAULT_CHUNK_SIZE)
+{
+    m_threadPool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+ParallelIndexer::~ParallelIndexer()
+{
+    cancel();
+    m_threadPool.waitForDone();
+}
+
+void ParallelIndexer::cancel()
+{
+    m_cancelRequested.store(true);
+}
+
+void ParallelIndexer::setChunkSize(qint64 bytes)
+{
+    m_chunkSize = std::max(bytes, MIN_CHUNK_SIZE);
+}
+
+void ParallelIndexer::setMaxThreads(int count)
+{
+    m_threadPool.setMaxThreadCount(count > 0 ? count : QThread::idealThreadCount());
+}
+
+QVector<PacketIndexEntry> ParallelIndexer::indexFile(const QString& filePath, uint64_t baseTimestamp)
+{
+    QVector<PacketIndexEntry> entries;
+
+    m_cancelRequested.store(false);
+    m_bytesScanned.store(0);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_ERROR(LocalQTCompat::fromLocal8Bit("并行索引无法打开文件: %1 - %2").arg(filePath).arg(file.errorString()));
+        return entries;
+    }
+    const qint64 fileSize = file.size();
+    file.close();
+
+    if (fileSize <= 0) {
+        return entries;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 切分数据块并提交到线程池
+    QVector<QFuture<QVector<PacketFrameInfo>>> futures;
+    futures.reserve(static_cast<int>((fileSize + m_chunkSize - 1) / m_chunkSize));
+
+    for (qint64 chunkStart = 0; chunkStart < fileSize; chunkStart += m_chunkSize) {
+        qint64 chunkEnd = std::min(chunkStart + m_chunkSize, fileSize);
+        futures.append(QtConcurrent::run(&m_threadPool, [this, filePath, chunkStart, chunkEnd, fileSize]() {
+            return scanChunk(filePath, chunkStart, chunkEnd, fileSize);
+            }));
+    }
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("开始并行索引: %1，大小: %2字节，分块数: %3，线程数: %4")
+        .arg(filePath).arg(fileSize).arg(futures.size()).arg(m_threadPool.maxThreadCount()));
+
+    // 按文件顺序合并：只接受起始于上一帧结束位置之后的候选帧，
+    // 跨块边界的帧由其起始所在块负责，落在已接受帧负载内的候选帧被丢弃
+    uint64_t nextAllowedOffset = 0;
+    int lastProgress = -1;
+
+    for (auto& future : futures) {
+        future.waitForFinished();
+
+        if (m_cancelRequested.load()) {
+            break;
+        }
+
+        const QVector<PacketFrameInfo> frames = future.result();
+        for (const PacketFrameInfo& frame : frames) {
+            if (frame.offset < nextAllowedOffset) {
+                continue;
+            }
+            entries.append(makeEntry(frame, filePath, baseTimestamp, static_cast<uint32_t>(entries.size())));
+            nextAllowedOffset = frame.offset + frame.totalSize();
+        }
+
+        int progress = static_cast<int>((m_bytesScanned.load() * 100) / fileSize);
+        if (progress != lastProgress) {
+            lastProgress = progress;
+            emit signal_PIDX_progressChanged(progress);
+        }
+    }
+
+    if (m_cancelRequested.load()) {
+        m_threadPool.waitForDone();
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("并行索引已取消: %1").arg(filePath));
+        return QVector<PacketIndexEntry>();
+    }
+
+    qint64 elapsed = timer.elapsed();
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("并行索引完成: 共%1个数据包，耗时%2毫秒")
+        .arg(entries.size()).arg(elapsed));
+
+    emit signal_PIDX_finished(entries.size(), elapsed);
+    return entries;
+}
+
+QVector<PacketFrameInfo> ParallelIndexer::scanChunk(const QString& filePath, qint64 chunkStart,
+    qint64 chunkEnd, qint64 fileSize)
+{
+    QVector<PacketFrameInfo> frames;
+
+    if (m_cancelRequested.load()) {
+        return frames;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(chunkStart)) {
+        LOG_ERROR(LocalQTCompat::fromLocal8Bit("并行索引读取数据块失败: 偏移%1 - %2").arg(chunkStart).arg(file.errorString()));
+        return frames;
+    }
+
+    // 多读取前瞻字节，保证块末尾起始的帧头可以被完整判定
+    qint64 readEnd = std::min(chunkEnd + static_cast<qint64>(PacketFraming::MAX_FRAME_LOOKAHEAD), fileSize);
+    QByteArray buffer = file.read(readEnd - chunkStart);
+    file.close();
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.constData());
+    const size_t size = static_cast<size_t>(buffer.size());
+    const size_t end = std::min(static_cast<size_t>(chunkEnd - chunkStart), size);
+    const uint64_t limit = static_cast<uint64_t>(fileSize - chunkStart);
+
+    // 记录块内起始的全部候选帧（不跳过负载），由合并阶段确定最终结果
+    PacketFrameInfo frame;
+    size_t pos = 0;
+    size_t lastReported = 0;
+    while (pos < end) {
+        if (m_cancelRequested.load()) {
+            return QVector<PacketFrameInfo>();
+        }
+
+        size_t strideEnd = std::min(end, pos + SCAN_STRIDE);
+        if (PacketFraming::findNextFrame(data, size, pos, strideEnd, limit, frame)) {
+            pos = static_cast<size_t>(frame.offset) + 1;
+            frame.offset += static_cast<uint64_t>(chunkStart);
+            frames.append(frame);
+        }
+        else {
+            pos = strideEnd;
+        }
+
+        if (pos - lastReported >= SCAN_STRIDE) {
+            m_bytesScanned.fetch_add(static_cast<qint64>(pos - lastReported));
+            lastReported = pos;
+        }
+    }
+    m_bytesScanned.fetch_add(static_cast<qint64>(end - lastReported));
+
+    return frames;
+}
+
+QVector<PacketIndexEntry> ParallelIndexer::scanSequential(const QString& filePath, uint64_t baseTimestamp)
+{
+    QVector<PacketIndexEntry> entries;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_ERROR(LocalQTCompat::fromLocal8Bit("顺序索引无法打开文件: %1 - %2").arg(filePath).arg(file.errorString()));
+        return entries;
+    }
+    const qint64 fileSize = file.size();
+
+    PacketFrameInfo frame;
+    qint64 windowStart = 0;
+    while (windowStart < fileSize) {
+        if (!file.seek(windowStart)) {
+            break;
+        }
+
+        qint64 readSize = std::min(SEQUENTIAL_WINDOW + static_cast<qint64>(PacketFraming::MAX_FRAME_LOOKAHEAD),
+            fileSize - windowStart);
+        QByteArray buffer = file.read(readSize);
+        if (buffer.isEmpty()) {
+            break;
+        }
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.constData());
+        const size_t size = static_cast<size_t>(buffer.size());
+        const size_t end = std::min(static_cast<size_t>(SEQUENTIAL_WINDOW), size);
+        const uint64_t limit = static_cast<uint64_t>(fileSize - windowStart);
+
+        // 找到一帧后直接跳过整帧，下一帧可能位于后续窗口
+        uint64_t pos = 0;
+        while (pos < end) {
+            if (!PacketFraming::findNextFrame(data, size, static_cast<size_t>(pos), end, limit, frame)) {
+                pos = end;
+                break;
+            }
+            pos = frame.offset + frame.totalSize();
+            frame.offset += static_cast<uint64_t>(windowStart);
+            entries.append(makeEntry(frame, filePath, baseTimestamp, static_cast<uint32_t>(entries.size())));
+        }
+
+        windowStart += static_cast<qint64>(pos);
+    }
+
+    return entries;
+}
+
+PacketIndexEntry ParallelIndexer::makeEntry(const PacketFrameInfo& frame, const QString& filePath,
+    uint64_t baseTimestamp, uint32_t ordinal)
+{
+    PacketIndexEntry entry;
+    // 以文件偏移作为纳秒增量，保证时间戳单调且与扫描方式无关
+    entry.timestamp = baseTimestamp + frame.offset;
+    entry.fileOffset = frame.offset;
+    entry.size = static_cast<uint32_t>(frame.totalSize());
+    entry.fileName = filePath;
+    entry.batchId = frame.commandType;
+    entry.packetIndex = ordinal;
+    entry.commandType = frame.commandType;
+    entry.sequence = frame.sequence;
+    entry.isValidHeader = true;
+    return entry;
+}
@@ -0,0 +1,103 @@
+﻿// Source/Analysis/ParallelIndexer.h
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+#include <atomic>
+#include "IndexGenerator.h"
+#include "PacketFraming.h"
+
+/**
+ * @brief 大文件并行分块索引器
+ *
+ * 将文件切分为固定大小的块，块之间重叠MAX_FRAME_LOOKAHEAD字节，
+ * 由线程池并行找出每个块内起始的所有候选帧头；随后按文件顺序合并，
+ * 仅接受起始于上一帧结束位置之后的候选帧，结果与scanSequential完全一致。
+ */
+class ParallelIndexer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ParallelIndexer(QObject* parent = nullptr);
+    ~ParallelIndexer();
+
+    /**
+     * @brief 并行索引整个文件（阻塞调用，应在工作线程中执行）
+     * @param filePath 数据文件路径
+     * @param baseTimestamp 基准时间戳(ns)，条目时间戳为基准加文件偏移
+     * @return 按文件偏移有序的索引条目；取消或失败时返回空列表
+     */
+    QVector<PacketIndexEntry> indexFile(const QString& filePath, uint64_t baseTimestamp);
+
+    /**
+     * @brief 顺序扫描整个文件，作为并行结果的参考实现
+     * @param filePath 数据文件路径
+     * @param baseTimestamp 基准时间戳(ns)
+     * @return 按文件偏移有序的索引条目
+     */
+    static QVector<PacketIndexEntry> scanSequential(const QString& filePath, uint64_t baseTimestamp);
+
+    /**
+     * @brief 请求取消当前索引任务
+     */
+    void cancel();
+
+    /**
+     * @brief 当前任务是否已被取消
+     */
+    bool isCanceled() const { return m_cancelRequested.load(); }
+
+    /**
+     * @brief 设置分块大小
+     * @param bytes 每块字节数（最小1MB）
+     */
+    void setChunkSize(qint64 bytes);
+
+    /**
+     * @brief 设置最大并行线程数
+     * @param count 线程数，<=0表示使用CPU核心数
+     */
+    void setMaxThreads(int count);
+
+signals:
+    /**
+     * @brief 索引进度信号
+     * @param percent 进度百分比(0-100)
+     */
+    void signal_PIDX_progressChanged(int percent);
+
+    /**
+     * @brief 索引完成信号
+     * @param packetCount 识别到的数据包数量
+     * @param elapsedMs 耗时(毫秒)
+     */
+    void signal_PIDX_finished(int packetCount, qint64 elapsedMs);
+
+private:
+    /**
+     * @brief 扫描单个数据块内起始的所有候选帧
+     * @param filePath 数据文件路径
+     * @param chunkStart 块起始偏移
+     * @param chunkEnd 块结束偏移（不含）
+     * @param fileSize 文件总大小
+     * @return 候选帧列表，offset为文件绝对偏移
+     */
+    QVector<PacketFrameInfo> scanChunk(const QString& filePath, qint64 chunkStart,
+        qint64 chunkEnd, qint64 fileSize);
+
+    /**
+     * @brief 根据帧信息构建索引条目
+     */
+    static PacketIndexEntry makeEntry(const PacketFrameInfo& frame, const QString& filePath,
+        uint64_t baseTimestamp, uint32_t ordinal);
+
+    static constexpr qint64 DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;  // 默认分块16MB
+    static constexpr qint64 MIN_CHUNK_SIZE = 1024 * 1024;           // 最小分块1MB
+
+    QThreadPool m_threadPool;                   ///< 专用线程池，避免占用全局线程池
+    std::atomic<bool> m_cancelRequested{ false };
+    std::atomic<qint64> m_bytesScanned{ 0 };
+    qint64 m_chunkSize;
+};
@@ -0,0 +1,70 @@
+﻿// Source/Analysis/ReadPlanner.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief 待读取的文件区间
+ */
+struct ReadExtent {
+    uint64_t offset = 0;    ///< 文件偏移
+    uint64_t size = 0;      ///< 长度
+};
+
+/**
+ * @brief 合并后的一次顺序读取
+ *
+ * 覆盖区间[offset, offset + length)，包含输入中下标为[first, last)的区间。
+ */
+struct ReadRun {
+    uint64_t offset = 0;    ///< 读取起始偏移
+    uint64_t length = 0;    ///< 读取长度
+    size_t first = 0;       ///< 首个区间下标
+    size_t last = 0;        ///< 末个区间下标+1
+};
+
+/**
+ * @brief 合并读取计划
+ *
+ * 将按偏移排序的区间合并为少量大块顺序读取：相邻区间的空隙不超过maxGap时合并，
+ * 多读的空隙数据远比一次额外的定位便宜；单次读取不超过maxRunBytes，限制内存占用。
+ * 重叠或重复的区间同样合并。纯C++实现，不依赖Qt。
+ *
+ * @param extents 按offset升序排列的区间
+ * @param maxGap 允许合并的最大空隙（字节）
+ * @param maxRunBytes 单次读取的最大长度（字节），单个区间超过时单独成为一次读取
+ * @return 读取计划，按偏移升序
+ */
+inline std::vector<ReadRun> planReadRuns(const std::vector<ReadExtent>& extents,
+    uint64_t maxGap, uint64_t maxRunBytes)
+{
+    std::vector<ReadRun> runs;
+
+    size_t i = 0;
+    while (i < extents.size()) {
+        ReadRun run;
+        run.offset = extents[i].offset;
+        run.first = i;
+        uint64_t runEnd = extents[i].offset + extents[i].size;
+        i++;
+
+        while (i < extents.size()) {
+            const ReadExtent& next = extents[i];
+            const uint64_t nextEnd = std::max(runEnd, next.offset + next.size);
+            if (next.offset > runEnd + maxGap || nextEnd - run.offset > maxRunBytes) {
+                break;
+            }
+            runEnd = nextEnd;
+            i++;
+        }
+
+        run.length = runEnd - run.offset;
+        run.last = i;
+        runs.push_back(run);
+    }
+
+    return runs;
+}
@@ -0,0 +1,407 @@
+﻿// Source/Analysis/RgbScanlineDecoder.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RGB_DECODER_SSSE3
+#else
+#define RGB_DECODER_SSSE3 __attribute__((target("ssse3")))
+#endif
+
+/**
+ * @brief 视频原始数据按行解码为RGB888
+ *
+ * 输出与QImage::Format_RGB888的扫描线布局相同（每像素R、G、B三字节），调用方直接传入scanLine()。
+ *
+ * 源数据格式：
+ * - 24/36/30/18位模式为小端位流，每像素依次存放三个分量（顺序由色彩排布决定），
+ *   每个分量12/10/8/6位，从低位开始；36位每2像素9字节，30位每4像素15字节，18位每4像素9字节，
+ *   跨字节的分量按位流拼接。24位正好是每像素三字节。
+ * - 16位模式为小端5-6-5，R在高位，不使用色彩排布。
+ * - 每行从字节边界开始，行字节数为rowBytes(width)。
+ *
+ * 多于8位的分量按round(v * 255 / max)定点缩放，6位分量同样四舍五入扩展到8位。
+ * 24位用预先生成的pshufb掩码一条指令完成一组像素的提取和换序；位压缩模式每次8个像素：
+ * pshufb把每个分量所在的两个字节取到16位通道，pmullw按各自的位偏移左移对齐到高位，
+ * pmulhuw完成缩放，最后再用pshufb按色彩排布交织成24字节；16位模式用SSE2移位展开565。
+ * SSSE3不属于x64基线指令集，运行时检测一次，不支持时使用标量路径，结果逐字节相同。
+ * 纯C++实现，不依赖Qt，各行互不相关，可以按行带并行。
+ */
+class RgbScanlineDecoder {
+public:
+    /**
+     * @brief 色彩模式，与视频配置界面的下拉框顺序一致
+     */
+    enum ColorMode {
+        COLOR_RGB36 = 0,    ///< 36位RGB，每分量12位
+        COLOR_RGB30 = 1,    ///< 30位RGB，每分量10位
+        COLOR_RGB24 = 2,    ///< 24位RGB，每分量8位
+        COLOR_RGB18 = 3,    ///< 18位RGB，每分量6位
+        COLOR_RGB565 = 4    ///< 16位RGB(5-6-5，小端)
+    };
+
+    static constexpr int ARRANGEMENT_COUNT = 6;     ///< 色彩排布数
+
+    /**
+     * @brief 构造解码器
+     * @param colorMode 色彩模式
+     * @param colorArrangement 色彩排布：0 R-G-B，1 R-B-G，2 G-B-R，3 G-R-B，4 B-G-R，5 B-R-G，
+     *        表示源数据中三个分量的先后顺序；16位模式不使用
+     */
+    RgbScanlineDecoder(int colorMode, int colorArrangement)
+        : m_bitsPerPixel(bitsPerPixel(colorMode))
+        , m_componentBits(m_bitsPerPixel == 16 ? 0 : m_bitsPerPixel / 3)
+        , m_useSsse3(hasSsse3())
+    {
+        if (colorArrangement < 0 || colorArrangement >= ARRANGEMENT_COUNT) {
+            colorArrangement = 0;
+        }
+        for (int c = 0; c < 3; ++c) {
+            m_sourceIndex[c] = SOURCE_ORDER[colorArrangement][c];
+        }
+
+        // 24位：每个16字节向量取5个像素，输出15字节，第16字节置零后由下一次覆盖
+        for (int i = 0; i < 16; ++i) {
+            m_byteShuffle[i] = static_cast<int8_t>(-1);
+        }
+        for (int p = 0; p < 5; ++p) {
+            for (int c = 0; c < 3; ++c) {
+                m_byteShuffle[p * 3 + c] = static_cast<int8_t>(p * 3 + m_sourceIndex[c]);
+            }
+        }
+
+        if (m_componentBits == 0 || m_componentBits == 8) {
+            return;
+        }
+
+        const ScaleParameters& scale = scaleParameters(m_componentBits);
+        m_scaleMultiplier = scale.multiplier;
+        m_scaleShift = scale.shift;
+        m_alignShift = 16 - m_componentBits;
+
+        // 8个连续分量共8 * bits位，正好是整字节，所以三组分量共用同一套取字节掩码和对齐乘数
+        for (int lane = 0; lane < 8; ++lane) {
+            const int bit = lane * m_componentBits;
+            m_gatherShuffle[2 * lane] = static_cast<int8_t>(bit / 8);
+            m_gatherShuffle[2 * lane + 1] = static_cast<int8_t>(bit / 8 + 1);
+            m_alignMultiplier[lane] = static_cast<uint16_t>(1u << (16 - m_componentBits - bit % 8));
+        }
+
+        // 8个像素的24个分量按源顺序排在lo(0..15)和hi(16..23)中，按排布重排为R G B
+        for (int i = 0; i < 16; ++i) {
+            m_arrangeLoFromLo[i] = m_arrangeLoFromHi[i] = static_cast<int8_t>(-1);
+            m_arrangeHiFromLo[i] = m_arrangeHiFromHi[i] = static_cast<int8_t>(-1);
+        }
+        for (int i = 0; i < 24; ++i) {
+            const int source = (i / 3) * 3 + m_sourceIndex[i % 3];
+            int8_t* fromLo = i < 16 ? &m_arrangeLoFromLo[i] : &m_arrangeHiFromLo[i - 16];
+            int8_t* fromHi = i < 16 ? &m_arrangeLoFromHi[i] : &m_arrangeHiFromHi[i - 16];
+            if (source < 16) {
+                *fromLo = static_cast<int8_t>(source);
+            }
+            else {
+                *fromHi = static_cast<int8_t>(source - 16);
+            }
+        }
+    }
+
+    /**
+     * @brief 色彩模式每像素占用的位数
+     */
+    static int bitsPerPixel(int colorMode)
+    {
+        switch (colorMode) {
+        case COLOR_RGB36: return 36;
+        case COLOR_RGB30: return 30;
+        case COLOR_RGB24: return 24;
+        case COLOR_RGB18: return 18;
+        case COLOR_RGB565: return 16;
+        default: return 24;
+        }
+    }
+
+    int bitsPerPixel() const { return m_bitsPerPixel; }
+
+    /**
+     * @brief 一行源数据的字节数，不足一字节的尾部按一字节计
+     */
+    size_t rowBytes(int width) const
+    {
+        return (static_cast<size_t>(width > 0 ? width : 0) * m_bitsPerPixel + 7) / 8;
+    }
+
+    /**
+     * @brief 解码一行
+     * @param src 该行源数据，长度至少为rowBytes(width)
+     * @param dst 输出扫描线，长度至少为width * 3
+     * @param width 像素数
+     */
+    void decodeRow(const uint8_t* src, uint8_t* dst, int width) const
+    {
+        if (width <= 0) {
+            return;
+        }
+
+        int x = 0;
+        if (m_componentBits == 0) {
+            if (m_useSsse3) {
+                x = decode565Ssse3(src, dst, width);
+            }
+            decode565Scalar(src, dst, x, width);
+        }
+        else if (m_componentBits == 8) {
+            if (m_useSsse3) {
+                x = decodeBytesSsse3(src, dst, width);
+            }
+            decodeBytesScalar(src, dst, x, width);
+        }
+        else {
+            if (m_useSsse3) {
+                x = decodePackedSsse3(src, dst, width);
+            }
+            decodePackedScalar(src, dst, x, width);
+        }
+    }
+
+    /**
+     * @brief 解码连续的若干行
+     * @param src 第一行的源数据
+     * @param srcStride 源数据每行字节数
+     * @param dst 第一行的输出扫描线
+     * @param dstStride 输出每行字节数（QImage::bytesPerLine()，含对齐填充）
+     */
+    void decodeRows(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride,
+        int width, int rowCount) const
+    {
+        for (int row = 0; row < rowCount; ++row) {
+            decodeRow(src + row * srcStride, dst + row * dstStride, width);
+        }
+    }
+
+    /**
+     * @brief CPU是否支持SSSE3，只检测一次
+     */
+    static bool hasSsse3()
+    {
+        static const bool supported = []() {
+#ifdef _MSC_VER
+            int info[4] = { 0 };
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+#else
+            return __builtin_cpu_supports("ssse3") != 0;
+#endif
+            }();
+        return supported;
+    }
+
+private:
+    /**
+     * @brief 分量缩放到8位的定点参数：out = (((v << (16 - bits)) * multiplier >> 16) + round) >> shift
+     */
+    struct ScaleParameters {
+        int bits;               ///< 分量位数
+        uint16_t multiplier;    ///< 乘数
+        int shift;              ///< 右移位数
+    };
+
+    /// 各分量位数的缩放参数，均已逐值验证与round(v * 255 / max)一致
+    static const ScaleParameters& scaleParameters(int bits)
+    {
+        static constexpr ScaleParameters TABLE[] = {
+            { 6, 4145, 4 },
+            { 10, 1021, 2 },
+            { 12, 4081, 4 }
+        };
+        return bits == 6 ? TABLE[0] : (bits == 10 ? TABLE[1] : TABLE[2]);
+    }
+
+    /// 各排布下输出R、G、B分别取源像素的第几个分量
+    static constexpr uint8_t SOURCE_ORDER[ARRANGEMENT_COUNT][3] = {
+        { 0, 1, 2 },    // R-G-B
+        { 0, 2, 1 },    // R-B-G
+        { 2, 0, 1 },    // G-B-R
+        { 1, 0, 2 },    // G-R-B
+        { 2, 1, 0 },    // B-G-R
+        { 1, 2, 0 }     // B-R-G
+    };
+
+    uint8_t scaleComponent(unsigned value) const
+    {
+        const unsigned scaled = ((value << m_alignShift) * m_scaleMultiplier) >> 16;
+        return static_cast<uint8_t>((scaled + (1u << (m_scaleShift - 1))) >> m_scaleShift);
+    }
+
+    void decodeBytesScalar(const uint8_t* src, uint8_t* dst, int x, int width) const
+    {
+        const int r = m_sourceIndex[0];
+        const int g = m_sourceIndex[1];
+        const int b = m_sourceIndex[2];
+        for (; x < width; ++x) {
+            const uint8_t* pixel = src + static_cast<size_t>(x) * 3;
+            uint8_t* out = dst + static_cast<size_t>(x) * 3;
+            out[0] = pixel[r];
+            out[1] = pixel[g];
+            out[2] = pixel[b];
+        }
+    }
+
+    void decodePackedScalar(const uint8_t* src, uint8_t* dst, int x, int width) const
+    {
+        const int bits = m_componentBits;
+        const unsigned mask = (1u << bits) - 1;
+        for (; x < width; ++x) {
+            unsigned component[3];
+            for (int c = 0; c < 3; ++c) {
+                // 分量最多跨两个字节；第二个字节只在需要时读取，避免越过行尾
+                const size_t bit = (static_cast<size_t>(x) * 3 + c) * bits;
+                const int offset = static_cast<int>(bit % 8);
+                unsigned word = src[bit / 8];
+                if (offset + bits > 8) {
+                    word |= static_cast<unsigned>(src[bit / 8 + 1]) << 8;
+                }
+                component[c] = (word >> offset) & mask;
+            }
+
+            uint8_t* out = dst + static_cast<size_t>(x) * 3;
+            out[0] = scaleComponent(component[m_sourceIndex[0]]);
+            out[1] = scaleComponent(component[m_sourceIndex[1]]);
+            out[2] = scaleComponent(component[m_sourceIndex[2]]);
+        }
+    }
+
+    static void decode565Scalar(const uint8_t* src, uint8_t* dst, int x, int width)
+    {
+        for (; x < width; ++x) {
+            const unsigned value = src[2 * x] | (src[2 * x + 1] << 8);
+            uint8_t* out = dst + static_cast<size_t>(x) * 3;
+            out[0] = static_cast<uint8_t>(((value >> 11) & 0x1F) << 3);
+            out[1] = static_cast<uint8_t>(((value >> 5) & 0x3F) << 2);
+            out[2] = static_cast<uint8_t>((value & 0x1F) << 3);
+        }
+    }
+
+    /**
+     * @brief 24位：每次读16字节、写16字节，前进5个像素；写出的第16字节由下一次覆盖
+     * @return 已处理的像素数，其余由标量路径完成
+     */
+    RGB_DECODER_SSSE3 int decodeBytesSsse3(const uint8_t* src, uint8_t* dst, int width) const
+    {
+        const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_byteShuffle));
+
+        // 读写都不越过行尾：x * 3 + 16 <= width * 3
+        int x = 0;
+        for (; x + 6 <= width; x += 5) {
+            const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + static_cast<size_t>(x) * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + static_cast<size_t>(x) * 3), _mm_shuffle_epi8(in, shuffle));
+        }
+        return x;
+    }
+
+    /**
+     * @brief 从p开始解出8个连续分量并缩放到8位，结果在8个16位通道中
+     */
+    RGB_DECODER_SSSE3 static __m128i unpackComponents(const uint8_t* p, __m128i gather, __m128i align,
+        __m128i topMask, __m128i multiplier, __m128i round, __m128i shift)
+    {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), gather);
+        v = _mm_and_si128(_mm_mullo_epi16(v, align), topMask);
+        v = _mm_mulhi_epu16(v, multiplier);
+        return _mm_srl_epi16(_mm_add_epi16(v, round), shift);
+    }
+
+    /**
+     * @brief 位压缩模式：每次8个像素（3 * bits字节），分三组各8个分量解出，再按排布交织
+     * @return 已处理的像素数
+     */
+    RGB_DECODER_SSSE3 int decodePackedSsse3(const uint8_t* src, uint8_t* dst, int width) const
+    {
+        const __m128i gather = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_gatherShuffle));
+        const __m128i align = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_alignMultiplier));
+        const __m128i topMask = _mm_set1_epi16(static_cast<short>(0xFFFF << m_alignShift));
+        const __m128i multiplier = _mm_set1_epi16(static_cast<short>(m_scaleMultiplier));
+        const __m128i round = _mm_set1_epi16(static_cast<short>(1 << (m_scaleShift - 1)));
+        const __m128i shift = _mm_cvtsi32_si128(m_scaleShift);
+        const __m128i loFromLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_arrangeLoFromLo));
+        const __m128i loFromHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_arrangeLoFromHi));
+        const __m128i hiFromLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_arrangeHiFromLo));
+        const __m128i hiFromHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_arrangeHiFromHi));
+
+        const size_t groupBytes = static_cast<size_t>(3 * m_componentBits);     // 8像素
+        const size_t vectorBytes = static_cast<size_t>(m_componentBits);        // 8个分量
+        const size_t totalBytes = rowBytes(width);
+
+        int x = 0;
+        size_t offset = 0;
+        // 第三组从2 * vectorBytes处读16字节，不能越过行尾
+        for (; x + 8 <= width && offset + 2 * vectorBytes + 16 <= totalBytes; x += 8, offset += groupBytes) {
+            const uint8_t* group = src + offset;
+            const __m128i c0 = unpackComponents(group, gather, align, topMask, multiplier, round, shift);
+            const __m128i c1 = unpackComponents(group + vectorBytes, gather, align, topMask, multiplier, round, shift);
+            const __m128i c2 = unpackComponents(group + 2 * vectorBytes, gather, align, topMask, multiplier, round, shift);
+            const __m128i lo = _mm_packus_epi16(c0, c1);
+            const __m128i hi = _mm_packus_epi16(c2, c2);
+
+            uint8_t* out = dst + static_cast<size_t>(x) * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                _mm_or_si128(_mm_shuffle_epi8(lo, loFromLo), _mm_shuffle_epi8(hi, loFromHi)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16),
+                _mm_or_si128(_mm_shuffle_epi8(lo, hiFromLo), _mm_shuffle_epi8(hi, hiFromHi)));
+        }
+        return x;
+    }
+
+    /**
+     * @brief 每次8个像素：SSE2按16位通道展开565，再用pshufb交织成24字节
+     * @return 已处理的像素数
+     */
+    RGB_DECODER_SSSE3 static int decode565Ssse3(const uint8_t* src, uint8_t* dst, int width)
+    {
+        const __m128i mask5 = _mm_set1_epi16(0x1F);
+        const __m128i mask6 = _mm_set1_epi16(0x3F);
+
+        // rg：R0 G0 R1 G1 ... R7 G7，b：B0 ... B7（低8字节）
+        const __m128i rgToLow = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+        const __m128i bToLow = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+        const __m128i rgToHigh = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i bToHigh = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * x));
+            const __m128i r = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(value, 11), mask5), 3);
+            const __m128i g = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(value, 5), mask6), 2);
+            const __m128i b = _mm_slli_epi16(_mm_and_si128(value, mask5), 3);
+
+            // r在低字节、g在高字节，正好是R G交替的字节序
+            const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+            const __m128i b8 = _mm_packus_epi16(b, b);
+
+            uint8_t* out = dst + static_cast<size_t>(x) * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                _mm_or_si128(_mm_shuffle_epi8(rg, rgToLow), _mm_shuffle_epi8(b8, bToLow)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16),
+                _mm_or_si128(_mm_shuffle_epi8(rg, rgToHigh), _mm_shuffle_epi8(b8, bToHigh)));
+        }
+        return x;
+    }
+
+    int m_bitsPerPixel;                         ///< 每像素源位数
+    int m_componentBits;                        ///< 每分量位数，16位模式为0
+    bool m_useSsse3;                            ///< 是否使用SSSE3路径
+    uint8_t m_sourceIndex[3] = { 0 };           ///< 输出R、G、B对应的源分量
+    int m_alignShift = 0;                       ///< 分量左移到16位高端的位数
+    uint16_t m_scaleMultiplier = 0;             ///< 缩放乘数
+    int m_scaleShift = 1;                       ///< 缩放右移位数
+    alignas(16) int8_t m_byteShuffle[16];       ///< 24位的取字节/换序掩码
+    alignas(16) int8_t m_gatherShuffle[16];     ///< 位压缩模式：每个分量所在的两个字节
+    alignas(16) uint16_t m_alignMultiplier[8];  ///< 位压缩模式：按位偏移对齐到高位的乘数
+    alignas(16) int8_t m_arrangeLoFromLo[16];   ///< 输出前16字节取自lo的掩码
+    alignas(16) int8_t m_arrangeLoFromHi[16];   ///< 输出前16字节取自hi的掩码
+    alignas(16) int8_t m_arrangeHiFromLo[16];   ///< 输出后8字节取自lo的掩码
+    alignas(16) int8_t m_arrangeHiFromHi[16];   ///< 输出后8字节取自hi的掩码
+};
@@ -0,0 +1,305 @@
+﻿// Source/Analysis/StreamingStatistics.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief 对数分桶的分位数草图
+ *
+ * 按DDSketch的方式分桶：正数x落入键ceil(log_γ(x))，γ = (1+α)/(1-α)，负数按绝对值放入另一组桶，
+ * 接近0的值单独计数。每个桶用其代表值返回，任何分位数的相对误差不超过α。
+ * 桶只做计数，因此和P²、t-digest不同，可以精确地删除已加入的值，适合按先进先出淘汰的数据窗口。
+ *
+ * 桶数只取决于数据的数量级跨度（α=0.5%时每10倍约230个桶），与数据量无关；
+ * 加入、删除为O(1)，查询遍历一次桶。纯C++实现，非线程安全。
+ */
+class QuantileSketch {
+public:
+    static constexpr double DEFAULT_RELATIVE_ACCURACY = 0.005;  ///< 默认相对误差
+    static constexpr double MIN_INDEXABLE = 1e-12;              ///< 绝对值小于此值按0计
+
+    explicit QuantileSketch(double relativeAccuracy = DEFAULT_RELATIVE_ACCURACY)
+    {
+        const double gamma = (1.0 + relativeAccuracy) / (1.0 - relativeAccuracy);
+        m_gamma = gamma;
+        m_inverseLogGamma = 1.0 / std::log(gamma);
+    }
+
+    void clear()
+    {
+        m_positive.clear();
+        m_negative.clear();
+        m_zeroCount = 0;
+    }
+
+    uint64_t count() const { return m_positive.total + m_negative.total + m_zeroCount; }
+
+    /**
+     * @brief 加入一个有限值
+     */
+    void add(double value)
+    {
+        update(value, 1);
+    }
+
+    /**
+     * @brief 删除一个之前加入过的值
+     */
+    void remove(double value)
+    {
+        update(value, -1);
+    }
+
+    /**
+     * @brief 分位数
+     * @param q 分位(0-1)，0.5为中位数
+     * @return 分位数的近似值，没有数据时为0
+     */
+    double quantile(double q) const
+    {
+        const uint64_t total = count();
+        if (total == 0) {
+            return 0.0;
+        }
+
+        const uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(total - 1));
+        uint64_t seen = 0;
+
+        // 从小到大：绝对值最大的负数、0、正数
+        for (size_t i = m_negative.counts.size(); i-- > 0;) {
+            seen += m_negative.counts[i];
+            if (seen > rank) {
+                return -valueOf(m_negative.offset + static_cast<int>(i));
+            }
+        }
+        seen += m_zeroCount;
+        if (seen > rank) {
+            return 0.0;
+        }
+        for (size_t i = 0; i < m_positive.counts.size(); ++i) {
+            seen += m_positive.counts[i];
+            if (seen > rank) {
+                return valueOf(m_positive.offset + static_cast<int>(i));
+            }
+        }
+        return valueOf(m_positive.offset + static_cast<int>(m_positive.counts.size()) - 1);
+    }
+
+private:
+    /**
+     * @brief 连续键范围的桶计数，按需向两端扩展
+     */
+    struct BucketStore {
+        std::vector<uint64_t> counts;   ///< 键offset+i的计数
+        int offset = 0;                 ///< 第一个桶的键
+        uint64_t total = 0;             ///< 总计数
+
+        void clear()
+        {
+            counts.clear();
+            offset = 0;
+            total = 0;
+        }
+
+        void update(int key, int delta)
+        {
+            if (counts.empty()) {
+                counts.assign(1, 0);
+                offset = key;
+            }
+            else if (key < offset) {
+                // 向下扩展时多留一些余量，避免数据缓慢下移时每次都整体搬移
+                const int grow = std::max(offset - key, static_cast<int>(counts.size() / 2));
+                counts.insert(counts.begin(), static_cast<size_t>(grow), 0);
+                offset -= grow;
+            }
+            else if (key >= offset + static_cast<int>(counts.size())) {
+                counts.resize(static_cast<size_t>(key - offset) + 1, 0);
+            }
+
+            uint64_t& bucket = counts[static_cast<size_t>(key - offset)];
+            if (delta < 0 && bucket == 0) {
+                return;
+            }
+            bucket += delta;
+            total += delta;
+        }
+    };
+
+    void update(double value, int delta)
+    {
+        if (!std::isfinite(value)) {
+            return;
+        }
+        if (value > MIN_INDEXABLE) {
+            m_positive.update(keyOf(value), delta);
+        }
+        else if (value < -MIN_INDEXABLE) {
+            m_negative.update(keyOf(-value), delta);
+        }
+        else if (delta > 0 || m_zeroCount > 0) {
+            m_zeroCount += delta;
+        }
+    }
+
+    int keyOf(double magnitude) const
+    {
+        return static_cast<int>(std::ceil(std::log(magnitude) * m_inverseLogGamma));
+    }
+
+    /**
+     * @brief 桶(γ^(k-1), γ^k]的代表值，与两端的相对误差相同
+     */
+    double valueOf(int key) const
+    {
+        return 2.0 * std::pow(m_gamma, key) / (m_gamma + 1.0);
+    }
+
+    double m_gamma = 1.0;           ///< 相邻桶边界之比
+    double m_inverseLogGamma = 0.0; ///< 1/ln(γ)
+    BucketStore m_positive;         ///< 正数桶
+    BucketStore m_negative;         ///< 负数桶（按绝对值）
+    uint64_t m_zeroCount = 0;       ///< 接近0的值的计数
+};
+
+/**
+ * @brief 增量统计累加器
+ *
+ * 数据到达时逐个累加，查询不再遍历数据：
+ * - 平均值和方差用Welford算法，单遍且数值稳定；
+ * - 最小值、最大值用单调队列，按加入顺序淘汰最旧的值时均摊O(1)；
+ * - 中位数等分位数由QuantileSketch给出近似值。
+ *
+ * 除了追加，只支持按加入顺序删除最旧的值（removeOldest）。任意位置的删除、修改或重排后，
+ * 由调用者clear()后重新加入。Welford的删除会累积舍入误差，needsRebuild()为真时也应重新加入，
+ * 删除次数超过现有数量才需要一次，均摊仍为O(1)。
+ *
+ * 非有限值（NaN、无穷）被忽略。纯C++实现，非线程安全。
+ */
+class StreamingStatistics {
+public:
+    explicit StreamingStatistics(double relativeAccuracy = QuantileSketch::DEFAULT_RELATIVE_ACCURACY)
+        : m_sketch(relativeAccuracy)
+    {
+    }
+
+    void clear()
+    {
+        m_count = 0;
+        m_mean = 0.0;
+        m_m2 = 0.0;
+        m_minQueue.clear();
+        m_maxQueue.clear();
+        m_nextSequence = 0;
+        m_oldestSequence = 0;
+        m_removedSinceClear = 0;
+        m_sketch.clear();
+    }
+
+    /**
+     * @brief 加入一个值
+     */
+    void add(double value)
+    {
+        if (!std::isfinite(value)) {
+            return;
+        }
+
+        m_count++;
+        const double delta = value - m_mean;
+        m_mean += delta / static_cast<double>(m_count);
+        m_m2 += delta * (value - m_mean);
+
+        const uint64_t sequence = m_nextSequence++;
+        while (!m_minQueue.empty() && m_minQueue.back().value >= value) {
+            m_minQueue.pop_back();
+        }
+        m_minQueue.push_back({ sequence, value });
+        while (!m_maxQueue.empty() && m_maxQueue.back().value <= value) {
+            m_maxQueue.pop_back();
+        }
+        m_maxQueue.push_back({ sequence, value });
+
+        m_sketch.add(value);
+    }
+
+    /**
+     * @brief 删除最旧的值
+     * @param value 该值本身，必须与最早一次仍被计入的add()的参数相同
+     */
+    void removeOldest(double value)
+    {
+        if (!std::isfinite(value) || m_count == 0) {
+            return;
+        }
+
+        if (m_count == 1) {
+            clear();
+            return;
+        }
+
+        // Welford的逆运算
+        const double meanBefore = m_mean;
+        m_count--;
+        m_mean = (meanBefore * static_cast<double>(m_count + 1) - value) / static_cast<double>(m_count);
+        m_m2 = std::max(0.0, m_m2 - (value - meanBefore) * (value - m_mean));
+
+        const uint64_t sequence = m_oldestSequence++;
+        if (!m_minQueue.empty() && m_minQueue.front().sequence == sequence) {
+            m_minQueue.pop_front();
+        }
+        if (!m_maxQueue.empty() && m_maxQueue.front().sequence == sequence) {
+            m_maxQueue.pop_front();
+        }
+
+        m_sketch.remove(value);
+        m_removedSinceClear++;
+    }
+
+    /**
+     * @brief 删除累积的误差可能已不可忽略，应清空后重新加入
+     */
+    bool needsRebuild() const { return m_removedSinceClear > m_count; }
+
+    uint64_t count() const { return m_count; }
+    double mean() const { return m_mean; }
+    double min() const { return m_minQueue.empty() ? 0.0 : m_minQueue.front().value; }
+    double max() const { return m_maxQueue.empty() ? 0.0 : m_maxQueue.front().value; }
+
+    /**
+     * @brief 总体方差（除以n）
+     */
+    double variance() const { return m_count > 0 ? m_m2 / static_cast<double>(m_count) : 0.0; }
+    double standardDeviation() const { return std::sqrt(variance()); }
+
+    /**
+     * @brief 分位数的近似值，相对误差见QuantileSketch；限制在[min, max]内，数据只有一种值时是精确的
+     * @param q 分位(0-1)
+     */
+    double quantile(double q) const { return m_count > 0 ? std::clamp(m_sketch.quantile(q), min(), max()) : 0.0; }
+    double median() const { return quantile(0.5); }
+
+private:
+    /**
+     * @brief 单调队列中的值和它的加入序号
+     */
+    struct QueuedValue {
+        uint64_t sequence;  ///< 加入序号
+        double value;       ///< 值
+    };
+
+    uint64_t m_count = 0;                   ///< 值的数量
+    double m_mean = 0.0;                    ///< 平均值
+    double m_m2 = 0.0;                      ///< 与平均值之差的平方和
+    std::deque<QueuedValue> m_minQueue;     ///< 单调递增队列，队首为最小值
+    std::deque<QueuedValue> m_maxQueue;     ///< 单调递减队列，队首为最大值
+    uint64_t m_nextSequence = 0;            ///< 下一个加入的值的序号
+    uint64_t m_oldestSequence = 0;          ///< 最旧的值的序号
+    uint64_t m_removedSinceClear = 0;       ///< 上次清空后的删除次数
+    QuantileSketch m_sketch;                ///< 分位数草图
+};
@@ -0,0 +1,235 @@
+﻿// Source/Analysis/TimestampColumn.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <xmmintrin.h>
+
+/**
+ * @brief 按时间戳有序的连续时间戳列
+ *
+ * 与索引条目数组一一对应（第i项为第i个条目的时间戳），以连续的uint64_t数组代替红黑树映射。
+ * 查找使用Eytzinger（BFS）布局的副本：前几层节点集中在少数缓存行内，
+ * 比在大结构体数组上做二分查找的缓存命中率高得多。
+ *
+ * 树节点对应的有序位置由节点编号直接算出，不另存位置表，查找结束时少一次随机访存。
+ *
+ * 追加只写入有序列，Eytzinger副本延迟重建：未覆盖的尾部用普通二分查找，
+ * 尾部超过已建树规模的1/8时才整体重建，追加的均摊开销为O(1)。
+ *
+ * 纯C++实现，不依赖Qt；非线程安全，由调用者加锁。
+ * 调用freeze()后不再追加时，const查找不修改任何成员，可被多个线程同时调用。
+ */
+class TimestampColumn {
+public:
+    /**
+     * @brief 清空所有数据
+     */
+    void clear()
+    {
+        m_sorted.clear();
+        m_tree.clear();
+        m_treeSize = 0;
+        m_outOfOrder = 0;
+    }
+
+    /**
+     * @brief 预留固定容量
+     * @param capacity 容量
+     */
+    void reserve(size_t capacity)
+    {
+        m_sorted.reserve(capacity);
+    }
+
+    /**
+     * @brief 为批量追加预留空间（按倍数增长，避免逐批精确扩容导致的反复拷贝）
+     * @param additional 即将追加的数量
+     */
+    void reserveForAppend(size_t additional)
+    {
+        size_t required = m_sorted.size() + additional;
+        if (required > m_sorted.capacity()) {
+            m_sorted.reserve(std::max(required, m_sorted.capacity() * 2));
+        }
+    }
+
+    /**
+     * @brief 追加时间戳
+     * @param timestamp 时间戳，应不小于已有的最后一个值
+     */
+    void append(uint64_t timestamp)
+    {
+        if (!m_sorted.empty() && timestamp < m_sorted.back()) {
+            m_outOfOrder++;
+        }
+        m_sorted.push_back(timestamp);
+    }
+
+    /**
+     * @brief 立即为全部内容建立查找树，之后的只读查找不再触发重建
+     */
+    void freeze()
+    {
+        rebuildTree();
+    }
+
+    size_t size() const { return m_sorted.size(); }
+    bool empty() const { return m_sorted.empty(); }
+    uint64_t at(size_t pos) const { return m_sorted[pos]; }
+    const uint64_t* data() const { return m_sorted.data(); }
+
+    /**
+     * @brief 乱序追加的次数，非零时查找结果不可靠
+     */
+    size_t outOfOrderCount() const { return m_outOfOrder; }
+
+    /**
+     * @brief 首个不小于timestamp的位置
+     * @return 位置，全部小于timestamp时返回size()
+     */
+    size_t lowerBound(uint64_t timestamp) const
+    {
+        return search(timestamp, false);
+    }
+
+    /**
+     * @brief 首个大于timestamp的位置
+     * @return 位置，全部不大于timestamp时返回size()
+     */
+    size_t upperBound(uint64_t timestamp) const
+    {
+        return search(timestamp, true);
+    }
+
+    /**
+     * @brief 时间戳最接近timestamp的位置，距离相等时取较晚的一个
+     * @return 位置，列为空时返回size()
+     */
+    size_t closest(uint64_t timestamp) const
+    {
+        const size_t count = m_sorted.size();
+        if (count == 0) {
+            return 0;
+        }
+
+        size_t pos = lowerBound(timestamp);
+        if (pos >= count) {
+            return count - 1;
+        }
+        if (pos == 0 || m_sorted[pos] == timestamp) {
+            return pos;
+        }
+
+        uint64_t diffLeft = timestamp - m_sorted[pos - 1];
+        uint64_t diffRight = m_sorted[pos] - timestamp;
+        return diffLeft < diffRight ? pos - 1 : pos;
+    }
+
+private:
+    static constexpr size_t MIN_UNTREED_TAIL = 4096;   // 尾部小于此值时不重建
+    static constexpr size_t PREFETCH_STRIDE = 8;        // 预取距离（节点编号倍数）
+
+    /**
+     * @brief 在有序列中查找边界位置
+     * @param timestamp 目标时间戳
+     * @param upper true查找首个大于的位置，false查找首个不小于的位置
+     */
+    size_t search(uint64_t timestamp, bool upper) const
+    {
+        const size_t count = m_sorted.size();
+        if (count == 0) {
+            return 0;
+        }
+
+        size_t tail = count - m_treeSize;
+        if (tail > MIN_UNTREED_TAIL && tail > m_treeSize / 8) {
+            rebuildTree();
+        }
+
+        // 目标落在尚未建树的尾部时直接二分尾部
+        if (m_treeSize == 0 ||
+            (upper ? timestamp >= m_sorted[m_treeSize - 1] : timestamp > m_sorted[m_treeSize - 1])) {
+            auto first = m_sorted.begin() + m_treeSize;
+            auto it = upper ? std::upper_bound(first, m_sorted.end(), timestamp)
+                : std::lower_bound(first, m_sorted.end(), timestamp);
+            return static_cast<size_t>(it - m_sorted.begin());
+        }
+
+        // Eytzinger下降：每层只访问一个节点，分支由比较结果直接算出
+        const uint64_t* tree = m_tree.data();
+        size_t k = 1;
+        while (k <= m_treeSize) {
+            // 预取三层之后的节点：8个连续的后代正好占一个缓存行
+            _mm_prefetch(reinterpret_cast<const char*>(tree + std::min(k * PREFETCH_STRIDE, m_treeSize)), _MM_HINT_T0);
+            uint64_t value = tree[k];
+            k = 2 * k + (upper ? (value <= timestamp) : (value < timestamp));
+        }
+
+        // 去掉末尾连续的"向右"步，得到最后一次"向左"的节点
+        k >>= countTrailingOnes(k) + 1;
+        return k == 0 ? m_treeSize : treeRank(k);
+    }
+
+    /**
+     * @brief 树节点k在有序列中的位置
+     *
+     * 先按满二叉树计算中序位置，再减去最底层缺失的叶子中排在它前面的个数；
+     * 满二叉树中最底层叶子占据偶数位置，实际存在的是最左边的若干个。
+     */
+    size_t treeRank(size_t k) const
+    {
+        const int levels = std::bit_width(m_treeSize);
+        const int depth = std::bit_width(k) - 1;
+        size_t rank = ((2 * k + 1) << (levels - 1 - depth)) - (size_t(1) << levels) - 1;
+
+        const size_t bottomLeaves = m_treeSize - ((size_t(1) << (levels - 1)) - 1);
+        if (rank > 2 * bottomLeaves) {
+            rank -= (rank - 2 * bottomLeaves + 1) / 2;
+        }
+        return rank;
+    }
+
+    /**
+     * @brief 用有序列当前内容重建Eytzinger副本
+     */
+    void rebuildTree() const
+    {
+        m_treeSize = m_sorted.size();
+        m_tree.assign(m_treeSize + 1, 0);
+
+        // 中序遍历隐式完全二叉树，依次填入有序值
+        size_t next = 0;
+        size_t k = 1;
+        while (true) {
+            while (k <= m_treeSize) {
+                k *= 2;
+            }
+            k >>= countTrailingOnes(k) + 1;
+            if (k == 0) {
+                break;
+            }
+            m_tree[k] = m_sorted[next];
+            next++;
+            k = 2 * k + 1;
+        }
+    }
+
+    static int countTrailingOnes(size_t value)
+    {
+        int count = 0;
+        while (value & 1) {
+            value >>= 1;
+            count++;
+        }
+        return count;
+    }
+
+    std::vector<uint64_t> m_sorted;             ///< 按条目顺序存放的时间戳
+    mutable std::vector<uint64_t> m_tree;       ///< Eytzinger布局副本，下标从1开始
+    mutable size_t m_treeSize = 0;              ///< 已建树覆盖的前缀长度
+    size_t m_outOfOrder = 0;                    ///< 乱序追加次数
+};
@@ -0,0 +1,270 @@
+﻿// Source/Analysis/VideoFramePipeline.cpp
+#include "VideoFramePipeline.h"
+#include "DataAccessService.h"
+#include "RgbScanlineDecoder.h"
+#include "BayerDemosaic.h"
+#include "Logger.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
+#include <algorithm>
+
+VideoFramePipeline::VideoFramePipeline(QObject* parent)
+    : QObject(parent)
+    , m_bufferPool(DEFAULT_AHEAD_FRAMES)
+    , m_dataService(&DataAccessService::getInstance())
+{
+    m_decodePool.setMaxThreadCount(MAX_PARALLEL_DECODES);
+}
+
+VideoFramePipeline::~VideoFramePipeline()
+{
+    m_queue.clear();
+    m_decodePool.clear();
+    m_decodePool.waitForDone();
+}
+
+void VideoFramePipeline::setFrames(const VideoFrameView& entries)
+{
+    m_entries = entries;
+    m_currentIndex = -1;
+    invalidate();
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("视频预解码帧列表更新，帧数: %1").arg(entries.size()));
+}
+
+bool VideoFramePipeline::setDecodeParameters(const VideoDecodeParameters& parameters)
+{
+    if (parameters == m_parameters) {
+        return false;
+    }
+
+    m_parameters = parameters;
+    invalidate();
+    updateWindow();
+    return true;
+}
+
+void VideoFramePipeline::setWindow(int aheadFrames, int behindFrames)
+{
+    m_aheadFrames = std::max(0, aheadFrames);
+    m_behindFrames = std::max(0, behindFrames);
+    updateWindow();
+}
+
+void VideoFramePipeline::setCurrentFrame(int index, int direction)
+{
+    if (index < 0 || index >= frameCount()) {
+        return;
+    }
+
+    m_currentIndex = index;
+    m_direction = direction < 0 ? -1 : 1;
+    updateWindow();
+    emit signal_VD_PIPE_statisticsChanged(readyAhead(), m_averageDecodeMs);
+}
+
+int VideoFramePipeline::readyAhead() const
+{
+    if (m_currentIndex < 0) {
+        return 0;
+    }
+
+    int count = 0;
+    for (int step = 1; step <= m_aheadFrames && step < frameCount(); ++step) {
+        if (!m_frames.contains(wrapIndex(m_currentIndex + m_direction * step))) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+void VideoFramePipeline::invalidate()
+{
+    // 已在解码的任务无法取消，结果回来时按代数丢弃
+    m_generation++;
+    m_frames.clear();
+    m_queue.clear();
+    m_window.clear();
+    m_decoding.clear();
+    m_failures.clear();
+}
+
+void VideoFramePipeline::updateWindow()
+{
+    m_queue.clear();
+    m_window.clear();
+    if (m_currentIndex < 0 || frameCount() == 0) {
+        return;
+    }
+
+    // 当前帧优先，然后是播放方向的帧，最后是反方向的帧
+    QList<int> order;
+    order.append(m_currentIndex);
+    for (int step = 1; step <= m_aheadFrames; ++step) {
+        order.append(wrapIndex(m_currentIndex + m_direction * step));
+    }
+    for (int step = 1; step <= m_behindFrames; ++step) {
+        order.append(wrapIndex(m_currentIndex - m_direction * step));
+    }
+
+    for (int index : order) {
+        if (m_window.contains(index)) {
+            continue;
+        }
+        m_window.insert(index);
+        if (!m_frames.contains(index) && !m_decoding.contains(index)) {
+            m_queue.append(index);
+        }
+    }
+
+    for (auto it = m_frames.begin(); it != m_frames.end();) {
+        it = m_window.contains(it.key()) ? std::next(it) : m_frames.erase(it);
+    }
+    for (auto it = m_failures.begin(); it != m_failures.end();) {
+        it = m_window.contains(it.key()) ? std::next(it) : m_failures.erase(it);
+    }
+
+    startQueuedDecodes();
+}
+
+void VideoFramePipeline::startQueuedDecodes()
+{
+    while (!m_queue.isEmpty() && m_decoding.size() < MAX_PARALLEL_DECODES) {
+        const int index = m_queue.takeFirst();
+        const PacketIndexEntry entry = m_entries.at(index);
+        const VideoDecodeParameters parameters = m_parameters;
+        const quint64 generation = m_generation;
+        DataAccessService* service = m_dataService;
+        FrameBufferPool* bufferPool = &m_bufferPool;
+
+        m_decoding.insert(index);
+        QtConcurrent::run(&m_decodePool, [this, service, bufferPool, entry, parameters, generation, index]() {
+            QElapsedTimer timer;
+            timer.start();
+            QImage image;
+            const QByteArray data = service->readPacketData(entry);
+            if (!data.isEmpty()) {
+                image = decodeFrame(data, parameters, bufferPool);
+            }
+            const double elapsedMs = timer.nsecsElapsed() / 1.0e6;
+
+            // 图像随排队调用移交给界面线程，不复制像素
+            QMetaObject::invokeMethod(this, [this, generation, index, image = std::move(image), elapsedMs]() mutable {
+                finishDecode(generation, index, std::move(image), elapsedMs);
+                }, Qt::QueuedConnection);
+            });
+    }
+}
+
+void VideoFramePipeline::finishDecode(quint64 generation, int index, QImage image, double elapsedMs)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    m_decoding.remove(index);
+
+    if (image.isNull()) {
+        const int failures = ++m_failures[index];
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧%1读取或解码失败，第%2次").arg(index).arg(failures));
+
+        // 解码期间窗口可能已经移走
+        if (m_window.contains(index)) {
+            if (failures <= MAX_DECODE_RETRIES) {
+                m_queue.prepend(index);
+            }
+            else {
+                // 不再重试，以黑色图像就绪，回放可以越过这一帧
+                m_frames.insert(index, placeholderFrame());
+                emit signal_VD_PIPE_frameReady(index);
+                emit signal_VD_PIPE_statisticsChanged(readyAhead(), m_averageDecodeMs);
+            }
+        }
+    }
+    else {
+        m_failures.remove(index);
+        m_lastDecodeMs = elapsedMs;
+        m_averageDecodeMs = m_averageDecodeMs == 0.0 ? elapsedMs
+            : m_averageDecodeMs + DECODE_TIME_SMOOTHING * (elapsedMs - m_averageDecodeMs);
+
+        // 解码期间窗口可能已经移走
+        if (m_window.contains(index)) {
+            m_frames.insert(index, std::move(image));
+            emit signal_VD_PIPE_frameReady(index);
+        }
+        emit signal_VD_PIPE_statisticsChanged(readyAhead(), m_averageDecodeMs);
+    }
+
+    startQueuedDecodes();
+}
+
+QImage VideoFramePipeline::placeholderFrame() const
+{
+    QImage image(std::max(1, m_parameters.width), std::max(1, m_parameters.height), QImage::Format_RGB888);
+    image.fill(Qt::black);
+    return image;
+}
+
+int VideoFramePipeline::wrapIndex(int index) const
+{
+    const int count = frameCount();
+    return count > 0 ? ((index % count) + count) % count : 0;
+}
+
+QImage VideoFramePipeline::decodeFrame(const QByteArray& data, const VideoDecodeParameters& parameters,
+    FrameBufferPool* bufferPool)
+{
+    if (parameters.width <= 0 || parameters.height <= 0) {
+        return QImage();
+    }
+
+    QImage image = bufferPool ? bufferPool->acquire(parameters.width, parameters.height, QImage::Format_RGB888)
+        : QImage(parameters.width, parameters.height, QImage::Format_RGB888);
+
+    // 根据色彩模式确定每行字节数，36/30/18位按位压缩计算；去马赛克时按RAW位数计算
+    const RgbScanlineDecoder decoder(parameters.colorMode, parameters.colorArrangement);
+    const BayerDemosaic demosaic(parameters.rawBits, parameters.bayerPattern,
+        parameters.demosaicMethod == 2 ? BayerDemosaic::METHOD_EDGE_AWARE : BayerDemosaic::METHOD_BILINEAR,
+        parameters.toneMap && parameters.demosaicEnabled());
+    const bool useDemosaic = parameters.demosaicEnabled() && BayerDemosaic::supports(parameters.width, parameters.height);
+    const size_t srcStride = useDemosaic ? demosaic.rowBytes(parameters.width) : decoder.rowBytes(parameters.width);
+
+    // 检查数据量是否足够
+    const qint64 requiredBytes = static_cast<qint64>(srcStride) * parameters.height;
+    if (data.size() < requiredBytes) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("数据量不足以填充完整图像: 需要%1字节，实际%2字节")
+            .arg(requiredBytes).arg(data.size()));
+
+        // 用黑色填充的图像
+        image.fill(Qt::black);
+        return image;
+    }
+
+    // 按行带分给线程池，各行带写入扫描线的不同区域，无需同步
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(data.constData());
+    const size_t dstStride = static_cast<size_t>(image.bytesPerLine());
+    uint8_t* dst = image.bits();
+    const int width = parameters.width;
+    const int height = parameters.height;
+
+    QVector<int> bandStarts;
+    for (int row = 0; row < height; row += DECODE_BAND_ROWS) {
+        bandStarts.append(row);
+    }
+
+    QtConcurrent::blockingMap(bandStarts, [&](int firstRow) {
+        const int rowCount = std::min(DECODE_BAND_ROWS, height - firstRow);
+        if (useDemosaic) {
+            // 行带边界的光晕行直接读相邻行带的源数据，工作缓冲每个线程一份
+            thread_local BayerDemosaic::Workspace workspace;
+            demosaic.decodeRows(src, srcStride, width, height, firstRow, rowCount, dst, dstStride, workspace);
+        }
+        else {
+            decoder.decodeRows(src + firstRow * srcStride, srcStride,
+                dst + firstRow * dstStride, dstStride, width, rowCount);
+        }
+        });
+
+    return image;
+}
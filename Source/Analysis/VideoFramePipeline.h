@@ -0,0 +1,199 @@
+﻿// Source/Analysis/VideoFramePipeline.h
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QSet>
+#include <QVector>
+#include <QThreadPool>
+#include "VideoFrameTable.h"
+#include "FrameBufferPool.h"
+
+class DataAccessService;
+
+/**
+ * @brief 视频帧解码参数
+ */
+struct VideoDecodeParameters {
+    int width = 0;                  ///< 图像宽度
+    int height = 0;                 ///< 图像高度
+    int colorMode = 0;              ///< 色彩模式，见RgbScanlineDecoder::ColorMode
+    int colorArrangement = 0;       ///< 色彩排布
+    int rawBits = 0;                ///< RAW位数（8/10/12），非RAW格式为0
+    int demosaicMethod = 0;         ///< 去马赛克方法：0关闭，1双线性，2边缘自适应
+    int bayerPattern = 0;           ///< 拜耳排列，见BayerDemosaic::Pattern
+    bool toneMap = false;           ///< 去马赛克后做gamma色调映射
+
+    /**
+     * @brief 是否按拜耳RAW去马赛克，否则按色彩模式解码
+     */
+    bool demosaicEnabled() const { return rawBits != 0 && demosaicMethod > 0; }
+
+    bool operator==(const VideoDecodeParameters& other) const
+    {
+        return width == other.width && height == other.height
+            && colorMode == other.colorMode && colorArrangement == other.colorArrangement
+            && rawBits == other.rawBits && demosaicMethod == other.demosaicMethod
+            && bayerPattern == other.bayerPattern && toneMap == other.toneMap;
+    }
+    bool operator!=(const VideoDecodeParameters& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 视频回放的预解码流水线
+ *
+ * 以当前帧为中心维护一个解码窗口：播放方向预解码aheadFrames帧，反方向保留behindFrames帧，
+ * 读取和解码在后台线程池中完成，界面线程只取已就绪的QImage显示，不再等待磁盘和解码。
+ * 窗口随当前帧移动，移出窗口的图像被释放，排队但已不在窗口内的请求被取消；
+ * 帧列表或解码参数变化时整体作废，之前发出的任务结果按代数丢弃。
+ * 读取或解码失败的帧重试MAX_DECODE_RETRIES次，仍失败时以黑色图像就绪，回放不会停在这一帧。
+ *
+ * 解码结果使用FrameBufferPool中的像素缓冲，图像离开窗口并且不再显示后缓冲回到池中复用。
+ *
+ * 除后台任务外，所有接口都只在界面线程调用，结果通过排队调用回到界面线程，缓存不需要加锁。
+ */
+class VideoFramePipeline : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_AHEAD_FRAMES = 8;      ///< 默认播放方向预解码帧数
+    static constexpr int DEFAULT_BEHIND_FRAMES = 3;     ///< 默认反方向保留帧数
+    static constexpr int MAX_PARALLEL_DECODES = 2;      ///< 同时进行的解码数
+
+    explicit VideoFramePipeline(QObject* parent = nullptr);
+    ~VideoFramePipeline();
+
+    /**
+     * @brief 设置帧列表，丢弃全部已解码图像
+     */
+    void setFrames(const VideoFrameView& entries);
+
+    /**
+     * @brief 设置解码参数
+     * @return 参数有变化时为true，此时已解码图像全部作废，当前窗口重新解码
+     */
+    bool setDecodeParameters(const VideoDecodeParameters& parameters);
+
+    /**
+     * @brief 设置窗口大小
+     * @param aheadFrames 播放方向预解码帧数
+     * @param behindFrames 反方向保留帧数
+     */
+    void setWindow(int aheadFrames, int behindFrames);
+
+    /**
+     * @brief 移动当前帧，按新窗口排队解码
+     * @param index 当前帧序号
+     * @param direction 播放方向，1为向后，-1为向前
+     */
+    void setCurrentFrame(int index, int direction = 1);
+
+    /**
+     * @brief 获取已解码的帧
+     * @return 帧图像，尚未就绪时为空
+     */
+    QImage frame(int index) const { return m_frames.value(index); }
+
+    bool isReady(int index) const { return m_frames.contains(index); }
+    int frameCount() const { return static_cast<int>(m_entries.size()); }
+
+    /**
+     * @brief 当前帧之后（按播放方向）连续就绪的帧数，即队列深度
+     */
+    int readyAhead() const;
+
+    /**
+     * @brief 单帧读取加解码耗时的滑动平均（毫秒）
+     */
+    double averageDecodeMs() const { return m_averageDecodeMs; }
+
+    /**
+     * @brief 最近一帧的读取加解码耗时（毫秒）
+     */
+    double lastDecodeMs() const { return m_lastDecodeMs; }
+
+    /**
+     * @brief 解码使用的像素缓冲池
+     */
+    FrameBufferPool* bufferPool() { return &m_bufferPool; }
+
+    /**
+     * @brief 把一帧原始数据解码为图像，可在任意线程调用
+     *
+     * 行按行带分给全局线程池，由RgbScanlineDecoder（或启用去马赛克时由BayerDemosaic）直接写入scanLine()。
+     * @param bufferPool 像素缓冲池，为空时新分配图像
+     * @return 解码后的图像；数据不足一帧时为黑色图像，参数无效时为空
+     */
+    static QImage decodeFrame(const QByteArray& data, const VideoDecodeParameters& parameters,
+        FrameBufferPool* bufferPool = nullptr);
+
+signals:
+    /**
+     * @brief 帧解码完成信号
+     * @param index 帧序号
+     */
+    void signal_VD_PIPE_frameReady(int index);
+
+    /**
+     * @brief 队列深度或解码耗时变化信号
+     * @param readyAhead 当前帧之后连续就绪的帧数
+     * @param averageDecodeMs 单帧平均耗时（毫秒）
+     */
+    void signal_VD_PIPE_statisticsChanged(int readyAhead, double averageDecodeMs);
+
+private:
+    static constexpr int DECODE_BAND_ROWS = 64;             ///< 并行解码时每个行带的行数
+    static constexpr double DECODE_TIME_SMOOTHING = 0.2;    ///< 耗时滑动平均的新样本权重
+    static constexpr int MAX_DECODE_RETRIES = 2;            ///< 失败的帧重新解码的次数
+
+    /**
+     * @brief 作废全部图像和未完成的请求
+     */
+    void invalidate();
+
+    /**
+     * @brief 按当前帧和方向重建队列，释放窗口外的图像
+     */
+    void updateWindow();
+
+    /**
+     * @brief 从队列中启动解码，直到达到并发上限
+     */
+    void startQueuedDecodes();
+
+    /**
+     * @brief 后台解码完成，在界面线程中执行
+     */
+    void finishDecode(quint64 generation, int index, QImage image, double elapsedMs);
+
+    /**
+     * @brief 读取或解码失败时代替帧图像的黑色图像
+     */
+    QImage placeholderFrame() const;
+
+    /**
+     * @brief 帧序号按帧数循环，回放到末尾时从头继续
+     */
+    int wrapIndex(int index) const;
+
+    VideoFrameView m_entries;                   ///< 帧列表
+    VideoDecodeParameters m_parameters;         ///< 解码参数
+    FrameBufferPool m_bufferPool;               ///< 像素缓冲池
+    QHash<int, QImage> m_frames;                ///< 已解码的帧
+    QList<int> m_queue;                         ///< 等待解码的帧，按优先级排列
+    QSet<int> m_window;                         ///< 当前窗口内的帧
+    QSet<int> m_decoding;                       ///< 正在解码的帧
+    QHash<int, int> m_failures;                 ///< 窗口内各帧已失败的次数
+    QThreadPool m_decodePool;                   ///< 解码线程池
+    DataAccessService* m_dataService;           ///< 数据访问服务
+
+    quint64 m_generation = 0;                   ///< 作废计数，丢弃作废前发出的解码结果
+    int m_currentIndex = -1;                    ///< 当前帧
+    int m_direction = 1;                        ///< 播放方向
+    int m_aheadFrames = DEFAULT_AHEAD_FRAMES;   ///< 播放方向预解码帧数
+    int m_behindFrames = DEFAULT_BEHIND_FRAMES; ///< 反方向保留帧数
+    double m_averageDecodeMs = 0.0;             ///< 平均耗时
+    double m_lastDecodeMs = 0.0;                ///< 最近耗时
+};
@@ -0,0 +1,304 @@
+﻿// Source/Analysis/VideoFrameTable.cpp
+#include "VideoFrameTable.h"
+#include "Logger.h"
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QHash>
+#include <algorithm>
+
+namespace {
+    constexpr quint32 TABLE_MAGIC = 0x31544656;     // "VFT1"
+    constexpr quint32 TABLE_VERSION = 1;
+
+    static_assert(sizeof(VideoFrameTable::Frame) == 24, "帧记录按原始字节保存，布局不能改变");
+}
+
+std::shared_ptr<const VideoFrameTable> VideoFrameTable::build(const IndexSnapshot& snapshot)
+{
+    std::shared_ptr<VideoFrameTable> table(new VideoFrameTable());
+    if (!table->appendEntries(snapshot, 0)) {
+        return nullptr;
+    }
+    table->refreshFileSizes();
+    table->groupByCommandType();
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("视频帧表已建立: %1个数据包，%2个文件").arg(snapshot.size()).arg(table->m_files.size()));
+    return table;
+}
+
+std::shared_ptr<const VideoFrameTable> VideoFrameTable::extend(const VideoFrameTable& base, const IndexSnapshot& snapshot)
+{
+    const int baseCount = base.sourceCount();
+    if (snapshot.size() < baseCount) {
+        return build(snapshot);
+    }
+
+    // 旧记录按时间顺序取回，不再访问索引条目和文件名
+    std::shared_ptr<VideoFrameTable> table(new VideoFrameTable());
+    table->m_files = base.m_files;
+    table->m_frames.resize(static_cast<size_t>(baseCount));
+    for (int i = 0; i < baseCount; ++i) {
+        table->m_frames[static_cast<size_t>(i)] = base.m_frames[base.m_timeOrder[static_cast<size_t>(i)]];
+    }
+
+    if (!table->appendEntries(snapshot, baseCount)) {
+        return nullptr;
+    }
+    table->refreshFileSizes();
+    table->groupByCommandType();
+    return table;
+}
+
+bool VideoFrameTable::appendEntries(const IndexSnapshot& snapshot, int first)
+{
+    const int count = snapshot.size();
+    m_frames.resize(static_cast<size_t>(count));
+
+    QHash<QString, int> fileIds;
+    for (int i = 0; i < m_files.size(); ++i) {
+        fileIds.insert(m_files[i], i);
+    }
+
+    // 相邻条目几乎总在同一文件中，先和上一个文件名比较，不同时才查表
+    QString lastFile;
+    int lastFileId = -1;
+    for (int i = first; i < count; ++i) {
+        const PacketIndexEntry& entry = snapshot.at(i);
+        if (lastFileId < 0 || entry.fileName != lastFile) {
+            auto it = fileIds.find(entry.fileName);
+            if (it == fileIds.end()) {
+                if (m_files.size() > UINT16_MAX) {
+                    LOG_WARN(LocalQTCompat::fromLocal8Bit("采集文件数超过%1，无法建立视频帧表").arg(UINT16_MAX + 1));
+                    return false;
+                }
+                it = fileIds.insert(entry.fileName, static_cast<int>(m_files.size()));
+                m_files.append(entry.fileName);
+            }
+            lastFile = entry.fileName;
+            lastFileId = it.value();
+        }
+
+        Frame& frame = m_frames[static_cast<size_t>(i)];
+        frame.timestamp = entry.timestamp;
+        frame.fileOffset = entry.fileOffset;
+        frame.size = entry.size;
+        frame.fileId = static_cast<uint16_t>(lastFileId);
+        frame.commandType = entry.commandType;
+        frame.flags = entry.isValidHeader ? FLAG_VALID_HEADER : 0;
+    }
+    return true;
+}
+
+void VideoFrameTable::refreshFileSizes()
+{
+    m_fileSizes.clear();
+    for (const QString& file : m_files) {
+        const QFileInfo info(file);
+        m_fileSizes.append(info.exists() ? info.size() : -1);
+    }
+}
+
+void VideoFrameTable::groupByCommandType()
+{
+    // 计数排序：稳定，组内保持原来的时间顺序
+    m_typeOffsets.fill(0);
+    for (const Frame& frame : m_frames) {
+        m_typeOffsets[frame.commandType + 1]++;
+    }
+    for (int type = 0; type < 256; ++type) {
+        m_typeOffsets[type + 1] += m_typeOffsets[type];
+    }
+
+    std::array<uint32_t, 256> cursor;
+    std::copy(m_typeOffsets.begin(), m_typeOffsets.begin() + 256, cursor.begin());
+
+    std::vector<Frame> grouped(m_frames.size());
+    m_timeOrder.resize(m_frames.size());
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        const uint32_t slot = cursor[m_frames[i].commandType]++;
+        grouped[slot] = m_frames[i];
+        m_timeOrder[i] = slot;
+    }
+    m_frames.swap(grouped);
+}
+
+int VideoFrameTable::frameCount(int commandType) const
+{
+    if (commandType == ALL_COMMAND_TYPES) {
+        return static_cast<int>(m_frames.size());
+    }
+    if (commandType < 0 || commandType > 255) {
+        return 0;
+    }
+    return static_cast<int>(m_typeOffsets[commandType + 1] - m_typeOffsets[commandType]);
+}
+
+int VideoFrameTable::lowerBound(int commandType, uint64_t timestamp) const
+{
+    int low = 0;
+    int high = frameCount(commandType);
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (frame(commandType, mid).timestamp < timestamp) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int VideoFrameTable::upperBound(int commandType, uint64_t timestamp) const
+{
+    int low = 0;
+    int high = frameCount(commandType);
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (frame(commandType, mid).timestamp <= timestamp) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+PacketIndexEntry VideoFrameTable::toEntry(const Frame& frame) const
+{
+    PacketIndexEntry entry{};
+    entry.timestamp = frame.timestamp;
+    entry.fileOffset = frame.fileOffset;
+    entry.size = frame.size;
+    entry.fileName = m_files[frame.fileId];
+    entry.commandType = frame.commandType;
+    entry.isValidHeader = (frame.flags & FLAG_VALID_HEADER) != 0;
+    return entry;
+}
+
+bool VideoFrameTable::save(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("无法写入视频帧表: %1").arg(path));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << TABLE_MAGIC << TABLE_VERSION;
+    stream << static_cast<qint32>(m_files.size());
+    for (int i = 0; i < m_files.size(); ++i) {
+        stream << m_files[i] << m_fileSizes[i];
+    }
+
+    // 记录和映射按原始字节写入，读取时直接拷回
+    stream << static_cast<quint32>(m_frames.size());
+    stream.writeRawData(reinterpret_cast<const char*>(m_frames.data()), static_cast<int>(m_frames.size() * sizeof(Frame)));
+    stream.writeRawData(reinterpret_cast<const char*>(m_typeOffsets.data()), static_cast<int>(sizeof(m_typeOffsets)));
+    stream.writeRawData(reinterpret_cast<const char*>(m_timeOrder.data()), static_cast<int>(m_timeOrder.size() * sizeof(uint32_t)));
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("保存视频帧表失败: %1").arg(path));
+        return false;
+    }
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("视频帧表已保存: %1").arg(path));
+    return true;
+}
+
+std::shared_ptr<const VideoFrameTable> VideoFrameTable::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 fileCount = 0;
+    stream >> magic >> version >> fileCount;
+    if (magic != TABLE_MAGIC || version != TABLE_VERSION || fileCount < 0 || fileCount > UINT16_MAX + 1) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧表格式不符: %1").arg(path));
+        return nullptr;
+    }
+
+    std::shared_ptr<VideoFrameTable> table(new VideoFrameTable());
+    for (qint32 i = 0; i < fileCount; ++i) {
+        QString name;
+        qint64 size = 0;
+        stream >> name >> size;
+
+        // 采集文件被改写或仍在增长时，表中的偏移不再可信
+        const QFileInfo info(name);
+        if (!info.exists() || info.size() != size) {
+            LOG_INFO(LocalQTCompat::fromLocal8Bit("视频帧表已过期，采集文件有变化: %1").arg(name));
+            return nullptr;
+        }
+        table->m_files.append(name);
+        table->m_fileSizes.append(size);
+    }
+
+    quint32 frameCount = 0;
+    stream >> frameCount;
+    const qint64 expectedBytes = static_cast<qint64>(frameCount) * (sizeof(Frame) + sizeof(uint32_t)) + sizeof(m_typeOffsets);
+    if (stream.status() != QDataStream::Ok || file.size() - file.pos() != expectedBytes) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧表长度不符: %1").arg(path));
+        return nullptr;
+    }
+
+    table->m_frames.resize(frameCount);
+    table->m_timeOrder.resize(frameCount);
+    stream.readRawData(reinterpret_cast<char*>(table->m_frames.data()), static_cast<int>(frameCount * sizeof(Frame)));
+    stream.readRawData(reinterpret_cast<char*>(table->m_typeOffsets.data()), static_cast<int>(sizeof(m_typeOffsets)));
+    stream.readRawData(reinterpret_cast<char*>(table->m_timeOrder.data()), static_cast<int>(frameCount * sizeof(uint32_t)));
+    if (stream.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+
+    // 校验分组边界和文件号，防止损坏的文件造成越界访问
+    if (table->m_typeOffsets[0] != 0 || table->m_typeOffsets[256] != frameCount
+        || !std::is_sorted(table->m_typeOffsets.begin(), table->m_typeOffsets.end())) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧表已损坏: %1").arg(path));
+        return nullptr;
+    }
+    for (const Frame& frame : table->m_frames) {
+        if (frame.fileId >= table->m_files.size()) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧表已损坏: %1").arg(path));
+            return nullptr;
+        }
+    }
+    for (uint32_t slot : table->m_timeOrder) {
+        if (slot >= frameCount) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("视频帧表已损坏: %1").arg(path));
+            return nullptr;
+        }
+    }
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("视频帧表已读取: %1，%2个数据包").arg(path).arg(frameCount));
+    return table;
+}
+
+VideoFrameView::VideoFrameView(std::shared_ptr<const VideoFrameTable> table, int commandType,
+    uint64_t startTime, uint64_t endTime, int limit)
+    : m_table(std::move(table))
+    , m_commandType(commandType)
+{
+    if (!m_table || startTime > endTime) {
+        return;
+    }
+
+    m_first = m_table->lowerBound(m_commandType, startTime);
+    m_count = m_table->upperBound(m_commandType, endTime) - m_first;
+    if (limit >= 0 && m_count > limit) {
+        m_count = limit;
+    }
+}
@@ -0,0 +1,182 @@
+﻿// Source/Analysis/VideoFrameTable.h
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <array>
+#include <memory>
+#include <vector>
+#include "IndexGenerator.h"
+
+/**
+ * @brief 视频帧定位表
+ *
+ * 每次采集建立一次：把索引中的全部数据包压缩为定长记录（时间戳、文件偏移、大小、文件号、指令类型），
+ * 按指令类型分组存放，组内保持时间顺序，另存一份全体数据包按时间顺序到记录位置的映射。
+ * 于是“某指令类型的第N帧”是一次数组访问，按时间范围筛选是一次二分查找，
+ * 切换筛选条件不再查询和复制索引条目。
+ *
+ * 表建成后只读，通过shared_ptr在界面线程和解码线程之间共享。
+ * 采集进行中索引不断增长，用extend()在旧表上只转换新增条目；
+ * 采集结束后可以保存为采集文件旁的.vft文件，再次打开同一采集时直接读入，不必重建。
+ */
+class VideoFrameTable {
+public:
+    static constexpr int ALL_COMMAND_TYPES = -1;            ///< 不按指令类型筛选
+    static constexpr const char* FILE_SUFFIX = ".vft";      ///< 帧表文件后缀
+
+    /**
+     * @brief 帧记录，24字节
+     */
+    struct Frame {
+        uint64_t timestamp = 0;     ///< 时间戳
+        uint64_t fileOffset = 0;    ///< 文件中的偏移位置
+        uint32_t size = 0;          ///< 数据包大小
+        uint16_t fileId = 0;        ///< 文件名在文件表中的序号
+        uint8_t commandType = 0;    ///< 指令类型
+        uint8_t flags = 0;          ///< FLAG_VALID_HEADER等标志
+    };
+
+    static constexpr uint8_t FLAG_VALID_HEADER = 0x01;     ///< 头部有效
+
+    /**
+     * @brief 从索引快照建立帧表
+     * @param snapshot 索引快照，条目按时间戳有序
+     * @return 帧表；文件数超过记录能表示的范围时为空
+     */
+    static std::shared_ptr<const VideoFrameTable> build(const IndexSnapshot& snapshot);
+
+    /**
+     * @brief 在已有帧表上追加快照中新增的条目
+     *
+     * 只转换base.sourceCount()之后的条目，旧记录按原始字节复制后重新分组，并刷新各文件大小。
+     * @param base 由同一索引较早的快照建立的帧表
+     * @param snapshot 索引快照，前base.sourceCount()个条目与base一致
+     * @return 帧表；快照比base短时按快照完整重建，文件数超过记录能表示的范围时为空
+     */
+    static std::shared_ptr<const VideoFrameTable> extend(const VideoFrameTable& base, const IndexSnapshot& snapshot);
+
+    /**
+     * @brief 读取保存的帧表
+     *
+     * 记录的每个采集文件大小都要与磁盘上一致，否则视为过期。
+     * @param path 帧表文件路径
+     * @return 帧表；文件不存在、格式不符或已过期时为空
+     */
+    static std::shared_ptr<const VideoFrameTable> load(const QString& path);
+
+    /**
+     * @brief 保存帧表
+     * @param path 帧表文件路径，先写临时文件再替换
+     * @return 是否成功
+     */
+    bool save(const QString& path) const;
+
+    /**
+     * @brief 采集文件对应的帧表路径
+     */
+    static QString tablePathFor(const QString& captureFile) { return captureFile + FILE_SUFFIX; }
+
+    /**
+     * @brief 建表时索引的条目数，用于判断索引是否已经增长
+     */
+    int sourceCount() const { return static_cast<int>(m_frames.size()); }
+
+    /**
+     * @brief 主采集文件（第一个数据包所在文件），帧表保存在它旁边
+     */
+    QString primaryFile() const { return m_files.isEmpty() ? QString() : m_files.first(); }
+
+    /**
+     * @brief 某指令类型（或全部）的帧数
+     */
+    int frameCount(int commandType) const;
+
+    /**
+     * @brief 某指令类型（或全部）的第frameNumber帧，O(1)
+     */
+    const Frame& frame(int commandType, int frameNumber) const
+    {
+        return commandType == ALL_COMMAND_TYPES ? m_frames[m_timeOrder[frameNumber]]
+            : m_frames[m_typeOffsets[commandType] + frameNumber];
+    }
+
+    /**
+     * @brief 某指令类型（或全部）中首个时间戳不小于timestamp的帧号，O(log n)
+     */
+    int lowerBound(int commandType, uint64_t timestamp) const;
+
+    /**
+     * @brief 某指令类型（或全部）中首个时间戳大于timestamp的帧号，O(log n)
+     */
+    int upperBound(int commandType, uint64_t timestamp) const;
+
+    /**
+     * @brief 把帧记录还原为索引条目（不含批次、序列号和描述）
+     */
+    PacketIndexEntry toEntry(const Frame& frame) const;
+
+private:
+    VideoFrameTable() = default;
+
+    /**
+     * @brief 按指令类型分组并建立时间顺序映射，m_frames此时按时间顺序排列
+     */
+    void groupByCommandType();
+
+    /**
+     * @brief 把快照中[first, size())的条目转换为记录，追加到m_frames（时间顺序）
+     * @return 文件数超过记录能表示的范围时返回false
+     */
+    bool appendEntries(const IndexSnapshot& snapshot, int first);
+
+    /**
+     * @brief 按磁盘上的当前大小记录各文件大小
+     */
+    void refreshFileSizes();
+
+    QStringList m_files;                        ///< 文件表
+    QVector<qint64> m_fileSizes;                ///< 建表时各文件的大小，读取时校验
+    std::vector<Frame> m_frames;                ///< 帧记录，按指令类型分组，组内按时间顺序
+    std::array<uint32_t, 257> m_typeOffsets{};  ///< 各指令类型在m_frames中的起始位置
+    std::vector<uint32_t> m_timeOrder;          ///< 时间顺序 -> m_frames中的位置
+};
+
+/**
+ * @brief 帧表上的一段筛选结果
+ *
+ * 只记录指令类型和帧号范围，复制代价为一次引用计数，取第i帧为O(1)。
+ */
+class VideoFrameView {
+public:
+    VideoFrameView() = default;
+
+    /**
+     * @brief 按指令类型、时间范围和数量筛选
+     * @param table 帧表
+     * @param commandType 指令类型，ALL_COMMAND_TYPES表示全部
+     * @param startTime 开始时间戳（含）
+     * @param endTime 结束时间戳（含）
+     * @param limit 最多帧数，-1表示不限制
+     */
+    VideoFrameView(std::shared_ptr<const VideoFrameTable> table, int commandType,
+        uint64_t startTime = 0, uint64_t endTime = UINT64_MAX, int limit = -1);
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    /**
+     * @brief 第index帧的索引条目
+     */
+    PacketIndexEntry at(int index) const
+    {
+        return m_table->toEntry(m_table->frame(m_commandType, m_first + index));
+    }
+
+private:
+    std::shared_ptr<const VideoFrameTable> m_table;     ///< 帧表
+    int m_commandType = VideoFrameTable::ALL_COMMAND_TYPES; ///< 指令类型
+    int m_first = 0;                                    ///< 首帧在该指令类型中的帧号
+    int m_count = 0;                                    ///< 帧数
+};
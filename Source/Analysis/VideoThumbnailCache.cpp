@@ -0,0 +1,200 @@
+﻿// Source/Analysis/VideoThumbnailCache.cpp
+#include "VideoThumbnailCache.h"
+#include "Logger.h"
+#include <QBuffer>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QtEndian>
+
+namespace {
+    constexpr quint32 CACHE_MAGIC = 0x31485456;     // "VTH1"
+    constexpr quint32 CACHE_VERSION = 2;
+    constexpr qint64 HEADER_BYTES = 16;             // magic u32, version u32, signature u64
+    constexpr qint64 RECORD_HEADER_BYTES = 16;      // offset u64, name length u32, length u32
+    constexpr quint32 MAX_RECORD_BYTES = 4 * 1024 * 1024;
+    constexpr quint32 MAX_NAME_BYTES = 4096;
+}
+
+VideoThumbnailCache::~VideoThumbnailCache()
+{
+    close();
+}
+
+bool VideoThumbnailCache::open(const QString& path, quint64 signature)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_records.clear();
+    m_signature = signature;
+    m_directory = QFileInfo(path).absoluteDir();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("无法打开缩略图缓存: %1").arg(path));
+        return false;
+    }
+
+    uchar header[HEADER_BYTES] = { 0 };
+    const bool headerMatches = m_file.read(reinterpret_cast<char*>(header), HEADER_BYTES) == HEADER_BYTES
+        && qFromLittleEndian<quint32>(header) == CACHE_MAGIC
+        && qFromLittleEndian<quint32>(header + 4) == CACHE_VERSION
+        && qFromLittleEndian<quint64>(header + 8) == signature;
+
+    if (!headerMatches) {
+        // 新文件，或解码参数、缩略图尺寸已变：旧缩略图全部作废
+        qToLittleEndian<quint32>(CACHE_MAGIC, header);
+        qToLittleEndian<quint32>(CACHE_VERSION, header + 4);
+        qToLittleEndian<quint64>(signature, header + 8);
+        if (!m_file.resize(0) || !m_file.seek(0)
+            || m_file.write(reinterpret_cast<const char*>(header), HEADER_BYTES) != HEADER_BYTES) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("无法初始化缩略图缓存: %1").arg(path));
+            m_file.close();
+            return false;
+        }
+        m_file.flush();
+        return true;
+    }
+
+    scanRecordsLocked();
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("缩略图缓存已打开: %1，%2张").arg(path).arg(m_records.size()));
+    return true;
+}
+
+void VideoThumbnailCache::close()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_records.clear();
+}
+
+bool VideoThumbnailCache::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_file.isOpen();
+}
+
+int VideoThumbnailCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_records.size());
+}
+
+VideoThumbnailCache::Key VideoThumbnailCache::recordKeyLocked(const QString& fileName, quint64 fileOffset) const
+{
+    return Key(QDir::cleanPath(m_directory.relativeFilePath(QFileInfo(fileName).absoluteFilePath())), fileOffset);
+}
+
+void VideoThumbnailCache::scanRecordsLocked()
+{
+    const qint64 fileSize = m_file.size();
+    qint64 position = HEADER_BYTES;
+    // 同一文件的记录连续出现，文件名未变时沿用上一条的QString（隐式共享），不再逐条解码和分配
+    QByteArray lastNameBytes;
+    QString lastName;
+    while (position + RECORD_HEADER_BYTES <= fileSize) {
+        uchar recordHeader[RECORD_HEADER_BYTES];
+        if (!m_file.seek(position)
+            || m_file.read(reinterpret_cast<char*>(recordHeader), RECORD_HEADER_BYTES) != RECORD_HEADER_BYTES) {
+            break;
+        }
+
+        const quint64 fileOffset = qFromLittleEndian<quint64>(recordHeader);
+        const quint32 nameLength = qFromLittleEndian<quint32>(recordHeader + 8);
+        const quint32 length = qFromLittleEndian<quint32>(recordHeader + 12);
+        const qint64 dataPosition = position + RECORD_HEADER_BYTES + nameLength;
+        if (nameLength == 0 || nameLength > MAX_NAME_BYTES || length == 0 || length > MAX_RECORD_BYTES
+            || dataPosition + length > fileSize) {
+            break;
+        }
+
+        const QByteArray nameBytes = m_file.read(nameLength);
+        if (nameBytes.size() != static_cast<qsizetype>(nameLength)) {
+            break;
+        }
+        if (nameBytes != lastNameBytes) {
+            lastNameBytes = nameBytes;
+            lastName = QString::fromUtf8(nameBytes);
+        }
+
+        m_records.insert(Key(lastName, fileOffset), Record{ dataPosition, length });
+        position = dataPosition + length;
+    }
+
+    // 上次写入中断留下的半条记录
+    if (position < fileSize) {
+        m_file.resize(position);
+    }
+}
+
+QImage VideoThumbnailCache::lookup(const QString& fileName, quint64 fileOffset)
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_records.constFind(recordKeyLocked(fileName, fileOffset));
+        if (it == m_records.constEnd() || !m_file.seek(it->position)) {
+            return QImage();
+        }
+        data = m_file.read(it->length);
+    }
+
+    // 解压在锁外进行
+    QImage thumbnail;
+    thumbnail.loadFromData(data);
+    return thumbnail;
+}
+
+void VideoThumbnailCache::store(const QString& fileName, quint64 fileOffset, const QImage& thumbnail, quint64 signature)
+{
+    if (thumbnail.isNull()) {
+        return;
+    }
+
+    // 压缩在锁外进行
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!thumbnail.save(&buffer, "JPG", 85)) {
+        data.clear();
+        buffer.seek(0);
+        if (!thumbnail.save(&buffer, "PNG")) {
+            return;
+        }
+    }
+    if (data.isEmpty() || data.size() > static_cast<qsizetype>(MAX_RECORD_BYTES)) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const Key key = recordKeyLocked(fileName, fileOffset);
+    if (!m_file.isOpen() || signature != m_signature || m_records.contains(key)) {
+        return;
+    }
+
+    const QByteArray nameBytes = key.first.toUtf8();
+    if (nameBytes.isEmpty() || nameBytes.size() > static_cast<qsizetype>(MAX_NAME_BYTES)) {
+        return;
+    }
+
+    uchar recordHeader[RECORD_HEADER_BYTES];
+    qToLittleEndian<quint64>(fileOffset, recordHeader);
+    qToLittleEndian<quint32>(static_cast<quint32>(nameBytes.size()), recordHeader + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), recordHeader + 12);
+
+    const qint64 position = m_file.size();
+    if (!m_file.seek(position)
+        || m_file.write(reinterpret_cast<const char*>(recordHeader), RECORD_HEADER_BYTES) != RECORD_HEADER_BYTES
+        || m_file.write(nameBytes) != nameBytes.size()
+        || m_file.write(data) != data.size()) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("写入缩略图缓存失败: %1").arg(m_file.fileName()));
+        m_file.resize(position);
+        return;
+    }
+
+    const qint64 dataPosition = position + RECORD_HEADER_BYTES + nameBytes.size();
+    m_records.insert(key, Record{ dataPosition, static_cast<quint32>(data.size()) });
+}
@@ -0,0 +1,94 @@
+﻿// Source/Analysis/VideoThumbnailCache.h
+#pragma once
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+/**
+ * @brief 视频缩略图磁盘缓存
+ *
+ * 每个采集文件旁一个.thumbs文件：文件头记录解码参数签名，之后是只追加的记录
+ * [文件偏移 u64][文件名长度 u32][图像长度 u32][文件名 UTF-8][压缩图像]，按(文件名, 帧数据偏移)定位；
+ * 记录中保存完整的文件名，查找时逐字比较，不会因哈希冲突或同名文件取到别的缩略图。
+ * 文件名为相对缓存文件所在目录的路径，采集目录整体移动后缓存仍然有效。
+ * 缩略图压缩为JPEG（不可用时为PNG），每张几KB，几小时的采集也只有几十MB。
+ * 打开时只扫描记录头建立内存索引；签名不符时清空重建，末尾不完整的记录被截掉。
+ * 所有接口都加锁，可在多个后台线程中同时读写。
+ */
+class VideoThumbnailCache {
+public:
+    static constexpr const char* FILE_SUFFIX = ".thumbs";   ///< 缓存文件后缀
+
+    VideoThumbnailCache() = default;
+    ~VideoThumbnailCache();
+
+    VideoThumbnailCache(const VideoThumbnailCache&) = delete;
+    VideoThumbnailCache& operator=(const VideoThumbnailCache&) = delete;
+
+    /**
+     * @brief 打开缓存文件
+     * @param path 缓存文件路径
+     * @param signature 解码参数和缩略图尺寸的签名，不一致时清空缓存
+     * @return 是否成功
+     */
+    bool open(const QString& path, quint64 signature);
+
+    /**
+     * @brief 关闭缓存文件
+     */
+    void close();
+
+    bool isOpen() const;
+    int count() const;
+
+    /**
+     * @brief 采集文件对应的缓存路径
+     */
+    static QString cachePathFor(const QString& captureFile) { return captureFile + FILE_SUFFIX; }
+
+    /**
+     * @brief 查找缩略图
+     * @param fileName 帧数据所在文件
+     * @param fileOffset 帧数据在文件中的偏移
+     * @return 缩略图，不存在时为空
+     */
+    QImage lookup(const QString& fileName, quint64 fileOffset);
+
+    /**
+     * @brief 保存缩略图，已存在时忽略
+     * @param signature 生成缩略图时使用的签名；缓存已按其他签名重新打开时忽略，避免写入过期的缩略图
+     */
+    void store(const QString& fileName, quint64 fileOffset, const QImage& thumbnail, quint64 signature);
+
+private:
+    /**
+     * @brief 记录在文件中的位置
+     */
+    struct Record {
+        qint64 position = 0;    ///< 压缩数据的位置
+        quint32 length = 0;     ///< 压缩数据长度
+    };
+
+    using Key = QPair<QString, quint64>;    ///< (相对文件名, 帧数据偏移)
+
+    /**
+     * @brief 记录的键，文件名转换为相对缓存目录的路径（调用者需持有m_mutex）
+     */
+    Key recordKeyLocked(const QString& fileName, quint64 fileOffset) const;
+
+    /**
+     * @brief 扫描记录头建立索引（调用者需持有m_mutex）
+     */
+    void scanRecordsLocked();
+
+    mutable QMutex m_mutex;                 ///< 保护以下成员
+    QFile m_file;                           ///< 缓存文件
+    QHash<Key, Record> m_records;           ///< 记录索引
+    QDir m_directory;                       ///< 缓存文件所在目录
+    quint64 m_signature = 0;                ///< 当前签名
+};
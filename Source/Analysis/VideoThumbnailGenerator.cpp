@@ -0,0 +1,198 @@
+﻿// Source/Analysis/VideoThumbnailGenerator.cpp
+#include "VideoThumbnailGenerator.h"
+#include "RgbScanlineDecoder.h"
+#include "BayerDemosaic.h"
+#include "Logger.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+#include <vector>
+
+VideoThumbnailGenerator::VideoThumbnailGenerator(QObject* parent)
+    : QObject(parent)
+    , m_cache(std::make_shared<VideoThumbnailCache>())
+    , m_currentGeneration(std::make_shared<std::atomic<quint64>>(0))
+{
+    m_pool.setMaxThreadCount(MAX_PARALLEL_THUMBNAILS);
+}
+
+VideoThumbnailGenerator::~VideoThumbnailGenerator()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void VideoThumbnailGenerator::cancel()
+{
+    // 正在执行的任务无法中断，结果回来时按代数丢弃；排队的任务直接移除
+    m_generation++;
+    m_currentGeneration->store(m_generation);
+    m_pool.clear();
+    m_remaining = 0;
+}
+
+void VideoThumbnailGenerator::start(const VideoFrameView& frames, const VideoDecodeParameters& parameters,
+    int step, int thumbnailWidth)
+{
+    cancel();
+
+    m_step = std::max(1, step);
+    m_total = frames.isEmpty() ? 0 : (frames.size() - 1) / m_step + 1;
+    if (m_total == 0 || parameters.width <= 0 || parameters.height <= 0 || thumbnailWidth <= 0) {
+        m_total = 0;
+        return;
+    }
+    m_remaining = m_total;
+    m_timer.start();
+
+    // 缓存放在主采集文件旁；打开失败时照常生成，只是不保存
+    const quint64 signature = cacheSignature(parameters, thumbnailWidth);
+    m_cache->open(VideoThumbnailCache::cachePathFor(frames.at(0).fileName), signature);
+
+    // 由粗到细排列：先每COARSE_STRIDE张取一张，再逐级减半间隔补齐
+    QVector<int> order;
+    order.reserve(m_total);
+    std::vector<bool> queued(static_cast<size_t>(m_total), false);
+    for (int stride = COARSE_STRIDE; stride >= 1; stride /= 2) {
+        for (int slot = 0; slot < m_total; slot += stride) {
+            if (!queued[static_cast<size_t>(slot)]) {
+                queued[static_cast<size_t>(slot)] = true;
+                order.append(slot);
+            }
+        }
+    }
+
+    const quint64 generation = m_generation;
+    const std::shared_ptr<std::atomic<quint64>> currentGeneration = m_currentGeneration;
+    const std::shared_ptr<VideoThumbnailCache> cache = m_cache;
+    for (int slot : order) {
+        const int frameIndex = slot * m_step;
+        const PacketIndexEntry entry = frames.at(frameIndex);
+
+        QtConcurrent::run(&m_pool, [this, currentGeneration, cache, entry, parameters, thumbnailWidth, signature, generation, frameIndex]() {
+            if (currentGeneration->load() != generation) {
+                return;
+            }
+
+            QImage thumbnail = cache->lookup(entry.fileName, entry.fileOffset);
+            if (thumbnail.isNull()) {
+                QFile file(entry.fileName);
+                if (file.open(QIODevice::ReadOnly)) {
+                    thumbnail = decodeThumbnail(file, entry, parameters, thumbnailWidth);
+                    cache->store(entry.fileName, entry.fileOffset, thumbnail, signature);
+                }
+            }
+
+            QMetaObject::invokeMethod(this, [this, generation, frameIndex, thumbnail = std::move(thumbnail)]() mutable {
+                finishThumbnail(generation, frameIndex, std::move(thumbnail));
+                }, Qt::QueuedConnection);
+            });
+    }
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("开始生成视频缩略图: %1张，每%2帧一张").arg(m_total).arg(m_step));
+}
+
+void VideoThumbnailGenerator::finishThumbnail(quint64 generation, int frameIndex, QImage thumbnail)
+{
+    if (generation != m_generation || m_remaining == 0) {
+        return;
+    }
+
+    m_remaining--;
+    if (!thumbnail.isNull()) {
+        emit signal_VD_THUMB_thumbnailReady(frameIndex, thumbnail);
+    }
+
+    if (m_remaining == 0) {
+        const qint64 elapsedMs = m_timer.elapsed();
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("视频缩略图生成完成: %1张，耗时%2毫秒，缓存%3张")
+            .arg(m_total).arg(elapsedMs).arg(m_cache->count()));
+        emit signal_VD_THUMB_finished(m_total, elapsedMs);
+    }
+}
+
+quint64 VideoThumbnailGenerator::cacheSignature(const VideoDecodeParameters& parameters, int thumbnailWidth)
+{
+    const QByteArray key = QByteArray::number(parameters.width) + ',' + QByteArray::number(parameters.height)
+        + ',' + QByteArray::number(parameters.colorMode) + ',' + QByteArray::number(parameters.colorArrangement)
+        + ',' + QByteArray::number(parameters.rawBits) + ',' + QByteArray::number(parameters.demosaicMethod)
+        + ',' + QByteArray::number(parameters.bayerPattern) + ',' + QByteArray::number(parameters.toneMap ? 1 : 0)
+        + ',' + QByteArray::number(thumbnailWidth);
+    // qHash的结果随Qt版本和平台变化，签名要写入磁盘，取固定算法的摘要
+    const QByteArray digest = QCryptographicHash::hash(key, QCryptographicHash::Sha1);
+    return qFromLittleEndian<quint64>(digest.constData());
+}
+
+QImage VideoThumbnailGenerator::decodeThumbnail(QIODevice& device, const PacketIndexEntry& entry,
+    const VideoDecodeParameters& parameters, int thumbnailWidth)
+{
+    if (parameters.width <= 0 || parameters.height <= 0 || thumbnailWidth <= 0) {
+        return QImage();
+    }
+
+    // 拜耳RAW用2x2超像素，倍数取偶数，取样行对保持CFA相位
+    const bool useDemosaic = parameters.demosaicEnabled() && BayerDemosaic::supports(parameters.width, parameters.height);
+    int factor = std::max(1, parameters.width / thumbnailWidth);
+    if (useDemosaic) {
+        factor = std::max(2, factor & ~1);
+    }
+    const int width = parameters.width / factor;
+    const int height = parameters.height / factor;
+    if (width <= 0 || height <= 0) {
+        return QImage();
+    }
+
+    const RgbScanlineDecoder decoder(parameters.colorMode, parameters.colorArrangement);
+    const BayerDemosaic demosaic(parameters.rawBits, parameters.bayerPattern, BayerDemosaic::METHOD_BILINEAR,
+        parameters.toneMap && useDemosaic);
+    const qint64 srcStride = static_cast<qint64>(useDemosaic ? demosaic.rowBytes(parameters.width)
+        : decoder.rowBytes(parameters.width));
+
+    QImage thumbnail(width, height, QImage::Format_RGB888);
+
+    // 与decodeFrame一致：数据不足一帧时为黑色
+    if (static_cast<qint64>(entry.size) < srcStride * parameters.height) {
+        thumbnail.fill(Qt::black);
+        return thumbnail;
+    }
+
+    const int rowsPerSample = useDemosaic ? 2 : 1;
+    QByteArray rows(static_cast<qsizetype>(srcStride * rowsPerSample), Qt::Uninitialized);
+    std::vector<uint8_t> line(useDemosaic ? 0 : static_cast<size_t>(parameters.width) * 3);
+    BayerDemosaic::Workspace workspace;
+
+    for (int y = 0; y < height; ++y) {
+        // RGB取每组行的中间一行；拜耳取每组开头的一对行
+        const int sourceRow = useDemosaic ? y * factor : y * factor + factor / 2;
+        if (!device.seek(static_cast<qint64>(entry.fileOffset) + sourceRow * srcStride)
+            || device.read(rows.data(), rows.size()) != rows.size()) {
+            return QImage();
+        }
+
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(rows.constData());
+        uint8_t* out = thumbnail.scanLine(y);
+        if (useDemosaic) {
+            demosaic.decodeSuperpixelRow(src, src + srcStride, parameters.width, factor, out, workspace);
+            continue;
+        }
+
+        // 整行解码后每factor个像素取平均
+        decoder.decodeRows(src, static_cast<size_t>(srcStride), line.data(), line.size(), parameters.width, 1);
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* pixel = line.data() + static_cast<size_t>(x) * factor * 3;
+            int sums[3] = { 0, 0, 0 };
+            for (int i = 0; i < factor; ++i) {
+                sums[0] += pixel[3 * i];
+                sums[1] += pixel[3 * i + 1];
+                sums[2] += pixel[3 * i + 2];
+            }
+            for (int c = 0; c < 3; ++c) {
+                out[3 * x + c] = static_cast<uint8_t>((sums[c] + factor / 2) / factor);
+            }
+        }
+    }
+
+    return thumbnail;
+}
@@ -0,0 +1,104 @@
+﻿// Source/Analysis/VideoThumbnailGenerator.h
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "VideoFrameTable.h"
+#include "VideoFramePipeline.h"
+#include "VideoThumbnailCache.h"
+
+class QIODevice;
+
+/**
+ * @brief 视频缩略图条的后台生成器
+ *
+ * 每隔step帧取一帧生成缩略图。缩小解码只读取和解码需要的行：RGB模式每factor行读一行并在行内
+ * 按factor个像素取平均；拜耳RAW每factor行读一对行，用2x2超像素直接得到RGB，不做完整去马赛克。
+ * 1080p缩到160像素宽时，RGB每帧只读约1/12的数据，拜耳约1/6；读取绕过DataAccessService的块缓存，不挤占回放缓存。
+ *
+ * 生成顺序由粗到细：先每16张取一张，再逐级补齐中间的，整条缩略图很快就能先看到大致内容。
+ * 结果写入采集文件旁的VideoThumbnailCache，再次打开同一采集时直接从缓存读出。
+ *
+ * 接口只在界面线程调用；重新开始或取消时，之前发出的任务按代数丢弃。
+ */
+class VideoThumbnailGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_THUMBNAIL_WIDTH = 160;    ///< 默认缩略图宽度
+    static constexpr int MAX_PARALLEL_THUMBNAILS = 2;       ///< 同时生成的缩略图数
+
+    explicit VideoThumbnailGenerator(QObject* parent = nullptr);
+    ~VideoThumbnailGenerator();
+
+    /**
+     * @brief 开始生成，取消之前未完成的任务
+     * @param frames 帧列表
+     * @param parameters 解码参数
+     * @param step 每隔多少帧取一帧
+     * @param thumbnailWidth 缩略图目标宽度
+     */
+    void start(const VideoFrameView& frames, const VideoDecodeParameters& parameters, int step,
+        int thumbnailWidth = DEFAULT_THUMBNAIL_WIDTH);
+
+    /**
+     * @brief 取消未完成的任务
+     */
+    void cancel();
+
+    bool isRunning() const { return m_remaining > 0; }
+    int step() const { return m_step; }
+
+    /**
+     * @brief 从一帧数据中缩小解码出缩略图，可在任意线程调用
+     * @param device 已打开的采集文件
+     * @param entry 帧的索引条目
+     * @param parameters 解码参数
+     * @param thumbnailWidth 缩略图目标宽度，实际宽度为原宽度除以整数倍数
+     * @return 缩略图；读取失败或参数无效时为空
+     */
+    static QImage decodeThumbnail(QIODevice& device, const PacketIndexEntry& entry,
+        const VideoDecodeParameters& parameters, int thumbnailWidth);
+
+signals:
+    /**
+     * @brief 缩略图就绪信号
+     * @param frameIndex 帧序号
+     * @param thumbnail 缩略图
+     */
+    void signal_VD_THUMB_thumbnailReady(int frameIndex, const QImage& thumbnail);
+
+    /**
+     * @brief 全部缩略图生成完成信号
+     * @param count 缩略图数量
+     * @param elapsedMs 耗时（毫秒）
+     */
+    void signal_VD_THUMB_finished(int count, qint64 elapsedMs);
+
+private:
+    static constexpr int COARSE_STRIDE = 16;    ///< 第一轮生成的间隔（按缩略图计）
+
+    /**
+     * @brief 后台任务完成，在界面线程中执行
+     */
+    void finishThumbnail(quint64 generation, int frameIndex, QImage thumbnail);
+
+    /**
+     * @brief 解码参数和缩略图尺寸的签名，用于判断缓存是否有效
+     */
+    static quint64 cacheSignature(const VideoDecodeParameters& parameters, int thumbnailWidth);
+
+    QThreadPool m_pool;                                 ///< 缩略图线程池
+    std::shared_ptr<VideoThumbnailCache> m_cache;       ///< 缩略图缓存，切换采集或参数时重新打开
+    std::shared_ptr<std::atomic<quint64>> m_currentGeneration; ///< 后台任务检查的代数
+    quint64 m_generation = 0;                           ///< 当前代数
+    int m_step = 1;                                     ///< 取帧间隔
+    int m_total = 0;                                    ///< 本次缩略图总数
+    int m_remaining = 0;                                ///< 未完成的缩略图数
+    QElapsedTimer m_timer;                              ///< 本次耗时
+};
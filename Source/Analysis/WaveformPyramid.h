@@ -0,0 +1,218 @@
+﻿// Source/Analysis/WaveformPyramid.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "LogicChannel.h"
+
+/**
+ * @brief 波形摘要桶
+ */
+struct WaveformBucket {
+    uint8_t minLevel = 0;       ///< 桶内最低电平
+    uint8_t maxLevel = 0;       ///< 桶内最高电平
+    uint8_t firstLevel = 0;     ///< 桶内第一个样本的电平
+    uint8_t lastLevel = 0;      ///< 桶内最后一个样本的电平
+    uint32_t transitions = 0;   ///< 桶内跳变数（含与前一桶交界处的跳变）
+};
+
+/**
+ * @brief 折线顶点（样本坐标）
+ */
+struct WaveformTracePoint {
+    double sample = 0.0;        ///< 样本下标
+    uint8_t level = 0;          ///< 电平(0/1)
+};
+
+/**
+ * @brief 逻辑通道的多分辨率最小/最大值摘要
+ *
+ * 第0层每桶2^BASE_SHIFT个样本（正好一个位图字），之后每层桶大小翻倍，直到只剩一个桶。
+ * 每次加载数据后构建一次；绘制时按每像素样本数选择桶不超过一个像素的最粗层级，
+ * 顶点数只与视口宽度有关，与缩放级别无关。每像素样本数不足一个桶时直接按游程绘制原始样本。
+ * 纯C++实现，不依赖Qt，可脱离界面单独测试。
+ */
+class WaveformPyramid {
+public:
+    static constexpr int BASE_SHIFT = 6;    ///< 第0层每桶64个样本
+
+    /**
+     * @brief 由通道数据构建全部层级
+     */
+    void build(const LogicChannel& channel)
+    {
+        m_levels.clear();
+        m_sourceSize = channel.size();
+        if (m_sourceSize == 0) {
+            return;
+        }
+
+        // 第0层：每桶一个字，统计都由位图按字计算
+        const size_t baseSize = size_t(1) << BASE_SHIFT;
+        std::vector<WaveformBucket> base((m_sourceSize + baseSize - 1) / baseSize);
+        for (size_t b = 0; b < base.size(); ++b) {
+            const size_t begin = b * baseSize;
+            const size_t end = std::min(begin + baseSize, m_sourceSize);
+            const size_t high = channel.countHigh(begin, end);
+
+            WaveformBucket& bucket = base[b];
+            bucket.minLevel = high == end - begin ? 1 : 0;
+            bucket.maxLevel = high > 0 ? 1 : 0;
+            bucket.firstLevel = channel.valueAt(begin) ? 1 : 0;
+            bucket.lastLevel = channel.valueAt(end - 1) ? 1 : 0;
+            bucket.transitions = static_cast<uint32_t>(begin > 0 ? channel.countTransitions(begin - 1, end)
+                : channel.countTransitions(0, end));
+        }
+        m_levels.push_back(std::move(base));
+
+        // 逐层两两合并
+        while (m_levels.back().size() > 1) {
+            const std::vector<WaveformBucket>& lower = m_levels.back();
+            std::vector<WaveformBucket> upper((lower.size() + 1) / 2);
+            for (size_t b = 0; b < upper.size(); ++b) {
+                const WaveformBucket& left = lower[2 * b];
+                if (2 * b + 1 >= lower.size()) {
+                    upper[b] = left;
+                    continue;
+                }
+                const WaveformBucket& right = lower[2 * b + 1];
+                WaveformBucket& merged = upper[b];
+                merged.minLevel = std::min(left.minLevel, right.minLevel);
+                merged.maxLevel = std::max(left.maxLevel, right.maxLevel);
+                merged.firstLevel = left.firstLevel;
+                merged.lastLevel = right.lastLevel;
+                merged.transitions = left.transitions + right.transitions;
+            }
+            m_levels.push_back(std::move(upper));
+        }
+    }
+
+    void clear()
+    {
+        m_levels.clear();
+        m_sourceSize = 0;
+    }
+
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    size_t sourceSize() const { return m_sourceSize; }
+
+    /**
+     * @brief 指定层级每桶的样本数
+     */
+    static size_t bucketSize(int level) { return size_t(1) << (BASE_SHIFT + level); }
+
+    /**
+     * @brief 指定层级的全部桶
+     */
+    const std::vector<WaveformBucket>& level(int level) const { return m_levels[static_cast<size_t>(level)]; }
+
+    /**
+     * @brief 选择绘制层级
+     * @param samplesPerPixel 每像素样本数
+     * @return 桶大小不超过samplesPerPixel的最粗层级，-1表示应直接绘制原始样本
+     */
+    int chooseLevel(double samplesPerPixel) const
+    {
+        int chosen = -1;
+        for (int level = 0; level < levelCount(); ++level) {
+            if (static_cast<double>(bucketSize(level)) > samplesPerPixel) {
+                break;
+            }
+            chosen = level;
+        }
+        return chosen;
+    }
+
+    /**
+     * @brief 生成可见范围的阶梯折线（GL_LINE_STRIP顺序）
+     *
+     * 原始层级按游程生成；摘要层级中电平单一的桶与前面相同电平时合并为一条水平线，
+     * 电平混合的桶画成贯穿高低电平的竖线。可见范围两端所在的桶按整桶计算，误差不超过一个像素。
+     *
+     * @param channel 通道数据（与build时相同）
+     * @param first 可见范围第一个样本
+     * @param last 可见范围最后一个样本（含）
+     * @param pixelWidth 绘制宽度（像素）
+     * @param points 输出折线顶点，先清空
+     */
+    void trace(const LogicChannel& channel, size_t first, size_t last, int pixelWidth,
+        std::vector<WaveformTracePoint>& points) const
+    {
+        if (channel.empty() || first > last || first >= channel.size()) {
+            points.clear();
+            return;
+        }
+        last = std::min(last, channel.size() - 1);
+
+        const double samplesPerPixel = static_cast<double>(last - first + 1) / std::max(pixelWidth, 1);
+        traceLevel(channel, first, last, chooseLevel(samplesPerPixel), points);
+    }
+
+    /**
+     * @brief 按指定层级生成可见范围的阶梯折线
+     * @param levelIndex 层级，-1表示原始样本；摘要与通道不匹配时按原始样本生成
+     * @see trace
+     */
+    void traceLevel(const LogicChannel& channel, size_t first, size_t last, int levelIndex,
+        std::vector<WaveformTracePoint>& points) const
+    {
+        points.clear();
+        if (channel.empty() || first > last || first >= channel.size()) {
+            return;
+        }
+        last = std::min(last, channel.size() - 1);
+        if (m_sourceSize != channel.size() || levelIndex >= levelCount()) {
+            levelIndex = -1;
+        }
+
+        uint8_t current = channel.valueAt(first) ? 1 : 0;
+        points.push_back({ static_cast<double>(first), current });
+
+        if (levelIndex < 0) {
+            channel.forEachRun(first, last + 1, [&](size_t start, size_t /*length*/, bool high) {
+                const uint8_t level = high ? 1 : 0;
+                if (level != current) {
+                    points.push_back({ static_cast<double>(start), current });
+                    points.push_back({ static_cast<double>(start), level });
+                    current = level;
+                }
+                });
+        }
+        else {
+            const std::vector<WaveformBucket>& buckets = level(levelIndex);
+            const int shift = BASE_SHIFT + levelIndex;
+            const size_t firstBucket = first >> shift;
+            const size_t lastBucket = last >> shift;
+
+            for (size_t b = firstBucket; b <= lastBucket; ++b) {
+                const WaveformBucket& bucket = buckets[b];
+                const double x = static_cast<double>(std::max(b << shift, first));
+
+                if (bucket.minLevel == bucket.maxLevel) {
+                    if (bucket.minLevel != current) {
+                        points.push_back({ x, current });
+                        points.push_back({ x, bucket.minLevel });
+                        current = bucket.minLevel;
+                    }
+                }
+                else {
+                    // 竖线覆盖高低电平，停在桶内最后的电平
+                    points.push_back({ x, current });
+                    points.push_back({ x, static_cast<uint8_t>(1 - current) });
+                    if (bucket.lastLevel == current) {
+                        points.push_back({ x, current });
+                    }
+                    current = bucket.lastLevel;
+                }
+            }
+        }
+
+        points.push_back({ static_cast<double>(last), current });
+    }
+
+private:
+    std::vector<std::vector<WaveformBucket>> m_levels;     ///< 各层级的桶，第0层最细
+    size_t m_sourceSize = 0;                                ///< 构建时的样本数
+};
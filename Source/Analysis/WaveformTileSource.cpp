@@ -0,0 +1,230 @@
+﻿// Source/Analysis/WaveformTileSource.cpp
+#include "WaveformTileSource.h"
+#include "DataAccessService.h"
+#include "Logger.h"
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+size_t WaveformTile::memoryBytes() const
+{
+    size_t bytes = sizeof(WaveformTile);
+    for (int ch = 0; ch < ChannelDeinterleave::CHANNEL_COUNT; ++ch) {
+        bytes += channels[ch].memoryBytes();
+        for (int level = 0; level < pyramids[ch].levelCount(); ++level) {
+            bytes += pyramids[ch].level(level).capacity() * sizeof(WaveformBucket);
+        }
+    }
+    return bytes;
+}
+
+WaveformTileSource::WaveformTileSource(QObject* parent)
+    : QObject(parent)
+    , m_dataService(&DataAccessService::getInstance())
+{
+    m_loadPool.setMaxThreadCount(MAX_PARALLEL_LOADS);
+}
+
+WaveformTileSource::~WaveformTileSource()
+{
+    m_queue.clear();
+    m_loadPool.clear();
+    m_loadPool.waitForDone();
+}
+
+void WaveformTileSource::reset(quint64 totalSamples)
+{
+    // 已在读取的任务无法取消，移出m_loading后结果回来时丢弃
+    m_tiles.clear();
+    m_queue.clear();
+    m_loading.clear();
+    m_totalSamples = totalSamples;
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("波形分块数据源重置，样本数: %1，分块数: %2")
+        .arg(totalSamples).arg(tileCount()));
+}
+
+void WaveformTileSource::updateTotalSamples(quint64 totalSamples)
+{
+    if (totalSamples == m_totalSamples) {
+        return;
+    }
+
+    if (totalSamples < m_totalSamples || m_totalSamples == 0) {
+        // 文件变短或原来没有文件，说明换了文件
+        reset(totalSamples);
+        return;
+    }
+
+    // 原来的最后一块如果不完整，丢弃后重新读取；正在按旧长度读取的结果也作废
+    const quint64 lastTile = tileCount() - 1;
+    auto it = m_tiles.find(lastTile);
+    if (it != m_tiles.end() && it->tile->sampleCount < static_cast<size_t>(TILE_SAMPLES)) {
+        m_tiles.erase(it);
+    }
+    if (m_totalSamples % TILE_SAMPLES != 0) {
+        m_loading.remove(lastTile);
+    }
+    m_totalSamples = totalSamples;
+}
+
+void WaveformTileSource::requestRange(quint64 firstSample, quint64 lastSample)
+{
+    if (!isActive() || firstSample > lastSample) {
+        return;
+    }
+
+    const quint64 lastTileIndex = tileCount() - 1;
+    const quint64 firstTile = std::min(tileIndexOf(firstSample), lastTileIndex);
+    const quint64 lastTile = std::min(tileIndexOf(lastSample), lastTileIndex);
+
+    // 两端各多预读一块，平移时相邻分块已经就绪
+    const quint64 rangeFirst = firstTile > 0 ? firstTile - 1 : 0;
+    const quint64 rangeLast = std::min(lastTile + 1, lastTileIndex);
+    const quint64 center = (firstTile + lastTile) / 2;
+
+    // 从中心向两侧交替排队；总数不超过常驻上限，否则后加载的会把先加载的挤出缓存
+    QList<quint64> queue;
+    const int limit = std::max(1, m_maxTiles - static_cast<int>(m_loading.size()));
+    for (quint64 distance = 0; queue.size() < limit; ++distance) {
+        const bool hasLeft = center >= rangeFirst + distance;
+        const bool hasRight = center + distance <= rangeLast;
+        if (!hasLeft && !hasRight) {
+            break;
+        }
+
+        if (hasLeft) {
+            const quint64 index = center - distance;
+            if (!m_tiles.contains(index) && !m_loading.contains(index)) {
+                queue.append(index);
+            }
+        }
+        if (hasRight && distance > 0 && queue.size() < limit) {
+            const quint64 index = center + distance;
+            if (!m_tiles.contains(index) && !m_loading.contains(index)) {
+                queue.append(index);
+            }
+        }
+    }
+
+    // 替换之前的队列，已经移出视图的请求不再读取
+    m_queue = queue;
+    startQueuedLoads();
+}
+
+QSharedPointer<const WaveformTile> WaveformTileSource::tile(quint64 tileIndex)
+{
+    auto it = m_tiles.find(tileIndex);
+    if (it == m_tiles.end()) {
+        return QSharedPointer<const WaveformTile>();
+    }
+    it->lastUse = ++m_useCounter;
+    return it->tile;
+}
+
+bool WaveformTileSource::isPending(quint64 tileIndex) const
+{
+    return m_loading.contains(tileIndex) || m_queue.contains(tileIndex);
+}
+
+void WaveformTileSource::setMaxTiles(int maxTiles)
+{
+    m_maxTiles = std::max(1, maxTiles);
+    evictTiles();
+}
+
+size_t WaveformTileSource::memoryBytes() const
+{
+    size_t bytes = 0;
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        bytes += it->tile->memoryBytes();
+    }
+    return bytes;
+}
+
+void WaveformTileSource::startQueuedLoads()
+{
+    while (!m_queue.isEmpty() && m_loading.size() < MAX_PARALLEL_LOADS) {
+        const quint64 tileIndex = m_queue.takeFirst();
+        const quint64 firstSample = tileIndex * TILE_SAMPLES;
+        const int sampleCount = static_cast<int>(std::min<quint64>(TILE_SAMPLES, m_totalSamples - firstSample));
+        const quint64 loadId = ++m_loadCounter;
+        DataAccessService* service = m_dataService;
+
+        m_loading.insert(tileIndex, loadId);
+        QtConcurrent::run(&m_loadPool, [this, service, loadId, tileIndex, sampleCount]() {
+            QSharedPointer<WaveformTile> loaded = loadTile(service, tileIndex, sampleCount);
+            QMetaObject::invokeMethod(this, [this, loadId, tileIndex, sampleCount, loaded]() {
+                finishLoad(loadId, tileIndex, sampleCount, loaded);
+                }, Qt::QueuedConnection);
+            });
+    }
+}
+
+void WaveformTileSource::finishLoad(quint64 loadId, quint64 tileIndex, int sampleCount, QSharedPointer<WaveformTile> tile)
+{
+    // 换了文件或分块长度已变化，这次读取已被移出m_loading
+    auto loading = m_loading.find(tileIndex);
+    if (loading == m_loading.end() || loading.value() != loadId) {
+        return;
+    }
+
+    m_loading.erase(loading);
+
+    // 中间的分块读取不完整说明读取出错，不放入缓存，下次请求时重新读取；
+    // 最后一块不完整由updateTotalSamples在文件增长时丢弃
+    if (tile && tile->sampleCount < static_cast<size_t>(sampleCount) && tileIndex + 1 < tileCount()) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("波形分块%1只读到%2个样本，应为%3，不缓存")
+            .arg(tileIndex).arg(tile->sampleCount).arg(sampleCount));
+        startQueuedLoads();
+        return;
+    }
+
+    if (tile) {
+        m_tiles.insert(tileIndex, TileEntry{ tile, ++m_useCounter });
+        evictTiles();
+        emit signal_WF_TILE_tileReady(tileIndex);
+    }
+    else {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("波形分块%1读取失败").arg(tileIndex));
+    }
+
+    startQueuedLoads();
+}
+
+void WaveformTileSource::evictTiles()
+{
+    while (m_tiles.size() > m_maxTiles) {
+        auto oldest = m_tiles.begin();
+        for (auto it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_tiles.erase(oldest);
+    }
+}
+
+QSharedPointer<WaveformTile> WaveformTileSource::loadTile(DataAccessService* service, quint64 tileIndex, int sampleCount)
+{
+    const quint64 firstSample = tileIndex * TILE_SAMPLES;
+    const QVector<QByteArray> planes = service->readChannelSamples(firstSample, sampleCount);
+
+    // 末尾不足一个样本的字节只出现在前几个通道，按最短的通道截齐
+    int loadedSamples = planes.isEmpty() ? 0 : static_cast<int>(planes[0].size());
+    for (const QByteArray& plane : planes) {
+        loadedSamples = std::min(loadedSamples, static_cast<int>(plane.size()));
+    }
+    if (loadedSamples <= 0) {
+        return QSharedPointer<WaveformTile>();
+    }
+
+    QSharedPointer<WaveformTile> tile(new WaveformTile());
+    tile->firstSample = firstSample;
+    tile->sampleCount = static_cast<size_t>(loadedSamples);
+    for (int ch = 0; ch < ChannelDeinterleave::CHANNEL_COUNT; ++ch) {
+        tile->channels[ch].assignNonZero(reinterpret_cast<const uint8_t*>(planes[ch].constData()),
+            tile->sampleCount);
+        tile->pyramids[ch].build(tile->channels[ch]);
+    }
+    return tile;
+}
@@ -0,0 +1,155 @@
+﻿// Source/Analysis/WaveformTileSource.h
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include "ChannelDeinterleave.h"
+#include "LogicChannel.h"
+#include "WaveformPyramid.h"
+
+class DataAccessService;
+
+/**
+ * @brief 波形分块：固定样本数的4通道位压缩数据及其摘要
+ *
+ * 在后台线程中构建完成后只读，可被界面线程直接绘制。
+ */
+struct WaveformTile {
+    quint64 firstSample = 0;                                        ///< 第一个样本的全局位置
+    size_t sampleCount = 0;                                         ///< 样本数，最后一块可能不足TILE_SAMPLES
+    LogicChannel channels[ChannelDeinterleave::CHANNEL_COUNT];      ///< 各通道电平
+    WaveformPyramid pyramids[ChannelDeinterleave::CHANNEL_COUNT];   ///< 各通道摘要
+
+    /**
+     * @brief 占用的内存（字节）
+     */
+    size_t memoryBytes() const;
+};
+
+/**
+ * @brief 覆盖整个采集文件的分块波形数据源
+ *
+ * 文件按TILE_SAMPLES个样本切成固定大小的分块，按视图范围在后台线程池中异步读取，
+ * 已加载的分块按最近使用淘汰，常驻数量有上限，因此内存占用与文件大小无关。
+ * 尚未加载的分块由界面绘制为占位区域，加载完成后发出signal_WF_TILE_tileReady，不会阻塞界面。
+ *
+ * 除后台读取外，所有接口都只在界面线程调用；读取结果通过排队调用回到界面线程再放入缓存，
+ * 因此缓存本身不需要加锁。
+ */
+class WaveformTileSource : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int TILE_SAMPLES = 1 << 20;        ///< 每块样本数，原始数据4MB，压缩后约2MB(含摘要)
+    static constexpr int DEFAULT_MAX_TILES = 64;        ///< 默认常驻分块数
+    static constexpr int MAX_PARALLEL_LOADS = 2;        ///< 同时进行的读取数
+
+    explicit WaveformTileSource(QObject* parent = nullptr);
+    ~WaveformTileSource();
+
+    /**
+     * @brief 切换到新的采集文件，丢弃全部分块和未完成的请求
+     * @param totalSamples 文件的样本数，0表示没有可用文件
+     */
+    void reset(quint64 totalSamples);
+
+    /**
+     * @brief 更新样本数（实时保存时文件持续增长）
+     *
+     * 原来末尾不完整的分块会被丢弃，下次请求时重新读取。
+     */
+    void updateTotalSamples(quint64 totalSamples);
+
+    quint64 totalSamples() const { return m_totalSamples; }
+    bool isActive() const { return m_totalSamples > 0; }
+
+    /**
+     * @brief 分块总数
+     */
+    quint64 tileCount() const { return (m_totalSamples + TILE_SAMPLES - 1) / TILE_SAMPLES; }
+
+    /**
+     * @brief 样本所在的分块
+     */
+    static quint64 tileIndexOf(quint64 sample) { return sample / TILE_SAMPLES; }
+
+    /**
+     * @brief 请求覆盖样本区间[firstSample, lastSample]的分块
+     *
+     * 从区间中心向两侧排队，两端各多预读一块；之前排队但不在新区间内的请求被取消。
+     * 需要的分块多于常驻上限时只请求靠近中心的部分，其余继续显示占位。
+     */
+    void requestRange(quint64 firstSample, quint64 lastSample);
+
+    /**
+     * @brief 获取已加载的分块，并标记为最近使用
+     * @param tileIndex 分块序号
+     * @return 分块，尚未加载时为空
+     */
+    QSharedPointer<const WaveformTile> tile(quint64 tileIndex);
+
+    /**
+     * @brief 分块是否正在排队或读取
+     */
+    bool isPending(quint64 tileIndex) const;
+
+    /**
+     * @brief 设置常驻分块上限
+     */
+    void setMaxTiles(int maxTiles);
+
+    /**
+     * @brief 常驻分块占用的内存（字节）
+     */
+    size_t memoryBytes() const;
+
+signals:
+    /**
+     * @brief 分块加载完成信号
+     * @param tileIndex 分块序号
+     */
+    void signal_WF_TILE_tileReady(quint64 tileIndex);
+
+private:
+    struct TileEntry {
+        QSharedPointer<const WaveformTile> tile;    ///< 分块数据
+        quint64 lastUse = 0;                        ///< 最近使用序号
+    };
+
+    /**
+     * @brief 从队列中启动读取，直到达到并发上限
+     */
+    void startQueuedLoads();
+
+    /**
+     * @brief 后台读取完成，在界面线程中执行
+     * @param loadId 发出读取时的读取序号，与m_loading中的不一致说明结果已过期
+     * @param sampleCount 请求的样本数
+     */
+    void finishLoad(quint64 loadId, quint64 tileIndex, int sampleCount, QSharedPointer<WaveformTile> tile);
+
+    /**
+     * @brief 淘汰最久未使用的分块，直到不超过上限
+     */
+    void evictTiles();
+
+    /**
+     * @brief 读取并构建一个分块，在后台线程中执行
+     * @return 分块，读取失败时为空
+     */
+    static QSharedPointer<WaveformTile> loadTile(DataAccessService* service, quint64 tileIndex, int sampleCount);
+
+    QHash<quint64, TileEntry> m_tiles;      ///< 已加载的分块
+    QList<quint64> m_queue;                 ///< 等待读取的分块，按优先级排列
+    QHash<quint64, quint64> m_loading;      ///< 正在读取的分块到读取序号
+    QThreadPool m_loadPool;                 ///< 读取线程池
+    DataAccessService* m_dataService;       ///< 数据访问服务
+
+    quint64 m_totalSamples = 0;             ///< 文件样本数
+    quint64 m_loadCounter = 0;              ///< 读取序号计数
+    quint64 m_useCounter = 0;               ///< 最近使用计数
+    int m_maxTiles = DEFAULT_MAX_TILES;     ///< 常驻分块上限
+};
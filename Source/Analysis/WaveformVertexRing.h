@@ -0,0 +1,262 @@
+﻿// Source/Analysis/WaveformVertexRing.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include "LogicChannel.h"
+#include "WaveformPyramid.h"
+
+/**
+ * @brief 波形顶点，与着色器的position属性(vec2)对应
+ */
+struct WaveformVertex {
+    float x = 0.0f;         ///< 相对原点的样本位置
+    float level = 0.0f;     ///< 电平(0/1)，由着色器映射到通道的高低电平
+};
+
+/**
+ * @brief 单通道波形的分块环形顶点缓冲（CPU侧）
+ *
+ * 样本轴按chunkSamples个样本分块，chunkSamples取不小于CHUNK_PIXELS个像素所含样本数的2的幂，
+ * 缩放在2倍以内时保持不变。第c块的顶点固定放在第(c % slotCount)个槽中，
+ * 平移时只生成新露出的块并覆盖离开视图的块所在的槽，其余槽原样保留。
+ * 顶点x是相对原点的样本位置，到屏幕坐标的平移和缩放由着色器按xTransform完成，
+ * 所以纯平移、块大小不变的缩放都不需要重新上传已有的块。
+ *
+ * 每次update后dirtySlots()给出内容变化的槽，由调用方上传到GPU缓冲的对应区间；
+ * update返回true时槽数量或块大小变了，需要重新分配并整体上传。
+ * 不依赖Qt和OpenGL，顶点生成可以单独测试和计时。
+ */
+class WaveformVertexRing {
+public:
+    static constexpr int CHUNK_PIXELS = 32;                 ///< 每块在屏幕上至少占的像素数
+    static constexpr int SLOT_VERTICES = 1024;              ///< 每个槽的顶点容量
+    static constexpr int MARGIN_CHUNKS = 2;                 ///< 视图两侧预先生成的块数
+    static constexpr int64_t MAX_ORIGIN_DISTANCE = 1 << 16; ///< 块离原点超过此块数时重定原点，保证float精度
+
+    /**
+     * @brief 块的生成函数
+     *
+     * 参数依次为：块的第一个样本、最后一个样本（含，等于下一块的第一个样本，使相邻块首尾相连）、
+     * 生成时使用的像素宽度、输出折线顶点（样本坐标）。
+     * 返回false表示数据暂不可用，该块不绘制，下次update时重试。
+     */
+    using ChunkBuilder = std::function<bool(uint64_t, uint64_t, int, std::vector<WaveformTracePoint>&)>;
+
+    /**
+     * @brief 按视图生成缺少的块
+     * @param viewMin 视图最小样本位置
+     * @param viewMax 视图最大样本位置
+     * @param pixelWidth 视图宽度（像素）
+     * @param sampleCount 样本总数
+     * @param builder 块的生成函数
+     * @return 需要重新分配GPU缓冲时为true
+     */
+    bool update(double viewMin, double viewMax, int pixelWidth, uint64_t sampleCount, const ChunkBuilder& builder)
+    {
+        if (pixelWidth <= 0 || sampleCount == 0 || !(viewMax > viewMin)) {
+            m_rangeFirst = 0;
+            m_rangeLast = -1;
+            return false;
+        }
+
+        const double samplesPerPixel = (viewMax - viewMin) / pixelWidth;
+        uint64_t chunkSamples = 1;
+        while (static_cast<double>(chunkSamples) < CHUNK_PIXELS * samplesPerPixel) {
+            chunkSamples <<= 1;
+        }
+
+        // 视图最多跨pixelWidth / CHUNK_PIXELS + 2块，两侧再各留MARGIN_CHUNKS块
+        const int slotCount = pixelWidth / CHUNK_PIXELS + 2 + 2 * MARGIN_CHUNKS;
+        const int64_t lastChunk = static_cast<int64_t>((sampleCount - 1) / chunkSamples);
+        const double clampedMin = std::clamp(viewMin, 0.0, static_cast<double>(sampleCount - 1));
+        const double clampedMax = std::clamp(viewMax, 0.0, static_cast<double>(sampleCount - 1));
+        const int64_t first = std::max<int64_t>(0,
+            static_cast<int64_t>(clampedMin / static_cast<double>(chunkSamples)) - MARGIN_CHUNKS);
+        const int64_t last = std::min({ lastChunk,
+            static_cast<int64_t>(clampedMax / static_cast<double>(chunkSamples)) + MARGIN_CHUNKS,
+            first + slotCount - 1 });
+
+        bool reallocate = false;
+        if (chunkSamples != m_chunkSamples || slotCount != m_slotCount) {
+            m_chunkSamples = chunkSamples;
+            m_slotCount = slotCount;
+            m_slots.assign(static_cast<size_t>(slotCount), Slot());
+            m_vertices.assign(static_cast<size_t>(slotCount) * SLOT_VERTICES, WaveformVertex());
+            m_dirty.clear();
+            m_originChunk = first;
+            reallocate = true;
+        }
+        else if (sampleCount != m_sampleCount) {
+            // 文件增长或截短，原来末尾的块内容已变
+            const uint64_t changedFrom = std::min(sampleCount, m_sampleCount);
+            invalidateSamples(changedFrom > 0 ? changedFrom - 1 : 0, std::max(sampleCount, m_sampleCount));
+        }
+        m_sampleCount = sampleCount;
+
+        if (std::llabs(first - m_originChunk) > MAX_ORIGIN_DISTANCE) {
+            m_originChunk = first;
+            invalidate();
+        }
+
+        const double origin = static_cast<double>(m_originChunk) * static_cast<double>(m_chunkSamples);
+        for (int64_t chunk = first; chunk <= last; ++chunk) {
+            const int slotIndex = static_cast<int>(chunk % m_slotCount);
+            Slot& slot = m_slots[static_cast<size_t>(slotIndex)];
+            if (slot.chunk == chunk && slot.valid) {
+                continue;
+            }
+
+            const uint64_t chunkFirst = static_cast<uint64_t>(chunk) * m_chunkSamples;
+            const uint64_t chunkLast = std::min(chunkFirst + m_chunkSamples, sampleCount - 1);
+
+            m_points.clear();
+            slot.chunk = chunk;
+            slot.valid = builder(chunkFirst, chunkLast, 2 * CHUNK_PIXELS, m_points);
+            slot.vertexCount = slot.valid ? static_cast<int>(std::min<size_t>(m_points.size(), SLOT_VERTICES)) : 0;
+
+            WaveformVertex* out = m_vertices.data() + static_cast<size_t>(slotIndex) * SLOT_VERTICES;
+            for (int i = 0; i < slot.vertexCount; ++i) {
+                out[i].x = static_cast<float>(m_points[static_cast<size_t>(i)].sample - origin);
+                out[i].level = static_cast<float>(m_points[static_cast<size_t>(i)].level);
+            }
+
+            if (!slot.dirty) {
+                slot.dirty = true;
+                m_dirty.push_back(slotIndex);
+            }
+        }
+
+        m_rangeFirst = first;
+        m_rangeLast = last;
+        return reallocate;
+    }
+
+    /**
+     * @brief 数据整体变化，所有块在下次update时重新生成
+     */
+    void invalidate()
+    {
+        for (Slot& slot : m_slots) {
+            slot.valid = false;
+        }
+    }
+
+    /**
+     * @brief 样本区间[first, last]的数据变化，覆盖它的块在下次update时重新生成
+     */
+    void invalidateSamples(uint64_t first, uint64_t last)
+    {
+        if (m_chunkSamples == 0) {
+            return;
+        }
+        for (Slot& slot : m_slots) {
+            if (slot.chunk < 0) {
+                continue;
+            }
+            const uint64_t chunkFirst = static_cast<uint64_t>(slot.chunk) * m_chunkSamples;
+            if (chunkFirst <= last && chunkFirst + m_chunkSamples >= first) {
+                slot.valid = false;
+            }
+        }
+    }
+
+    /**
+     * @brief 清空全部内容
+     */
+    void clear()
+    {
+        m_slots.clear();
+        m_vertices.clear();
+        m_dirty.clear();
+        m_chunkSamples = 0;
+        m_slotCount = 0;
+        m_sampleCount = 0;
+        m_rangeFirst = 0;
+        m_rangeLast = -1;
+    }
+
+    int slotCount() const { return m_slotCount; }
+    int slotVertexCount(int slotIndex) const { return m_slots[static_cast<size_t>(slotIndex)].vertexCount; }
+    uint64_t chunkSamples() const { return m_chunkSamples; }
+
+    /**
+     * @brief 全部槽的顶点，第i个槽从i * SLOT_VERTICES开始
+     */
+    const std::vector<WaveformVertex>& vertices() const { return m_vertices; }
+
+    /**
+     * @brief 上次clearDirty之后内容变化的槽
+     */
+    const std::vector<int>& dirtySlots() const { return m_dirty; }
+
+    void clearDirty()
+    {
+        for (int slotIndex : m_dirty) {
+            m_slots[static_cast<size_t>(slotIndex)].dirty = false;
+        }
+        m_dirty.clear();
+    }
+
+    /**
+     * @brief 遍历当前范围内可绘制的块
+     * @param fn 回调，参数为(槽序号, 顶点数)，每块是一条独立的GL_LINE_STRIP
+     */
+    template <typename Fn>
+    void forEachDrawable(Fn&& fn) const
+    {
+        for (int64_t chunk = m_rangeFirst; chunk <= m_rangeLast; ++chunk) {
+            const int slotIndex = static_cast<int>(chunk % m_slotCount);
+            const Slot& slot = m_slots[static_cast<size_t>(slotIndex)];
+            if (slot.chunk == chunk && slot.valid && slot.vertexCount >= 2) {
+                fn(slotIndex, slot.vertexCount);
+            }
+        }
+    }
+
+    /**
+     * @brief 着色器中的x变换：ndcX = x * scale + offset
+     */
+    void xTransform(double viewMin, double viewMax, float& scale, float& offset) const
+    {
+        const double range = viewMax > viewMin ? viewMax - viewMin : 1.0;
+        const double origin = static_cast<double>(m_originChunk) * static_cast<double>(m_chunkSamples);
+        scale = static_cast<float>(2.0 / range);
+        offset = static_cast<float>((origin - viewMin) * 2.0 / range - 1.0);
+    }
+
+    /**
+     * @brief 生成一段通道数据的折线，原始样本的顶点数超过槽容量时改用第0层摘要
+     */
+    static void traceChannel(const LogicChannel& channel, const WaveformPyramid& pyramid,
+        size_t first, size_t last, int pixelWidth, std::vector<WaveformTracePoint>& points)
+    {
+        pyramid.trace(channel, first, last, pixelWidth, points);
+        if (points.size() > static_cast<size_t>(SLOT_VERTICES) && pyramid.levelCount() > 0) {
+            pyramid.traceLevel(channel, first, last, 0, points);
+        }
+    }
+
+private:
+    struct Slot {
+        int64_t chunk = -1;         ///< 槽中的块号
+        int vertexCount = 0;        ///< 顶点数
+        bool valid = false;         ///< 内容是否有效
+        bool dirty = false;         ///< 是否在m_dirty中
+    };
+
+    std::vector<Slot> m_slots;                  ///< 各槽状态
+    std::vector<WaveformVertex> m_vertices;     ///< 全部槽的顶点
+    std::vector<int> m_dirty;                   ///< 内容变化的槽
+    std::vector<WaveformTracePoint> m_points;   ///< 生成块时复用的缓冲
+    uint64_t m_chunkSamples = 0;                ///< 每块样本数
+    uint64_t m_sampleCount = 0;                 ///< 样本总数
+    int m_slotCount = 0;                        ///< 槽数量
+    int64_t m_originChunk = 0;                  ///< 原点所在的块
+    int64_t m_rangeFirst = 0;                   ///< 当前范围第一块
+    int64_t m_rangeLast = -1;                   ///< 当前范围最后一块
+};
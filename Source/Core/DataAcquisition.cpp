@@ -267,6 +267,9 @@ bool DataAcquisitionManager::startAcquisition(uint16_t width, uint16_t height, u
     m_rateStats.reset();
     m_totalBytes.store(0);
     m_dataRate.store(0.0);
+    if (m_processor) {
+        m_processor->resetStream();
+    }
 
     // 设置运行标志
     {
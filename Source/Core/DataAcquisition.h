@@ -42,6 +42,11 @@ public:
             processData(packet);
         }
     }
+
+    /**
+     * @brief 新的采集开始（在采集线程启动前调用，默认不处理）
+     */
+    virtual void resetStream() {}
 };
 
 /**
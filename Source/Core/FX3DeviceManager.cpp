@@ -2,6 +2,7 @@
 
 #include "FX3DeviceManager.h"
 #include "Logger.h"
+#include "LiveWaveformProcessor.h"
 #include <QThread>
 #include <QCoreApplication>
 #include <algorithm>
@@ -96,6 +97,9 @@ bool FX3DeviceManager::initializeDeviceAndManager(HWND windowHandle)
         // 创建采集管理器
         try {
             m_acquisitionManager = DataAcquisitionManager::create(m_usbDevice);
+
+            // 处理线程直接向实时波形缓冲送数据
+            m_acquisitionManager->setDataProcessor(LiveWaveformProcessor::getInstance());
         }
         catch (const std::exception& e) {
             handleCriticalError(
@@ -0,0 +1,25 @@
+﻿// Source/Core/LiveWaveformProcessor.cpp
+#include "LiveWaveformProcessor.h"
+
+std::shared_ptr<LiveWaveformProcessor> LiveWaveformProcessor::getInstance()
+{
+    static std::shared_ptr<LiveWaveformProcessor> instance(new LiveWaveformProcessor());
+    return instance;
+}
+
+void LiveWaveformProcessor::processData(const DataPacket& packet)
+{
+    m_ring.push(packet.getData(), packet.getSize());
+}
+
+void LiveWaveformProcessor::processBatchData(const DataPacketBatch& packets)
+{
+    for (const auto& packet : packets) {
+        m_ring.push(packet.getData(), packet.getSize());
+    }
+}
+
+void LiveWaveformProcessor::resetStream()
+{
+    m_ring.resetStream();
+}
@@ -0,0 +1,34 @@
+﻿// Source/Core/LiveWaveformProcessor.h
+#pragma once
+
+#include <memory>
+#include "DataAcquisition.h"
+#include "LiveWaveformRing.h"
+
+/**
+ * @brief 实时波形数据处理器
+ *
+ * 作为采集管理器的数据处理器，在处理线程中把每个数据包直接送入LiveWaveformRing，
+ * 不经过界面线程和文件。波形分析模块开启实时显示时才启用抽取，未启用时每包只累加字节数。
+ */
+class LiveWaveformProcessor : public IDataProcessor {
+public:
+    /**
+     * @brief 获取单例
+     */
+    static std::shared_ptr<LiveWaveformProcessor> getInstance();
+
+    /**
+     * @brief 实时波形环形缓冲
+     */
+    LiveWaveformRing& ring() { return m_ring; }
+
+    void processData(const DataPacket& packet) override;
+    void processBatchData(const DataPacketBatch& packets) override;
+    void resetStream() override;
+
+private:
+    LiveWaveformProcessor() = default;
+
+    LiveWaveformRing m_ring;    ///< 抽取环形缓冲
+};
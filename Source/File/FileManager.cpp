@@ -108,6 +108,17 @@ void FileManager::setUseAsyncWriter(bool useAsync)
     }
 }
 
+bool FileManager::setWriteObserver(std::shared_ptr<IWriteObserver> observer)
+{
+    if (m_running) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("保存过程中无法更换写入观察者"));
+        return false;
+    }
+
+    m_writeObserver = observer;
+    return true;
+}
+
 bool FileManager::createNewFile(const DataPacket& packet) {
     // 创建文件名
     QString filename = createFileName(packet);
@@ -604,6 +615,21 @@ void FileManager::resetFileWriter()
     }
 }
 
+void FileManager::closeCurrentFile(const std::shared_ptr<IWriteObserver>& observer)
+{
+    bool wasOpen = m_fileWriter->isOpen();
+    m_fileWriter->close();
+
+    if (wasOpen && observer && !m_currentFilePath.isEmpty()) {
+        uint64_t fileSize = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            fileSize = m_statistics.currentFileBytes;
+        }
+        observer->onFileClosed(m_currentFilePath, fileSize);
+    }
+}
+
 void FileManager::saveDataBatch(const DataPacketBatch& packets)
 {
     if (packets.empty()) {
@@ -1129,6 +1155,12 @@ void FileManager::saveThreadFunction()
     uint64_t bytesWrittenSinceLastUpdate = 0;
     speedCalculationTimer.start();
 
+    // 保存期间观察者不变，取一次引用即可
+    std::shared_ptr<IWriteObserver> observer = m_writeObserver;
+    if (observer) {
+        observer->onCaptureStarted(m_statistics.savePath);
+    }
+
     while (m_running) {
         bool hasBatch = false;
         bool hasPacket = false;
@@ -1189,7 +1221,7 @@ void FileManager::saveThreadFunction()
 
                 // Create new file (if necessary)
                 if (!m_fileWriter->isOpen() || shouldSplitFile()) {
-                    m_fileWriter->close(); // 确保关闭当前文件（如果有）
+                    closeCurrentFile(observer); // 确保关闭当前文件（如果有）
 
                     QString filename = createFileName(packet);
                     // 确保使用RAW扩展名
@@ -1215,10 +1247,20 @@ void FileManager::saveThreadFunction()
                     }
 
                     LOG_INFO(LocalQTCompat::fromLocal8Bit("已创建新文件: %1").arg(m_currentFilePath));
+
+                    if (observer) {
+                        observer->onFileOpened(m_currentFilePath);
+                    }
                 }
 
                 // 直接写入原始数据
                 if (!rawData.isEmpty()) {
+                    uint64_t writeOffset = 0;
+                    {
+                        std::lock_guard<std::mutex> lock(m_statsMutex);
+                        writeOffset = m_statistics.currentFileBytes;
+                    }
+
                     if (!m_fileWriter->write(rawData)) {
                         throw std::runtime_error(LocalQTCompat::fromLocal8Bit("写入文件失败: %1")
                             .arg(m_fileWriter->getLastError()).toStdString());
@@ -1233,6 +1275,11 @@ void FileManager::saveThreadFunction()
                         m_statistics.currentFileBytes += rawData.size();
                     }
 
+                    // 通知观察者数据的最终文件位置
+                    if (observer) {
+                        observer->onDataWritten(m_currentFilePath, writeOffset, rawData);
+                    }
+
                     // 累积写入字节数用于速率计算
                     bytesWrittenSinceLastUpdate += rawData.size();
 
@@ -1276,7 +1323,7 @@ void FileManager::saveThreadFunction()
             emit signal_FSM_saveError(LocalQTCompat::fromLocal8Bit("保存数据异常: %1").arg(e.what()));
 
             // Close file and reset
-            m_fileWriter->close();
+            closeCurrentFile(observer);
 
             // Short pause to avoid high load in error conditions
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -1284,7 +1331,11 @@ void FileManager::saveThreadFunction()
     }
 
     // Close current file
-    m_fileWriter->close();
+    closeCurrentFile(observer);
+
+    if (observer) {
+        observer->onCaptureStopped();
+    }
 
     // Save metadata
     saveMetadata();
@@ -99,6 +99,27 @@ public:
     virtual bool isOpen() const = 0;
 };
 
+// 写入观察者接口，在保存线程中按写入顺序回调，实现者不应阻塞
+class IWriteObserver {
+public:
+    virtual ~IWriteObserver() = default;
+
+    // 开始采集保存
+    virtual void onCaptureStarted(const QString& savePath) = 0;
+
+    // 新文件已打开
+    virtual void onFileOpened(const QString& filePath) = 0;
+
+    // 数据已写入文件，fileOffset为该段数据在文件中的起始偏移
+    virtual void onDataWritten(const QString& filePath, uint64_t fileOffset, const QByteArray& data) = 0;
+
+    // 文件已关闭
+    virtual void onFileClosed(const QString& filePath, uint64_t fileSize) = 0;
+
+    // 采集保存结束
+    virtual void onCaptureStopped() = 0;
+};
+
 // 标准文件写入器
 class WriterFileStandard : public IFileWriter {
 public:
@@ -199,6 +220,9 @@ public:
     // 暂停/恢复保存数据
     bool pauseSaving(bool pause);
 
+    // 是否正在保存数据（采集文件仍在增长）
+    bool isSaving() const { return m_running; }
+
     // 获取保存统计信息
     SaveStatistics getStatistics();
 
@@ -211,6 +235,9 @@ public:
     // 设置使用异步写入
     void setUseAsyncWriter(bool useAsync);
 
+    // 设置写入观察者（需在startSaving之前设置），保存过程中返回false
+    bool setWriteObserver(std::shared_ptr<IWriteObserver> observer);
+
     // 创建新文件
     bool createNewFile(const DataPacket& packet);
 
@@ -329,6 +356,9 @@ private:
     // 重置文件写入器
     void resetFileWriter();
 
+    // 关闭当前文件并通知写入观察者
+    void closeCurrentFile(const std::shared_ptr<IWriteObserver>& observer);
+
     void saveDataBatch(const DataPacketBatch& packets);
 
     // 文件加载线程函数
@@ -348,6 +378,7 @@ private:
     std::atomic<bool> m_useAsyncWriter;
 
     std::map<FileFormat, std::shared_ptr<IDataConverter>> m_converters;
+    std::shared_ptr<IWriteObserver> m_writeObserver;
     std::unique_ptr<DataCacheManager> m_cacheManager;
 
     std::thread m_saveThread;
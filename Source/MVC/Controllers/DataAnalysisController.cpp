@@ -5,6 +5,7 @@
 #include "ui_DataAnalysis.h"
 #include "DataAnalysisModel.h"
 #include "IndexGenerator.h"
+#include "ParallelIndexer.h"
 #include "Logger.h"
 
 #include <QFileDialog>
@@ -29,6 +30,7 @@ DataAnalysisController::DataAnalysisController(DataAnalysisView* view)
     , m_dataCounter(0)
     , m_isUpdatingTable(false)
     , m_isInitialized(false)
+    , m_parallelIndexer(new ParallelIndexer(this))
     , m_maxBatchSize(500)
     , m_processingData(false)
     , m_batchLoadPosition(0)
@@ -61,6 +63,7 @@ DataAnalysisController::~DataAnalysisController()
 {
     // 等待任何未完成的异步操作
     if (m_processWatcher.isRunning()) {
+        m_parallelIndexer->cancel();
         m_processWatcher.waitForFinished();
     }
 
@@ -111,6 +114,12 @@ void DataAnalysisController::connectSignals()
     connect(m_view, &DataAnalysisView::signal_DA_V_loadDataFromFileRequested,
         this, &DataAnalysisController::slot_DA_C_onLoadDataFromFileRequested);
 
+    // 连接并行索引进度与取消
+    connect(m_parallelIndexer, &ParallelIndexer::signal_PIDX_progressChanged,
+        m_view, &DataAnalysisView::slot_DA_V_updateProgressDialog, Qt::QueuedConnection);
+    connect(m_view, &DataAnalysisView::signal_DA_V_progressCanceled,
+        m_parallelIndexer, &ParallelIndexer::cancel);
+
     // 连接索引生成器信号
     connect(&IndexGenerator::getInstance(), &IndexGenerator::indexEntryAdded,
         this, &DataAnalysisController::slot_DA_C_onIndexEntryAdded, Qt::QueuedConnection);
@@ -295,60 +304,25 @@ bool DataAnalysisController::importData(const QString& filePath)
         );
     }
 
-    // 获取文件总大小用于进度计算
-    qint64 fileSize = file.size();
+    file.close();
 
     // 标记异步处理开始
     m_processingData = true;
     m_performanceTimer.restart();
 
-    // 创建异步处理任务
-    QFuture<int> future = QtConcurrent::run([this, selectedFilePath, fileSize]() -> int {
-        // 重新打开文件（在新线程中）
-        QFile threadFile(selectedFilePath);
-        if (!threadFile.open(QIODevice::ReadOnly)) {
-            LOG_ERROR(LocalQTCompat::fromLocal8Bit("线程中无法打开数据文件: %1").arg(threadFile.errorString()));
-            return 0;
-        }
-
-        // 使用更大的缓冲区提高性能
-        constexpr qint64 THREAD_BUFFER_SIZE = 4 * 1024 * 1024; // 4MB缓冲区
-        QByteArray buffer;
-        qint64 totalRead = 0;
-        int totalPackets = 0;
-        QString fileName = QFileInfo(selectedFilePath).fileName();
-
-        // 读取并处理数据块
-        while (!threadFile.atEnd()) {
-            buffer = threadFile.read(THREAD_BUFFER_SIZE);
-            if (buffer.isEmpty()) {
-                break;
-            }
-
-            // 使用IndexGenerator的parseDataStream方法分析和索引数据
-            int packetsFound = IndexGenerator::getInstance().parseDataStream(
-                reinterpret_cast<const uint8_t*>(buffer.constData()),
-                buffer.size(),
-                totalRead
-            );
-
-            totalPackets += packetsFound;
-            totalRead += buffer.size();
+    // 基准时间戳在UI线程中取一次，保证并行与顺序索引结果一致
+    uint64_t baseTimestamp = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()) * 1000000;
 
-            // 更新进度
-            if (fileSize > 0) {
-                int progress = static_cast<int>((totalRead * 100) / fileSize);
+    // 创建异步处理任务，文件按块并行扫描后按顺序合并
+    QFuture<int> future = QtConcurrent::run([this, selectedFilePath, baseTimestamp]() -> int {
+        QVector<PacketIndexEntry> entries = m_parallelIndexer->indexFile(selectedFilePath, baseTimestamp);
 
-                // 使用Qt元对象系统在UI线程中更新进度
-                QMetaObject::invokeMethod(this, [this, progress]() {
-                    if (m_view) {
-                        m_view->slot_DA_V_updateProgressDialog(progress);
-                    }
-                    }, Qt::QueuedConnection);
-            }
+        if (m_parallelIndexer->isCanceled()) {
+            LOG_INFO(LocalQTCompat::fromLocal8Bit("用户取消了数据导入: %1").arg(selectedFilePath));
+            return 0;
         }
 
-        threadFile.close();
+        int totalPackets = IndexGenerator::getInstance().addIndexEntries(entries);
 
         // 强制保存索引
         IndexGenerator::getInstance().saveIndex(true);
@@ -386,11 +360,11 @@ bool DataAnalysisController::exportData(const QString& filePath, bool selectedRo
     QVector<PacketIndexEntry> entries;
 
     if (selectedRowsOnly && !m_selectedRows.isEmpty()) {
-        // 只导出选中的行
-        QVector<PacketIndexEntry> allEntries = IndexGenerator::getInstance().getAllIndexEntries();
+        // 只导出选中的行，通过快照按位置读取，不复制整个索引
+        const IndexSnapshot snapshot = IndexGenerator::getInstance().getSnapshot();
         for (int row : m_selectedRows) {
-            if (row >= 0 && row < allEntries.size()) {
-                entries.append(allEntries[row]);
+            if (row >= 0 && row < snapshot.size()) {
+                entries.append(snapshot.at(row));
             }
         }
     }
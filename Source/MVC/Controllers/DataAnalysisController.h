@@ -15,6 +15,7 @@
 
 class DataAnalysisView;
 class DataAnalysisModel;
+class ParallelIndexer;
 namespace Ui { class DataAnalysisClass; }
 struct DataPacket;
 struct PacketIndexEntry;
@@ -262,6 +263,7 @@ private:
     bool m_isInitialized;                         ///< 初始化标志
 
     QFutureWatcher<int> m_processWatcher;         ///< 异步处理监视器
+    ParallelIndexer* m_parallelIndexer;           ///< 文件并行索引器
     QFutureWatcher<void> m_loadWatcher;           ///< 加载数据监视器
     QFileSystemWatcher m_fileWatcher;             ///< 文件监视器
     QElapsedTimer m_performanceTimer;             ///< 性能计时器
@@ -2,6 +2,7 @@
 #include "FileOperationController.h"
 #include "Logger.h"
 #include <QDir>
+#include <QFileInfo>
 #include <QDateTime>
 #include <QMessageBox>
 #include <QThread>
@@ -455,12 +456,31 @@ void FileOperationController::slot_FO_C_seekTo(uint64_t position) {
     m_model->seekTo(position);
 }
 
+QString FileOperationController::waveformFilePath() const {
+    if (!m_initialized || (!slot_FO_C_isLoading() && !isSaving())) {
+        return QString();
+    }
+    return m_model->getCurrentFileName();
+}
+
 uint64_t FileOperationController::slot_FO_C_getTotalFileSize() const {
-    if (!m_initialized || !slot_FO_C_isLoading()) {
+    if (!m_initialized) {
         return 0;
     }
 
-    return m_model->getTotalFileSize();
+    if (slot_FO_C_isLoading()) {
+        return m_model->getTotalFileSize();
+    }
+
+    // 实时保存时返回当前保存文件已写入的大小，与slot_FO_C_getWaveformData的数据来源一致
+    if (isSaving()) {
+        const QString currentSavePath = m_model->getCurrentFileName();
+        if (!currentSavePath.isEmpty()) {
+            return static_cast<uint64_t>(QFileInfo(currentSavePath).size());
+        }
+    }
+
+    return 0;
 }
 
 QByteArray FileOperationController::slot_FO_C_getFileData(uint64_t startOffset, uint64_t size) {
@@ -45,6 +45,12 @@ public:
      */
     bool isSaving() const;
 
+    /**
+     * @brief 波形数据所在的文件：加载时为加载的文件，实时保存时为当前保存文件
+     * @return 文件路径，既未加载也未保存时为空
+     */
+    QString waveformFilePath() const;
+
     /**
      * @brief 设置图像参数
      * @param width 图像宽度
@@ -150,7 +156,7 @@ public slots:
 
     /**
      * @brief 获取文件总大小
-     * @return 文件大小
+     * @return 加载中的文件大小；实时保存时为保存文件的当前大小
      */
     uint64_t slot_FO_C_getTotalFileSize() const;
 
@@ -5,8 +5,14 @@
 #include "VideoDisplayModel.h"
 #include "Logger.h"
 #include "DataAccessService.h"
+#include "FileManager.h"
+#include "BayerDemosaic.h"
 // #include "VideoDataProcessor.h"
 #include <QMessageBox>
+#include <QElapsedTimer>
+#include <QListWidget>
+#include <QPixmap>
+#include <algorithm>
 
 VideoDisplayController::VideoDisplayController(VideoDisplayView* view)
     : QObject(view)
@@ -26,9 +32,23 @@ VideoDisplayController::VideoDisplayController(VideoDisplayView* view)
 
     // 创建播放定时器
     m_playbackTimer = new QTimer(this);
+    m_playbackTimer->setTimerType(Qt::PreciseTimer);
     connect(m_playbackTimer, &QTimer::timeout, this,
         &VideoDisplayController::slot_VD_C_onPlaybackTimerTimeout);
 
+    // 创建预解码流水线，读取和解码都在后台完成
+    m_framePipeline = new VideoFramePipeline(this);
+    m_framePipeline->setDecodeParameters(decodeParameters(m_model->getConfig()));
+    connect(m_framePipeline, &VideoFramePipeline::signal_VD_PIPE_frameReady, this,
+        &VideoDisplayController::slot_VD_C_onFrameReady);
+    connect(m_framePipeline, &VideoFramePipeline::signal_VD_PIPE_statisticsChanged, this,
+        &VideoDisplayController::slot_VD_C_onPipelineStatisticsChanged);
+
+    // 创建缩略图条生成器
+    m_thumbnailGenerator = new VideoThumbnailGenerator(this);
+    connect(m_thumbnailGenerator, &VideoThumbnailGenerator::signal_VD_THUMB_thumbnailReady, this,
+        &VideoDisplayController::slot_VD_C_onThumbnailReady);
+
     // 初始化命令类型列表
     m_commandTypes = {
         {0x00, "默认"},
@@ -215,19 +235,9 @@ int VideoDisplayController::loadFramesByCommandType(uint8_t commandType, int lim
         .arg(commandType, 2, 16, QChar('0'))
         .arg(limit));
 
-    // 使用DataAccessService查询指定命令类型的数据包
-    QVector<PacketIndexEntry> entries;
-
     try {
-        // 创建查询
-        IndexQuery query;
-        query.featureFilters.append(QString("commandType=%1").arg(commandType));
-        if (limit > 0) {
-            query.limit = limit;
-        }
-
-        // 执行查询
-        entries = DataAccessService::getInstance().getIndexAccess()->queryIndex(query);
+        // 在帧表中取该指令类型的帧，不查询和复制索引条目
+        const VideoFrameView entries(currentFrameTable(), commandType, 0, UINT64_MAX, limit > 0 ? limit : -1);
 
         if (entries.isEmpty()) {
             LOG_WARN(QString("未找到命令类型为 0x%1 的数据包").arg(commandType, 2, 16, QChar('0')));
@@ -239,7 +249,10 @@ int VideoDisplayController::loadFramesByCommandType(uint8_t commandType, int lim
             .arg(commandType, 2, 16, QChar('0')));
 
         // 更新模型
+        m_framePipeline->setFrames(entries);
+        m_presentedFrameIndex = -1;
         m_model->setLoadedFrames(entries);
+        startThumbnailStrip();
 
         // 加载第一帧
         if (!entries.isEmpty()) {
@@ -269,23 +282,11 @@ int VideoDisplayController::loadFramesByTimeRange(uint64_t startTime, uint64_t e
     LOG_INFO(QString("加载时间范围 %1 - %2 的帧数据")
         .arg(startTime).arg(endTime));
 
-    // 使用DataAccessService查询指定时间范围的数据包
-    QVector<PacketIndexEntry> entries;
-
     try {
-        // 创建查询
-        IndexQuery query;
-        query.timestampStart = startTime;
-        query.timestampEnd = endTime;
-
-        // 如果设置了命令类型过滤
+        // 如果设置了命令类型过滤，在该类型的帧中二分查找时间范围
         VideoConfig config = m_model->getConfig();
-        if (config.commandType > 0) {
-            query.featureFilters.append(QString("commandType=%1").arg(config.commandType));
-        }
-
-        // 执行查询
-        entries = DataAccessService::getInstance().getIndexAccess()->queryIndex(query);
+        const int commandType = config.commandType > 0 ? config.commandType : VideoFrameTable::ALL_COMMAND_TYPES;
+        const VideoFrameView entries(currentFrameTable(), commandType, startTime, endTime);
 
         if (entries.isEmpty()) {
             LOG_WARN(QString("未找到时间范围 %1 - %2 内的数据包")
@@ -296,7 +297,10 @@ int VideoDisplayController::loadFramesByTimeRange(uint64_t startTime, uint64_t e
         LOG_INFO(QString("找到 %1 个时间范围内的数据包").arg(entries.size()));
 
         // 更新模型
+        m_framePipeline->setFrames(entries);
+        m_presentedFrameIndex = -1;
         m_model->setLoadedFrames(entries);
+        startThumbnailStrip();
 
         // 加载第一帧
         if (!entries.isEmpty()) {
@@ -315,6 +319,50 @@ int VideoDisplayController::loadFramesByTimeRange(uint64_t startTime, uint64_t e
     }
 }
 
+std::shared_ptr<const VideoFrameTable> VideoDisplayController::currentFrameTable()
+{
+    const IndexSnapshot snapshot = IndexGenerator::getInstance().getSnapshot();
+    if (snapshot.isEmpty()) {
+        m_frameTable.reset();
+        return m_frameTable;
+    }
+
+    const QString captureFile = snapshot.at(0).fileName;
+    const QString tablePath = VideoFrameTable::tablePathFor(captureFile);
+    const bool capturing = FileManager::instance().isSaving();
+
+    if (m_frameTable && m_frameTable->primaryFile() == captureFile) {
+        if (m_frameTable->sourceCount() == snapshot.size() && !(m_frameTableUnsaved && !capturing)) {
+            return m_frameTable;
+        }
+
+        // 同一采集的索引增长：只转换新增条目；采集结束后按最终文件大小保存一次
+        std::shared_ptr<const VideoFrameTable> table = VideoFrameTable::extend(*m_frameTable, snapshot);
+        m_frameTableUnsaved = capturing;
+        if (table && !capturing) {
+            table->save(tablePath);
+        }
+        m_frameTable = table;
+        return m_frameTable;
+    }
+
+    // 重新打开同一采集时直接读入保存的帧表；文件有变化时重建。采集进行中保存的表必然过期，不读也不写
+    std::shared_ptr<const VideoFrameTable> table = capturing ? nullptr : VideoFrameTable::load(tablePath);
+    if (!table || table->sourceCount() != snapshot.size() || table->primaryFile() != captureFile) {
+        QElapsedTimer timer;
+        timer.start();
+        table = VideoFrameTable::build(snapshot);
+        LOG_INFO(QString("视频帧表建立耗时: %1 毫秒").arg(timer.elapsed()));
+        if (table && !capturing) {
+            table->save(tablePath);
+        }
+    }
+
+    m_frameTable = table;
+    m_frameTableUnsaved = capturing;
+    return m_frameTable;
+}
+
 bool VideoDisplayController::setCurrentFrame(int index)
 {
     if (!m_model || !m_model->setCurrentFrameIndex(index)) {
@@ -415,15 +463,16 @@ void VideoDisplayController::slot_VD_C_onStartButtonClicked()
     }
     else {
         // 加载默认帧（时间最早的几帧）
-        IndexQuery query;
-        query.limit = 100;
-        auto entries = DataAccessService::getInstance().getIndexAccess()->queryIndex(query);
+        const VideoFrameView entries(currentFrameTable(), VideoFrameTable::ALL_COMMAND_TYPES, 0, UINT64_MAX, 100);
         if (entries.isEmpty()) {
             QMessageBox::warning(m_view, "加载失败", "未找到可显示的数据包");
             return;
         }
 
+        m_framePipeline->setFrames(entries);
+        m_presentedFrameIndex = -1;
         m_model->setLoadedFrames(entries);
+        startThumbnailStrip();
         m_model->setCurrentFrameIndex(0);
         loadCurrentFrameData();
     }
@@ -507,15 +556,10 @@ void VideoDisplayController::slot_VD_C_onColorModeChanged(int index)
 
     LOG_INFO(QString("色彩模式已更改为: %1").arg(m_ui->comboBox_2->currentText()));
 
-    // 更新模型
+    // 更新模型，预解码流水线随配置变化重新解码
     VideoConfig config = m_model->getConfig();
     config.colorMode = index;
     m_model->setConfig(config);
-
-    // 如果正在显示，更新渲染
-    if (config.isRunning) {
-        renderVideoFrame();
-    }
 }
 
 void VideoDisplayController::slot_VD_C_onDataModeChanged(int index)
@@ -540,15 +584,50 @@ void VideoDisplayController::slot_VD_C_onColorArrangementChanged(int index)
 
     LOG_INFO(QString("色彩排布已更改为: %1").arg(m_ui->comboBox_4->currentText()));
 
-    // 更新模型
+    // 更新模型，预解码流水线随配置变化重新解码
     VideoConfig config = m_model->getConfig();
     config.colorArrangement = index;
     m_model->setConfig(config);
+}
 
-    // 如果正在显示，更新渲染
-    if (config.isRunning) {
-        renderVideoFrame();
+void VideoDisplayController::slot_VD_C_onDemosaicMethodChanged(int index)
+{
+    if (m_isBatchUpdate || !m_model) {
+        return;
+    }
+
+    LOG_INFO(QString("去马赛克方法已更改为: %1").arg(m_ui->cmbDemosaicMethod->currentText()));
+
+    // 更新模型，预解码流水线随配置变化重新解码
+    VideoConfig config = m_model->getConfig();
+    config.demosaicMethod = index;
+    m_model->setConfig(config);
+}
+
+void VideoDisplayController::slot_VD_C_onBayerPatternChanged(int index)
+{
+    if (m_isBatchUpdate || !m_model) {
+        return;
     }
+
+    LOG_INFO(QString("拜耳排列已更改为: %1").arg(m_ui->cmbBayerPattern->currentText()));
+
+    VideoConfig config = m_model->getConfig();
+    config.bayerPattern = index;
+    m_model->setConfig(config);
+}
+
+void VideoDisplayController::slot_VD_C_onToneMapToggled(bool enabled)
+{
+    if (m_isBatchUpdate || !m_model) {
+        return;
+    }
+
+    LOG_INFO(QString("色调映射已%1").arg(enabled ? "启用" : "关闭"));
+
+    VideoConfig config = m_model->getConfig();
+    config.toneMap = enabled;
+    m_model->setConfig(config);
 }
 
 void VideoDisplayController::slot_VD_C_onVirtualChannelChanged(int index)
@@ -742,18 +821,32 @@ void VideoDisplayController::slot_VD_C_onSpeedChanged(int value)
 
 void VideoDisplayController::slot_VD_C_onPlaybackTimerTimeout()
 {
-    // 移动到下一帧
-    if (!moveToNextFrame()) {
-        // 如果无法移动到下一帧，检查是否到达末尾
-        if (m_model && m_model->getCurrentFrameIndex() == m_model->getTotalFrames() - 1) {
-            // 循环播放 - 返回第一帧
-            setCurrentFrame(0);
-        }
+    if (!m_model || m_model->getTotalFrames() == 0) {
+        return;
     }
+
+    // 到达末尾时循环播放，返回第一帧
+    const int nextIndex = (m_model->getCurrentFrameIndex() + 1) % m_model->getTotalFrames();
+
+    // 定时器只切换已解码的帧；解码没跟上时保持当前帧，不在界面线程等待
+    if (!m_framePipeline->isReady(nextIndex)) {
+        return;
+    }
+
+    setCurrentFrame(nextIndex);
 }
 
 void VideoDisplayController::slot_VD_C_onConfigChanged(const VideoConfig& config)
 {
+    // 解码参数变化时预解码的帧全部作废，重新解码并显示当前帧
+    if (m_framePipeline->setDecodeParameters(decodeParameters(config))) {
+        m_pendingFrameIndex = -1;
+        if (m_model && m_model->getCurrentFrameIndex() >= 0) {
+            loadCurrentFrameData();
+            startThumbnailStrip();
+        }
+    }
+
     // 更新UI
     m_isBatchUpdate = true;
     applyModelToUI();
@@ -793,6 +886,13 @@ void VideoDisplayController::slot_VD_C_onCurrentFrameChanged(int index, int tota
         // 更新播放控制状态
         m_ui->btnPrevFrame->setEnabled(index > 0);
         m_ui->btnNextFrame->setEnabled(index < total - 1);
+
+        // 缩略图条跟随当前帧
+        const int row = index / m_thumbnailGenerator->step();
+        if (index >= 0 && row < m_ui->listThumbnails->count()) {
+            m_ui->listThumbnails->setCurrentRow(row);
+            m_ui->listThumbnails->scrollToItem(m_ui->listThumbnails->item(row));
+        }
     }
 
     // 重绘视图
@@ -815,6 +915,68 @@ void VideoDisplayController::slot_VD_C_onCurrentEntryChanged(const PacketIndexEn
     loadCurrentFrameData();
 }
 
+void VideoDisplayController::slot_VD_C_onFrameReady(int index)
+{
+    if (!m_model || index != m_pendingFrameIndex || index != m_model->getCurrentFrameIndex()) {
+        return;
+    }
+
+    m_pendingFrameIndex = -1;
+    m_model->setRenderImage(m_framePipeline->frame(index));
+}
+
+void VideoDisplayController::slot_VD_C_onPipelineStatisticsChanged(int readyAhead, double averageDecodeMs)
+{
+    if (m_ui) {
+        m_ui->lblFrameCounter->setToolTip(QString("预解码: %1帧, 平均解码耗时: %2毫秒")
+            .arg(readyAhead).arg(averageDecodeMs, 0, 'f', 1));
+    }
+}
+
+void VideoDisplayController::slot_VD_C_onThumbnailReady(int frameIndex, const QImage& thumbnail)
+{
+    if (!m_ui) {
+        return;
+    }
+
+    QListWidgetItem* item = m_ui->listThumbnails->item(frameIndex / m_thumbnailGenerator->step());
+    if (item && item->data(Qt::UserRole).toInt() == frameIndex) {
+        item->setIcon(QIcon(QPixmap::fromImage(thumbnail)));
+    }
+}
+
+void VideoDisplayController::slot_VD_C_onThumbnailClicked(QListWidgetItem* item)
+{
+    if (!item) {
+        return;
+    }
+
+    const int frameIndex = item->data(Qt::UserRole).toInt();
+    LOG_INFO(QString("从缩略图条跳转到第 %1 帧").arg(frameIndex + 1));
+    setCurrentFrame(frameIndex);
+}
+
+void VideoDisplayController::startThumbnailStrip()
+{
+    if (!m_ui || !m_model) {
+        return;
+    }
+
+    // 帧数多时加大取帧间隔，缩略图数不超过MAX_STRIP_THUMBNAILS
+    const VideoFrameView frames = m_model->getLoadedFrames();
+    const int step = std::max(1, (frames.size() + MAX_STRIP_THUMBNAILS - 1) / MAX_STRIP_THUMBNAILS);
+
+    QListWidget* strip = m_ui->listThumbnails;
+    strip->clear();
+    for (int frameIndex = 0; frameIndex < frames.size(); frameIndex += step) {
+        QListWidgetItem* item = new QListWidgetItem(QString("#%1").arg(frameIndex + 1), strip);
+        item->setData(Qt::UserRole, frameIndex);
+        item->setToolTip(QString("第 %1 帧，时间戳: %2").arg(frameIndex + 1).arg(frames.at(frameIndex).timestamp));
+    }
+
+    m_thumbnailGenerator->start(frames, decodeParameters(m_model->getConfig()), step);
+}
+
 void VideoDisplayController::connectSignals()
 {
     if (!m_ui || !m_model) {
@@ -835,6 +997,18 @@ void VideoDisplayController::connectSignals()
     connect(m_ui->comboBox_4, QOverload<int>::of(&QComboBox::currentIndexChanged),
         this, &VideoDisplayController::slot_VD_C_onColorArrangementChanged);
 
+    // 去马赛克
+    connect(m_ui->cmbDemosaicMethod, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &VideoDisplayController::slot_VD_C_onDemosaicMethodChanged);
+    connect(m_ui->cmbBayerPattern, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, &VideoDisplayController::slot_VD_C_onBayerPatternChanged);
+    connect(m_ui->chkToneMap, &QCheckBox::toggled,
+        this, &VideoDisplayController::slot_VD_C_onToneMapToggled);
+
+    // 缩略图条
+    connect(m_ui->listThumbnails, &QListWidget::itemClicked,
+        this, &VideoDisplayController::slot_VD_C_onThumbnailClicked);
+
     // 虚拟通道
     connect(m_ui->comboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
         this, &VideoDisplayController::slot_VD_C_onVirtualChannelChanged);
@@ -921,6 +1095,13 @@ void VideoDisplayController::updateUIState()
     m_ui->comboBox_4->setEnabled(!isRunning);
     m_ui->comboBox->setEnabled(!isRunning);
 
+    // 去马赛克只对RAW格式有效，开启后按RGB解码的色彩模式和排布不再起作用
+    const bool isRawFormat = BayerDemosaic::rawBitsOf(config.format) != 0;
+    const bool demosaicEnabled = isRawFormat && config.demosaicMethod > 0;
+    m_ui->cmbDemosaicMethod->setEnabled(!isRunning && isRawFormat);
+    m_ui->cmbBayerPattern->setEnabled(!isRunning && demosaicEnabled);
+    m_ui->chkToneMap->setEnabled(!isRunning && demosaicEnabled);
+
     // 新增UI控件状态
     m_ui->cmbCommandType->setEnabled(!isRunning);
     m_ui->txtStartTime->setReadOnly(isRunning);
@@ -1017,6 +1198,11 @@ void VideoDisplayController::applyModelToUI()
     // 设置色彩排布
     m_ui->comboBox_4->setCurrentIndex(config.colorArrangement);
 
+    // 设置去马赛克
+    m_ui->cmbDemosaicMethod->setCurrentIndex(config.demosaicMethod);
+    m_ui->cmbBayerPattern->setCurrentIndex(config.bayerPattern);
+    m_ui->chkToneMap->setChecked(config.toneMap);
+
     // 设置虚拟通道
     m_ui->comboBox->setCurrentIndex(config.virtualChannel);
 
@@ -1073,6 +1259,11 @@ void VideoDisplayController::applyUIToModel()
     // 获取色彩排布
     config.colorArrangement = m_ui->comboBox_4->currentIndex();
 
+    // 获取去马赛克设置
+    config.demosaicMethod = m_ui->cmbDemosaicMethod->currentIndex();
+    config.bayerPattern = m_ui->cmbBayerPattern->currentIndex();
+    config.toneMap = m_ui->chkToneMap->isChecked();
+
     // 获取虚拟通道
     config.virtualChannel = m_ui->comboBox->currentIndex();
 
@@ -1149,7 +1340,7 @@ void VideoDisplayController::renderVideoFrame()
     }
 
     // 更新模型中的渲染图像
-    m_model->setRenderImage(image);
+    m_model->setRenderImage(std::move(image));
 }
 
 QImage VideoDisplayController::decodeRawData(const QByteArray& data)
@@ -1158,105 +1349,22 @@ QImage VideoDisplayController::decodeRawData(const QByteArray& data)
         return QImage();
     }
 
-    // 获取当前配置
-    VideoConfig config = m_model->getConfig();
-
-    // 创建目标图像
-    QImage image(config.width, config.height, QImage::Format_RGB888);
-
-    // 根据色彩模式确定每像素字节数
-    int bytesPerPixel = 3; // 默认24位RGB
-
-    switch (config.colorMode) {
-    case 0: // 36Bit RGB
-        bytesPerPixel = 5; // 实际是4.5字节，向上取整
-        break;
-    case 1: // 30Bit RGB
-        bytesPerPixel = 4; // 实际是3.75字节，向上取整
-        break;
-    case 2: // 24Bit RGB
-        bytesPerPixel = 3;
-        break;
-    case 3: // 18Bit RGB
-        bytesPerPixel = 3; // 实际是2.25字节，向上取整
-        break;
-    case 4: // 16Bit RGB
-        bytesPerPixel = 2;
-        break;
-    default:
-        bytesPerPixel = 3;
-        break;
-    }
-
-    // 检查数据量是否足够
-    int totalPixels = config.width * config.height;
-    int requiredBytes = totalPixels * bytesPerPixel;
-
-    if (data.size() < requiredBytes) {
-        LOG_WARN(QString("数据量不足以填充完整图像: 需要%1字节，实际%2字节")
-            .arg(requiredBytes).arg(data.size()));
-
-        // 用黑色填充的图像
-        image.fill(Qt::black);
-        return image;
-    }
-
-    // 填充图像数据
-    for (int y = 0; y < config.height; y++) {
-        for (int x = 0; x < config.width; x++) {
-            int pixelOffset = (y * config.width + x) * bytesPerPixel;
-
-            if (pixelOffset + 2 < data.size()) {
-                // 根据不同的色彩模式处理
-                if (bytesPerPixel >= 3) {
-                    // 24位以上的RGB模式
-                    uchar r = static_cast<uchar>(data[pixelOffset]);
-                    uchar g = static_cast<uchar>(data[pixelOffset + 1]);
-                    uchar b = static_cast<uchar>(data[pixelOffset + 2]);
-
-                    // 根据色彩排布交换RGB顺序
-                    switch (config.colorArrangement) {
-                    case 0: // R-G-B
-                        break; // 默认顺序，不需要交换
-                    case 1: // R-B-G
-                        std::swap(g, b);
-                        break;
-                    case 2: // G-B-R
-                        std::swap(r, g);
-                        std::swap(g, b);
-                        break;
-                    case 3: // G-R-B
-                        std::swap(r, g);
-                        break;
-                    case 4: // B-G-R
-                        std::swap(r, b);
-                        break;
-                    case 5: // B-R-G
-                        std::swap(r, b);
-                        std::swap(g, b);
-                        break;
-                    }
-
-                    image.setPixelColor(x, y, QColor(r, g, b));
-                }
-                else if (bytesPerPixel == 2) {
-                    // 16位RGB模式 (假设是5-6-5格式)
-                    uchar b1 = static_cast<uchar>(data[pixelOffset]);
-                    uchar b2 = static_cast<uchar>(data[pixelOffset + 1]);
-
-                    // 从16位值提取RGB分量
-                    int value = (b2 << 8) | b1;
-                    int r = ((value >> 11) & 0x1F) << 3;
-                    int g = ((value >> 5) & 0x3F) << 2;
-                    int b = (value & 0x1F) << 3;
-
-                    image.setPixelColor(x, y, QColor(r, g, b));
-                }
-            }
-        }
-    }
+    return VideoFramePipeline::decodeFrame(data, decodeParameters(m_model->getConfig()),
+        m_framePipeline->bufferPool());
+}
 
-    return image;
+VideoDecodeParameters VideoDisplayController::decodeParameters(const VideoConfig& config)
+{
+    VideoDecodeParameters parameters;
+    parameters.width = config.width;
+    parameters.height = config.height;
+    parameters.colorMode = config.colorMode;
+    parameters.colorArrangement = config.colorArrangement;
+    parameters.rawBits = BayerDemosaic::rawBitsOf(config.format);
+    parameters.demosaicMethod = parameters.rawBits != 0 ? config.demosaicMethod : 0;
+    parameters.bayerPattern = config.bayerPattern;
+    parameters.toneMap = config.toneMap;
+    return parameters;
 }
 
 bool VideoDisplayController::loadCurrentFrameData()
@@ -1267,35 +1375,29 @@ bool VideoDisplayController::loadCurrentFrameData()
 
     // 获取当前索引条目
     PacketIndexEntry entry = m_model->getCurrentEntry();
-    if (entry.fileName.isEmpty() || entry.size == 0) {
+    const int index = m_model->getCurrentFrameIndex();
+    if (entry.fileName.isEmpty() || entry.size == 0 || index < 0) {
         LOG_WARN("当前索引条目无效，无法加载帧数据");
         return false;
     }
 
-    try {
-        // 使用DataAccessService读取数据
-        QByteArray data = DataAccessService::getInstance().readPacketData(entry);
-
-        if (data.isEmpty()) {
-            LOG_ERROR(QString("读取帧数据失败: 文件=%1, 偏移=%2, 大小=%3")
-                .arg(entry.fileName)
-                .arg(entry.fileOffset)
-                .arg(entry.size));
-            return false;
-        }
-
-        // 更新模型中的帧数据
-        m_model->setFrameData(data);
-
-        // 渲染新帧
-        renderVideoFrame();
+    // 按移动方向预解码，从末尾循环到开头仍按向后处理
+    const int total = m_model->getTotalFrames();
+    const bool wrappedForward = index == 0 && m_presentedFrameIndex == total - 1;
+    const int direction = (index >= m_presentedFrameIndex || wrappedForward) ? 1 : -1;
+    m_presentedFrameIndex = index;
+    m_framePipeline->setCurrentFrame(index, direction);
 
+    QImage image = m_framePipeline->frame(index);
+    if (image.isNull()) {
+        // 尚未解码，完成后显示
+        m_pendingFrameIndex = index;
         return true;
     }
-    catch (const std::exception& e) {
-        LOG_ERROR(QString("加载帧数据异常: %1").arg(e.what()));
-        return false;
-    }
+
+    m_pendingFrameIndex = -1;
+    m_model->setRenderImage(std::move(image));
+    return true;
 }
 
 void VideoDisplayController::updatePlaybackControls()
@@ -8,8 +8,11 @@
 #include <QTimer>
 #include "DataAccessService.h"
 #include "IIndexAccess.h"
+#include "VideoFramePipeline.h"
+#include "VideoThumbnailGenerator.h"
 
 class VideoDisplayView;
+class QListWidgetItem;
 namespace Ui { class VideoDisplayClass; }
 class VideoDisplayModel;
 struct VideoConfig;
@@ -103,6 +106,11 @@ public:
      */
     void setAutoPlay(bool enable, int interval = 33);
 
+    /**
+     * @brief 获取回放预解码流水线，用于查询队列深度和解码耗时
+     */
+    const VideoFramePipeline* framePipeline() const { return m_framePipeline; }
+
 public slots:
     /**
      * @brief 开始按钮点击事件处理
@@ -137,6 +145,24 @@ public slots:
      */
     void slot_VD_C_onColorArrangementChanged(int index);
 
+    /**
+     * @brief 去马赛克方法改变事件处理
+     * @param index 0关闭，1双线性，2边缘自适应
+     */
+    void slot_VD_C_onDemosaicMethodChanged(int index);
+
+    /**
+     * @brief 拜耳排列改变事件处理
+     * @param index 当前选中的拜耳排列索引
+     */
+    void slot_VD_C_onBayerPatternChanged(int index);
+
+    /**
+     * @brief 色调映射开关事件处理
+     * @param enabled 是否启用
+     */
+    void slot_VD_C_onToneMapToggled(bool enabled);
+
     /**
      * @brief 虚拟通道改变事件处理
      * @param index 当前选中的虚拟通道索引
@@ -236,6 +262,32 @@ private slots:
      */
     void slot_VD_C_onCurrentEntryChanged(const PacketIndexEntry& entry);
 
+    /**
+     * @brief 预解码完成处理函数，等待中的当前帧就绪时显示
+     * @param index 帧序号
+     */
+    void slot_VD_C_onFrameReady(int index);
+
+    /**
+     * @brief 预解码统计变更处理函数
+     * @param readyAhead 当前帧之后连续就绪的帧数
+     * @param averageDecodeMs 单帧平均耗时（毫秒）
+     */
+    void slot_VD_C_onPipelineStatisticsChanged(int readyAhead, double averageDecodeMs);
+
+    /**
+     * @brief 缩略图就绪处理函数，填入缩略图条
+     * @param frameIndex 帧序号
+     * @param thumbnail 缩略图
+     */
+    void slot_VD_C_onThumbnailReady(int frameIndex, const QImage& thumbnail);
+
+    /**
+     * @brief 缩略图点击处理函数，跳转到对应帧
+     * @param item 被点击的缩略图
+     */
+    void slot_VD_C_onThumbnailClicked(QListWidgetItem* item);
+
 private:
     /**
      * @brief 连接UI组件的信号与槽
@@ -277,11 +329,34 @@ private:
     QImage decodeRawData(const QByteArray& data);
 
     /**
-     * @brief 加载当前帧数据
-     * @return 是否成功加载
+     * @brief 由视频配置得到解码参数
+     */
+    static VideoDecodeParameters decodeParameters(const VideoConfig& config);
+
+    /**
+     * @brief 显示当前帧
+     *
+     * 已预解码时直接显示；否则交给预解码流水线，就绪后在slot_VD_C_onFrameReady中显示。
+     * 同时按移动方向更新预解码窗口。
+     * @return 当前索引条目是否有效
      */
     bool loadCurrentFrameData();
 
+    /**
+     * @brief 获取与当前索引一致的视频帧表
+     *
+     * 已有帧表与索引的条目数和主采集文件一致时直接使用；同一采集的索引增长时只追加新增条目；
+     * 否则先读取采集文件旁保存的帧表，仍不一致时从索引快照重建，之后切换筛选条件不再查询索引。
+     * 采集进行中文件还在变化，帧表只保存在内存中，采集结束后保存一次。
+     * @return 帧表，索引为空时为空
+     */
+    std::shared_ptr<const VideoFrameTable> currentFrameTable();
+
+    /**
+     * @brief 按已加载的帧列表重建缩略图条，后台生成缩略图
+     */
+    void startThumbnailStrip();
+
     /**
      * @brief 更新播放控制UI
      */
@@ -302,12 +377,19 @@ private:
     bool m_isPlaying;                                    ///< 是否正在播放
 
     QTimer* m_playbackTimer;                             ///< 播放定时器
+    VideoFramePipeline* m_framePipeline;                 ///< 回放预解码流水线
+    std::shared_ptr<const VideoFrameTable> m_frameTable; ///< 当前采集的视频帧表
+    bool m_frameTableUnsaved = false;                    ///< 帧表在采集中建立，尚未保存
+    VideoThumbnailGenerator* m_thumbnailGenerator;       ///< 缩略图条生成器
+    int m_pendingFrameIndex = -1;                        ///< 等待解码完成后显示的帧
+    int m_presentedFrameIndex = -1;                      ///< 上次请求显示的帧，用于判断移动方向
 
     // 常量定义
     static const int MAX_RESOLUTION = 4096;              ///< 最大分辨率限制
     static const int DEFAULT_WIDTH = 1920;               ///< 默认宽度
     static const int DEFAULT_HEIGHT = 1080;              ///< 默认高度
     static const uint8_t DEFAULT_FORMAT = 0x39;          ///< 默认RAW10格式
+    static const int MAX_STRIP_THUMBNAILS = 400;         ///< 缩略图条最多的缩略图数，帧多时加大取帧间隔
 
     // 命令类型映射
     struct CommandTypeInfo {
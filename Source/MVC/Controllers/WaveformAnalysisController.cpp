@@ -5,11 +5,12 @@
 #include "ui_WaveformAnalysis.h"
 #include "WaveformAnalysisModel.h"
 #include "DataAccessService.h"
+#include "WaveformTileSource.h"
+#include "FileOperationController.h"
+#include "LiveWaveformProcessor.h"
 #include "Logger.h"
 #include <QMessageBox>
 #include <QFileInfo>
-#include <QProgressDialog>
-#include <QtConcurrent>
 #include <algorithm>
 #include <cmath>
 
@@ -24,11 +25,7 @@ WaveformAnalysisController::WaveformAnalysisController(WaveformAnalysisView* vie
     , m_isRunning(false)
     , m_isInitialized(false)
     , m_verticalScale(1.0)
-    , m_autoScale(true)
-    , m_dataPacketCache(new QByteArray())
-    , m_cacheStartIndex(0)
-    , m_cacheLength(0)
-    , m_isCacheValid(false) {
+    , m_autoScale(true) {
 
     // 获取UI对象
     if (m_view) {
@@ -43,11 +40,21 @@ WaveformAnalysisController::WaveformAnalysisController(WaveformAnalysisView* vie
     m_updateTimer = new QTimer(this);
     m_updateTimer->setInterval(100);  // 100ms更新间隔
 
+    // 实时显示按固定刷新率取数据，与采集数据到达的节奏无关
+    m_liveRing = &LiveWaveformProcessor::getInstance()->ring();
+    m_liveTimer = new QTimer(this);
+    m_liveTimer->setTimerType(Qt::PreciseTimer);
+    m_liveTimer->setInterval(LIVE_REFRESH_MS);
+
     LOG_INFO(LocalQTCompat::fromLocal8Bit("波形分析控制器已创建"));
 }
 
 WaveformAnalysisController::~WaveformAnalysisController()
 {
+    if (m_liveRing) {
+        m_liveRing->setEnabled(false);
+    }
+
     if (m_updateTimer) {
         m_updateTimer->stop();
         delete m_updateTimer;
@@ -67,6 +74,20 @@ WaveformAnalysisController::~WaveformAnalysisController()
     LOG_INFO(LocalQTCompat::fromLocal8Bit("波形分析控制器已销毁"));
 }
 
+void WaveformAnalysisController::setFileOperationController(FileOperationController* controller)
+{
+    if (m_fileOperationController) {
+        disconnect(m_fileOperationController, nullptr, this, nullptr);
+    }
+
+    m_fileOperationController = controller;
+
+    if (m_fileOperationController) {
+        connect(m_fileOperationController, &FileOperationController::signal_FO_C_loadStarted,
+            this, &WaveformAnalysisController::slot_WA_C_onCaptureFileChanged);
+    }
+}
+
 bool WaveformAnalysisController::initialize()
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("开始初始化波形分析控制器"));
@@ -144,9 +165,12 @@ void WaveformAnalysisController::connectSignals()
         this, &WaveformAnalysisController::slot_WA_C_onMarkersChanged);
     connect(m_model, &WaveformAnalysisModel::signal_WA_M_channelStateChanged,
         this, &WaveformAnalysisController::slot_WA_C_onChannelStateChanged);
+    connect(m_model->getTileSource(), &WaveformTileSource::signal_WF_TILE_tileReady,
+        this, &WaveformAnalysisController::slot_WA_C_onTileReady);
 
     // 连接定时器信号
     connect(m_updateTimer, &QTimer::timeout, this, &WaveformAnalysisController::slot_WA_C_onUpdateTimerTriggered);
+    connect(m_liveTimer, &QTimer::timeout, this, &WaveformAnalysisController::slot_WA_C_onLiveTimerTriggered);
 }
 
 bool WaveformAnalysisController::processWaveformData(const QByteArray& data)
@@ -252,6 +276,11 @@ void WaveformAnalysisController::slot_WA_C_zoomIn()
 
     if (!m_model || !m_glWidget) return;
 
+    if (m_liveMode) {
+        setLiveDecimation(m_liveShift - 1);
+        return;
+    }
+
     double xMin, xMax;
     m_model->getViewRange(xMin, xMax);
 
@@ -280,6 +309,11 @@ void WaveformAnalysisController::slot_WA_C_zoomOut()
 
     if (!m_model || !m_glWidget) return;
 
+    if (m_liveMode) {
+        setLiveDecimation(m_liveShift + 1);
+        return;
+    }
+
     double xMin, xMax;
     m_model->getViewRange(xMin, xMax);
 
@@ -308,12 +342,27 @@ void WaveformAnalysisController::slot_WA_C_zoomReset()
 
     if (!m_model || !m_glWidget) return;
 
+    if (m_liveMode) {
+        setLiveDecimation(DEFAULT_LIVE_DECIMATION_SHIFT);
+        return;
+    }
+
     // 重置为显示所有数据
-    QVector<double> indexData = m_model->getIndexData();
+    const int indexCount = m_model->getIndexCount();
+    WaveformTileSource* tiles = m_model->getTileSource();
+
+    if (tiles->isActive()) {
+        // 显示整个文件，未加载的分块先显示占位
+        double max = static_cast<double>(tiles->totalSamples() - 1);
 
-    if (!indexData.isEmpty()) {
-        double min = indexData.first();
-        double max = indexData.last();
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("重置视图范围到整个文件 [0, %1]").arg(max));
+        m_model->setViewRange(0, max);
+        m_glWidget->setViewRange(0, max);
+        requestVisibleTiles(0, max);
+    }
+    else if (indexCount > 0) {
+        double min = m_model->getIndexStart();
+        double max = min + indexCount - 1;
 
         LOG_INFO(LocalQTCompat::fromLocal8Bit("重置视图范围到 [%1, %2]").arg(min).arg(max));
         m_model->setViewRange(min, max);
@@ -402,44 +451,55 @@ void WaveformAnalysisController::slot_WA_C_handleTabActivated()
     }
 }
 
-bool WaveformAnalysisController::slot_WA_C_loadDataRange(int startPos, int length)
+bool WaveformAnalysisController::slot_WA_C_loadDataRange(qint64 startPos, qint64 length)
 {
     // 确保非负值
-    startPos = std::max(0, startPos);
-    length = std::max(100, length);
+    startPos = std::max<qint64>(0, startPos);
+    length = std::max<qint64>(100, length);
 
     LOG_INFO(LocalQTCompat::fromLocal8Bit("按需加载波形数据 - 起始: %1, 长度: %2")
         .arg(startPos).arg(length));
 
-    return loadWaveformDataFromService(startPos, length);
+    if (!m_model || !m_dataService) {
+        LOG_ERROR(LocalQTCompat::fromLocal8Bit("模型或数据服务为空，无法加载数据"));
+        return false;
+    }
+
+    // 文件大小可能已变化（实时保存），样本数变短说明换了文件
+    WaveformTileSource* tiles = m_model->getTileSource();
+    tiles->updateTotalSamples(m_dataService->getCaptureSampleCount());
+    if (!tiles->isActive()) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("没有可用的采集文件"));
+        return false;
+    }
+
+    // 视图范围用double表示，2^53以内的样本位置都是精确的
+    const double lastSample = static_cast<double>(tiles->totalSamples() - 1);
+    const double min = std::min(static_cast<double>(startPos), lastSample);
+    const double max = std::min(min + static_cast<double>(length - 1), lastSample);
+
+    m_currentPosition = static_cast<qint64>(min);
+    m_model->setViewRange(min, max);
+    if (m_glWidget) {
+        m_glWidget->setViewRange(min, max);
+    }
+    requestVisibleTiles(min, max);
+
+    return true;
 }
 
 void WaveformAnalysisController::slot_WA_C_onGLWidgetViewRangeChanged(double xMin, double xMax)
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("OpenGL控件视图范围变更: [%1, %2]").arg(xMin).arg(xMax));
 
-    // 同步到模型
-    m_model->setViewRange(xMin, xMax);
+    if (m_liveMode) return;
 
-    // 检查是否需要加载更多数据
-    if (shouldLoadMoreData(xMin, xMax)) {
-        // 计算加载范围，比当前视图范围略大一些，减少未来加载需求
-        double viewRange = xMax - xMin;
-        int loadStart = std::max(0, static_cast<int>(std::floor(xMin - viewRange * 0.5)));
-        int loadLength = static_cast<int>(std::ceil(viewRange * 2.0));
-
-        // 限制单次加载的最大数据量
-        const int MAX_LOAD_LENGTH = 500000;
-        if (loadLength > MAX_LOAD_LENGTH) {
-            double center = (xMin + xMax) / 2.0;
-            loadStart = static_cast<int>(std::floor(center - MAX_LOAD_LENGTH / 2.0));
-            loadStart = std::max(0, loadStart);
-            loadLength = MAX_LOAD_LENGTH;
-        }
+    // 同步到模型，记录起始样本，重新激活时回到同一位置
+    m_currentPosition = static_cast<qint64>(std::max(0.0, xMin));
+    m_model->setViewRange(xMin, xMax);
 
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("加载额外数据 - 起始: %1, 长度: %2").arg(loadStart).arg(loadLength));
-        slot_WA_C_loadDataRange(loadStart, loadLength);
-    }
+    // 请求视图范围内的分块，已加载的分块立即可见
+    requestVisibleTiles(xMin, xMax);
 }
 
 void WaveformAnalysisController::slot_WA_C_onGLWidgetMarkerAdded(int index)
@@ -452,7 +512,7 @@ void WaveformAnalysisController::slot_WA_C_onGLWidgetMarkerAdded(int index)
 
 void WaveformAnalysisController::slot_WA_C_onGLWidgetPanRequested(int deltaX)
 {
-    if (!m_model || !m_glWidget) return;
+    if (!m_model || !m_glWidget || m_liveMode) return;
 
     double xMin, xMax;
     m_model->getViewRange(xMin, xMax);
@@ -469,11 +529,15 @@ void WaveformAnalysisController::slot_WA_C_onGLWidgetPanRequested(int deltaX)
     double minDataIndex = 0;
     double maxDataIndex = 0;
 
-    // 获取实际通道数据的范围
-    for (int ch = 0; ch < 4; ++ch) {
+    // 获取实际通道数据的范围；有采集文件时为整个文件
+    WaveformTileSource* tiles = m_model->getTileSource();
+    if (tiles->isActive()) {
+        maxDataIndex = static_cast<double>(tiles->totalSamples() - 1);
+    }
+    for (int ch = 0; ch < 4 && !tiles->isActive(); ++ch) {
         if (m_model->isChannelEnabled(ch)) {
-            QVector<double> data = m_model->getChannelData(ch);
-            if (!data.isEmpty()) {
+            const LogicChannel& data = m_model->getLogicChannel(ch);
+            if (!data.empty()) {
                 maxDataIndex = std::max(maxDataIndex, static_cast<double>(data.size() - 1));
             }
         }
@@ -508,12 +572,13 @@ void WaveformAnalysisController::slot_WA_C_onGLWidgetPanRequested(int deltaX)
 
     // 仅在范围确实变化时更新
     if (newMin != xMin || newMax != xMax) {
+        m_currentPosition = static_cast<qint64>(newMin);
         m_model->setViewRange(newMin, newMax);
         m_glWidget->setViewRange(newMin, newMax);
     }
 }
 
-void WaveformAnalysisController::slot_WA_C_onGLWidgetLoadDataRequested(int startIndex, int length)
+void WaveformAnalysisController::slot_WA_C_onGLWidgetLoadDataRequested(qint64 startIndex, qint64 length)
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("OpenGL控件请求加载数据 - 起始: %1, 长度: %2")
         .arg(startIndex).arg(length));
@@ -537,8 +602,7 @@ void WaveformAnalysisController::slot_WA_C_onDataLoaded(bool success)
     bool hasData = false;
     int maxDataSize = 0;
     for (int ch = 0; ch < 4; ++ch) {
-        QVector<double> data = m_model->getChannelData(ch);
-        int dataSize = data.size();
+        int dataSize = static_cast<int>(m_model->getLogicChannel(ch).size());
         if (dataSize > 0) {
             hasData = true;
             maxDataSize = qMax(maxDataSize, dataSize);
@@ -552,20 +616,21 @@ void WaveformAnalysisController::slot_WA_C_onDataLoaded(bool success)
         return;
     }
 
-    // 获取加载后的索引数据
-    QVector<double> indexData = m_model->getIndexData();
+    // 索引数据为连续值，只需起点和长度
+    const double indexStart = m_model->getIndexStart();
+    const int indexCount = m_model->getIndexCount();
     LOG_INFO(LocalQTCompat::fromLocal8Bit("索引数据加载后状态: 大小=%1, 首值=%2, 尾值=%3")
-        .arg(indexData.size())
-        .arg(indexData.isEmpty() ? "N/A" : QString::number(indexData.first()))
-        .arg(indexData.isEmpty() ? "N/A" : QString::number(indexData.last())));
+        .arg(indexCount)
+        .arg(indexCount == 0 ? "N/A" : QString::number(indexStart))
+        .arg(indexCount == 0 ? "N/A" : QString::number(indexStart + indexCount - 1)));
 
     // 确保通道数据和索引数据长度一致
     ensureDataConsistency();
 
     // 调整视图范围，确保设置了合理的范围
-    if (!indexData.isEmpty()) {
-        double startIdx = indexData.first();
-        double endIdx = indexData.last();
+    if (indexCount > 0) {
+        double startIdx = indexStart;
+        double endIdx = indexStart + indexCount - 1;
 
         // 强制应用新的范围
         LOG_INFO(LocalQTCompat::fromLocal8Bit("重置视图范围: %1 到 %2").arg(startIdx).arg(endIdx));
@@ -598,25 +663,8 @@ void WaveformAnalysisController::slot_WA_C_onViewRangeChanged(double xMin, doubl
         m_glWidget->setViewRange(xMin, xMax);
     }
 
-    // 检查并加载需要的数据
-    if (shouldLoadMoreData(xMin, xMax)) {
-        // 计算加载范围，比当前视图范围略大一些
-        double viewRange = xMax - xMin;
-        int loadStart = std::max(0, static_cast<int>(std::floor(xMin - viewRange * 0.5)));
-        int loadLength = static_cast<int>(std::ceil(viewRange * 2.0));
-
-        // 限制单次加载的最大数据量
-        const int MAX_LOAD_LENGTH = 500000;
-        if (loadLength > MAX_LOAD_LENGTH) {
-            double center = (xMin + xMax) / 2.0;
-            loadStart = static_cast<int>(std::floor(center - MAX_LOAD_LENGTH / 2.0));
-            loadStart = std::max(0, loadStart);
-            loadLength = MAX_LOAD_LENGTH;
-        }
-
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("加载额外数据 - 起始: %1, 长度: %2").arg(loadStart).arg(loadLength));
-        slot_WA_C_loadDataRange(loadStart, loadLength);
-    }
+    // 请求视图范围内的分块
+    requestVisibleTiles(xMin, xMax);
 }
 
 void WaveformAnalysisController::slot_WA_C_onMarkersChanged()
@@ -653,204 +701,59 @@ void WaveformAnalysisController::slot_WA_C_onChannelStateChanged(int channel, bo
 
 void WaveformAnalysisController::slot_WA_C_onUpdateTimerTriggered()
 {
-    // 更新OpenGL控件
+    // 实时保存时文件持续增长，时间轴随之延伸
+    WaveformTileSource* tiles = m_model ? m_model->getTileSource() : nullptr;
+    if (tiles && tiles->isActive() && m_dataService) {
+        tiles->updateTotalSamples(m_dataService->getCaptureSampleCount());
+    }
+
+    // 重绘即可：文件增长时末尾的块由控件自行重新生成，已有顶点不需要失效
     if (m_glWidget) {
-        m_glWidget->requestUpdate();
+        m_glWidget->update();
     }
 }
 
-bool WaveformAnalysisController::loadWaveformDataFromService(int startIndex, int length)
+void WaveformAnalysisController::slot_WA_C_onTileReady(quint64 tileIndex)
 {
-    // 检查数据服务是否可用
-    if (!m_dataService) {
-        LOG_ERROR(LocalQTCompat::fromLocal8Bit("数据访问服务未设置，无法加载波形数据"));
-        return false;
-    }
+    if (!m_glWidget || !m_model) return;
 
-    // 检查范围是否有效
-    if (startIndex < 0 || length <= 0) {
-        LOG_ERROR(LocalQTCompat::fromLocal8Bit("无效的数据范围"));
-        return false;
+    // 只有落在视图内的分块需要重绘，且只重新生成覆盖该分块的顶点块
+    double xMin, xMax;
+    m_model->getViewRange(xMin, xMax);
+    const double tileFirst = static_cast<double>(tileIndex) * WaveformTileSource::TILE_SAMPLES;
+    const double tileLast = tileFirst + WaveformTileSource::TILE_SAMPLES - 1;
+    if (tileLast >= xMin && tileFirst <= xMax) {
+        m_glWidget->invalidateSamples(tileFirst, tileLast);
     }
-
-    LOG_INFO(LocalQTCompat::fromLocal8Bit("开始加载波形数据 - 起始: %1, 长度: %2").arg(startIndex).arg(length));
-
-    // 创建一个进度对话框，但先不显示
-    QProgressDialog* progressDialog = nullptr;
-    QTimer* progressTimer = new QTimer(this);
-
-    // 设置500ms后才显示进度对话框，避免短时操作闪烁
-    connect(progressTimer, &QTimer::timeout, this, [&progressDialog, this]() {
-        if (!progressDialog) {
-            progressDialog = new QProgressDialog("正在加载数据...", "取消", 0, 100,
-                qobject_cast<QWidget*>(parent()));
-            progressDialog->setWindowModality(Qt::WindowModal);
-            progressDialog->setMinimumDuration(0);
-            progressDialog->setValue(10);
-            progressDialog->show();
-        }
-        });
-    progressTimer->setSingleShot(true);
-    progressTimer->start(500);
-
-    // 创建加载任务并放入后台线程
-    auto future = QtConcurrent::run([this, startIndex, length, progressDialog, progressTimer]() {
-        bool success = false;
-
-        try {
-            // 先生成索引数据
-            QVector<double> indexData;
-            indexData.reserve(length);
-            for (int i = 0; i < length; ++i) {
-                indexData.append(startIndex + i);
-            }
-
-            // 准备通道数据容器
-            QVector<QVector<double>> channelDataResults(4);
-
-            // 读取原始数据
-            QByteArray rawData = m_dataService->readRawData(startIndex, length);
-
-            if (!rawData.isEmpty()) {
-                // 成功读取原始数据
-                // 更新缓存
-                m_dataPacketCache = QSharedPointer<QByteArray>(new QByteArray(rawData));
-                m_cacheStartIndex = startIndex;
-                m_cacheLength = rawData.size();
-                m_isCacheValid = true;
-
-                // 提取每个通道的数据
-                for (int ch = 0; ch < 4; ++ch) {
-                    channelDataResults[ch] = m_dataService->extractChannelData(rawData, ch);
-                }
-
-                success = true;
-            }
-
-            // 在主线程中更新UI
-            QMetaObject::invokeMethod(this, [this, success, indexData, channelDataResults,
-                startIndex, length, progressTimer, progressDialog]() {
-                    // 取消进度对话框计时器
-                    progressTimer->stop();
-                    delete progressTimer;
-
-                    // 关闭进度对话框
-                    if (progressDialog) {
-                        progressDialog->close();
-                        progressDialog->deleteLater();
-                    }
-
-                    if (success && m_model) {
-                        // 更新模型数据
-                        m_model->updateIndexData(indexData);
-
-                        for (int ch = 0; ch < 4; ++ch) {
-                            if (!channelDataResults[ch].isEmpty()) {
-                                m_model->updateChannelData(ch, channelDataResults[ch]);
-                            }
-                        }
-
-                        // 确保通道数据和索引数据长度一致
-                        ensureDataConsistency();
-
-                        // 设置视图范围
-                        m_model->setViewRange(startIndex, startIndex + length - 1);
-
-                        // 同步到OpenGL控件
-                        if (m_glWidget) {
-                            m_glWidget->setViewRange(startIndex, startIndex + length - 1);
-                            m_glWidget->requestUpdate();
-                        }
-
-                        // 发送数据加载成功信号
-                        emit m_model->signal_WA_M_dataLoaded(true);
-                    }
-                    else if (m_model) {
-                        emit m_model->signal_WA_M_dataLoaded(false);
-                    }
-                }, Qt::QueuedConnection);
-
-        }
-        catch (const std::exception& e) {
-            LOG_ERROR(LocalQTCompat::fromLocal8Bit("加载波形数据异常: %1").arg(e.what()));
-
-            // 在主线程中处理错误
-            QMetaObject::invokeMethod(this, [progressTimer, progressDialog]() {
-                progressTimer->stop();
-                delete progressTimer;
-
-                if (progressDialog) {
-                    progressDialog->close();
-                    progressDialog->deleteLater();
-                }
-                }, Qt::QueuedConnection);
-        }
-        });
-
-    return true; // 返回true表示加载操作已开始
 }
 
-bool WaveformAnalysisController::shouldLoadMoreData(double xMin, double xMax)
+void WaveformAnalysisController::slot_WA_C_onCaptureFileChanged(const QString& filePath, uint64_t fileSize)
 {
-    // 如果缓存无效，需要加载
-    if (!m_isCacheValid || !m_dataPacketCache || m_dataPacketCache->isEmpty()) {
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("缓存无效，需要加载更多数据"));
-        return true;
-    }
+    if (!m_model) return;
 
-    // 如果请求的范围完全在缓存中，不需要加载
-    if (xMin >= m_cacheStartIndex && xMax <= m_cacheStartIndex + m_cacheLength) {
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("请求范围完全在缓存中，无需加载"));
-        return false;
-    }
+    const quint64 totalSamples = DataAccessService::sampleCountForFileSize(fileSize);
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("波形时间轴切换到文件: %1，样本数: %2").arg(filePath).arg(totalSamples));
 
-    // 如果超出缓存太多，需要加载
-    double overlap = 0.0;
-    double requestLength = xMax - xMin;
+    m_model->getTileSource()->reset(totalSamples);
+    m_currentPosition = 0;
 
-    // 计算与缓存区域的重叠部分
-    if (xMin < m_cacheStartIndex && xMax > m_cacheStartIndex) {
-        overlap = xMax - m_cacheStartIndex;
-    }
-    else if (xMin < m_cacheStartIndex + m_cacheLength && xMax > m_cacheStartIndex + m_cacheLength) {
-        overlap = m_cacheStartIndex + m_cacheLength - xMin;
-    }
-    else if (xMin >= m_cacheStartIndex && xMax <= m_cacheStartIndex + m_cacheLength) {
-        overlap = requestLength;
+    if (m_isCurrentlyVisible) {
+        slot_WA_C_loadDataRange(m_currentPosition, m_viewWidth);
     }
-
-    // 计算重叠比例
-    double overlapRatio = requestLength > 0 ? (overlap / requestLength) : 0;
-
-    LOG_INFO(LocalQTCompat::fromLocal8Bit("与缓存重叠比例: %1").arg(overlapRatio));
-
-    // 如果重叠不足50%，需要加载新数据
-    return overlapRatio < 0.5;
 }
 
-void WaveformAnalysisController::updateDataCache(int startIndex, int length)
+void WaveformAnalysisController::requestVisibleTiles(double xMin, double xMax)
 {
-    if (!m_dataService) {
-        LOG_ERROR(LocalQTCompat::fromLocal8Bit("数据访问服务未设置，无法更新缓存"));
+    if (!m_model) return;
+
+    WaveformTileSource* tiles = m_model->getTileSource();
+    if (!tiles->isActive() || xMax < 0) {
         return;
     }
 
-    // 读取原始数据
-    QByteArray rawData = m_dataService->readRawData(startIndex, length);
-
-    if (!rawData.isEmpty()) {
-        m_dataPacketCache = QSharedPointer<QByteArray>(new QByteArray(rawData));
-        m_cacheStartIndex = startIndex;
-        m_cacheLength = rawData.size();
-        m_isCacheValid = true;
-
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("更新数据缓存成功 - 起始: %1, 长度: %2")
-            .arg(startIndex).arg(m_cacheLength));
-    }
-    else {
-        m_isCacheValid = false;
-        LOG_ERROR(LocalQTCompat::fromLocal8Bit("更新数据缓存失败"));
-    }
+    const quint64 first = static_cast<quint64>(std::max(0.0, std::floor(xMin)));
+    const quint64 last = static_cast<quint64>(std::max(0.0, std::ceil(xMax)));
+    tiles->requestRange(first, last);
 }
 
 void WaveformAnalysisController::ensureDataConsistency()
@@ -862,10 +765,7 @@ void WaveformAnalysisController::ensureDataConsistency()
     // 检查所有通道数据长度
     int maxLength = 0;
     for (int ch = 0; ch < 4; ++ch) {
-        QVector<double> data = m_model->getChannelData(ch);
-        if (!data.isEmpty()) {
-            maxLength = qMax(maxLength, data.size());
-        }
+        maxLength = qMax(maxLength, static_cast<int>(m_model->getLogicChannel(ch).size()));
     }
 
     if (maxLength == 0) {
@@ -873,21 +773,108 @@ void WaveformAnalysisController::ensureDataConsistency()
         return;
     }
 
-    // 获取索引数据
-    QVector<double> indexData = m_model->getIndexData();
-
     // 如果索引数据长度与通道数据不一致，调整索引数据
-    if (indexData.size() != maxLength) {
+    const int indexCount = m_model->getIndexCount();
+    if (indexCount != maxLength) {
         LOG_INFO(LocalQTCompat::fromLocal8Bit("索引数据长度(%1)与通道数据长度(%2)不一致，调整索引数据")
-            .arg(indexData.size()).arg(maxLength));
+            .arg(indexCount).arg(maxLength));
+
+        m_model->setIndexRange(0, maxLength);
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("已生成 %1 个新索引数据点").arg(maxLength));
+    }
+}
 
-        QVector<double> newIndexData;
-        newIndexData.reserve(maxLength);
-        for (int i = 0; i < maxLength; ++i) {
-            newIndexData.append(i);
+void WaveformAnalysisController::slot_WA_C_setLiveMode(bool enabled)
+{
+    if (m_liveMode == enabled || !m_glWidget || !m_liveRing) return;
+
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("实时显示: %1").arg(enabled ? "开启" : "关闭"));
+
+    m_liveMode = enabled;
+    m_liveRing->setDecimationShift(m_liveShift);
+    m_liveRing->setEnabled(enabled);
+    m_glWidget->setLiveMode(enabled);
+
+    if (enabled) {
+        m_liveTimer->start();
+        setLiveDecimation(m_liveShift);
+    }
+    else {
+        m_liveTimer->stop();
+
+        // 恢复实时显示之前的视图范围
+        if (m_model) {
+            double xMin, xMax;
+            m_model->getViewRange(xMin, xMax);
+            m_glWidget->setViewRange(xMin, xMax);
+        }
+        if (m_view) {
+            m_view->setStatusMessage(LocalQTCompat::fromLocal8Bit("实时显示已关闭"));
         }
+    }
+}
+
+void WaveformAnalysisController::slot_WA_C_setLiveTrigger(int channel, LiveWaveformRing::TriggerEdge edge)
+{
+    m_triggerChannel = (channel >= 0 && channel < 4) ? channel : -1;
+    m_triggerEdge = edge;
 
-        m_model->updateIndexData(newIndexData);
-        LOG_INFO(LocalQTCompat::fromLocal8Bit("已生成 %1 个新索引数据点").arg(newIndexData.size()));
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("实时触发: 通道%1, 边沿%2")
+        .arg(m_triggerChannel).arg(static_cast<int>(edge)));
+}
+
+void WaveformAnalysisController::setLiveDecimation(int shift)
+{
+    m_liveShift = std::clamp(shift, 0, LiveWaveformRing::MAX_DECIMATION_SHIFT);
+    if (m_liveRing) {
+        m_liveRing->setDecimationShift(m_liveShift);
     }
+
+    if (m_view) {
+        m_view->setStatusMessage(LocalQTCompat::fromLocal8Bit("实时显示：每屏%1个样本")
+            .arg(static_cast<quint64>(LIVE_WINDOW_ENTRIES) << m_liveShift));
+    }
+}
+
+void WaveformAnalysisController::slot_WA_C_onLiveTimerTriggered()
+{
+    if (!m_liveMode || !m_glWidget || !m_model) return;
+
+    // 先读写位置再读段：段在两次读取之间切换时起点超过写位置，本帧跳过
+    const uint64_t end = m_liveRing->writeIndex();
+    uint64_t start = 0;
+    int shift = 0;
+    m_liveRing->segment(start, shift);
+    if (shift != m_liveShift || start >= end) return;   // 新的抽取倍数尚未生效，或还没有数据
+
+    // 触发时向前多取一屏用于查找边沿
+    const size_t window = LIVE_WINDOW_ENTRIES;
+    const size_t wanted = m_triggerChannel >= 0 ? 2 * window : window;
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(end - start, wanted));
+    m_liveEntries.resize(count);
+    if (!m_liveRing->copy(end - count, count, m_liveEntries.data())) return;    // 复制期间被覆盖
+
+    // 默认显示最新的一屏（滚动）；找到触发边沿时把它放在屏幕中央
+    size_t first = count > window ? count - window : 0;
+    double triggerPosition = -1.0;
+    if (m_triggerChannel >= 0 && count > window) {
+        const int64_t edge = LiveWaveformRing::findTrigger(m_liveEntries.data(),
+            window / 2, count - window / 2, m_triggerChannel, m_triggerEdge);
+        if (edge >= 0) {
+            first = static_cast<size_t>(edge) - window / 2;
+            triggerPosition = static_cast<double>(window / 2);
+        }
+    }
+
+    const size_t length = std::min(window, count);
+    for (int ch = 0; ch < 4; ++ch) {
+        if (m_model->isChannelEnabled(ch)) {
+            LiveWaveformRing::trace(m_liveEntries.data() + first, length, ch, m_liveTraces[ch]);
+        }
+        else {
+            m_liveTraces[ch].clear();
+        }
+    }
+
+    m_glWidget->setLiveFrame(m_liveTraces, static_cast<double>(window), triggerPosition);
 }
@@ -9,6 +9,8 @@
 #include <QSharedPointer>
 #include <QByteArray>
 #include <memory>
+#include <vector>
+#include "LiveWaveformRing.h"
 
 class WaveformAnalysisView;
 namespace Ui { class WaveformAnalysisClass; }
@@ -58,12 +60,10 @@ public:
     void setTabVisible(bool visible);
 
     /**
-     * @brief 设置文件操作控制器
+     * @brief 设置文件操作控制器，并在打开新文件时切换分块数据源
      * @param controller 文件操作控制器
      */
-    void setFileOperationController(FileOperationController* controller) {
-        m_fileOperationController = controller;
-    }
+    void setFileOperationController(FileOperationController* controller);
 
     /**
      * @brief 获取模型指针
@@ -127,12 +127,32 @@ public slots:
     void slot_WA_C_handleTabActivated();
 
     /**
-     * @brief 按需加载数据范围
-     * @param startPos 起始位置
-     * @param length 数据长度
-     * @return 加载是否成功
+     * @brief 显示采集文件中的数据范围
+     *
+     * 数据由分块数据源在后台加载，此函数立即返回，未加载的部分先显示占位。
+     *
+     * @param startPos 起始样本，大文件的样本位置超过int范围
+     * @param length 样本数
+     * @return 是否有可用的采集文件
+     */
+    bool slot_WA_C_loadDataRange(qint64 startPos, qint64 length);
+
+    /**
+     * @brief 切换实时显示
+     *
+     * 实时显示直接读取采集处理线程写入的抽取缓冲，按固定刷新率绘制最新的一屏，
+     * 不读文件；此时放大/缩小调整抽取倍数（时基）。
+     *
+     * @param enabled 是否实时显示
+     */
+    void slot_WA_C_setLiveMode(bool enabled);
+
+    /**
+     * @brief 设置实时显示的触发条件
+     * @param channel 触发通道，-1表示不触发（滚动显示）
+     * @param edge 触发边沿
      */
-    bool slot_WA_C_loadDataRange(int startPos, int length);
+    void slot_WA_C_setLiveTrigger(int channel, LiveWaveformRing::TriggerEdge edge);
 
 private slots:
     /**
@@ -159,7 +179,7 @@ private slots:
      * @param startIndex 起始索引
      * @param length 数据长度
      */
-    void slot_WA_C_onGLWidgetLoadDataRequested(int startIndex, int length);
+    void slot_WA_C_onGLWidgetLoadDataRequested(qint64 startIndex, qint64 length);
 
     /**
      * @brief 模型数据加载完成
@@ -191,41 +211,54 @@ private slots:
      */
     void slot_WA_C_onUpdateTimerTriggered();
 
-private:
     /**
-     * @brief 连接信号和槽
+     * @brief 波形分块加载完成
+     * @param tileIndex 分块序号
      */
-    void connectSignals();
+    void slot_WA_C_onTileReady(quint64 tileIndex);
 
     /**
-     * @brief 从服务中加载波形数据
-     * @param startIndex 起始索引
-     * @param length 数据长度
-     * @return 加载是否成功
+     * @brief 开始加载新的采集文件
+     * @param filePath 文件路径
+     * @param fileSize 文件大小
      */
-    bool loadWaveformDataFromService(int startIndex, int length);
+    void slot_WA_C_onCaptureFileChanged(const QString& filePath, uint64_t fileSize);
 
     /**
-     * @brief 判断是否需要加载更多数据
-     * @param xMin 最小索引
-     * @param xMax 最大索引
-     * @return 是否需要加载
+     * @brief 实时显示刷新定时器触发，生成一帧
      */
-    bool shouldLoadMoreData(double xMin, double xMax);
+    void slot_WA_C_onLiveTimerTriggered();
 
+private:
     /**
-     * @brief 更新数据缓存
-     * @param startIndex 起始索引
-     * @param length 数据长度
+     * @brief 连接信号和槽
+     */
+    void connectSignals();
+
+    /**
+     * @brief 请求覆盖视图范围的波形分块
+     * @param xMin 最小索引
+     * @param xMax 最大索引
      */
-    void updateDataCache(int startIndex, int length);
+    void requestVisibleTiles(double xMin, double xMax);
 
     /**
      * @brief 确保通道数据和索引数据长度匹配
      */
     void ensureDataConsistency();
 
+    /**
+     * @brief 设置实时显示的抽取倍数
+     * @param shift 每项2^shift个样本
+     */
+    void setLiveDecimation(int shift);
+
 private:
+    static constexpr int LIVE_REFRESH_MS = 33;              ///< 实时显示刷新间隔（约30帧/秒）
+    static constexpr int LIVE_WINDOW_ENTRIES = 2048;        ///< 实时显示每屏的抽取项数
+    static constexpr int DEFAULT_LIVE_DECIMATION_SHIFT = 8; ///< 默认每项256个样本
+
+
     WaveformAnalysisView* m_view;                   ///< 视图对象
     Ui::WaveformAnalysisClass* m_ui;                ///< UI对象
     WaveformAnalysisModel* m_model;                 ///< 模型对象
@@ -242,11 +275,15 @@ private:
     bool m_isActive{ false };                       ///< 当前标签页是否激活
     bool m_isCurrentlyVisible{ false };             ///< 当前标签页是否可见
     int m_viewWidth{ 1000 };                        ///< 当前视图宽度(数据点)
-    int m_currentPosition{ 0 };                     ///< 当前视图起始位置
-
-    // 缓存相关
-    QSharedPointer<QByteArray> m_dataPacketCache;   ///< 数据包缓存
-    int m_cacheStartIndex;                          ///< 缓存起始索引
-    int m_cacheLength;                              ///< 缓存长度
-    bool m_isCacheValid;                            ///< 缓存是否有效
+    qint64 m_currentPosition{ 0 };                  ///< 当前视图起始样本
+
+    // 实时显示
+    LiveWaveformRing* m_liveRing{ nullptr };        ///< 采集数据的抽取缓冲
+    QTimer* m_liveTimer{ nullptr };                 ///< 实时显示刷新定时器
+    bool m_liveMode{ false };                       ///< 是否实时显示
+    int m_liveShift{ DEFAULT_LIVE_DECIMATION_SHIFT }; ///< 抽取倍数
+    int m_triggerChannel{ -1 };                     ///< 触发通道，-1表示不触发
+    LiveWaveformRing::TriggerEdge m_triggerEdge{ LiveWaveformRing::TriggerEdge::Rising }; ///< 触发边沿
+    std::vector<uint16_t> m_liveEntries;            ///< 每帧复制出的抽取项
+    std::vector<WaveformTracePoint> m_liveTraces[4]; ///< 每帧各通道的折线
 };
\ No newline at end of file
@@ -10,8 +10,7 @@
 #include <QJsonArray>
 #include <QFileInfo>
 #include <algorithm>
-#include <numeric>
-#include <cmath>
+#include <limits>
 
 DataAnalysisModel* DataAnalysisModel::getInstance()
 {
@@ -33,38 +32,66 @@ DataAnalysisModel::~DataAnalysisModel()
     LOG_INFO(LocalQTCompat::fromLocal8Bit("数据分析模型已销毁"));
 }
 
-const std::vector<DataAnalysisItem>& DataAnalysisModel::getDataItems() const
+std::vector<DataAnalysisItem> DataAnalysisModel::getDataItems() const
 {
-    return m_dataItems;
+    std::vector<DataAnalysisItem> items;
+    items.reserve(m_store.size());
+    for (int row = 0; row < getDataItemCount(); ++row) {
+        items.push_back(getDataItem(row));
+    }
+    return items;
 }
 
 int DataAnalysisModel::getDataItemCount() const
 {
-    return static_cast<int>(m_dataItems.size());
+    return static_cast<int>(m_store.size());
 }
 
-const DataAnalysisItem& DataAnalysisModel::getDataItem(int index) const
+DataAnalysisItem DataAnalysisModel::getDataItem(int index) const
 {
-    static DataAnalysisItem emptyItem;
+    if (index < 0 || index >= getDataItemCount()) {
+        return DataAnalysisItem();
+    }
+
+    const size_t row = static_cast<size_t>(index);
+    const double* points = m_store.points(row);
+    return DataAnalysisItem(m_store.index(row), m_store.timestamp(row), m_store.value(row), m_store.description(row),
+        QVector<double>(points, points + m_store.pointCount(row)), m_store.isValid(row));
+}
 
-    if (index >= 0 && index < static_cast<int>(m_dataItems.size())) {
-        return m_dataItems[index];
+quint64 DataAnalysisModel::getRowId(int index) const
+{
+    if (index < 0 || index >= getDataItemCount()) {
+        return DataItemStore::INVALID_ROW_ID;
     }
+    return m_store.rowId(static_cast<size_t>(index));
+}
 
-    return emptyItem;
+int DataAnalysisModel::findRowById(quint64 rowId) const
+{
+    return m_store.rowOf(rowId);
+}
+
+void DataAnalysisModel::appendItem(const DataAnalysisItem& item)
+{
+    m_store.append(item.index, item.timeStamp, item.value, item.description,
+        item.dataPoints.constData(), static_cast<int>(item.dataPoints.size()), item.isValid);
 }
 
 void DataAnalysisModel::addDataItem(const DataAnalysisItem& item)
 {
-    m_dataItems.push_back(item);
-    calculateStatistics();
+    appendItem(item);
+    accumulateRow(m_store.size() - 1);
+    publishStatistics();
     emit signal_DA_M_dataChanged();
 }
 
 bool DataAnalysisModel::updateDataItem(int index, const DataAnalysisItem& item)
 {
-    if (index >= 0 && index < static_cast<int>(m_dataItems.size())) {
-        m_dataItems[index] = item;
+    if (index >= 0 && index < getDataItemCount()) {
+        m_store.update(static_cast<size_t>(index), item.index, item.timeStamp, item.value, item.description,
+            item.dataPoints.constData(), static_cast<int>(item.dataPoints.size()), item.isValid);
+        // 中间位置的修改无法增量撤销，重建一遍
         calculateStatistics();
         emit signal_DA_M_dataChanged();
         return true;
@@ -75,8 +102,8 @@ bool DataAnalysisModel::updateDataItem(int index, const DataAnalysisItem& item)
 
 bool DataAnalysisModel::removeDataItem(int index)
 {
-    if (index >= 0 && index < static_cast<int>(m_dataItems.size())) {
-        m_dataItems.erase(m_dataItems.begin() + index);
+    if (index >= 0 && index < getDataItemCount()) {
+        m_store.remove(static_cast<size_t>(index));
         calculateStatistics();
         emit signal_DA_M_dataChanged();
         return true;
@@ -87,7 +114,8 @@ bool DataAnalysisModel::removeDataItem(int index)
 
 void DataAnalysisModel::clearDataItems()
 {
-    m_dataItems.clear();
+    m_store.clear();
+    m_accumulator.clear();
     m_statistics = StatisticsInfo();
     emit signal_DA_M_dataChanged();
     emit signal_DA_M_statisticsChanged(m_statistics);
@@ -100,65 +128,56 @@ StatisticsInfo DataAnalysisModel::getStatistics() const
 
 void DataAnalysisModel::calculateStatistics()
 {
-    if (m_dataItems.empty()) {
-        m_statistics = StatisticsInfo();
-        emit signal_DA_M_statisticsChanged(m_statistics);
+    rebuildStatistics();
+    publishStatistics();
+}
+
+void DataAnalysisModel::accumulateRow(size_t row)
+{
+    if (!m_store.isValid(row)) {
         return;
     }
 
-    // 用于统计的有效数据点
-    std::vector<double> validValues;
-
-    // 收集所有有效的数据点
-    for (const auto& item : m_dataItems) {
-        if (item.isValid) {
-            validValues.push_back(item.value);
-
-            // 添加数据点列表中的所有值（如果有的话）
-            for (const auto& point : item.dataPoints) {
-                validValues.push_back(point);
-            }
-        }
+    m_accumulator.add(m_store.value(row));
+    const double* points = m_store.points(row);
+    for (int i = 0; i < m_store.pointCount(row); ++i) {
+        m_accumulator.add(points[i]);
     }
+}
 
-    // 如果没有有效数据，返回空统计
-    if (validValues.empty()) {
-        m_statistics = StatisticsInfo();
-        emit signal_DA_M_statisticsChanged(m_statistics);
+void DataAnalysisModel::removeOldestRow(size_t row)
+{
+    if (!m_store.isValid(row)) {
         return;
     }
 
-    // 计算最小值和最大值
-    auto [minIt, maxIt] = std::minmax_element(validValues.begin(), validValues.end());
-    m_statistics.min = *minIt;
-    m_statistics.max = *maxIt;
-
-    // 计算平均值
-    double sum = std::accumulate(validValues.begin(), validValues.end(), 0.0);
-    m_statistics.count = static_cast<int>(validValues.size());
-    m_statistics.average = sum / m_statistics.count;
-
-    // 计算中位数（需要排序后计算）
-    std::vector<double> sortedValues = validValues;
-    std::sort(sortedValues.begin(), sortedValues.end());
-
-    if (sortedValues.size() % 2 == 0) {
-        // 偶数个数据点，取中间两个数的平均值
-        size_t mid = sortedValues.size() / 2;
-        m_statistics.median = (sortedValues[mid - 1] + sortedValues[mid]) / 2.0;
+    // 与accumulateRow的加入顺序一致
+    m_accumulator.removeOldest(m_store.value(row));
+    const double* points = m_store.points(row);
+    for (int i = 0; i < m_store.pointCount(row); ++i) {
+        m_accumulator.removeOldest(points[i]);
     }
-    else {
-        // 奇数个数据点，取中间的数
-        m_statistics.median = sortedValues[sortedValues.size() / 2];
+}
+
+void DataAnalysisModel::rebuildStatistics()
+{
+    m_accumulator.clear();
+    for (size_t row = 0; row < m_store.size(); ++row) {
+        accumulateRow(row);
     }
+}
 
-    // 计算标准差
-    double variance = 0.0;
-    for (const auto& value : validValues) {
-        variance += std::pow(value - m_statistics.average, 2);
+void DataAnalysisModel::publishStatistics()
+{
+    m_statistics = StatisticsInfo();
+    if (m_accumulator.count() > 0) {
+        m_statistics.min = m_accumulator.min();
+        m_statistics.max = m_accumulator.max();
+        m_statistics.average = m_accumulator.mean();
+        m_statistics.median = m_accumulator.median();
+        m_statistics.stdDeviation = m_accumulator.standardDeviation();
+        m_statistics.count = static_cast<int>(std::min<uint64_t>(m_accumulator.count(), std::numeric_limits<int>::max()));
     }
-    variance /= m_statistics.count;
-    m_statistics.stdDeviation = std::sqrt(variance);
 
     emit signal_DA_M_statisticsChanged(m_statistics);
 }
@@ -256,10 +275,10 @@ bool DataAnalysisModel::importData(const QString& filePath)
         }
 
         file.close();
-        calculateStatistics();
+        publishStatistics();
 
-        LOG_INFO(QString(LocalQTCompat::fromLocal8Bit("从文件 %1 导入了 %2 条数据")).arg(filePath).arg(m_dataItems.size()));
-        emit signal_DA_M_importCompleted(true, QString(LocalQTCompat::fromLocal8Bit("成功导入 %1 条数据")).arg(m_dataItems.size()));
+        LOG_INFO(QString(LocalQTCompat::fromLocal8Bit("从文件 %1 导入了 %2 条数据")).arg(filePath).arg(getDataItemCount()));
+        emit signal_DA_M_importCompleted(true, QString(LocalQTCompat::fromLocal8Bit("成功导入 %1 条数据")).arg(getDataItemCount()));
         return true;
     }
     catch (const std::exception& e) {
@@ -288,11 +307,12 @@ bool DataAnalysisModel::exportData(const QString& filePath, const QVector<int>&
             out << "Index,Timestamp,Value,Description,DataPoints...\n";
 
             // 写入数据
-            const std::vector<DataAnalysisItem>& items = getDataItems();
+            const int itemCount = getDataItemCount();
 
             if (selectedIndices.isEmpty()) {
                 // 导出所有数据
-                for (const auto& item : items) {
+                for (int row = 0; row < itemCount; ++row) {
+                    const DataAnalysisItem item = getDataItem(row);
                     if (!item.isValid) continue; // 跳过无效项
 
                     out << item.index << "," << item.timeStamp << "," << item.value << ","
@@ -309,8 +329,8 @@ bool DataAnalysisModel::exportData(const QString& filePath, const QVector<int>&
             else {
                 // 导出选定的索引
                 for (int index : selectedIndices) {
-                    if (index >= 0 && index < static_cast<int>(items.size())) {
-                        const DataAnalysisItem& item = items[index];
+                    if (index >= 0 && index < itemCount) {
+                        const DataAnalysisItem item = getDataItem(index);
                         if (!item.isValid) continue; // 跳过无效项
 
                         out << item.index << "," << item.timeStamp << "," << item.value << ","
@@ -328,11 +348,12 @@ bool DataAnalysisModel::exportData(const QString& filePath, const QVector<int>&
         }
         else if (fileExtension == "json") {
             QJsonArray array;
-            const std::vector<DataAnalysisItem>& items = getDataItems();
+            const int itemCount = getDataItemCount();
 
             if (selectedIndices.isEmpty()) {
                 // 导出所有数据
-                for (const auto& item : items) {
+                for (int row = 0; row < itemCount; ++row) {
+                    const DataAnalysisItem item = getDataItem(row);
                     if (!item.isValid) continue; // 跳过无效项
 
                     QJsonObject obj;
@@ -353,8 +374,8 @@ bool DataAnalysisModel::exportData(const QString& filePath, const QVector<int>&
             else {
                 // 导出选定的索引
                 for (int index : selectedIndices) {
-                    if (index >= 0 && index < static_cast<int>(items.size())) {
-                        const DataAnalysisItem& item = items[index];
+                    if (index >= 0 && index < itemCount) {
+                        const DataAnalysisItem item = getDataItem(index);
                         if (!item.isValid) continue; // 跳过无效项
 
                         QJsonObject obj;
@@ -388,11 +409,12 @@ bool DataAnalysisModel::exportData(const QString& filePath, const QVector<int>&
                 QDataStream stream(&binaryData, QIODevice::WriteOnly);
 
                 // 写入项目数量
-                const std::vector<DataAnalysisItem>& items = getDataItems();
-                stream << static_cast<qint32>(items.size());
+                const int itemCount = getDataItemCount();
+                stream << static_cast<qint32>(itemCount);
 
                 // 写入每个项目
-                for (const auto& item : items) {
+                for (int row = 0; row < itemCount; ++row) {
+                    const DataAnalysisItem item = getDataItem(row);
                     if (!item.isValid) continue; // 跳过无效项
 
                     stream << item.index << item.timeStamp << item.value << item.description;
@@ -464,7 +486,7 @@ bool DataAnalysisModel::setRawData(const QByteArray& data, int columns, int rows
                 }
             }
 
-            calculateStatistics();
+            publishStatistics();
             return true;
         }
     }
@@ -478,103 +500,25 @@ bool DataAnalysisModel::setRawData(const QByteArray& data, int columns, int rows
 
 QVector<int> DataAnalysisModel::filterData(const QString& filterExpression)
 {
-    QVector<int> result;
-
-    if (filterExpression.isEmpty()) {
-        // 如果过滤表达式为空，返回所有有效项的索引
-        for (size_t i = 0; i < m_dataItems.size(); ++i) {
-            if (m_dataItems[i].isValid) {
-                result.append(static_cast<int>(i));
-            }
+    // 同一表达式反复筛选（如数据刷新后）时不重新编译
+    if (filterExpression != m_filterExpression.text()) {
+        m_filterExpression = DataFilterExpression::compile(filterExpression);
+        if (!m_filterExpression.isValid()) {
+            LOG_WARN(LocalQTCompat::fromLocal8Bit("筛选表达式无法解析，按描述查找: %1").arg(m_filterExpression.errorString()));
+            m_filterExpression = DataFilterExpression::descriptionContains(filterExpression);
         }
-        return result;
     }
 
-    // 简单的过滤逻辑
-    for (size_t i = 0; i < m_dataItems.size(); ++i) {
-        const DataAnalysisItem& item = m_dataItems[i];
-
-        if (!item.isValid) {
-            continue;
-        }
-
-        // 检查描述中是否包含过滤表达式
-        if (item.description.contains(filterExpression, Qt::CaseInsensitive)) {
-            result.append(static_cast<int>(i));
-            continue;
-        }
-
-        // 检查值是否匹配表达式
-        bool matchesValue = false;
-
-        if (filterExpression.contains(">")) {
-            double threshold = filterExpression.section('>', 1).trimmed().toDouble();
-            if (item.value > threshold) {
-                matchesValue = true;
-            }
-        }
-        else if (filterExpression.contains("<")) {
-            double threshold = filterExpression.section('<', 1).trimmed().toDouble();
-            if (item.value < threshold) {
-                matchesValue = true;
-            }
-        }
-        else if (filterExpression.contains("=")) {
-            double threshold = filterExpression.section('=', 1).trimmed().toDouble();
-            if (qFuzzyCompare(item.value, threshold)) {
-                matchesValue = true;
-            }
-        }
-
-        if (matchesValue) {
-            result.append(static_cast<int>(i));
-        }
-    }
-
-    return result;
+    return m_filterExpression.evaluate(m_store.filterColumns());
 }
 
 void DataAnalysisModel::sortData(int column, bool ascending)
 {
-    // 根据指定列对数据进行排序
-    auto comparator = [column, ascending](const DataAnalysisItem& a, const DataAnalysisItem& b) {
-        // 如果无效项，则将其排在后面
-        if (!a.isValid && !b.isValid) return false;
-        if (!a.isValid) return false;
-        if (!b.isValid) return true;
-
-        bool result = false;
-
-        switch (column) {
-        case 0: // 索引
-            result = a.index < b.index;
-            break;
-        case 1: // 时间戳
-            result = a.timeStamp < b.timeStamp;
-            break;
-        case 2: // 值
-            result = a.value < b.value;
-            break;
-        case 3: // 描述
-            result = a.description < b.description;
-            break;
-        default: // 数据点
-            if (column - 4 < a.dataPoints.size() && column - 4 < b.dataPoints.size()) {
-                result = a.dataPoints[column - 4] < b.dataPoints[column - 4];
-            }
-            else if (column - 4 < a.dataPoints.size()) {
-                result = true;
-            }
-            else {
-                result = false;
-            }
-            break;
-        }
+    // 根据指定列计算排列，再整体重排各列；无效项排在后面
+    m_store.applyPermutation(m_store.sortPermutation(column, ascending));
 
-        return ascending ? result : !result;
-    };
-
-    std::sort(m_dataItems.begin(), m_dataItems.end(), comparator);
+    // 统计值不变，但淘汰开头数据时要求累加器的加入顺序与列表一致
+    rebuildStatistics();
     emit signal_DA_M_dataChanged();
 }
 
@@ -586,16 +530,25 @@ void DataAnalysisModel::addDataItems(const std::vector<DataAnalysisItem>& items)
     }
 
     // 添加新项目
-    m_dataItems.insert(m_dataItems.end(), items.begin(), items.end());
+    for (const auto& item : items) {
+        appendItem(item);
+        accumulateRow(m_store.size() - 1);
+    }
 
     // 如果超过最大数量限制，删除旧数据
-    if (m_maxDataItems > 0 && m_dataItems.size() > static_cast<size_t>(m_maxDataItems)) {
-        size_t itemsToRemove = m_dataItems.size() - m_maxDataItems;
-        m_dataItems.erase(m_dataItems.begin(), m_dataItems.begin() + itemsToRemove);
+    if (m_maxDataItems > 0 && m_store.size() > static_cast<size_t>(m_maxDataItems)) {
+        size_t itemsToRemove = m_store.size() - m_maxDataItems;
+        for (size_t i = 0; i < itemsToRemove; ++i) {
+            removeOldestRow(i);
+        }
+        m_store.removeFront(itemsToRemove);
     }
 
-    // 更新统计信息
-    calculateStatistics();
+    // 更新统计信息：只计入新项、去掉淘汰项，不再遍历全部数据
+    if (m_accumulator.needsRebuild()) {
+        rebuildStatistics();
+    }
+    publishStatistics();
 
     // 发出通知
     emit signal_DA_M_dataChanged();
@@ -606,12 +559,18 @@ void DataAnalysisModel::setMaxDataItems(int maxItems)
     m_maxDataItems = maxItems;
 
     // 如果当前数据项超过新的限制，删除旧数据
-    if (m_maxDataItems > 0 && m_dataItems.size() > static_cast<size_t>(m_maxDataItems)) {
-        size_t itemsToRemove = m_dataItems.size() - m_maxDataItems;
-        m_dataItems.erase(m_dataItems.begin(), m_dataItems.begin() + itemsToRemove);
+    if (m_maxDataItems > 0 && m_store.size() > static_cast<size_t>(m_maxDataItems)) {
+        size_t itemsToRemove = m_store.size() - m_maxDataItems;
+        for (size_t i = 0; i < itemsToRemove; ++i) {
+            removeOldestRow(i);
+        }
+        m_store.removeFront(itemsToRemove);
 
         // 更新统计信息
-        calculateStatistics();
+        if (m_accumulator.needsRebuild()) {
+            rebuildStatistics();
+        }
+        publishStatistics();
 
         // 发出通知
         emit signal_DA_M_dataChanged();
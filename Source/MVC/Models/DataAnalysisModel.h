@@ -4,6 +4,9 @@
 #include <QObject>
 #include <memory>
 #include <vector>
+#include "StreamingStatistics.h"
+#include "DataFilterExpression.h"
+#include "DataItemStore.h"
 
  /**
   * @brief 数据分析项结构
@@ -42,7 +45,7 @@ struct StatisticsInfo {
     double min;                 ///< 最小值
     double max;                 ///< 最大值
     double average;             ///< 平均值
-    double median;              ///< 中位数
+    double median;              ///< 中位数（近似值，相对误差不超过0.5%）
     double stdDeviation;        ///< 标准差
     int count;                  ///< 数据点数量
 
@@ -57,6 +60,7 @@ struct StatisticsInfo {
  * @brief 数据分析模型类
  *
  * 负责存储和管理数据分析的数据，提供数据访问和处理接口
+ * 数据项按列存储在DataItemStore中，DataAnalysisItem只用于接口上的传入和取出
  * 采用单例模式实现
  */
 class DataAnalysisModel : public QObject
@@ -77,9 +81,9 @@ public:
 
     /**
      * @brief 获取数据项列表
-     * @return 数据项列表引用
+     * @return 所有数据项的副本，逐行生成；只需个别数据项时用getDataItem
      */
-    const std::vector<DataAnalysisItem>& getDataItems() const;
+    std::vector<DataAnalysisItem> getDataItems() const;
 
     /**
      * @brief 获取数据项数量
@@ -90,9 +94,25 @@ public:
     /**
      * @brief 获取指定索引的数据项
      * @param index 数据项索引
-     * @return 数据项引用
+     * @return 数据项副本，索引无效时为默认构造的数据项
      */
-    const DataAnalysisItem& getDataItem(int index) const;
+    DataAnalysisItem getDataItem(int index) const;
+
+    /**
+     * @brief 获取数据项的行号
+     *
+     * 行号在添加时分配，删除其他项、排序或淘汰旧数据后不变，可用于跨数据变化记住某一项
+     * @param index 数据项索引
+     * @return 行号，索引无效时为DataItemStore::INVALID_ROW_ID
+     */
+    quint64 getRowId(int index) const;
+
+    /**
+     * @brief 按行号查找数据项的当前索引
+     * @param rowId 行号
+     * @return 数据项索引，已删除时为-1
+     */
+    int findRowById(quint64 rowId) const;
 
     /**
      * @brief 添加数据项
@@ -127,7 +147,9 @@ public:
     StatisticsInfo getStatistics() const;
 
     /**
-     * @brief 计算统计信息
+     * @brief 从全部数据重新计算统计信息
+     *
+     * 数据增删时统计信息已增量更新，一般不需要调用；只做一遍线性扫描，不排序
      */
     void calculateStatistics();
 
@@ -157,6 +179,9 @@ public:
 
     /**
      * @brief 根据条件筛选数据
+     *
+     * 表达式语法见DataFilterExpression，例如"value > 5 AND desc ~ error"、"index IN [100, 200]"；
+     * 同一表达式只编译一次。无法解析的表达式按原样在描述中查找
      * @param filterExpression 筛选表达式
      * @return 筛选后的数据项索引列表
      */
@@ -241,9 +266,36 @@ private:
      */
     void sortData(int column, bool ascending);
 
+    /**
+     * @brief 追加一行到列存储
+     */
+    void appendItem(const DataAnalysisItem& item);
+
+    /**
+     * @brief 把一行的值和数据点计入统计
+     */
+    void accumulateRow(size_t row);
+
+    /**
+     * @brief 从统计中去掉最早计入的一行，只用于淘汰开头的数据
+     */
+    void removeOldestRow(size_t row);
+
+    /**
+     * @brief 从全部数据重建累加器，不发出信号
+     */
+    void rebuildStatistics();
+
+    /**
+     * @brief 从累加器取出统计信息并发出变更信号
+     */
+    void publishStatistics();
+
 private:
-    std::vector<DataAnalysisItem> m_dataItems;              ///< 数据项列表
+    DataItemStore m_store;                                  ///< 数据项列存储
     StatisticsInfo m_statistics;                            ///< 统计信息
+    StreamingStatistics m_accumulator;                      ///< 增量统计累加器，与m_store中的有效项保持一致
+    DataFilterExpression m_filterExpression;                ///< 上次编译的筛选表达式
     QByteArray m_rawData;                                   ///< 原始数据
     int m_columns;                                          ///< 列数
     int m_rows;                                             ///< 行数
@@ -1,5 +1,6 @@
 ﻿// Source/MVC/Models/FileOperationModel.cpp
 #include "FileOperationModel.h"
+#include "LiveIndexer.h"
 #include "Logger.h"
 #include <QSettings>
 #include <QDir>
@@ -14,6 +15,8 @@ FileOperationModel* FileOperationModel::getInstance()
 FileOperationModel::FileOperationModel()
     : QObject(nullptr)
     , m_fileManager(FileManager::instance())
+    , m_liveIndexer(std::make_shared<LiveIndexer>())
+    , m_liveIndexingEnabled(false)
     , m_status(SaveStatus::FS_IDLE)
 {
     // 将FileManager的信号连接到Model的信号
@@ -278,6 +281,23 @@ bool FileOperationModel::isUsingAsyncWriter() const
     return m_useAsyncWriter;
 }
 
+bool FileOperationModel::setLiveIndexingEnabled(bool enabled)
+{
+    // 采集写入的数据同步生成索引，停止采集后即可按偏移定位；会接管全局索引，因此需要显式启用
+    if (!m_fileManager.setWriteObserver(enabled ? m_liveIndexer : nullptr)) {
+        return false;
+    }
+
+    m_liveIndexingEnabled = enabled;
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("采集实时索引: %1").arg(enabled ? "已启用" : "已禁用"));
+    return true;
+}
+
+bool FileOperationModel::isLiveIndexingEnabled() const
+{
+    return m_liveIndexingEnabled;
+}
+
 bool FileOperationModel::saveConfigToSettings()
 {
     try {
@@ -294,6 +314,7 @@ bool FileOperationModel::saveConfigToSettings()
         settings.setValue("saveMetadata", m_parameters.saveMetadata);
         settings.setValue("compressionLevel", m_parameters.compressionLevel);
         settings.setValue("useAsyncWriter", m_useAsyncWriter);
+        settings.setValue("liveIndexing", m_liveIndexingEnabled);
 
         // 保存选项
         settings.beginGroup("Options");
@@ -327,6 +348,7 @@ bool FileOperationModel::loadConfigFromSettings()
         params.saveMetadata = settings.value("saveMetadata", false).toBool();
         params.compressionLevel = settings.value("compressionLevel", 0).toInt();
         m_useAsyncWriter = settings.value("useAsyncWriter", false).toBool();
+        setLiveIndexingEnabled(settings.value("liveIndexing", false).toBool());
 
         // 加载选项
         settings.beginGroup("Options");
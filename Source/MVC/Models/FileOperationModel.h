@@ -11,6 +11,8 @@
 #include <memory>
 #include <FileManager.h>
 
+class LiveIndexer;
+
 /**
  * @brief 文件保存模型类
  *
@@ -110,6 +112,21 @@ public:
      */
     bool isUsingAsyncWriter() const;
 
+    /**
+     * @brief 启用采集时的实时索引，默认关闭
+     *
+     * 启用后每次采集开始时LiveIndexer接管全局的IndexGenerator：关闭界面当前打开的索引（先保存），
+     * 改为本次采集的索引并持续追加，采集结束后可直接按索引定位。采集期间不要在界面中打开其他索引。
+     * @param enabled 是否启用
+     * @return 是否生效，保存过程中无法切换
+     */
+    bool setLiveIndexingEnabled(bool enabled);
+
+    /**
+     * @brief 是否启用采集时的实时索引
+     */
+    bool isLiveIndexingEnabled() const;
+
     /**
      * @brief 保存当前配置到系统设置
      * @return 保存结果，true表示成功
@@ -320,6 +337,8 @@ private:
 
 private:
     FileManager& m_fileManager;             // 引用FileManager单例
+    std::shared_ptr<LiveIndexer> m_liveIndexer; // 采集过程中的实时索引器
+    bool m_liveIndexingEnabled;             // 是否启用实时索引
     QString m_loadedFilePath;               // 当前加载的文件路径
     SaveParameters m_parameters;            // 保存参数
     std::atomic<SaveStatus> m_status;       // 当前状态
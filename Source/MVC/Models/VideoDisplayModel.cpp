@@ -80,6 +80,12 @@ void VideoDisplayModel::setRenderImage(const QImage& image)
     emit signal_VD_M_renderImageChanged(m_renderImage);
 }
 
+void VideoDisplayModel::setRenderImage(QImage&& image)
+{
+    m_renderImage = std::move(image);
+    emit signal_VD_M_renderImageChanged(m_renderImage);
+}
+
 bool VideoDisplayModel::saveConfig()
 {
     try {
@@ -96,6 +102,9 @@ bool VideoDisplayModel::saveConfig()
         settings.setValue("commandType", m_config.commandType);
         settings.setValue("playbackSpeed", m_config.playbackSpeed);
         settings.setValue("autoAdvance", m_config.autoAdvance);
+        settings.setValue("demosaicMethod", m_config.demosaicMethod);
+        settings.setValue("bayerPattern", m_config.bayerPattern);
+        settings.setValue("toneMap", m_config.toneMap);
 
         LOG_INFO("视频配置已保存到存储");
         return true;
@@ -122,6 +131,9 @@ bool VideoDisplayModel::loadConfig()
         m_config.commandType = settings.value("commandType", 0).toUInt();
         m_config.playbackSpeed = settings.value("playbackSpeed", 1).toInt();
         m_config.autoAdvance = settings.value("autoAdvance", false).toBool();
+        m_config.demosaicMethod = settings.value("demosaicMethod", 0).toInt();
+        m_config.bayerPattern = settings.value("bayerPattern", 0).toInt();
+        m_config.toneMap = settings.value("toneMap", false).toBool();
 
         // 重置运行状态
         m_config.isRunning = false;
@@ -152,7 +164,7 @@ void VideoDisplayModel::resetToDefault()
     m_renderImage.fill(Qt::black);
 
     // 清空已加载的帧列表
-    m_loadedFrames.clear();
+    m_loadedFrames = VideoFrameView();
     m_currentFrameIndex = -1;
 
     emit signal_VD_M_configChanged(m_config);
@@ -162,14 +174,14 @@ void VideoDisplayModel::resetToDefault()
     LOG_INFO("视频配置已重置为默认值");
 }
 
-void VideoDisplayModel::setLoadedFrames(const QVector<PacketIndexEntry>& entries)
+void VideoDisplayModel::setLoadedFrames(const VideoFrameView& frames)
 {
-    m_loadedFrames = entries;
+    m_loadedFrames = frames;
     m_currentFrameIndex = m_loadedFrames.isEmpty() ? -1 : 0;
 
     // 如果有帧，设置当前帧索引条目
     if (m_currentFrameIndex >= 0) {
-        m_currentEntry = m_loadedFrames[m_currentFrameIndex];
+        m_currentEntry = m_loadedFrames.at(m_currentFrameIndex);
         emit signal_VD_M_currentEntryChanged(m_currentEntry);
     }
 
@@ -178,7 +190,7 @@ void VideoDisplayModel::setLoadedFrames(const QVector<PacketIndexEntry>& entries
     LOG_INFO(QString("已加载 %1 个帧").arg(m_loadedFrames.size()));
 }
 
-QVector<PacketIndexEntry> VideoDisplayModel::getLoadedFrames() const
+VideoFrameView VideoDisplayModel::getLoadedFrames() const
 {
     return m_loadedFrames;
 }
@@ -198,7 +210,7 @@ bool VideoDisplayModel::setCurrentFrameIndex(int index)
 
     // 如果索引有效，更新当前索引条目
     if (m_currentFrameIndex >= 0) {
-        m_currentEntry = m_loadedFrames[m_currentFrameIndex];
+        m_currentEntry = m_loadedFrames.at(m_currentFrameIndex);
         emit signal_VD_M_currentEntryChanged(m_currentEntry);
     }
 
@@ -250,6 +262,9 @@ VideoConfig VideoDisplayModel::createDefaultConfig()
     config.endTimestamp = 0;
     config.autoAdvance = false;
     config.playbackSpeed = 1;
+    config.demosaicMethod = 0;  // 关闭，按RGB解码
+    config.bayerPattern = 0;  // RGGB
+    config.toneMap = false;
 
     return config;
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include <QImage>
 #include <QVector>
 #include <QPair>
-#include "IndexGenerator.h"
+#include "VideoFrameTable.h"
 
 /**
  * @brief 视频配置数据结构
@@ -26,6 +26,9 @@ struct VideoConfig {
     uint64_t endTimestamp = 0;           ///< 结束时间戳
     bool autoAdvance = false;            ///< 自动播放下一帧
     int playbackSpeed = 1;               ///< 播放速度倍率
+    int demosaicMethod = 0;              ///< 去马赛克方法：0关闭（按RGB解码），1双线性，2边缘自适应
+    int bayerPattern = 0;                ///< 拜耳排列：0 RGGB，1 GRBG，2 GBRG，3 BGGR
+    bool toneMap = false;                ///< 去马赛克后做gamma色调映射
 };
 
 /**
@@ -88,6 +91,14 @@ public:
      */
     void setRenderImage(const QImage& image);
 
+    /**
+     * @brief 设置渲染图像，接管图像的引用
+     *
+     * 解码结果来自FrameBufferPool，上一帧在这里释放引用后像素缓冲才能回到池中。
+     * @param image 新的渲染图像
+     */
+    void setRenderImage(QImage&& image);
+
     /**
      * @brief 保存配置到存储
      * @return 保存结果，true表示成功
@@ -107,15 +118,15 @@ public:
 
     /**
      * @brief 设置已加载的帧列表
-     * @param entries 索引条目列表
+     * @param frames 帧表上的筛选结果
      */
-    void setLoadedFrames(const QVector<PacketIndexEntry>& entries);
+    void setLoadedFrames(const VideoFrameView& frames);
 
     /**
      * @brief 获取已加载的帧列表
-     * @return 索引条目列表
+     * @return 帧表上的筛选结果
      */
-    QVector<PacketIndexEntry> getLoadedFrames() const;
+    VideoFrameView getLoadedFrames() const;
 
     /**
      * @brief 获取当前帧索引
@@ -201,7 +212,7 @@ private:
     VideoConfig m_config;                                ///< 当前配置
     QByteArray m_frameData;                              ///< 当前帧数据
     QImage m_renderImage;                                ///< 当前渲染图像
-    QVector<PacketIndexEntry> m_loadedFrames;            ///< 已加载的帧列表
+    VideoFrameView m_loadedFrames;                       ///< 已加载的帧列表
     int m_currentFrameIndex = -1;                        ///< 当前帧索引
     PacketIndexEntry m_currentEntry;                     ///< 当前帧的索引条目
 };
\ No newline at end of file
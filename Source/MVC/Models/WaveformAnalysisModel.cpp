@@ -1,8 +1,10 @@
 ﻿// Source/MVC/Models/WaveformAnalysisModel.cpp
 #include "WaveformAnalysisModel.h"
 #include "DataAccessService.h"
+#include "WaveformTileSource.h"
 #include "Logger.h"
 #include "DataPacket.h"
+#include <cmath>
 
 WaveformAnalysisModel* WaveformAnalysisModel::getInstance()
 {
@@ -13,6 +15,9 @@ WaveformAnalysisModel* WaveformAnalysisModel::getInstance()
 WaveformAnalysisModel::WaveformAnalysisModel()
     : QObject(nullptr)
     , m_dataService(nullptr)
+    , m_tileSource(nullptr)
+    , m_indexStart(0.0)
+    , m_indexCount(0)
     , m_xMin(0.0)
     , m_xMax(100.0)
     , m_zoomLevel(1.0)
@@ -22,6 +27,7 @@ WaveformAnalysisModel::WaveformAnalysisModel()
     initializeDefaults();
 
     m_dataService = &DataAccessService::getInstance();
+    m_tileSource = new WaveformTileSource(this);
 
     if (m_dataService) {
         connect(m_dataService, &DataAccessService::signal_DT_ACC_dataReadComplete,
@@ -44,6 +50,7 @@ void WaveformAnalysisModel::initializeDefaults()
 
     // 初始化通道数据容器
     m_channelData.resize(4);
+    m_channelPyramids.resize(4);
 
     // 设置默认通道颜色
     m_channelColors[0] = QColor(Qt::red);         // BYTE0 - 红色
@@ -84,28 +91,26 @@ bool WaveformAnalysisModel::loadData(int startIndex, int length)
         // 清除现有数据
         for (int i = 0; i < 4; ++i) {
             m_channelData[i].clear();
+            m_channelPyramids[i].clear();
         }
-        m_indexData.clear();
 
-        // 生成索引数据
-        m_indexData.reserve(length);
-        for (int i = 0; i < length; ++i) {
-            m_indexData.append(startIndex + i);
-        }
+        // 索引数据为从startIndex开始的连续值
+        m_indexStart = startIndex;
+        m_indexCount = length;
 
-        // 使用DataAccessService获取实际通道数据
+        // 使用DataAccessService获取实际通道数据，一次读取拆分全部通道
+        const QVector<QByteArray> planes = m_dataService->getChannelPlanes(startIndex, length);
         bool allChannelsEmpty = true;
         for (int channel = 0; channel < 4; ++channel) {
-            // 调用DataAccessService获取通道数据
-            LOG_INFO(LocalQTCompat::fromLocal8Bit("开始获取通道%1数据").arg(channel));
-            QVector<double> channelData = m_dataService->getChannelData(
-                channel, startIndex, length);
+            const QByteArray& plane = planes[channel];
 
-            if (!channelData.isEmpty()) {
-                m_channelData[channel] = channelData;
+            if (!plane.isEmpty()) {
+                m_channelData[channel].assignNonZero(reinterpret_cast<const uint8_t*>(plane.constData()),
+                    static_cast<size_t>(plane.size()));
+                rebuildPyramid(channel);
                 allChannelsEmpty = false;
                 LOG_INFO(LocalQTCompat::fromLocal8Bit("通道%1数据加载成功: 大小=%2")
-                    .arg(channel).arg(channelData.size()));
+                    .arg(channel).arg(plane.size()));
             }
             else {
                 LOG_WARN(LocalQTCompat::fromLocal8Bit("通道%1数据加载失败或为空，使用模拟数据").arg(channel));
@@ -120,7 +125,8 @@ bool WaveformAnalysisModel::loadData(int startIndex, int length)
                     simulatedData.append(value);
                 }
 
-                m_channelData[channel] = simulatedData;
+                m_channelData[channel].assignLevels(simulatedData.constData(), static_cast<size_t>(simulatedData.size()));
+                rebuildPyramid(channel);
                 allChannelsEmpty = false;
                 LOG_INFO(LocalQTCompat::fromLocal8Bit("通道%1使用模拟数据: 大小=%2")
                     .arg(channel).arg(simulatedData.size()));
@@ -180,8 +186,9 @@ bool WaveformAnalysisModel::loadDataAsync(uint64_t packetIndex)
         // 清除现有数据
         for (int i = 0; i < 4; ++i) {
             m_channelData[i].clear();
+            m_channelPyramids[i].clear();
         }
-        m_indexData.clear();
+        m_indexCount = 0;
 
         // 使用DataAccessService异步读取数据包
         // 如果DataAccessService没有直接提供按索引读取的方法，那么需要增加该接口
@@ -228,8 +235,9 @@ bool WaveformAnalysisModel::parsePacketData(const QByteArray& data)
         // 清除现有数据
         for (int i = 0; i < 4; ++i) {
             m_channelData[i].clear();
+            m_channelPyramids[i].clear();
         }
-        m_indexData.clear();
+        m_indexCount = 0;
 
         // 解析二进制数据到通道数据
         int dataLength = data.size();
@@ -240,46 +248,24 @@ bool WaveformAnalysisModel::parsePacketData(const QByteArray& data)
             return false;
         }
 
-        // 生成索引数据
-        m_indexData.reserve(dataLength);
-        for (int i = 0; i < dataLength; ++i) {
-            m_indexData.append(i);
-        }
+        // 索引数据为从0开始的连续值
+        m_indexStart = 0;
+        m_indexCount = dataLength;
 
         // 解析为4个通道的数据
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.constData());
+        std::vector<uint8_t> levels(static_cast<size_t>(dataLength));
         for (int channel = 0; channel < 4; ++channel) {
-            QVector<double> channelData;
-            channelData.reserve(dataLength);
 
+            // 这里假设每个字节包含4个通道的数据，每个通道占用2位：
+            // BYTE0为最低2位，BYTE1为中间2位，BYTE2为高2位，BYTE3为最高2位；非零视为高电平
+            const int shift = channel * 2;
             for (int i = 0; i < dataLength; ++i) {
-                // 从每个字节中提取对应通道的位
-                // 这里假设每个字节包含4个通道的数据，每个通道占用2位
-                uint8_t byteValue = static_cast<uint8_t>(data.at(i));
-
-                // 根据通道索引提取不同的位
-                double value = 0.0;
-                switch (channel) {
-                case 0: // BYTE0：提取最低2位
-                    value = byteValue & 0x03;
-                    break;
-                case 1: // BYTE1：提取中间2位
-                    value = (byteValue >> 2) & 0x03;
-                    break;
-                case 2: // BYTE2：提取高2位
-                    value = (byteValue >> 4) & 0x03;
-                    break;
-                case 3: // BYTE3：提取最高2位
-                    value = (byteValue >> 6) & 0x03;
-                    break;
-                }
-
-                // 归一化到0-1范围，大于0的值都视为高电平
-                value = value > 0 ? 1.0 : 0.0;
-
-                channelData.append(value);
+                levels[i] = static_cast<uint8_t>((bytes[i] >> shift) & 0x03);
             }
 
-            m_channelData[channel] = channelData;
+            m_channelData[channel].assignNonZero(levels.data(), levels.size());
+            rebuildPyramid(channel);
         }
 
         // 设置默认视图范围
@@ -309,17 +295,75 @@ QVector<double> WaveformAnalysisModel::getChannelData(int channel) const
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("获取 %1 通道数据").arg(channel));
 
+    QVector<double> result;
+    if (channel >= 0 && channel < m_channelData.size()) {
+        const LogicChannel& logic = m_channelData[channel];
+        result.resize(static_cast<int>(logic.size()));
+        double* values = result.data();
+        logic.forEachRun(0, logic.size(), [values](size_t start, size_t length, bool high) {
+            std::fill(values + start, values + start + length, high ? 1.0 : 0.0);
+            });
+    }
+    return result;
+}
+
+const LogicChannel& WaveformAnalysisModel::getLogicChannel(int channel) const
+{
+    static const LogicChannel emptyChannel;
+
     if (channel >= 0 && channel < m_channelData.size()) {
         return m_channelData[channel];
     }
-    return QVector<double>();
+    return emptyChannel;
+}
+
+const WaveformPyramid& WaveformAnalysisModel::getChannelPyramid(int channel) const
+{
+    static const WaveformPyramid emptyPyramid;
+
+    if (channel >= 0 && channel < m_channelPyramids.size()) {
+        return m_channelPyramids[channel];
+    }
+    return emptyPyramid;
+}
+
+WaveformTileSource* WaveformAnalysisModel::getTileSource() const
+{
+    return m_tileSource;
+}
+
+void WaveformAnalysisModel::rebuildPyramid(int channel)
+{
+    if (channel >= 0 && channel < m_channelPyramids.size()) {
+        m_channelPyramids[channel].build(m_channelData[channel]);
+    }
 }
 
 QVector<double> WaveformAnalysisModel::getIndexData() const
 {
-    LOG_INFO(LocalQTCompat::fromLocal8Bit("获取索引数据，数据大小：%1，没有数据是正常的，不要见怪").arg(m_indexData.size()));
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("获取索引数据，数据大小：%1，没有数据是正常的，不要见怪").arg(m_indexCount));
+
+    QVector<double> indexData(m_indexCount);
+    for (int i = 0; i < m_indexCount; ++i) {
+        indexData[i] = m_indexStart + i;
+    }
+    return indexData;
+}
 
-    return m_indexData;
+double WaveformAnalysisModel::getIndexStart() const
+{
+    return m_indexStart;
+}
+
+int WaveformAnalysisModel::getIndexCount() const
+{
+    return m_indexCount;
+}
+
+void WaveformAnalysisModel::setIndexRange(double start, int count)
+{
+    m_indexStart = start;
+    m_indexCount = std::max(count, 0);
 }
 
 void WaveformAnalysisModel::getViewRange(double& xMin, double& xMax) const
@@ -359,9 +403,13 @@ void WaveformAnalysisModel::setViewRange(double xMin, double xMax)
         return;
     }
 
-    // 防止极端值
+    // 防止极端值；有采集文件时时间轴为文件内的样本位置，上限随文件长度
     const double MAX_RANGE = 1.0e6;
-    if (std::abs(xMin) > MAX_RANGE || std::abs(xMax) > MAX_RANGE) {
+    double maxRange = MAX_RANGE;
+    if (m_tileSource && m_tileSource->isActive()) {
+        maxRange = std::max(maxRange, static_cast<double>(m_tileSource->totalSamples()));
+    }
+    if (std::abs(xMin) > maxRange || std::abs(xMax) > maxRange) {
         LOG_ERROR(LocalQTCompat::fromLocal8Bit("视图范围过大: xMin=%1, xMax=%2").arg(xMin).arg(xMax));
         return;
     }
@@ -532,46 +580,55 @@ void WaveformAnalysisModel::analyzeData()
 
     LOG_INFO(LocalQTCompat::fromLocal8Bit("分析数据"));
 
-    // 分析每个通道的数据
-    for (int ch = 0; ch < 4; ++ch) {
-        if (!isChannelEnabled(ch)) {
-            continue;
+    // 各通道在可见区域内的样本数、高电平数和跳变数
+    qint64 points[4] = {};
+    qint64 highs[4] = {};
+    qint64 transitions[4] = {};
+    bool analyzed[4] = {};
+
+    if (m_tileSource->isActive()) {
+        // 有采集文件时视图范围是文件中的样本位置，只统计已加载的分块
+        const qint64 missing = analyzeTiles(points, highs, transitions);
+        for (int ch = 0; ch < 4; ++ch) {
+            analyzed[ch] = isChannelEnabled(ch);
         }
-
-        const QVector<double>& data = m_channelData[ch];
-        if (data.isEmpty()) {
-            continue;
+        if (missing > 0) {
+            result += QString("部分分析: %1 个样本所在的分块尚未加载，未计入统计\n\n").arg(missing);
         }
-
-        // 计算可见区域的范围
-        int startIdx = qMax(0, qCeil(m_xMin));
-        int endIdx = qMin(data.size() - 1, qFloor(m_xMax));
-
-        // 统计高低电平
-        int highLevelCount = 0;
-        int lowLevelCount = 0;
-        int transitionCount = 0;
-        double lastValue = -1;
-
-        for (int i = startIdx; i <= endIdx; ++i) {
-            double value = data[i];
-
-            if (value > 0.5) {
-                highLevelCount++;
-            }
-            else {
-                lowLevelCount++;
+    }
+    else {
+        for (int ch = 0; ch < 4; ++ch) {
+            const LogicChannel& data = m_channelData[ch];
+            if (!isChannelEnabled(ch) || data.empty()) {
+                continue;
             }
 
-            if (lastValue >= 0 && lastValue != value) {
-                transitionCount++;
+            // 计算可见区域的范围
+            const qint64 startIdx = qMax<qint64>(0, qCeil(m_xMin));
+            const qint64 endIdx = qMin<qint64>(static_cast<qint64>(data.size()) - 1, qFloor(m_xMax));
+
+            // 统计高低电平和跳变：按字popcount，不逐点遍历
+            analyzed[ch] = true;
+            points[ch] = qMax<qint64>(endIdx - startIdx + 1, 0);
+            if (points[ch] > 0) {
+                highs[ch] = static_cast<qint64>(data.countHigh(static_cast<size_t>(startIdx), static_cast<size_t>(endIdx) + 1));
+                transitions[ch] = static_cast<qint64>(data.countTransitions(static_cast<size_t>(startIdx), static_cast<size_t>(endIdx) + 1));
             }
+        }
+    }
 
-            lastValue = value;
+    // 分析每个通道的数据
+    for (int ch = 0; ch < 4; ++ch) {
+        if (!analyzed[ch]) {
+            continue;
         }
 
+        const qint64 totalPoints = points[ch];
+        const qint64 highLevelCount = highs[ch];
+        const qint64 transitionCount = transitions[ch];
+        const qint64 lowLevelCount = totalPoints - highLevelCount;
+
         // 计算统计数据
-        int totalPoints = endIdx - startIdx + 1;
         double highPercent = totalPoints > 0 ? (highLevelCount * 100.0 / totalPoints) : 0;
         double lowPercent = totalPoints > 0 ? (lowLevelCount * 100.0 / totalPoints) : 0;
         double avgPeriod = transitionCount > 0 ? (totalPoints * 2.0 / transitionCount) : 0;
@@ -590,12 +647,79 @@ void WaveformAnalysisModel::analyzeData()
     emit signal_WA_M_dataAnalysisCompleted(result);
 }
 
+qint64 WaveformAnalysisModel::analyzeTiles(qint64 points[4], qint64 highs[4], qint64 transitions[4])
+{
+    if (m_xMax < 0) {
+        return 0;
+    }
+
+    const quint64 lastSample = m_tileSource->totalSamples() - 1;
+    const quint64 first = static_cast<quint64>(qMax(0.0, std::ceil(m_xMin)));
+    const quint64 last = qMin(static_cast<quint64>(std::floor(m_xMax)), lastSample);
+    if (first > last) {
+        return 0;
+    }
+
+    qint64 missing = 0;
+    bool hasPrevious = false;           // 上一块是否统计到了本块起点之前，用于统计分块边界上的跳变
+    quint64 previousEnd = 0;
+    bool previousLevel[4] = {};
+
+    for (quint64 tileIndex = WaveformTileSource::tileIndexOf(first);
+        tileIndex <= WaveformTileSource::tileIndexOf(last); ++tileIndex) {
+        const quint64 tileFirst = tileIndex * WaveformTileSource::TILE_SAMPLES;
+        const quint64 rangeBegin = qMax(first, tileFirst);
+        const quint64 rangeEnd = qMin(last + 1, tileFirst + WaveformTileSource::TILE_SAMPLES);
+
+        // 分块中的下标从该分块的第一个样本算起
+        const QSharedPointer<const WaveformTile> tile = m_tileSource->tile(tileIndex);
+        const quint64 loadedEnd = tile ? qMin(rangeEnd, tileFirst + tile->sampleCount) : rangeBegin;
+        missing += static_cast<qint64>(rangeEnd - loadedEnd);
+        if (loadedEnd <= rangeBegin) {
+            hasPrevious = false;
+            continue;
+        }
+
+        const size_t begin = static_cast<size_t>(rangeBegin - tileFirst);
+        const size_t end = static_cast<size_t>(loadedEnd - tileFirst);
+        for (int ch = 0; ch < 4; ++ch) {
+            if (!isChannelEnabled(ch)) {
+                continue;
+            }
+
+            const LogicChannel& data = tile->channels[ch];
+            points[ch] += static_cast<qint64>(end - begin);
+            highs[ch] += static_cast<qint64>(data.countHigh(begin, end));
+            transitions[ch] += static_cast<qint64>(data.countTransitions(begin, end));
+            if (hasPrevious && previousEnd == rangeBegin && previousLevel[ch] != data.valueAt(begin)) {
+                transitions[ch]++;
+            }
+            previousLevel[ch] = data.valueAt(end - 1);
+        }
+        hasPrevious = true;
+        previousEnd = loadedEnd;
+    }
+
+    return missing;
+}
+
 void WaveformAnalysisModel::updateChannelData(int channel, const QVector<double>& data)
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("更新通道：%1 数据").arg(channel));
 
+    if (channel >= 0 && channel < 4) {
+        m_channelData[channel].assignLevels(data.constData(), static_cast<size_t>(data.size()));
+        rebuildPyramid(channel);
+    }
+}
+
+void WaveformAnalysisModel::updateChannelData(int channel, const LogicChannel& data)
+{
+    LOG_INFO(LocalQTCompat::fromLocal8Bit("更新通道：%1 数据，样本数：%2").arg(channel).arg(data.size()));
+
     if (channel >= 0 && channel < 4) {
         m_channelData[channel] = data;
+        rebuildPyramid(channel);
     }
 }
 
@@ -603,5 +727,5 @@ void WaveformAnalysisModel::updateIndexData(const QVector<double>& data)
 {
     LOG_INFO(LocalQTCompat::fromLocal8Bit("更新索引数据：%1").arg(data.size()));
 
-    m_indexData = data;
+    setIndexRange(data.isEmpty() ? 0.0 : data.first(), data.size());
 }
\ No newline at end of file
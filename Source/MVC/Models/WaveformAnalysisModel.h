@@ -6,9 +6,12 @@
 #include <QMap>
 #include <QColor>
 #include <memory>
+#include "LogicChannel.h"
+#include "WaveformPyramid.h"
 
 // 添加必要的前向声明
 class DataAccessService;
+class WaveformTileSource;
 
 /**
  * @brief 波形分析模型类
@@ -43,17 +46,64 @@ public:
 
     /**
      * @brief 获取通道数据
+     *
+     * 由位压缩存储展开为每样本一个double，只用于兼容；绘制和统计应使用getLogicChannel。
+     *
      * @param channel 通道索引(0-3)
      * @return 通道数据向量
      */
     QVector<double> getChannelData(int channel) const;
 
+    /**
+     * @brief 获取位压缩的通道数据
+     * @param channel 通道索引(0-3)
+     * @return 通道数据，通道无效时为空通道
+     */
+    const LogicChannel& getLogicChannel(int channel) const;
+
+    /**
+     * @brief 获取通道的多分辨率摘要，通道数据更新时重建
+     * @param channel 通道索引(0-3)
+     * @return 摘要，通道无效时为空摘要
+     */
+    const WaveformPyramid& getChannelPyramid(int channel) const;
+
+    /**
+     * @brief 获取覆盖整个采集文件的分块数据源
+     *
+     * 数据源有可用文件时，视图索引即文件中的样本位置，绘制直接使用分块数据；
+     * 否则绘制getLogicChannel中的数据。
+     *
+     * @return 分块数据源，由模型持有
+     */
+    WaveformTileSource* getTileSource() const;
+
     /**
      * @brief 获取索引数据
+     *
+     * 索引总是从getIndexStart()开始的连续值，此函数按需生成，只用于兼容。
+     *
      * @return 索引数据向量
      */
     QVector<double> getIndexData() const;
 
+    /**
+     * @brief 获取第一个样本的索引，第i个样本的索引为getIndexStart() + i
+     */
+    double getIndexStart() const;
+
+    /**
+     * @brief 获取索引数据长度
+     */
+    int getIndexCount() const;
+
+    /**
+     * @brief 设置索引范围
+     * @param start 第一个样本的索引
+     * @param count 样本数
+     */
+    void setIndexRange(double start, int count);
+
     /**
      * @brief 获取可见数据范围
      * @param xMin 输出最小索引
@@ -194,6 +244,8 @@ public:
 
     /**
      * @brief 分析当前数据
+     *
+     * 有采集文件时按视图范围统计已加载的分块，尚未加载的部分不计入，结果中注明未统计的样本数。
      */
     void analyzeData();
 
@@ -204,9 +256,16 @@ public:
      */
     void updateChannelData(int channel, const QVector<double>& data);
 
+    /**
+     * @brief 更新通道数据
+     * @param channel 通道索引
+     * @param data 位压缩的通道数据
+     */
+    void updateChannelData(int channel, const LogicChannel& data);
+
     /**
      * @brief 更新索引数据
-     * @param data 索引数据
+     * @param data 索引数据，应为连续递增的值，只保留起点和长度
      */
     void updateIndexData(const QVector<double>& data);
 
@@ -269,9 +328,27 @@ private:
      */
     void processReceivedData(uint64_t timestamp, const QByteArray& data);
 
+    /**
+     * @brief 通道数据变化后重建该通道的摘要
+     * @param channel 通道索引
+     */
+    void rebuildPyramid(int channel);
+
+    /**
+     * @brief 在视图范围内的已加载分块上累加各启用通道的统计
+     * @param points 样本数
+     * @param highs 高电平样本数
+     * @param transitions 跳变次数，包括相邻分块交界处的跳变
+     * @return 所在分块尚未加载、未计入统计的样本数
+     */
+    qint64 analyzeTiles(qint64 points[4], qint64 highs[4], qint64 transitions[4]);
+
     DataAccessService* m_dataService;          // 数据访问服务
-    QVector<QVector<double>> m_channelData;    // 多通道数据
-    QVector<double> m_indexData;               // 索引数据
+    QVector<LogicChannel> m_channelData;       // 多通道数据（位压缩）
+    QVector<WaveformPyramid> m_channelPyramids; // 各通道的多分辨率摘要
+    WaveformTileSource* m_tileSource;          // 整个文件的分块数据源
+    double m_indexStart;                       // 第一个样本的索引
+    int m_indexCount;                          // 索引数据长度
     QVector<int> m_markerPoints;               // 标记点
     double m_xMin;                             // 视图最小索引
     double m_xMax;                             // 视图最大索引
@@ -106,6 +106,8 @@ void DataAnalysisView::slot_DA_V_showProgressDialog(const QString& title, const
     m_progressDialog->setWindowModality(Qt::WindowModal);
     m_progressDialog->setMinimumDuration(500); // 0.5秒后显示
     m_progressDialog->setValue(min);
+    connect(m_progressDialog, &QProgressDialog::canceled,
+        this, &DataAnalysisView::signal_DA_V_progressCanceled);
     m_progressDialog->show();
 }
 
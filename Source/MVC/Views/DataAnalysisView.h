@@ -119,6 +119,11 @@ signals:
      */
     void signal_DA_V_loadDataFromFileRequested(const QString& filePath);
 
+    /**
+     * @brief 进度对话框取消信号
+     */
+    void signal_DA_V_progressCanceled();
+
 private slots:
     /**
      * @brief 处理表格选择变化
@@ -137,6 +137,11 @@ void WaveformAnalysisView::connectSignals()
     connect(ui->actionStartAnalysis, &QAction::triggered, this, &WaveformAnalysisView::slot_WA_V_onStartAnalysisTriggered);
     connect(ui->actionStopAnalysis, &QAction::triggered, this, &WaveformAnalysisView::slot_WA_V_onStopAnalysisTriggered);
     connect(ui->actionExportData, &QAction::triggered, this, &WaveformAnalysisView::slot_WA_V_onExportDataTriggered);
+    connect(ui->actionLiveMode, &QAction::toggled, this, &WaveformAnalysisView::slot_WA_V_onLiveModeToggled);
+
+    // 实时触发
+    connect(ui->triggerChannelCombo, &QComboBox::currentIndexChanged, this, &WaveformAnalysisView::slot_WA_V_onTriggerChanged);
+    connect(ui->triggerEdgeCombo, &QComboBox::currentIndexChanged, this, &WaveformAnalysisView::slot_WA_V_onTriggerChanged);
 
     // 按钮
     connect(ui->analyzeButton, &QPushButton::clicked, this, &WaveformAnalysisView::slot_WA_V_onAnalyzeButtonClicked);
@@ -602,4 +607,29 @@ void WaveformAnalysisView::slot_WA_V_onVerticalScaleSliderChanged(int value)
         // 请求更新OpenGL控件
         updateWaveform();
     }
-}
\ No newline at end of file
+}
+
+void WaveformAnalysisView::slot_WA_V_onLiveModeToggled(bool checked)
+{
+    if (m_controller) {
+        LOG_INFO(LocalQTCompat::fromLocal8Bit("实时显示开关: %1").arg(checked ? "开启" : "关闭"));
+        m_controller->slot_WA_C_setLiveMode(checked);
+    }
+}
+
+void WaveformAnalysisView::slot_WA_V_onTriggerChanged()
+{
+    if (!m_controller)
+        return;
+
+    // 第0项为不触发，其余依次为通道0-3
+    const int channel = ui->triggerChannelCombo->currentIndex() - 1;
+    LiveWaveformRing::TriggerEdge edge = LiveWaveformRing::TriggerEdge::Rising;
+    switch (ui->triggerEdgeCombo->currentIndex()) {
+    case 1: edge = LiveWaveformRing::TriggerEdge::Falling; break;
+    case 2: edge = LiveWaveformRing::TriggerEdge::Either; break;
+    default: break;
+    }
+
+    m_controller->slot_WA_C_setLiveTrigger(channel, edge);
+}
@@ -241,6 +241,17 @@ private slots:
      */
     void slot_WA_V_onVerticalScaleSliderChanged(int value);
 
+    /**
+     * @brief 处理实时显示开关
+     * @param checked 是否开启
+     */
+    void slot_WA_V_onLiveModeToggled(bool checked);
+
+    /**
+     * @brief 处理触发通道或边沿变更
+     */
+    void slot_WA_V_onTriggerChanged();
+
 private:
     /**
      * @brief 初始化连接
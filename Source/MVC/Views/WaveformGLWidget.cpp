@@ -1,6 +1,7 @@
 ﻿// Source/MVC/Views/WaveformGLWidget.cpp
 #include "WaveformGLWidget.h"
 #include "WaveformAnalysisModel.h"
+#include "WaveformTileSource.h"
 #include "Logger.h"
 #include <QMatrix4x4>
 #include <QPainter>
@@ -56,6 +57,21 @@ WaveformGLWidget::~WaveformGLWidget()
         m_program = nullptr;
     }
 
+    // 释放波形环形缓冲
+    for (QOpenGLBuffer*& buffer : m_channelBuffers) {
+        if (buffer) {
+            buffer->destroy();
+            delete buffer;
+            buffer = nullptr;
+        }
+    }
+    m_waveformVao.destroy();
+
+    if (m_waveformProgram) {
+        delete m_waveformProgram;
+        m_waveformProgram = nullptr;
+    }
+
     // 释放网格绘制相关资源
     if (m_gridBuffer) {
         m_gridBuffer->destroy();
@@ -95,12 +111,52 @@ void WaveformGLWidget::requestUpdate()
     update();
 }
 
+void WaveformGLWidget::invalidateSamples(double first, double last)
+{
+    // 时间轴模式下视图索引即样本位置，与环形缓冲的样本坐标一致
+    const quint64 from = static_cast<quint64>(std::max(0.0, first));
+    const quint64 to = static_cast<quint64>(std::max(0.0, last));
+    for (WaveformVertexRing& ring : m_vertexRings) {
+        ring.invalidateSamples(from, to);
+    }
+    update();
+}
+
+void WaveformGLWidget::setLiveMode(bool live)
+{
+    if (m_liveMode == live)
+        return;
+
+    m_liveMode = live;
+    m_liveTriggerPosition = -1.0;
+    for (int ch = 0; ch < 4; ++ch) {
+        m_liveTraces[ch].clear();
+        m_vertexRings[ch].clear();
+    }
+    m_needsUpdate = true;
+    update();
+}
+
+void WaveformGLWidget::setLiveFrame(const std::vector<WaveformTracePoint> traces[4], double length, double triggerPosition)
+{
+    if (!m_liveMode || length <= 0)
+        return;
+
+    for (int ch = 0; ch < 4; ++ch) {
+        m_liveTraces[ch].assign(traces[ch].begin(), traces[ch].end());
+    }
+    m_viewXMin = 0.0;
+    m_viewXMax = length;
+    m_liveTriggerPosition = triggerPosition;
+    update();
+}
+
 void WaveformGLWidget::setViewRange(double xMin, double xMax)
 {
+    // 视图变化不使已生成的顶点失效，只需生成新露出的块
     if (m_viewXMin != xMin || m_viewXMax != xMax) {
         m_viewXMin = xMin;
         m_viewXMax = xMax;
-        m_needsUpdate = true;
         update();
     }
 }
@@ -114,8 +170,8 @@ void WaveformGLWidget::getViewRange(double& xMin, double& xMax) const
 void WaveformGLWidget::setVerticalScale(double scale)
 {
     if (scale > 0 && m_verticalScale != scale) {
+        // 高低电平的位置由着色器参数决定，不需要重新生成顶点
         m_verticalScale = scale;
-        m_needsUpdate = true;
         update();
     }
 }
@@ -239,7 +295,7 @@ void WaveformGLWidget::slot_WF_GL_handleWheelScroll(const QPoint& pos, const QPo
 
 void WaveformGLWidget::slot_WF_GL_handleWheelEvent(const QPoint& pos, const QPoint& angleDelta)
 {
-    if (!m_model)
+    if (!m_model || m_liveMode)
         return;
 
     // 获取当前视图范围
@@ -387,6 +443,44 @@ void WaveformGLWidget::initializeGL()
     m_gridColorBuffer->create();
     m_gridColorBuffer->setUsagePattern(QOpenGLBuffer::DynamicDraw);
 
+    // 创建波形着色器程序：顶点x为相对原点的样本位置，y为电平，
+    // 平移缩放和通道位置都由uniform给出，视图变化时不需要重新上传顶点
+    const char* waveformVertexShaderSource =
+        "#version 330 core\n"
+        "layout (location = 0) in vec2 position;\n"
+        "uniform vec2 xTransform;\n"
+        "uniform vec2 yLevels;\n"
+        "void main() {\n"
+        "    gl_Position = vec4(position.x * xTransform.x + xTransform.y,\n"
+        "        mix(yLevels.x, yLevels.y, position.y), 0.0, 1.0);\n"
+        "}\n";
+
+    const char* waveformFragmentShaderSource =
+        "#version 330 core\n"
+        "uniform vec3 lineColor;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    fragColor = vec4(lineColor, 1.0);\n"
+        "}\n";
+
+    m_waveformProgram = new QOpenGLShaderProgram();
+    m_waveformProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, waveformVertexShaderSource);
+    m_waveformProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, waveformFragmentShaderSource);
+    const bool waveformLinked = m_waveformProgram->link();
+
+    for (QOpenGLBuffer*& buffer : m_channelBuffers) {
+        buffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+        buffer->create();
+        buffer->setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+
+    // 核心模式下绘制必须绑定VAO；不可用时退回QPainter绘制波形
+    m_waveformGLReady = waveformLinked && m_waveformVao.create();
+    if (!m_waveformGLReady) {
+        LOG_WARN(LocalQTCompat::fromLocal8Bit("波形着色器不可用，使用QPainter绘制波形: %1")
+            .arg(m_waveformProgram->log()));
+    }
+
     // 初始化默认网格
     createDefaultGrid();
 
@@ -428,7 +522,6 @@ void WaveformGLWidget::resizeGL(int w, int h)
     glViewport(0, 0, w, h);
     m_viewportWidth = w;
     m_viewportHeight = h;
-    m_needsUpdate = true;
     LOG_INFO(LocalQTCompat::fromLocal8Bit("调整OpenGL视图大小: %1 x %2").arg(w).arg(h));
 }
 
@@ -456,16 +549,30 @@ void WaveformGLWidget::paintGL()
         painter.drawLine(0, y, width(), y);
     }
 
-    // 绘制通道数据（将原来的 OpenGL 绘制转换为 QPainter 绘制）
-    if (m_model) {
+    // 波形由GPU绘制：顶点按块增量上传，平移缩放只改变着色器参数
+    if (m_model && m_waveformGLReady) {
+        painter.beginNativePainting();
+        updateWaveformData();
+        drawWaveformsGL();
+        painter.endNativePainting();
+    }
+
+    // 时间轴的占位区域、触发位置，以及GPU不可用时的波形，由QPainter绘制
+    if (m_model && m_liveMode) {
+        drawLiveFrame(painter);
+    }
+    else if (m_model && m_model->getTileSource()->isActive()) {
+        drawTimeline(painter);
+    }
+    else if (m_model && !m_waveformGLReady) {
         for (int ch = 0; ch < 4; ++ch) {
             if (!m_model->isChannelEnabled(ch))
                 continue;
 
-            QVector<double> data = m_model->getChannelData(ch);
-            QVector<double> indexData = m_model->getIndexData();
+            const LogicChannel& data = m_model->getLogicChannel(ch);
+            const double indexStart = m_model->getIndexStart();
 
-            if (data.isEmpty() || indexData.isEmpty())
+            if (data.empty())
                 continue;
 
             // 设置通道颜色
@@ -483,22 +590,25 @@ void WaveformGLWidget::paintGL()
             int channelHeight = height() / 4;
             int midY = ch * channelHeight + channelHeight / 2;
 
-            // 绘制波形数据
-            QPainterPath path;
-            bool started = false;
+            // 只绘制可见范围；按每像素样本数选择摘要层级，顶点数只与控件宽度有关
+            const double viewFirst = std::floor(m_viewXMin - indexStart);
+            const double viewLast = std::ceil(m_viewXMax - indexStart);
+            if (viewLast < 0 || viewFirst >= static_cast<double>(data.size()))
+                continue;
+            const size_t first = static_cast<size_t>(std::max(viewFirst, 0.0));
+            const size_t last = std::min(static_cast<size_t>(viewLast), data.size() - 1);
 
-            for (int i = 0; i < data.size() && i < indexData.size(); ++i) {
-                double index = indexData[i];
-                double value = data[i];
+            m_model->getChannelPyramid(ch).trace(data, first, last, width(), m_tracePoints);
 
-                // 映射到屏幕坐标
-                double xRatio = (index - m_viewXMin) / (m_viewXMax - m_viewXMin);
-                int x = qRound(xRatio * width());
-                int y = midY - (value > 0.5 ? channelHeight / 4 : -channelHeight / 4);
+            QPainterPath path;
+            const double xScale = width() / (m_viewXMax - m_viewXMin);
+            for (size_t i = 0; i < m_tracePoints.size(); ++i) {
+                const WaveformTracePoint& point = m_tracePoints[i];
+                int x = qRound((indexStart + point.sample - m_viewXMin) * xScale);
+                int y = midY - (point.level ? channelHeight / 4 : -channelHeight / 4);
 
-                if (!started) {
+                if (i == 0) {
                     path.moveTo(x, y);
-                    started = true;
                 }
                 else {
                     path.lineTo(x, y);
@@ -508,7 +618,7 @@ void WaveformGLWidget::paintGL()
             painter.drawPath(path);
         }
     }
-    else {
+    else if (!m_model) {
         // 显示提示信息
         painter.setPen(Qt::darkGray);
         painter.drawText(rect(), Qt::AlignCenter, "无波形数据或模型未初始化");
@@ -519,6 +629,181 @@ void WaveformGLWidget::paintGL()
     painter.drawText(10, 20, QString("尺寸: %1 x %2").arg(width()).arg(height()));
 }
 
+bool WaveformGLWidget::traceTiles(int channel, quint64 first, quint64 last, int pixelWidth,
+    std::vector<WaveformTracePoint>& points)
+{
+    WaveformTileSource* tiles = m_model->getTileSource();
+    const quint64 firstTile = WaveformTileSource::tileIndexOf(first);
+    const quint64 lastTile = WaveformTileSource::tileIndexOf(last);
+    const double samplesPerPixel = static_cast<double>(last - first + 1) / std::max(pixelWidth, 1);
+
+    points.clear();
+    for (quint64 t = firstTile; t <= lastTile; ++t) {
+        QSharedPointer<const WaveformTile> tile = tiles->tile(t);
+        if (!tile) {
+            // 块的最后一个样本只用于和下一块相连，所在分块未加载时把末尾延伸过去即可
+            if (t == lastTile && t > firstTile && last == t * WaveformTileSource::TILE_SAMPLES && !points.empty()) {
+                points.push_back({ static_cast<double>(last), points.back().level });
+                break;
+            }
+            return false;
+        }
+
+        const quint64 tileFirst = tile->firstSample;
+        const size_t from = static_cast<size_t>(first > tileFirst ? first - tileFirst : 0);
+        const size_t to = static_cast<size_t>(std::min<quint64>(last - tileFirst, tile->sampleCount - 1));
+        if (from > to)
+            continue;
+
+        const int tileWidth = std::max(1, static_cast<int>(std::lround((to - from + 1) / samplesPerPixel)));
+        WaveformVertexRing::traceChannel(tile->channels[channel], tile->pyramids[channel], from, to, tileWidth, m_tracePoints);
+        for (const WaveformTracePoint& point : m_tracePoints) {
+            points.push_back({ static_cast<double>(tileFirst) + point.sample, point.level });
+        }
+    }
+
+    return !points.empty();
+}
+
+void WaveformGLWidget::drawLiveFrame(QPainter& painter)
+{
+    const double length = m_viewXMax - m_viewXMin;
+    if (length <= 0)
+        return;
+
+    const double xScale = width() / length;
+    const int channelHeight = height() / 4;
+
+    for (int ch = 0; ch < 4 && !m_waveformGLReady; ++ch) {
+        const std::vector<WaveformTracePoint>& trace = m_liveTraces[ch];
+        if (!m_model->isChannelEnabled(ch) || trace.size() < 2)
+            continue;
+
+        const int midY = ch * channelHeight + channelHeight / 2;
+        QPainterPath path;
+        for (size_t i = 0; i < trace.size(); ++i) {
+            const int x = qRound((trace[i].sample - m_viewXMin) * xScale);
+            const int y = midY - (trace[i].level ? channelHeight / 4 : -channelHeight / 4);
+            if (i == 0) {
+                path.moveTo(x, y);
+            }
+            else {
+                path.lineTo(x, y);
+            }
+        }
+        painter.setPen(QPen(m_model->getChannelColor(ch), 2));
+        painter.drawPath(path);
+    }
+
+    if (m_liveTriggerPosition >= 0) {
+        const int x = qRound((m_liveTriggerPosition - m_viewXMin) * xScale);
+        painter.setPen(QPen(QColor(255, 140, 0), 1, Qt::DashLine));
+        painter.drawLine(x, 0, x, height());
+        painter.drawText(x + 4, 14, "T");
+    }
+}
+
+void WaveformGLWidget::drawTimeline(QPainter& painter)
+{
+    WaveformTileSource* tiles = m_model->getTileSource();
+    const double viewRange = m_viewXMax - m_viewXMin;
+    if (viewRange <= 0 || width() <= 0)
+        return;
+
+    // 视图索引即文件中的样本位置
+    const double viewFirst = std::max(0.0, std::floor(m_viewXMin));
+    const double viewLast = std::min(static_cast<double>(tiles->totalSamples() - 1), std::ceil(m_viewXMax));
+    if (viewFirst > viewLast)
+        return;
+
+    const quint64 firstSample = static_cast<quint64>(viewFirst);
+    const quint64 lastSample = static_cast<quint64>(viewLast);
+    const quint64 firstTile = WaveformTileSource::tileIndexOf(firstSample);
+    const quint64 lastTile = WaveformTileSource::tileIndexOf(lastSample);
+
+    const double xScale = width() / viewRange;
+    const int channelHeight = height() / 4;
+
+    // 占位区域：连续未加载的分块合并为一个带斜纹的矩形
+    auto drawPlaceholder = [&](quint64 begin, quint64 end) {
+        const int x0 = qRound((begin - m_viewXMin) * xScale);
+        const int x1 = std::max(x0 + 1, qRound((end - m_viewXMin) * xScale));
+        const QRect area(x0, 0, x1 - x0, height());
+        painter.fillRect(area, QBrush(QColor(200, 200, 215), Qt::BDiagPattern));
+        if (area.width() > 80) {
+            painter.setPen(Qt::darkGray);
+            painter.drawText(area, Qt::AlignCenter, LocalQTCompat::fromLocal8Bit("加载中..."));
+        }
+        };
+
+    QPainterPath paths[4];
+    bool connected[4] = { false, false, false, false };
+    bool inPlaceholder = false;
+    quint64 placeholderStart = 0;
+
+    for (quint64 t = firstTile; t <= lastTile; ++t) {
+        const quint64 tileFirst = t * WaveformTileSource::TILE_SAMPLES;
+        QSharedPointer<const WaveformTile> tile = tiles->tile(t);
+
+        if (!tile) {
+            if (!inPlaceholder) {
+                placeholderStart = std::max(tileFirst, firstSample);
+                inPlaceholder = true;
+            }
+            std::fill(std::begin(connected), std::end(connected), false);
+            continue;
+        }
+
+        if (inPlaceholder) {
+            drawPlaceholder(placeholderStart, tileFirst);
+            inPlaceholder = false;
+        }
+
+        const size_t first = static_cast<size_t>(firstSample > tileFirst ? firstSample - tileFirst : 0);
+        const size_t last = static_cast<size_t>(std::min<quint64>(lastSample - tileFirst, tile->sampleCount - 1));
+        if (first > last)
+            continue;
+
+        // 分块在屏幕上的宽度决定摘要层级，放大缩小时每块的顶点数都只与其像素宽度有关
+        const int pixelWidth = std::max(1, qRound((last - first + 1) * xScale));
+
+        for (int ch = 0; ch < 4 && !m_waveformGLReady; ++ch) {
+            if (!m_model->isChannelEnabled(ch))
+                continue;
+
+            const int midY = ch * channelHeight + channelHeight / 2;
+            tile->pyramids[ch].trace(tile->channels[ch], first, last, pixelWidth, m_tracePoints);
+
+            for (size_t i = 0; i < m_tracePoints.size(); ++i) {
+                const WaveformTracePoint& point = m_tracePoints[i];
+                int x = qRound((tileFirst + point.sample - m_viewXMin) * xScale);
+                int y = midY - (point.level ? channelHeight / 4 : -channelHeight / 4);
+
+                // 与前一个已加载分块首尾相连
+                if (i == 0 && !connected[ch]) {
+                    paths[ch].moveTo(x, y);
+                }
+                else {
+                    paths[ch].lineTo(x, y);
+                }
+            }
+            connected[ch] = true;
+        }
+    }
+
+    if (inPlaceholder) {
+        drawPlaceholder(placeholderStart, lastSample + 1);
+    }
+
+    for (int ch = 0; ch < 4; ++ch) {
+        if (!m_model->isChannelEnabled(ch) || paths[ch].isEmpty())
+            continue;
+
+        painter.setPen(QPen(m_model->getChannelColor(ch), 2));
+        painter.drawPath(paths[ch]);
+    }
+}
+
 void WaveformGLWidget::updateGridVertices()
 {
     if (!m_model)
@@ -615,101 +900,86 @@ void WaveformGLWidget::updateWaveformData()
     if (!m_model)
         return;
 
-    // 清除之前的数据
-    for (int ch = 0; ch < 4; ++ch) {
-        m_vertexData[ch].clear();
-        m_colorData[ch].clear();
+    // 实时显示每帧内容都不同，整帧写到各通道缓冲的开头
+    if (m_liveMode) {
+        for (int ch = 0; ch < 4; ++ch) {
+            const std::vector<WaveformTracePoint>& trace = m_liveTraces[ch];
+            if (!m_model->isChannelEnabled(ch) || trace.size() < 2)
+                continue;
+
+            m_liveVertices.resize(trace.size());
+            for (size_t i = 0; i < trace.size(); ++i) {
+                m_liveVertices[i].x = static_cast<float>(trace[i].sample);
+                m_liveVertices[i].level = static_cast<float>(trace[i].level);
+            }
+
+            QOpenGLBuffer* buffer = m_channelBuffers[ch];
+            const int bytes = static_cast<int>(m_liveVertices.size() * sizeof(WaveformVertex));
+            buffer->bind();
+            if (buffer->size() < bytes) {
+                buffer->allocate(m_liveVertices.data(), bytes);
+            }
+            else {
+                buffer->write(0, m_liveVertices.data(), bytes);
+            }
+            buffer->release();
+        }
+        return;
+    }
+
+    // 数据整体变化时所有块重新生成；平移缩放只生成新露出的块
+    if (m_needsUpdate) {
+        for (WaveformVertexRing& ring : m_vertexRings) {
+            ring.invalidate();
+        }
+        m_needsUpdate = false;
     }
 
-    // 为每个通道准备数据
+    WaveformTileSource* tiles = m_model->getTileSource();
+    const bool timeline = tiles->isActive();
+    const double indexOffset = timeline ? 0.0 : m_model->getIndexStart();
+
     for (int ch = 0; ch < 4; ++ch) {
         if (!m_model->isChannelEnabled(ch))
             continue;
 
-        QVector<double> data = m_model->getChannelData(ch);
-        QVector<double> indexData = m_model->getIndexData();
+        WaveformVertexRing& ring = m_vertexRings[ch];
+        const LogicChannel& data = m_model->getLogicChannel(ch);
+        const quint64 sampleCount = timeline ? tiles->totalSamples() : data.size();
 
-        if (data.isEmpty() || indexData.isEmpty()) {
-            LOG_INFO(LocalQTCompat::fromLocal8Bit("通道：%1没有数据").arg(ch));
-            continue;
+        WaveformVertexRing::ChunkBuilder builder;
+        if (timeline) {
+            builder = [this, ch](uint64_t first, uint64_t last, int pixelWidth, std::vector<WaveformTracePoint>& points) {
+                return traceTiles(ch, first, last, pixelWidth, points);
+                };
         }
-
-        // 确保索引数据和通道数据长度一致
-        if (indexData.size() != data.size()) {
-            LOG_INFO(LocalQTCompat::fromLocal8Bit("警告：通道：%1索引数据和通道数据长度不一致，进行调整").arg(ch));
-            // 重新生成索引数据
-            indexData.clear();
-            for (int i = 0; i < data.size(); ++i) {
-                indexData.append(i);
-            }
+        else {
+            const WaveformPyramid& pyramid = m_model->getChannelPyramid(ch);
+            builder = [&data, &pyramid](uint64_t first, uint64_t last, int pixelWidth, std::vector<WaveformTracePoint>& points) {
+                WaveformVertexRing::traceChannel(data, pyramid, static_cast<size_t>(first), static_cast<size_t>(last),
+                    pixelWidth, points);
+                return true;
+                };
         }
 
-        // 计算可见数据点的范围
-        int startIdx = std::max(0, static_cast<int>(std::ceil(m_viewXMin)));
-        int endIdx = std::min(static_cast<int>(std::floor(m_viewXMax)), static_cast<int>(data.size()) - 1);
-
-        if (startIdx >= endIdx || startIdx < 0 || endIdx >= data.size()) {
-            LOG_INFO(LocalQTCompat::fromLocal8Bit("通道：%1可见范围无效，%2 到 %3")
-                .arg(ch).arg(startIdx).arg(endIdx));
+        const bool reallocate = ring.update(m_viewXMin - indexOffset, m_viewXMax - indexOffset, width(), sampleCount, builder);
+        if (ring.slotCount() == 0)
             continue;
-        }
 
-        // 获取通道颜色
-        QColor chColor = m_model->getChannelColor(ch);
-        float r = chColor.redF();
-        float g = chColor.greenF();
-        float b = chColor.blueF();
-        QVector3D colorVec(r, g, b);
-
-        // 计算通道区域
-        int channelHeight = height() / 4;
-        int channelTop = channelHeight * ch;
-        int midY = channelTop + channelHeight / 2;
-        int deltaY = static_cast<int>((channelHeight / 4) * m_verticalScale);
-        int highY = midY - deltaY;
-        int lowY = midY + deltaY;
-
-        // 准备顶点数据 - 为数字信号创建阶梯波形
-        QVector<QVector2D> vertices;
-        QVector<QVector3D> colors;
-
-        // 添加第一个点
-        if (startIdx < data.size()) {
-            float x = normalizeX(indexData[startIdx]);
-            float y = data[startIdx] > 0.5 ? normalizeY(highY) : normalizeY(lowY);
-
-            vertices.append(QVector2D(x, y));
-            colors.append(colorVec);
+        // 槽数量或块大小变化时重新分配整个缓冲，否则只上传内容变化的槽
+        QOpenGLBuffer* buffer = m_channelBuffers[ch];
+        const int bufferBytes = ring.slotCount() * WaveformVertexRing::SLOT_VERTICES * static_cast<int>(sizeof(WaveformVertex));
+        buffer->bind();
+        if (reallocate || buffer->size() != bufferBytes) {
+            buffer->allocate(bufferBytes);
         }
-
-        // 创建数字信号的阶梯波形
-        for (int i = startIdx; i < endIdx; ++i) {
-            if (i >= data.size() || i >= indexData.size() || i + 1 >= data.size() || i + 1 >= indexData.size())
-                continue;
-
-            float currentX = normalizeX(indexData[i]);
-            float nextX = normalizeX(indexData[i + 1]);
-
-            float currentY = data[i] > 0.5 ? normalizeY(highY) : normalizeY(lowY);
-            float nextY = data[i + 1] > 0.5 ? normalizeY(highY) : normalizeY(lowY);
-
-            // 添加水平线段到下一个点
-            vertices.append(QVector2D(nextX, currentY));
-            colors.append(colorVec);
-
-            // 如果有电平跳变，添加垂直线段
-            if (currentY != nextY) {
-                vertices.append(QVector2D(nextX, currentY));
-                colors.append(colorVec);
-
-                vertices.append(QVector2D(nextX, nextY));
-                colors.append(colorVec);
-            }
+        for (int slot : ring.dirtySlots()) {
+            const int offset = slot * WaveformVertexRing::SLOT_VERTICES;
+            buffer->write(offset * static_cast<int>(sizeof(WaveformVertex)), ring.vertices().data() + offset,
+                ring.slotVertexCount(slot) * static_cast<int>(sizeof(WaveformVertex)));
         }
-
-        // 保存顶点数据
-        m_vertexData[ch] = vertices;
-        m_colorData[ch] = colors;
+        buffer->release();
+        ring.clearDirty();
     }
 }
 
@@ -721,68 +991,62 @@ void WaveformGLWidget::drawWaveformsGL()
     // 设置线宽
     glLineWidth(m_model->getWaveformLineWidth());
 
-    // 绑定着色器程序
-    m_program->bind();
+    m_waveformProgram->bind();
+    m_waveformVao.bind();
 
-    // 设置MVP矩阵
-    QMatrix4x4 projection;
-    projection.ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
-    m_program->setUniformValue("mvp", projection);
+    const double indexOffset = m_model->getTileSource()->isActive() ? 0.0 : m_model->getIndexStart();
+    const int channelHeight = height() / 4;
 
-    // 标记是否有数据被绘制
-    bool hasDrawnAnyData = false;
-
-    // 为每个通道绘制数据
     for (int ch = 0; ch < 4; ++ch) {
-        if (!m_model->isChannelEnabled(ch) || m_vertexData[ch].isEmpty())
+        const WaveformVertexRing& ring = m_vertexRings[ch];
+        const int liveVertexCount = static_cast<int>(m_liveTraces[ch].size());
+        if (!m_model->isChannelEnabled(ch))
             continue;
-
-        // 确认顶点数量
-        int vertexCount = m_vertexData[ch].size();
-
-        if (vertexCount < 2) {
+        if (m_liveMode ? liveVertexCount < 2 : ring.slotCount() == 0)
             continue;
-        }
-
-        // 更新顶点缓冲区
-        m_vertexBuffer->bind();
-        m_vertexBuffer->allocate(m_vertexData[ch].constData(),
-            vertexCount * sizeof(QVector2D));
 
-        // 更新颜色缓冲区
-        m_colorBuffer->bind();
-        m_colorBuffer->allocate(m_colorData[ch].constData(),
-            vertexCount * sizeof(QVector3D));
-
-        // 设置顶点属性
-        m_program->enableAttributeArray(0);
-        m_vertexBuffer->bind();
-        m_program->setAttributeBuffer(0, GL_FLOAT, 0, 2);
+        // 顶点x相对环形缓冲的原点（实时显示时相对窗口起点），由着色器换算到当前视图
+        float xScale = 0.0f;
+        float xOffset = 0.0f;
+        if (m_liveMode) {
+            const double range = m_viewXMax > m_viewXMin ? m_viewXMax - m_viewXMin : 1.0;
+            xScale = static_cast<float>(2.0 / range);
+            xOffset = static_cast<float>(-m_viewXMin * 2.0 / range - 1.0);
+        }
+        else {
+            ring.xTransform(m_viewXMin - indexOffset, m_viewXMax - indexOffset, xScale, xOffset);
+        }
 
-        // 设置颜色属性
-        m_program->enableAttributeArray(1);
-        m_colorBuffer->bind();
-        m_program->setAttributeBuffer(1, GL_FLOAT, 0, 3);
+        // 电平0/1映射到通道的低/高电平位置
+        const int midY = channelHeight * ch + channelHeight / 2;
+        const int deltaY = static_cast<int>((channelHeight / 4) * m_verticalScale);
+        const QColor color = m_model->getChannelColor(ch);
 
-        // 使用GL_LINE_STRIP绘制连续线段
-        glDrawArrays(GL_LINE_STRIP, 0, vertexCount);
+        m_waveformProgram->setUniformValue("xTransform", xScale, xOffset);
+        m_waveformProgram->setUniformValue("yLevels", normalizeY(midY + deltaY), normalizeY(midY - deltaY));
+        m_waveformProgram->setUniformValue("lineColor",
+            static_cast<float>(color.redF()), static_cast<float>(color.greenF()), static_cast<float>(color.blueF()));
 
-        // 禁用顶点属性
-        m_program->disableAttributeArray(0);
-        m_program->disableAttributeArray(1);
+        m_channelBuffers[ch]->bind();
+        m_waveformProgram->enableAttributeArray(0);
+        m_waveformProgram->setAttributeBuffer(0, GL_FLOAT, 0, 2, sizeof(WaveformVertex));
 
-        hasDrawnAnyData = true;
-    }
+        // 每块一条独立的折线，相邻块首尾样本相同，画出来是连续的
+        if (m_liveMode) {
+            glDrawArrays(GL_LINE_STRIP, 0, liveVertexCount);
+        }
+        else {
+            ring.forEachDrawable([this](int slot, int vertexCount) {
+                glDrawArrays(GL_LINE_STRIP, slot * WaveformVertexRing::SLOT_VERTICES, vertexCount);
+                });
+        }
 
-    // 如果没有绘制任何数据，绘制一个提示文本或标志
-    if (!hasDrawnAnyData) {
-        // 这里只是设置一个标记，实际的提示文本绘制可以在paintGL中完成
-        // 或者在这里绘制一个简单的"无数据"标志
-        LOG_WARN(LocalQTCompat::fromLocal8Bit("没有有效的通道数据用于绘制"));
+        m_waveformProgram->disableAttributeArray(0);
+        m_channelBuffers[ch]->release();
     }
 
-    // 解绑着色器程序
-    m_program->release();
+    m_waveformVao.release();
+    m_waveformProgram->release();
 }
 
 void WaveformGLWidget::drawMarkers()
@@ -953,7 +1217,8 @@ void WaveformGLWidget::mouseDoubleClickEvent(QMouseEvent* event)
 
 void WaveformGLWidget::wheelEvent(QWheelEvent* event)
 {
-    if (!m_model)
+    // 实时显示的时基由控制器的放大/缩小调整
+    if (!m_model || m_liveMode)
         return;
 
     // 获取当前视图范围
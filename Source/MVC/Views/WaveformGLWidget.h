@@ -5,11 +5,15 @@
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
 #include <QVector2D>
 #include <QVector3D>
 #include <QMatrix4x4>
 #include <QMouseEvent>
 #include <QMap>
+#include <vector>
+#include "WaveformPyramid.h"
+#include "WaveformVertexRing.h"
 
 class WaveformAnalysisModel;
 
@@ -41,10 +45,36 @@ public:
     void setModel(WaveformAnalysisModel* model);
 
     /**
-     * @brief 请求更新波形
+     * @brief 请求更新波形，数据已变化，所有顶点重新生成
      */
     void requestUpdate();
 
+    /**
+     * @brief 样本区间的数据已变化（如分块加载完成），只重新生成覆盖它的顶点块
+     * @param first 第一个样本
+     * @param last 最后一个样本
+     */
+    void invalidateSamples(double first, double last);
+
+    /**
+     * @brief 切换实时显示，实时模式下只绘制setLiveFrame给出的折线
+     * @param live 是否实时显示
+     */
+    void setLiveMode(bool live);
+
+    /**
+     * @brief 是否处于实时显示
+     */
+    bool isLiveMode() const { return m_liveMode; }
+
+    /**
+     * @brief 设置实时显示的一帧并重绘
+     * @param traces 4个通道的折线，x为窗口内的位置
+     * @param length 窗口长度
+     * @param triggerPosition 触发位置，没有触发时为负数
+     */
+    void setLiveFrame(const std::vector<WaveformTracePoint> traces[4], double length, double triggerPosition);
+
     /**
      * @brief 设置数据范围
      * @param xMin 最小X值
@@ -159,7 +189,7 @@ signals:
      * @param startIndex 起始索引
      * @param length 数据长度
      */
-    void signal_WF_GL_loadDataRequested(int startIndex, int length);
+    void signal_WF_GL_loadDataRequested(qint64 startIndex, qint64 length);
 
 protected:
     /**
@@ -226,15 +256,38 @@ private:
     void createDefaultGrid();
 
     /**
-     * @brief 更新波形数据到OpenGL
+     * @brief 更新波形数据到OpenGL，只生成并上传新露出或数据已变化的顶点块
      */
     void updateWaveformData();
 
     /**
-     * @brief 使用OpenGL绘制波形
+     * @brief 使用OpenGL绘制波形，视图变换由着色器完成
      */
     void drawWaveformsGL();
 
+    /**
+     * @brief 由已加载的分块生成一个顶点块的折线
+     * @param channel 通道索引
+     * @param first 第一个样本
+     * @param last 最后一个样本（含）
+     * @param pixelWidth 像素宽度
+     * @param points 输出折线顶点
+     * @return 需要的分块都已加载时为true
+     */
+    bool traceTiles(int channel, quint64 first, quint64 last, int pixelWidth, std::vector<WaveformTracePoint>& points);
+
+    /**
+     * @brief 绘制实时显示的触发位置，GPU不可用时同时绘制折线
+     * @param painter 绘图对象
+     */
+    void drawLiveFrame(QPainter& painter);
+
+    /**
+     * @brief 按分块绘制整个文件的时间轴，未加载的分块绘制为占位区域
+     * @param painter 绘图对象
+     */
+    void drawTimeline(QPainter& painter);
+
     /**
      * @brief 绘制标记点
      */
@@ -262,12 +315,24 @@ private:
     QOpenGLBuffer* m_vertexBuffer = nullptr;          ///< 顶点缓冲区
     QOpenGLBuffer* m_colorBuffer = nullptr;           ///< 颜色缓冲区
 
-    QMap<int, QVector<QVector2D>> m_vertexData;       ///< 通道顶点数据
-    QMap<int, QVector<QVector3D>> m_colorData;        ///< 通道颜色数据
+    std::vector<WaveformTracePoint> m_tracePoints;    ///< 折线生成的复用缓冲区
+
+    // 波形顶点：每通道一个按块分槽的环形缓冲，x变换在着色器中完成
+    QOpenGLShaderProgram* m_waveformProgram = nullptr;    ///< 波形着色器程序
+    QOpenGLVertexArrayObject m_waveformVao;               ///< 波形顶点数组对象
+    QOpenGLBuffer* m_channelBuffers[4] = {};              ///< 各通道的GPU顶点缓冲
+    WaveformVertexRing m_vertexRings[4];                  ///< 各通道的CPU侧环形顶点
+    bool m_waveformGLReady = false;                       ///< GPU波形绘制是否可用
+
+    // 实时显示：每帧整体替换，不使用环形顶点
+    bool m_liveMode = false;                              ///< 是否实时显示
+    std::vector<WaveformTracePoint> m_liveTraces[4];      ///< 各通道当前帧的折线
+    std::vector<WaveformVertex> m_liveVertices;           ///< 上传用的顶点缓冲区
+    double m_liveTriggerPosition = -1.0;                  ///< 触发位置，负数表示未触发
 
     WaveformAnalysisModel* m_model = nullptr;         ///< 波形模型指针
 
-    bool m_needsUpdate = true;                        ///< 是否需要更新
+    bool m_needsUpdate = true;                        ///< 数据是否已变化，需要重新生成全部顶点
     bool m_isDragging = false;                        ///< 是否正在拖动
     QPoint m_lastMousePos;                            ///< 上次鼠标位置
     int m_frameCount = 0;                             ///< 帧计数器